@@ -34,7 +34,6 @@
 #include <wx/datetime.h>
 #include <wx/filename.h>
 #include <wx/log.h>
-#include <wx/stdpaths.h>
 
 #include <boost/version.hpp>
 
@@ -534,31 +533,9 @@ bool S3D_CACHE::Set3DConfigDir( const wxString& aConfigDir )
                     __FILE__, __FUNCTION__, __LINE__, m_ConfigDir );
     }
 
-    // 3D cache data must go to a user's cache directory;
-    // unfortunately wxWidgets doesn't seem to provide
-    // functions to retrieve such a directory.
-    //
-    // 1. OSX: ~/Library/Caches/kicad/3d/
-    // 2. Linux: ${XDG_CACHE_HOME}/kicad/3d ~/.cache/kicad/3d/
-    // 3. MSWin: AppData\Local\kicad\3d
-    wxString cacheDir;
-
-#if defined(_WIN32)
-    wxStandardPaths::Get().UseAppInfo( wxStandardPaths::AppInfo_None );
-    cacheDir = wxStandardPaths::Get().GetUserLocalDataDir();
-    cacheDir.append( "\\kicad\\3d" );
-#elif defined(__APPLE)
-    cacheDir = "${HOME}/Library/Caches/kicad/3d";
-#else   // assume Linux
-    cacheDir = ExpandEnvVarSubstitutions( "${XDG_CACHE_HOME}", nullptr );
-
-    if( cacheDir.empty() || cacheDir == "${XDG_CACHE_HOME}" )
-        cacheDir = "${HOME}/.cache";
-
-    cacheDir.append( "/kicad/3d" );
-#endif
+    // 3D cache data must go to a user's cache directory
+    wxString cacheDir = GetUserCacheDir() + wxFileName::GetPathSeparator() + "3d";
 
-    cacheDir = ExpandEnvVarSubstitutions( cacheDir, m_project );
     cfgdir.Assign( cacheDir, "" );
 
     if( !cfgdir.DirExists() )
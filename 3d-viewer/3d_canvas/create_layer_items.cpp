@@ -49,10 +49,10 @@
 #include <class_zone.h>
 #include <class_text_mod.h>
 #include <convert_basic_shapes_to_polygon.h>
+#include <thread_pool.h>
 #include <trigo.h>
 #include <utility>
 #include <vector>
-#include <thread>
 #include <algorithm>
 #include <atomic>
 
@@ -691,12 +691,12 @@ void BOARD_ADAPTER::createLayers( REPORTER *aStatusTextReporter )
         // Add zones objects
         // /////////////////////////////////////////////////////////////////////
         std::atomic<size_t> nextZone( 0 );
-        std::atomic<size_t> threadsFinished( 0 );
+        TASK_GROUP tasks;
 
-        size_t parallelThreadCount = std::max<size_t>( std::thread::hardware_concurrency(), 2 );
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+        size_t parallelTaskCount = THREAD_POOL::Get().GetThreadCount();
+        for( size_t ii = 0; ii < parallelTaskCount; ++ii )
         {
-            std::thread t = std::thread( [&]()
+            tasks.Run( [&]()
             {
                 for( size_t areaId = nextZone.fetch_add( 1 );
                             areaId < static_cast<size_t>( m_board->GetAreaCount() );
@@ -713,15 +713,10 @@ void BOARD_ADAPTER::createLayers( REPORTER *aStatusTextReporter )
                         AddSolidAreasShapesToContainer( zone, layerContainer->second,
                                                         zone->GetLayer() );
                 }
-
-                threadsFinished++;
             } );
-
-            t.detach();
         }
 
-        while( threadsFinished < parallelThreadCount )
-            std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+        tasks.Wait();
 
     }
 
@@ -761,14 +756,13 @@ void BOARD_ADAPTER::createLayers( REPORTER *aStatusTextReporter )
             && ( m_render_engine == RENDER_ENGINE::OPENGL_LEGACY ) )
     {
         std::atomic<size_t> nextItem( 0 );
-        std::atomic<size_t> threadsFinished( 0 );
+        TASK_GROUP tasks;
 
-        size_t parallelThreadCount = std::min<size_t>(
-                std::max<size_t>( std::thread::hardware_concurrency(), 2 ),
-                layer_id.size() );
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+        size_t parallelTaskCount = std::min<size_t>( THREAD_POOL::Get().GetThreadCount(),
+                                                 layer_id.size() );
+        for( size_t ii = 0; ii < parallelTaskCount; ++ii )
         {
-            std::thread t = std::thread( [&nextItem, &threadsFinished, &layer_id, this]()
+            tasks.Run( [&nextItem, &layer_id, this]()
             {
                 for( size_t i = nextItem.fetch_add( 1 );
                             i < layer_id.size();
@@ -780,15 +774,10 @@ void BOARD_ADAPTER::createLayers( REPORTER *aStatusTextReporter )
                         // This will make a union of all added contours
                         layerPoly->second->Simplify( SHAPE_POLY_SET::PM_FAST );
                 }
-
-                threadsFinished++;
             } );
-
-            t.detach();
         }
 
-        while( threadsFinished < parallelThreadCount )
-            std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+        tasks.Wait();
     }
 
 #ifdef PRINT_STATISTICS_3D_VIEWER
@@ -32,7 +32,6 @@
 #include <atomic>
 #include <chrono>
 #include <climits>
-#include <thread>
 
 #include "c3d_render_raytracing.h"
 #include "mortoncodes.h"
@@ -41,6 +40,7 @@
 #include "3d_math.h"
 #include "../common_ogl/ogl_utils.h"
 #include <profile.h>        // To use GetRunningMicroSecs or another profiling utility
+#include <thread_pool.h>
 
 // This should be used in future for the function
 // convertLinearToSRGB
@@ -371,14 +371,13 @@ void C3D_RENDER_RAYTRACING::rt_render_tracing( GLubyte *ptrPBO ,
 
     std::atomic<size_t> numBlocksRendered( 0 );
     std::atomic<size_t> currentBlock( 0 );
-    std::atomic<size_t> threadsFinished( 0 );
+    TASK_GROUP tasks;
 
-    size_t parallelThreadCount = std::min<size_t>(
-            std::max<size_t>( std::thread::hardware_concurrency(), 2 ),
-            m_blockPositions.size() );
-    for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+    size_t parallelTaskCount = std::min<size_t>( THREAD_POOL::Get().GetThreadCount(),
+                                                 m_blockPositions.size() );
+    for( size_t ii = 0; ii < parallelTaskCount; ++ii )
     {
-        std::thread t = std::thread( [&]()
+        tasks.Run( [&]()
         {
             for( size_t iBlock = currentBlock.fetch_add( 1 );
                         iBlock < m_blockPositions.size() && !breakLoop;
@@ -397,15 +396,10 @@ void C3D_RENDER_RAYTRACING::rt_render_tracing( GLubyte *ptrPBO ,
                         breakLoop = true;
                 }
             }
-
-            threadsFinished++;
         } );
-
-        t.detach();
     }
 
-    while( threadsFinished < parallelThreadCount )
-        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+    tasks.Wait();
 
     m_nrBlocksRenderProgress += numBlocksRendered;
 
@@ -917,12 +911,12 @@ void C3D_RENDER_RAYTRACING::rt_render_post_process_shade( GLubyte *ptrPBO,
             aStatusTextReporter->Report( _("Rendering: Post processing shader") );
 
         std::atomic<size_t> nextBlock( 0 );
-        std::atomic<size_t> threadsFinished( 0 );
+        TASK_GROUP tasks;
 
-        size_t parallelThreadCount = std::max<size_t>( std::thread::hardware_concurrency(), 2 );
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+        size_t parallelTaskCount = THREAD_POOL::Get().GetThreadCount();
+        for( size_t ii = 0; ii < parallelTaskCount; ++ii )
         {
-            std::thread t = std::thread( [&]()
+            tasks.Run( [&]()
             {
                 for( size_t y = nextBlock.fetch_add( 1 );
                             y < m_realBufferSize.y;
@@ -936,15 +930,10 @@ void C3D_RENDER_RAYTRACING::rt_render_post_process_shade( GLubyte *ptrPBO,
                         ptr++;
                     }
                 }
-
-                threadsFinished++;
             } );
-
-            t.detach();
         }
 
-        while( threadsFinished < parallelThreadCount )
-            std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+        tasks.Wait();
 
         // Set next state
         m_rt_render_state = RT_RENDER_STATE_POST_PROCESS_BLUR_AND_FINISH;
@@ -966,12 +955,12 @@ void C3D_RENDER_RAYTRACING::rt_render_post_process_blur_finish( GLubyte *ptrPBO,
     {
         // Now blurs the shader result and compute the final color
         std::atomic<size_t> nextBlock( 0 );
-        std::atomic<size_t> threadsFinished( 0 );
+        TASK_GROUP tasks;
 
-        size_t parallelThreadCount = std::max<size_t>( std::thread::hardware_concurrency(), 2 );
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+        size_t parallelTaskCount = THREAD_POOL::Get().GetThreadCount();
+        for( size_t ii = 0; ii < parallelTaskCount; ++ii )
         {
-            std::thread t = std::thread( [&]()
+            tasks.Run( [&]()
             {
                 for( size_t y = nextBlock.fetch_add( 1 );
                             y < m_realBufferSize.y;
@@ -1056,15 +1045,10 @@ void C3D_RENDER_RAYTRACING::rt_render_post_process_blur_finish( GLubyte *ptrPBO,
                         ptr += 4;
                     }
                 }
-
-                threadsFinished++;
             } );
-
-            t.detach();
         }
 
-        while( threadsFinished < parallelThreadCount )
-            std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+        tasks.Wait();
 
 
         // Debug code
@@ -1081,14 +1065,13 @@ void C3D_RENDER_RAYTRACING::render_preview( GLubyte *ptrPBO )
     m_isPreview = true;
 
     std::atomic<size_t> nextBlock( 0 );
-    std::atomic<size_t> threadsFinished( 0 );
+    TASK_GROUP tasks;
 
-    size_t parallelThreadCount = std::min<size_t>(
-            std::max<size_t>( std::thread::hardware_concurrency(), 2 ),
-            m_blockPositions.size() );
-    for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+    size_t parallelTaskCount = std::min<size_t>( THREAD_POOL::Get().GetThreadCount(),
+                                                 m_blockPositions.size() );
+    for( size_t ii = 0; ii < parallelTaskCount; ++ii )
     {
-        std::thread t = std::thread( [&]()
+        tasks.Run( [&]()
         {
             for( size_t iBlock = nextBlock.fetch_add( 1 );
                         iBlock < m_blockPositionsFast.size();
@@ -1694,15 +1677,10 @@ void C3D_RENDER_RAYTRACING::render_preview( GLubyte *ptrPBO )
                     }
                 }
             }
-
-            threadsFinished++;
         } );
-
-        t.detach();
     }
 
-    while( threadsFinished < parallelThreadCount )
-        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+    tasks.Wait();
 }
 
 
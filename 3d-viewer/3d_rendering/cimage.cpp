@@ -29,10 +29,10 @@
 
 #include "cimage.h"
 #include "buffers_debug.h"
+#include <thread_pool.h>
 #include <cstring> // For memcpy
 
 #include <atomic>
-#include <thread>
 #include <chrono>
 
 #ifndef CLAMP
@@ -476,13 +476,13 @@ void CIMAGE::EfxFilter( CIMAGE* aInImg, IMAGE_FILTER aFilterType )
     m_wraping         = IMAGE_WRAP::CLAMP;
 
     std::atomic<size_t> nextRow( 0 );
-    std::atomic<size_t> threadsFinished( 0 );
+    TASK_GROUP tasks;
 
-    size_t parallelThreadCount = std::max<size_t>( std::thread::hardware_concurrency(), 2 );
+    size_t parallelTaskCount = THREAD_POOL::Get().GetThreadCount();
 
-    for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+    for( size_t ii = 0; ii < parallelTaskCount; ++ii )
     {
-        std::thread t = std::thread( [&]()
+        tasks.Run( [&]()
         {
             for( size_t iy = nextRow.fetch_add( 1 );
                         iy < m_height;
@@ -511,15 +511,10 @@ void CIMAGE::EfxFilter( CIMAGE* aInImg, IMAGE_FILTER aFilterType )
                     m_pixels[ix + iy * m_width] = v;
                 }
             }
-
-            threadsFinished++;
         } );
-
-        t.detach();
     }
 
-    while( threadsFinished < parallelThreadCount )
-        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+    tasks.Wait();
 }
 
 
@@ -80,6 +80,18 @@ static const wxChar RealtimeConnectivity[] = wxT( "RealtimeConnectivity" );
  */
 static const wxChar CoroutineStackSize[] = wxT( "CoroutineStackSize" );
 
+/**
+ * Write the filled polygons of the zones to a binary cache file when saving a board, and use
+ * it instead of the fills of the board file when loading it, if the board file did not change.
+ */
+static const wxChar ZoneFillCache[] = wxT( "ZoneFillCache" );
+
+/**
+ * Record the events received by the interactive router.  The '0' key saves them, with the
+ * logs of the current routing algorithm, to the temporary directory.
+ */
+static const wxChar RecordRouterEvents[] = wxT( "RecordRouterEvents" );
+
 } // namespace KEYS
 
 
@@ -160,6 +172,8 @@ ADVANCED_CFG::ADVANCED_CFG()
     m_EnableUsePadProperty = false;
     m_realTimeConnectivity = true;
     m_coroutineStackSize = AC_STACK::default_stack;
+    m_EnableZoneFillCache = false;
+    m_RecordRouterEvents = false;
 
     loadFromConfigFile();
 }
@@ -203,6 +217,12 @@ void ADVANCED_CFG::loadSettings( wxConfigBase& aCfg )
                                                &m_coroutineStackSize, AC_STACK::default_stack,
                                                AC_STACK::min_stack, AC_STACK::max_stack ) );
 
+    configParams.push_back( new PARAM_CFG_BOOL( true, AC_KEYS::ZoneFillCache,
+                                                &m_EnableZoneFillCache, false ) );
+
+    configParams.push_back( new PARAM_CFG_BOOL( true, AC_KEYS::RecordRouterEvents,
+                                                &m_RecordRouterEvents, false ) );
+
     wxConfigLoadSetups( &aCfg, configParams );
 
     for( auto param : configParams )
@@ -528,31 +528,60 @@ wxString GetAbbreviatedUnitsLabel( EDA_UNITS aUnit, bool aUseMils, EDA_DATA_TYPE
 }
 
 
-std::string FormatInternalUnits( int aValue )
+/// Number of decimals of a value in mm, IU_PER_MM being a power of ten
+static constexpr int iuDecimals( double aIuPerMM )
 {
-    char    buf[50];
-    double  engUnits = aValue;
-    int     len;
+    return aIuPerMM < 10.0 ? 0 : 1 + iuDecimals( aIuPerMM / 10.0 );
+}
 
-    engUnits /= IU_PER_MM;
 
-    if( engUnits != 0.0 && fabs( engUnits ) <= 0.0001 )
+int FormatInternalUnits( int aValue, char* aBuffer )
+{
+    // The value in mm is written from the digits of aValue, which gives the same string as
+    // printf( "%.10g" ) of aValue / IU_PER_MM, the values having at most 10 digits.
+    const int decimals = iuDecimals( IU_PER_MM );
+    unsigned  value = aValue < 0 ? 0u - (unsigned) aValue : (unsigned) aValue;
+    char      digits[16];
+    int       count = 0;
+    char*     out = aBuffer;
+
+    // Digits are stored from the last one, with at least one digit before the decimal point
+    while( value || count <= decimals )
     {
-        len = snprintf( buf, sizeof(buf), "%.10f", engUnits );
+        digits[count++] = '0' + value % 10;
+        value /= 10;
+    }
 
-        while( --len > 0 && buf[len] == '0' )
-            buf[len] = '\0';
+    // Trailing zeros of the fractional part are not written
+    int first = 0;
 
-        if( buf[len] == '.' )
-            buf[len] = '\0';
-        else
-            ++len;
-    }
-    else
+    while( first < decimals && digits[first] == '0' )
+        first++;
+
+    if( aValue < 0 )
+        *out++ = '-';
+
+    for( int ii = count - 1; ii >= decimals; --ii )
+        *out++ = digits[ii];
+
+    if( first < decimals )
     {
-        len = snprintf( buf, sizeof(buf), "%.10g", engUnits );
+        *out++ = '.';
+
+        for( int ii = decimals - 1; ii >= first; --ii )
+            *out++ = digits[ii];
     }
 
+    *out = '\0';
+    return out - aBuffer;
+}
+
+
+std::string FormatInternalUnits( int aValue )
+{
+    char buf[16];
+    int  len = FormatInternalUnits( aValue, buf );
+
     return std::string( buf, len );
 }
 
@@ -570,18 +599,24 @@ std::string FormatAngle( double aAngle )
 
 std::string FormatInternalUnits( const wxPoint& aPoint )
 {
-    return FormatInternalUnits( aPoint.x ) + " " + FormatInternalUnits( aPoint.y );
+    FMT_IU text( aPoint );
+
+    return std::string( text.c_str(), text.Length() );
 }
 
 
 std::string FormatInternalUnits( const VECTOR2I& aPoint )
 {
-    return FormatInternalUnits( aPoint.x ) + " " + FormatInternalUnits( aPoint.y );
+    FMT_IU text( aPoint );
+
+    return std::string( text.c_str(), text.Length() );
 }
 
 
 std::string FormatInternalUnits( const wxSize& aSize )
 {
-    return FormatInternalUnits( aSize.GetWidth() ) + " " + FormatInternalUnits( aSize.GetHeight() );
+    FMT_IU text( aSize );
+
+    return std::string( text.c_str(), text.Length() );
 }
 
@@ -45,6 +45,9 @@ using KIGFX::COLOR4D;
 // Create only once, as seeding is *very* expensive
 static boost::uuids::random_generator randomGenerator;
 
+// The generator keeps internal state; items (e.g. DRC markers) may be created from worker threads
+static std::mutex randomGeneratorMutex;
+
 // These don't have the same performance penalty, but might as well be consistent
 static boost::uuids::string_generator stringGenerator;
 static boost::uuids::nil_generator nilGenerator;
@@ -53,8 +56,16 @@ static boost::uuids::nil_generator nilGenerator;
 KIID niluuid( 0 );
 
 
+static boost::uuids::uuid newRandomUuid()
+{
+    std::lock_guard<std::mutex> lock( randomGeneratorMutex );
+
+    return randomGenerator();
+}
+
+
 KIID::KIID() :
-        m_uuid( randomGenerator() ),
+        m_uuid( newRandomUuid() ),
         m_cached_timestamp( 0 )
 {
 }
@@ -98,7 +109,7 @@ KIID::KIID( const wxString& aString ) :
         {
             // Failed to parse string representation; best we can do is assign a new
             // random one.
-            m_uuid = randomGenerator();
+            m_uuid = newRandomUuid();
         }
     }
 }
@@ -172,7 +183,7 @@ void KIID::ConvertTimestampToUuid()
         return;
 
     m_cached_timestamp = 0;
-    m_uuid = randomGenerator();
+    m_uuid = newRandomUuid();
 }
 
 
@@ -586,6 +597,29 @@ const wxString ResolveUriByEnvVars( const wxString& aUri, PROJECT* aProject )
 }
 
 
+wxString GetUserCacheDir()
+{
+    // wxWidgets has no function for the user cache directory.  On Windows, reading it from
+    // wxStandardPaths would need to change the application info of the global instance.
+    wxString cacheDir;
+
+#if defined(_WIN32)
+    cacheDir = "${LOCALAPPDATA}\\kicad";
+#elif defined(__APPLE__)
+    cacheDir = "${HOME}/Library/Caches/kicad";
+#else   // assume Linux
+    cacheDir = ExpandEnvVarSubstitutions( "${XDG_CACHE_HOME}", nullptr );
+
+    if( cacheDir.empty() || cacheDir == "${XDG_CACHE_HOME}" )
+        cacheDir = "${HOME}/.cache";
+
+    cacheDir.append( "/kicad" );
+#endif
+
+    return ExpandEnvVarSubstitutions( cacheDir, nullptr );
+}
+
+
 bool EnsureFileDirectoryExists( wxFileName*     aTargetFullFileName,
                                 const wxString& aBaseFilename,
                                 REPORTER*       aReporter )
@@ -655,7 +655,7 @@ L_read:
                     case 'v':   c = '\x0b';     break;
 
                     case 'x':   // 1 or 2 byte hex escape sequence
-                        for( i=0; i<2; ++i )
+                        for( i=0; i<2 && head+i<limit; ++i )
                         {
                             if( !isxdigit( head[i] ) )
                                 break;
@@ -671,7 +671,7 @@ L_read:
 
                     default:    // 1-3 byte octal escape sequence
                         --head;
-                        for( i=0; i<3; ++i )
+                        for( i=0; i<3 && head+i<limit; ++i )
                         {
                             if( head[i] < '0' || head[i] > '7' )
                                 break;
@@ -697,7 +697,15 @@ L_read:
                 }
 
                 else
-                    curText += *head++;
+                {
+                    // copy the run of plain chars at once
+                    const char* run = head;
+
+                    while( head<limit && *head!='\\' && *head!='"' )
+                        ++head;
+
+                    curText.append( run, head );
+                }
 
             }   // while
 
@@ -777,11 +785,11 @@ L_read:
     }           // specctraMode
 
     // non-quoted token, read it into curText.
-    curText.clear();
-
     head = cur;
     while( head<limit && !isSep( *head ) )
-        curText += *head++;
+        ++head;
+
+    curText.assign( cur, head );
 
     if( isNumber( curText.c_str(), curText.c_str() + curText.size() ) )
     {
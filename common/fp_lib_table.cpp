@@ -338,6 +338,18 @@ const MODULE* FP_LIB_TABLE::GetEnumeratedFootprint( const wxString& aNickname,
 }
 
 
+bool FP_LIB_TABLE::GetEnumeratedFootprintSummary( const wxString& aNickname,
+                                                  const wxString& aFootprintName,
+                                                  FOOTPRINT_SUMMARY& aSummary )
+{
+    const FP_LIB_TABLE_ROW* row = FindRow( aNickname );
+    wxASSERT( (PLUGIN*) row->plugin );
+
+    return row->plugin->GetEnumeratedFootprintSummary( row->GetFullURI( true ), aFootprintName,
+                                                       aSummary, row->GetProperties() );
+}
+
+
 bool FP_LIB_TABLE::FootprintExists( const wxString& aNickname, const wxString& aFootprintName )
 {
     try
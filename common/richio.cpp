@@ -23,11 +23,21 @@
  */
 
 
+#include <algorithm>
 #include <cstdarg>
 #include <config.h> // HAVE_FGETC_NOLOCK
 
 #include <richio.h>
 
+#ifdef __WINDOWS__
+#include <wx/msw/wrapwin.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 
 // Fall back to getc() when getc_unlocked() is not available on the target platform.
 #if !defined( HAVE_FGETC_NOLOCK )
@@ -225,6 +235,236 @@ char* FILE_LINE_READER::ReadLine()
 }
 
 
+SPAN_LINE_READER::SPAN_LINE_READER() :
+    LINE_READER( 0 ),   // no line buffer, the lines are views into the span
+    m_data( NULL ), m_size( 0 ), m_ndx( 0 ), m_firstColumn( 0 ), m_breaks( 0 ), m_nextSkip( 0 )
+{
+}
+
+
+SPAN_LINE_READER::SPAN_LINE_READER( const char* aData, size_t aSize, const wxString& aSource,
+                                    unsigned aStartingLineNumber, unsigned aFirstColumn ) :
+    LINE_READER( 0 ),
+    m_data( aData ), m_size( aSize ), m_ndx( 0 ), m_firstColumn( aFirstColumn ), m_breaks( 0 ),
+    m_nextSkip( 0 )
+{
+    m_source  = aSource;
+    m_lineNum = aStartingLineNumber;
+    m_maxLineLength = LINE_READER_LINE_DEFAULT_MAX;
+}
+
+
+SPAN_LINE_READER::~SPAN_LINE_READER()
+{
+    // m_line is a view into the span or into m_buffer, LINE_READER must not delete it
+    m_line = NULL;
+}
+
+
+void SPAN_LINE_READER::Skip( size_t aStart, size_t aEnd )
+{
+    wxASSERT( aStart <= aEnd && aEnd <= m_size );
+    wxASSERT( m_skips.empty() || m_skips.back().second <= aStart );
+
+    m_skips.emplace_back( aStart, aEnd );
+}
+
+
+char* SPAN_LINE_READER::ReadLine()
+{
+    static char eof[1] = { 0 };
+    static char lineBreak[2] = { '\n', 0 };
+    size_t      length = 0;
+
+    // DSNLEXER does not write into its lines, so the span can be read only
+    if( m_breaks )
+    {
+        // An empty line of a skipped part
+        m_line = lineBreak;
+        length = 1;
+        --m_breaks;
+    }
+    else if( m_ndx < m_size )
+    {
+        const char* line = NULL;
+
+        m_buffer.clear();
+
+        if( m_ndx == 0 )
+            m_buffer.assign( m_firstColumn, ' ' );
+
+        for( ;; )
+        {
+            const char* piece = m_data + m_ndx;
+            bool        skip = m_nextSkip < m_skips.size();
+            size_t      end = skip ? m_skips[m_nextSkip].first : m_size;
+            const char* nl = (const char*) memchr( piece, '\n', end - m_ndx );
+
+            length = nl ? nl - piece + 1 : end - m_ndx;     // include the newline, if any
+            m_ndx += length;
+
+            if( !nl && skip )
+            {
+                // The line reaches a skipped part, which ends it if it holds line breaks
+                const char* skipStart = m_data + m_skips[m_nextSkip].first;
+                const char* skipEnd = m_data + m_skips[m_nextSkip].second;
+
+                m_breaks = (unsigned) std::count( skipStart, skipEnd, '\n' );
+                m_ndx = m_skips[m_nextSkip++].second;
+
+                if( m_breaks )
+                {
+                    --m_breaks;
+
+                    if( m_buffer.empty() && length == 0 )
+                    {
+                        line = lineBreak;
+                        length = 1;
+                        break;
+                    }
+                }
+                else
+                {
+                    // Only the pieces of a line around a skipped part are copied
+                    m_buffer.append( piece, length );
+                    continue;
+                }
+            }
+
+            if( !m_buffer.empty() )
+            {
+                m_buffer.append( piece, length );
+                line = m_buffer.data();
+                length = m_buffer.size();
+            }
+            else
+            {
+                line = piece;
+            }
+
+            break;
+        }
+
+        if( length >= m_maxLineLength )
+            THROW_IO_ERROR( _( "Maximum line length exceeded" ) );
+
+        m_line = const_cast<char*>( line );
+    }
+    else
+    {
+        m_line = eof;
+    }
+
+    m_length = (unsigned) length;
+
+    // m_lineNum is incremented even if there was no line read, because this
+    // leads to better error reporting when we hit an end of file.
+    ++m_lineNum;
+
+    return m_length ? m_line : NULL;
+}
+
+
+MAPPED_FILE_LINE_READER::MAPPED_FILE_LINE_READER( const wxString& aFileName,
+                                                  unsigned aStartingLineNumber ) :
+    m_mapping( NULL )
+{
+    bool ok = false;
+
+#ifdef __WINDOWS__
+    HANDLE file = CreateFileW( aFileName.wc_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                               OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+
+    if( file != INVALID_HANDLE_VALUE )
+    {
+        LARGE_INTEGER size;
+
+        if( GetFileSizeEx( file, &size ) )
+        {
+            m_size = (size_t) size.QuadPart;
+
+            // Empty files cannot be mapped
+            if( m_size == 0 )
+                ok = true;
+            else
+                m_mapping = CreateFileMappingW( file, NULL, PAGE_READONLY, 0, 0, NULL );
+
+            if( m_mapping )
+            {
+                m_data = (const char*) MapViewOfFile( m_mapping, FILE_MAP_READ, 0, 0, 0 );
+
+                if( m_data )
+                    ok = true;
+                else
+                    CloseHandle( m_mapping );
+            }
+        }
+
+        // The mapping keeps the file open
+        CloseHandle( file );
+    }
+#else
+    int fd = open( aFileName.fn_str(), O_RDONLY );
+
+    if( fd >= 0 )
+    {
+        struct stat st;
+
+        if( fstat( fd, &st ) == 0 )
+        {
+            m_size = (size_t) st.st_size;
+
+            // Empty files cannot be mapped
+            if( m_size == 0 )
+                ok = true;
+            else
+            {
+                void* data = mmap( NULL, m_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+
+                if( data != MAP_FAILED )
+                {
+                    // The file is read once, from start to end
+                    madvise( data, m_size, MADV_SEQUENTIAL );
+
+                    m_data = (const char*) data;
+                    ok = true;
+                }
+            }
+        }
+
+        // The mapping keeps the file open
+        close( fd );
+    }
+#endif
+
+    if( !ok )
+    {
+        wxString msg = wxString::Format(
+            _( "Unable to open filename \"%s\" for reading" ), aFileName.GetData() );
+        THROW_IO_ERROR( msg );
+    }
+
+    m_source  = aFileName;
+    m_lineNum = aStartingLineNumber;
+    m_maxLineLength = LINE_READER_LINE_DEFAULT_MAX;
+}
+
+
+MAPPED_FILE_LINE_READER::~MAPPED_FILE_LINE_READER()
+{
+#ifdef __WINDOWS__
+    if( m_data )
+    {
+        UnmapViewOfFile( m_data );
+        CloseHandle( m_mapping );
+    }
+#else
+    if( m_data )
+        munmap( (void*) m_data, m_size );
+#endif
+}
+
+
 STRING_LINE_READER::STRING_LINE_READER( const std::string& aString, const wxString& aSource ):
     LINE_READER( LINE_READER_LINE_DEFAULT_MAX ),
     m_lines( aString ), m_ndx( 0 )
@@ -401,6 +641,110 @@ int OUTPUTFORMATTER::sprint( const char* fmt, ... )
 }
 
 
+/**
+ * Function isSimpleFormat
+ * @return bool - true if the only conversions of \a aFormat are %s, %d, %u, %c and %%,
+ *                without flags, width nor precision.
+ */
+static bool isSimpleFormat( const char* aFormat )
+{
+    for( const char* cp = aFormat; *cp; ++cp )
+    {
+        if( *cp == '%' )
+        {
+            ++cp;
+
+            if( *cp != 's' && *cp != 'd' && *cp != 'u' && *cp != 'c' && *cp != '%' )
+                return false;
+        }
+    }
+
+    return true;
+}
+
+
+static void appendUnsigned( std::string& aOut, unsigned aValue )
+{
+    char  digits[16];
+    char* cp = digits + sizeof( digits );
+
+    do
+    {
+        *--cp = '0' + aValue % 10;
+        aValue /= 10;
+    } while( aValue );
+
+    aOut.append( cp, digits + sizeof( digits ) - cp );
+}
+
+
+/**
+ * Function appendSimpleFormat
+ * appends to \a aOut the output of a format accepted by isSimpleFormat(), like vsprintf()
+ * would, but much quicker.
+ */
+static void appendSimpleFormat( std::string& aOut, const char* aFormat, va_list ap )
+{
+    const char* cp = aFormat;
+
+    while( *cp )
+    {
+        const char* run = cp;
+
+        while( *cp && *cp != '%' )
+            ++cp;
+
+        aOut.append( run, cp - run );
+
+        if( !*cp )
+            break;
+
+        switch( *++cp )
+        {
+        case 's':
+        {
+            const char* text = va_arg( ap, const char* );
+
+            // As the vsnprintf() of glibc, which Print() used before
+            aOut.append( text ? text : "(null)" );
+            break;
+        }
+
+        case 'd':
+        {
+            int value = va_arg( ap, int );
+
+            if( value < 0 )
+            {
+                aOut += '-';
+                appendUnsigned( aOut, 0u - (unsigned) value );
+            }
+            else
+            {
+                appendUnsigned( aOut, value );
+            }
+
+            break;
+        }
+
+        case 'u':
+            appendUnsigned( aOut, va_arg( ap, unsigned ) );
+            break;
+
+        case 'c':
+            aOut += (char) va_arg( ap, int );
+            break;
+
+        default:    // '%'
+            aOut += '%';
+            break;
+        }
+
+        ++cp;
+    }
+}
+
+
 int OUTPUTFORMATTER::Print( int nestLevel, const char* fmt, ... )
 {
 #define NESTWIDTH           2   ///< how many spaces per nestLevel
@@ -412,6 +756,21 @@ int OUTPUTFORMATTER::Print( int nestLevel, const char* fmt, ... )
     int result = 0;
     int total  = 0;
 
+    // Most formats hold only strings and integers: they are then written, with the
+    // indentation, to a reused buffer and output by a single write(), without vsnprintf().
+    if( isSimpleFormat( fmt ) )
+    {
+        m_printBuffer.assign( std::max( nestLevel, 0 ) * NESTWIDTH, ' ' );
+        appendSimpleFormat( m_printBuffer, fmt, args );
+
+        va_end( args );
+
+        if( !m_printBuffer.empty() )
+            write( m_printBuffer.data(), m_printBuffer.size() );
+
+        return m_printBuffer.size();
+    }
+
     for( int i=0; i<nestLevel;  ++i )
     {
         // no error checking needed, an exception indicates an error.
@@ -513,6 +872,9 @@ FILE_OUTPUTFORMATTER::FILE_OUTPUTFORMATTER( const wxString& aFileName, const wxC
 
     if( !m_fp )
         THROW_IO_ERROR( strerror( errno ) );
+
+    // Print() writes many small chunks, a larger buffer than the default saves system calls
+    setvbuf( m_fp, NULL, _IOFBF, 1 << 16 );
 }
 
 
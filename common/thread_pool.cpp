@@ -0,0 +1,316 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+#include <chrono>
+
+#include <thread_pool.h>
+
+
+///> The pool of which the current thread is a worker, if any, and its index in that pool
+static thread_local THREAD_POOL* s_pool = nullptr;
+static thread_local int          s_worker = -1;
+
+
+THREAD_POOL& THREAD_POOL::Get()
+{
+    // Deliberately leaked, see the class description
+    static THREAD_POOL* pool =
+            new THREAD_POOL( std::max<size_t>( std::thread::hardware_concurrency(), 1 ) );
+
+    return *pool;
+}
+
+
+THREAD_POOL::THREAD_POOL( size_t aThreadCount ) :
+        m_queued( 0 ),
+        m_stopping( false )
+{
+    // One queue per worker, and the shared queue
+    for( size_t ii = 0; ii <= aThreadCount; ++ii )
+        m_queues.push_back( std::make_unique<TASK_QUEUE>() );
+
+    for( size_t ii = 0; ii < aThreadCount; ++ii )
+        m_threads.emplace_back( &THREAD_POOL::workerLoop, this, (int) ii );
+}
+
+
+THREAD_POOL::~THREAD_POOL()
+{
+    {
+        std::lock_guard<std::mutex> lock( m_sleepMutex );
+
+        m_stopping = true;
+    }
+
+    m_wakeUp.notify_all();
+
+    for( std::thread& thread : m_threads )
+        thread.join();
+}
+
+
+bool THREAD_POOL::ParallelFor( size_t aCount, const std::function<void( size_t )>& aJob,
+                               const std::function<bool()>& aProgress )
+{
+    THREAD_POOL&        pool = Get();
+    size_t              taskCount = std::min( pool.GetThreadCount(), aCount );
+    std::atomic<size_t> nextItem( 0 );
+    TASK_GROUP          group( pool );
+
+    auto lambda = [&]()
+    {
+        for( size_t i = nextItem++; i < aCount && !group.IsCancelled(); i = nextItem++ )
+            aJob( i );
+    };
+
+    // Nothing to gain from the pool, unless the caller has to be kept responsive
+    if( taskCount <= 1 && !aProgress )
+    {
+        lambda();
+        return true;
+    }
+
+    for( size_t ii = 0; ii < taskCount; ++ii )
+        group.Run( lambda );
+
+    return group.Wait( aProgress );
+}
+
+
+void THREAD_POOL::submit( TASK_GROUP* aGroup, std::function<void()>&& aFunc )
+{
+    int         worker = ( s_pool == this ) ? s_worker : -1;
+    TASK_QUEUE& queue = ( worker >= 0 ) ? *m_queues[worker] : *m_queues.back();
+
+    {
+        std::lock_guard<std::mutex> lock( queue.m_mutex );
+
+        queue.m_tasks.push_back( TASK{ aGroup, std::move( aFunc ) } );
+        m_queued++;
+    }
+
+    // Workers check m_queued with m_sleepMutex locked, so they cannot miss this notification
+    {
+        std::lock_guard<std::mutex> lock( m_sleepMutex );
+    }
+
+    m_wakeUp.notify_one();
+}
+
+
+bool THREAD_POOL::popFrom( TASK_QUEUE& aQueue, TASK& aTask, bool aNewest,
+                           const TASK_GROUP* aGroup )
+{
+    std::lock_guard<std::mutex> lock( aQueue.m_mutex );
+    std::deque<TASK>&           tasks = aQueue.m_tasks;
+
+    if( tasks.empty() )
+        return false;
+
+    if( !aGroup )
+    {
+        if( aNewest )
+        {
+            aTask = std::move( tasks.back() );
+            tasks.pop_back();
+        }
+        else
+        {
+            aTask = std::move( tasks.front() );
+            tasks.pop_front();
+        }
+    }
+    else
+    {
+        auto it = std::find_if( tasks.begin(), tasks.end(),
+                                [aGroup]( const TASK& aCandidate )
+                                {
+                                    return aCandidate.m_group == aGroup;
+                                } );
+
+        if( it == tasks.end() )
+            return false;
+
+        aTask = std::move( *it );
+        tasks.erase( it );
+    }
+
+    m_queued--;
+    return true;
+}
+
+
+bool THREAD_POOL::popTask( TASK& aTask, int aWorker, const TASK_GROUP* aGroup )
+{
+    if( m_queued == 0 )
+        return false;
+
+    if( aWorker >= 0 && popFrom( *m_queues[aWorker], aTask, true, aGroup ) )
+        return true;
+
+    if( popFrom( *m_queues.back(), aTask, false, aGroup ) )
+        return true;
+
+    // Steal from the other workers, starting with the next one to spread the thefts
+    size_t workerCount = m_threads.size();
+
+    for( size_t ii = 1; ii <= workerCount; ++ii )
+    {
+        size_t victim = ( aWorker + ii ) % workerCount;
+
+        if( (int) victim != aWorker && popFrom( *m_queues[victim], aTask, false, aGroup ) )
+            return true;
+    }
+
+    return false;
+}
+
+
+void THREAD_POOL::runTask( TASK& aTask )
+{
+    TASK_GROUP*        group = aTask.m_group;
+    std::exception_ptr exception;
+
+    if( !group->IsCancelled() )
+    {
+        try
+        {
+            aTask.m_func();
+        }
+        catch( ... )
+        {
+            exception = std::current_exception();
+        }
+    }
+
+    // Release what the task captured before its group can be considered finished
+    aTask.m_func = nullptr;
+    group->taskDone( exception );
+}
+
+
+void THREAD_POOL::workerLoop( int aWorker )
+{
+    s_pool = this;
+    s_worker = aWorker;
+
+    TASK task;
+
+    while( true )
+    {
+        if( popTask( task, aWorker, nullptr ) )
+        {
+            runTask( task );
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock( m_sleepMutex );
+
+        m_wakeUp.wait( lock, [this]() { return m_queued > 0 || m_stopping; } );
+
+        if( m_stopping && m_queued == 0 )
+            return;
+    }
+}
+
+
+TASK_GROUP::TASK_GROUP( THREAD_POOL& aPool ) :
+        m_pool( aPool ),
+        m_unfinished( 0 ),
+        m_cancelled( false )
+{
+}
+
+
+TASK_GROUP::~TASK_GROUP()
+{
+    // Queued tasks may use objects which are being destroyed along with the group
+    Cancel();
+
+    std::unique_lock<std::mutex> lock( m_mutex );
+
+    m_done.wait( lock, [this]() { return m_unfinished == 0; } );
+}
+
+
+void TASK_GROUP::Run( std::function<void()> aTask )
+{
+    m_unfinished++;
+    m_pool.submit( this, std::move( aTask ) );
+}
+
+
+bool TASK_GROUP::Wait( const std::function<bool()>& aProgress, int aInterval )
+{
+    if( !aProgress )
+    {
+        THREAD_POOL::TASK task;
+        int worker = ( s_pool == &m_pool ) ? s_worker : -1;
+
+        while( m_unfinished > 0 && m_pool.popTask( task, worker, this ) )
+            m_pool.runTask( task );
+    }
+
+    std::unique_lock<std::mutex> lock( m_mutex );
+    auto                         finished = [this]() { return m_unfinished == 0; };
+
+    if( aProgress )
+    {
+        while( !m_done.wait_for( lock, std::chrono::milliseconds( aInterval ), finished ) )
+        {
+            lock.unlock();
+
+            if( !aProgress() )
+                Cancel();
+
+            lock.lock();
+        }
+    }
+    else
+    {
+        m_done.wait( lock, finished );
+    }
+
+    std::exception_ptr exception = m_exception;
+
+    m_exception = nullptr;
+    lock.unlock();
+
+    if( exception )
+        std::rethrow_exception( exception );
+
+    return !m_cancelled;
+}
+
+
+void TASK_GROUP::taskDone( std::exception_ptr aException )
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    if( aException && !m_exception )
+        m_exception = aException;
+
+    if( --m_unfinished == 0 )
+        m_done.notify_all();
+}
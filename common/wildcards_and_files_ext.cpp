@@ -132,6 +132,7 @@ const std::string EquFileExtension( "equ" );
 
 const std::string LegacyPcbFileExtension( "brd" );
 const std::string KiCadPcbFileExtension( "kicad_pcb" );
+const std::string ZoneFillCacheFileExtension( "kicad_fills" );
 const std::string PageLayoutDescrFileExtension( "kicad_wks" );
 
 const std::string PdfFileExtension( "pdf" );
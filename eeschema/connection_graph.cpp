@@ -19,12 +19,12 @@
  */
 
 #include <list>
-#include <thread>
+#include <atomic>
 #include <algorithm>
-#include <future>
 #include <vector>
 #include <unordered_map>
 #include <profile.h>
+#include <thread_pool.h>
 
 #include <common.h>
 #include <erc.h>
@@ -729,12 +729,11 @@ void CONNECTION_GRAPH::buildConnectionGraph()
 
     // Resolve drivers for subgraphs and propagate connectivity info
 
-    // We don't want to spin up a new thread for fewer than 8 nets (overhead costs)
-    size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
+    // We don't want to queue tasks for fewer than 8 nets (overhead costs)
+    size_t parallelTaskCount = std::min<size_t>( THREAD_POOL::Get().GetThreadCount(),
             ( m_subgraphs.size() + 3 ) / 4 );
 
     std::atomic<size_t> nextSubgraph( 0 );
-    std::vector<std::future<size_t>> returns( parallelThreadCount );
     std::vector<CONNECTION_SUBGRAPH*> dirty_graphs;
 
     std::copy_if( m_subgraphs.begin(), m_subgraphs.end(), std::back_inserter( dirty_graphs ),
@@ -832,16 +831,16 @@ void CONNECTION_GRAPH::buildConnectionGraph()
         return 1;
     };
 
-    if( parallelThreadCount == 1 )
+    if( parallelTaskCount <= 1 )
         update_lambda();
     else
     {
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-            returns[ii] = std::async( std::launch::async, update_lambda );
+        TASK_GROUP tasks;
 
-        // Finalize the threads
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-            returns[ii].wait();
+        for( size_t ii = 0; ii < parallelTaskCount; ++ii )
+            tasks.Run( update_lambda );
+
+        tasks.Wait();
     }
 
     // Now discard any non-driven subgraphs from further consideration
@@ -294,7 +294,7 @@ static void formatStroke( OUTPUTFORMATTER* aFormatter, int aNestLevel, int aWidt
     aFormatter->Print( aNestLevel, "(stroke" );
 
     if( !( aWidth == 0 ) )
-        aFormatter->Print( 0, " (width %s)", FormatInternalUnits( aWidth ).c_str() );
+        aFormatter->Print( 0, " (width %s)", FMT_IU( aWidth ).c_str() );
 
     if( !( aStyle == PLOT_DASH_TYPE::DEFAULT || aStyle == PLOT_DASH_TYPE::SOLID ) )
         aFormatter->Print( 0, " (type %s)", TO_UTF8( getLineStyleToken( aStyle ) ) );
@@ -850,8 +850,8 @@ void SCH_SEXPR_PLUGIN::saveSymbol( SCH_COMPONENT* aSymbol, int aNestLevel )
 
     m_out->Print( 0, " (lib_id %s) (at %s %s %s)",
                   m_out->Quotew( aSymbol->GetLibId().Format().wx_str() ).c_str(),
-                  FormatInternalUnits( aSymbol->GetPosition().x ).c_str(),
-                  FormatInternalUnits( aSymbol->GetPosition().y ).c_str(),
+                  FMT_IU( aSymbol->GetPosition().x ).c_str(),
+                  FMT_IU( aSymbol->GetPosition().y ).c_str(),
                   FormatAngle( angle * 10.0 ).c_str() );
 
     bool mirrorX = aSymbol->GetOrientation() & CMP_MIRROR_X;
@@ -922,8 +922,8 @@ void SCH_SEXPR_PLUGIN::saveField( SCH_FIELD* aField, int aNestLevel )
                   m_out->Quotew( fieldName ).c_str(),
                   m_out->Quotew( aField->GetText() ).c_str(),
                   aField->GetId(),
-                  FormatInternalUnits( aField->GetPosition().x ).c_str(),
-                  FormatInternalUnits( aField->GetPosition().y ).c_str(),
+                  FMT_IU( aField->GetPosition().x ).c_str(),
+                  FMT_IU( aField->GetPosition().y ).c_str(),
                   FormatAngle( aField->GetTextAngleDegrees() * 10.0 ).c_str() );
 
     if( !aField->IsDefaultFormatting()
@@ -949,8 +949,8 @@ void SCH_SEXPR_PLUGIN::saveBitmap( SCH_BITMAP* aBitmap, int aNestLevel )
     wxCHECK_RET( image != NULL, "wxImage* is NULL" );
 
     m_out->Print( aNestLevel, "(image (at %s %s)",
-                  FormatInternalUnits( aBitmap->GetPosition().x ).c_str(),
-                  FormatInternalUnits( aBitmap->GetPosition().y ).c_str() );
+                  FMT_IU( aBitmap->GetPosition().x ).c_str(),
+                  FMT_IU( aBitmap->GetPosition().y ).c_str() );
 
     if( aBitmap->GetImage()->GetScale() != 1.0 )
         m_out->Print( 0, " (scale %g)", aBitmap->GetImage()->GetScale() );
@@ -990,10 +990,10 @@ void SCH_SEXPR_PLUGIN::saveSheet( SCH_SHEET* aSheet, int aNestLevel )
     wxCHECK_RET( aSheet != nullptr && m_out != nullptr, "" );
 
     m_out->Print( aNestLevel, "(sheet (at %s %s) (size %s %s)\n",
-                  FormatInternalUnits( aSheet->GetPosition().x ).c_str(),
-                  FormatInternalUnits( aSheet->GetPosition().y ).c_str(),
-                  FormatInternalUnits( aSheet->GetSize().GetWidth() ).c_str(),
-                  FormatInternalUnits( aSheet->GetSize().GetHeight() ).c_str() );
+                  FMT_IU( aSheet->GetPosition().x ).c_str(),
+                  FMT_IU( aSheet->GetPosition().y ).c_str(),
+                  FMT_IU( aSheet->GetSize().GetWidth() ).c_str(),
+                  FMT_IU( aSheet->GetSize().GetHeight() ).c_str() );
 
     if( !aSheet->UsesDefaultStroke() )
     {
@@ -1034,8 +1034,8 @@ void SCH_SEXPR_PLUGIN::saveSheet( SCH_SHEET* aSheet, int aNestLevel )
         m_out->Print( aNestLevel + 1, "(pin %s %s (at %s %s %s)",
                       EscapedUTF8( pin->GetText() ).c_str(),
                       getSheetPinShapeToken( pin->GetShape() ),
-                      FormatInternalUnits( pin->GetPosition().x ).c_str(),
-                      FormatInternalUnits( pin->GetPosition().y ).c_str(),
+                      FMT_IU( pin->GetPosition().x ).c_str(),
+                      FMT_IU( pin->GetPosition().y ).c_str(),
                       FormatAngle( getSheetPinAngle( pin->GetEdge() ) * 10.0 ).c_str() );
 
         if( !pin->IsDefaultFormatting()
@@ -1060,8 +1060,8 @@ void SCH_SEXPR_PLUGIN::saveJunction( SCH_JUNCTION* aJunction, int aNestLevel )
     wxCHECK_RET( aJunction != nullptr && m_out != nullptr, "" );
 
     m_out->Print( aNestLevel, "(junction (at %s %s))\n",
-                  FormatInternalUnits( aJunction->GetPosition().x ).c_str(),
-                  FormatInternalUnits( aJunction->GetPosition().y ).c_str() );
+                  FMT_IU( aJunction->GetPosition().x ).c_str(),
+                  FMT_IU( aJunction->GetPosition().y ).c_str() );
 }
 
 
@@ -1070,8 +1070,8 @@ void SCH_SEXPR_PLUGIN::saveNoConnect( SCH_NO_CONNECT* aNoConnect, int aNestLevel
     wxCHECK_RET( aNoConnect != nullptr && m_out != nullptr, "" );
 
     m_out->Print( aNestLevel, "(no_connect (at %s %s))\n",
-                  FormatInternalUnits( aNoConnect->GetPosition().x ).c_str(),
-                  FormatInternalUnits( aNoConnect->GetPosition().y ).c_str() );
+                  FMT_IU( aNoConnect->GetPosition().x ).c_str(),
+                  FMT_IU( aNoConnect->GetPosition().y ).c_str() );
 }
 
 
@@ -1090,10 +1090,10 @@ void SCH_SEXPR_PLUGIN::saveBusEntry( SCH_BUS_ENTRY_BASE* aBusEntry, int aNestLev
     else
     {
         m_out->Print( aNestLevel, "(bus_entry (at %s %s) (size %s %s))\n",
-                      FormatInternalUnits( aBusEntry->GetPosition().x ).c_str(),
-                      FormatInternalUnits( aBusEntry->GetPosition().y ).c_str(),
-                      FormatInternalUnits( aBusEntry->GetSize().GetWidth() ).c_str(),
-                      FormatInternalUnits( aBusEntry->GetSize().GetHeight() ).c_str() );
+                      FMT_IU( aBusEntry->GetPosition().x ).c_str(),
+                      FMT_IU( aBusEntry->GetPosition().y ).c_str(),
+                      FMT_IU( aBusEntry->GetSize().GetWidth() ).c_str(),
+                      FMT_IU( aBusEntry->GetSize().GetHeight() ).c_str() );
     }
 }
 
@@ -1114,10 +1114,10 @@ void SCH_SEXPR_PLUGIN::saveLine( SCH_LINE* aLine, int aNestLevel )
 
     m_out->Print( aNestLevel, "(%s (pts (xy %s %s) (xy %s %s))",
                   TO_UTF8( lineType ),
-                  FormatInternalUnits( aLine->GetStartPoint().x ).c_str(),
-                  FormatInternalUnits( aLine->GetStartPoint().y ).c_str(),
-                  FormatInternalUnits( aLine->GetEndPoint().x ).c_str(),
-                  FormatInternalUnits( aLine->GetEndPoint().y ).c_str() );
+                  FMT_IU( aLine->GetStartPoint().x ).c_str(),
+                  FMT_IU( aLine->GetStartPoint().y ).c_str(),
+                  FMT_IU( aLine->GetEndPoint().x ).c_str(),
+                  FMT_IU( aLine->GetEndPoint().y ).c_str() );
 
     if( !aLine->UsesDefaultStroke() )
     {
@@ -1155,16 +1155,16 @@ void SCH_SEXPR_PLUGIN::saveText( SCH_TEXT* aText, int aNestLevel )
     if( aText->GetText().Length() < 50 )
     {
         m_out->Print( 0, " (at %s %s %s)",
-                      FormatInternalUnits( aText->GetPosition().x ).c_str(),
-                      FormatInternalUnits( aText->GetPosition().y ).c_str(),
+                      FMT_IU( aText->GetPosition().x ).c_str(),
+                      FMT_IU( aText->GetPosition().y ).c_str(),
                       FormatAngle( angle * 10.0 ).c_str() );
     }
     else
     {
         m_out->Print( 0, "\n" );
         m_out->Print( aNestLevel + 1, "(at %s %s %s)",
-                      FormatInternalUnits( aText->GetPosition().x ).c_str(),
-                      FormatInternalUnits( aText->GetPosition().y ).c_str(),
+                      FMT_IU( aText->GetPosition().x ).c_str(),
+                      FMT_IU( aText->GetPosition().y ).c_str(),
                       FormatAngle( aText->GetTextAngle() ).c_str() );
     }
 
@@ -1487,7 +1487,7 @@ void SCH_SEXPR_PLUGIN_CACHE::SaveSymbol( LIB_PART* aSymbol, OUTPUTFORMATTER& aFo
 
             if( aSymbol->GetPinNameOffset() != Mils2iu( DEFAULT_PIN_NAME_OFFSET ) )
                 aFormatter.Print( 0, " (offset %s)",
-                                  FormatInternalUnits( aSymbol->GetPinNameOffset() ).c_str() );
+                                  FMT_IU( aSymbol->GetPinNameOffset() ).c_str() );
 
             if( !aSymbol->ShowPinNames() )
                 aFormatter.Print( 0, " hide" );
@@ -1672,13 +1672,13 @@ void SCH_SEXPR_PLUGIN_CACHE::saveArc( LIB_ARC* aArc,
     aFormatter.Print( aNestLevel,
                       "(arc (start %s %s) (end %s %s) (radius (at %s %s) (length %s) "
                       "(angles %g %g))",
-                      FormatInternalUnits( aArc->GetStart().x ).c_str(),
-                      FormatInternalUnits( aArc->GetStart().y ).c_str(),
-                      FormatInternalUnits( aArc->GetEnd().x ).c_str(),
-                      FormatInternalUnits( aArc->GetEnd().y ).c_str(),
-                      FormatInternalUnits( aArc->GetPosition().x ).c_str(),
-                      FormatInternalUnits( aArc->GetPosition().y ).c_str(),
-                      FormatInternalUnits( aArc->GetRadius() ).c_str(),
+                      FMT_IU( aArc->GetStart().x ).c_str(),
+                      FMT_IU( aArc->GetStart().y ).c_str(),
+                      FMT_IU( aArc->GetEnd().x ).c_str(),
+                      FMT_IU( aArc->GetEnd().y ).c_str(),
+                      FMT_IU( aArc->GetPosition().x ).c_str(),
+                      FMT_IU( aArc->GetPosition().y ).c_str(),
+                      FMT_IU( aArc->GetRadius() ).c_str(),
                       static_cast<double>( x1 ) / 10.0,
                       static_cast<double>( x2 ) / 10.0 );
 
@@ -1689,7 +1689,7 @@ void SCH_SEXPR_PLUGIN_CACHE::saveArc( LIB_ARC* aArc,
     {
         aFormatter.Print( 0, "\n" );
         aFormatter.Print( aNestLevel + 1, "(stroke (width %s))",
-                          FormatInternalUnits( aArc->GetWidth() ).c_str() );
+                          FMT_IU( aArc->GetWidth() ).c_str() );
         needsSpace = true;
         onNewLine = true;
     }
@@ -1731,16 +1731,16 @@ void SCH_SEXPR_PLUGIN_CACHE::saveBezier( LIB_BEZIER* aBezier,
         {
             aFormatter.Print( 0, "\n" );
             aFormatter.Print( aNestLevel + 3, " (xy %s %s)",
-                              FormatInternalUnits( pt.x ).c_str(),
-                              FormatInternalUnits( pt.y ).c_str() );
+                              FMT_IU( pt.x ).c_str(),
+                              FMT_IU( pt.y ).c_str() );
             newLine = 0;
             lineCount += 1;
         }
         else
         {
             aFormatter.Print( 0, " (xy %s %s)",
-                              FormatInternalUnits( pt.x ).c_str(),
-                              FormatInternalUnits( pt.y ).c_str() );
+                              FMT_IU( pt.x ).c_str(),
+                              FMT_IU( pt.y ).c_str() );
         }
 
         newLine += 1;
@@ -1761,7 +1761,7 @@ void SCH_SEXPR_PLUGIN_CACHE::saveBezier( LIB_BEZIER* aBezier,
     if( aBezier->GetWidth() != 0 && aBezier->GetWidth() != Mils2iu( DEFAULT_LINE_THICKNESS ) )
     {
         aFormatter.Print( aNestLevel + 1, "(stroke (width %s))",
-                          FormatInternalUnits( aBezier->GetWidth() ).c_str() );
+                          FMT_IU( aBezier->GetWidth() ).c_str() );
         needsSpace = true;
 
         if( aBezier->GetFillMode() == NO_FILL )
@@ -1794,14 +1794,14 @@ void SCH_SEXPR_PLUGIN_CACHE::saveCircle( LIB_CIRCLE* aCircle,
     wxCHECK_RET( aCircle && aCircle->Type() == LIB_CIRCLE_T, "Invalid LIB_CIRCLE object." );
 
     aFormatter.Print( aNestLevel, "(circle (center %s %s) (radius %s)",
-                      FormatInternalUnits( aCircle->GetPosition().x ).c_str(),
-                      FormatInternalUnits( aCircle->GetPosition().y ).c_str(),
-                      FormatInternalUnits( aCircle->GetRadius() ).c_str() );
+                      FMT_IU( aCircle->GetPosition().x ).c_str(),
+                      FMT_IU( aCircle->GetPosition().y ).c_str(),
+                      FMT_IU( aCircle->GetRadius() ).c_str() );
 
     if( aCircle->GetWidth() != 0 && aCircle->GetWidth() != Mils2iu( DEFAULT_LINE_THICKNESS ) )
     {
         aFormatter.Print( 0, " (stroke (width %s))",
-                          FormatInternalUnits( aCircle->GetWidth() ).c_str() );
+                          FMT_IU( aCircle->GetWidth() ).c_str() );
     }
 
     if( aCircle->GetFillMode() != NO_FILL )
@@ -1824,8 +1824,8 @@ void SCH_SEXPR_PLUGIN_CACHE::saveField( LIB_FIELD* aField,
                       aFormatter.Quotew( aField->GetName() ).c_str(),
                       aFormatter.Quotew( aField->GetText() ).c_str(),
                       aField->GetId(),
-                      FormatInternalUnits( aField->GetPosition().x ).c_str(),
-                      FormatInternalUnits( aField->GetPosition().y ).c_str(),
+                      FMT_IU( aField->GetPosition().x ).c_str(),
+                      FMT_IU( aField->GetPosition().y ).c_str(),
                       static_cast<double>( aField->GetTextAngle() ) / 10.0 );
 
     if( aField->IsDefaultFormatting()
@@ -1853,10 +1853,10 @@ void SCH_SEXPR_PLUGIN_CACHE::savePin( LIB_PIN* aPin,
     aFormatter.Print( aNestLevel, "(pin %s %s (at %s %s %s) (length %s)",
                       getPinElectricalTypeToken( aPin->GetType() ),
                       getPinShapeToken( aPin->GetShape() ),
-                      FormatInternalUnits( aPin->GetPosition().x ).c_str(),
-                      FormatInternalUnits( aPin->GetPosition().y ).c_str(),
+                      FMT_IU( aPin->GetPosition().x ).c_str(),
+                      FMT_IU( aPin->GetPosition().y ).c_str(),
                       FormatAngle( getPinAngle( aPin->GetOrientation() ) * 10.0 ).c_str(),
-                      FormatInternalUnits( aPin->GetLength() ).c_str() );
+                      FMT_IU( aPin->GetLength() ).c_str() );
 
     int nestLevel = 0;
 
@@ -1870,8 +1870,8 @@ void SCH_SEXPR_PLUGIN_CACHE::savePin( LIB_PIN* aPin,
         // This follows the EDA_TEXT effects formatting for future expansion.
         if( aPin->GetNameTextSize() != Mils2iu( DEFAULT_PINNAME_SIZE ) )
             aFormatter.Print( 0, " (effects (font (size %s %s)))",
-                              FormatInternalUnits( aPin->GetNameTextSize() ).c_str(),
-                              FormatInternalUnits( aPin->GetNameTextSize() ).c_str() );
+                              FMT_IU( aPin->GetNameTextSize() ).c_str(),
+                              FMT_IU( aPin->GetNameTextSize() ).c_str() );
 
         aFormatter.Print( 0, ")\n" );
         aFormatter.Print( aNestLevel + 1, "(number %s",
@@ -1880,8 +1880,8 @@ void SCH_SEXPR_PLUGIN_CACHE::savePin( LIB_PIN* aPin,
         // This follows the EDA_TEXT effects formatting for future expansion.
         if( aPin->GetNumberTextSize() != Mils2iu( DEFAULT_PINNUM_SIZE ) )
             aFormatter.Print( 0, " (effects (font (size %s %s)))",
-                              FormatInternalUnits( aPin->GetNumberTextSize() ).c_str(),
-                              FormatInternalUnits( aPin->GetNumberTextSize() ).c_str() );
+                              FMT_IU( aPin->GetNumberTextSize() ).c_str(),
+                              FMT_IU( aPin->GetNumberTextSize() ).c_str() );
         aFormatter.Print( 0, ")\n" );
         nestLevel = aNestLevel + 1;
     }
@@ -1919,16 +1919,16 @@ void SCH_SEXPR_PLUGIN_CACHE::savePolyLine( LIB_POLYLINE* aPolyLine,
         {
             aFormatter.Print( 0, "\n" );
             aFormatter.Print( aNestLevel + 3, " (xy %s %s)",
-                              FormatInternalUnits( pt.x ).c_str(),
-                              FormatInternalUnits( pt.y ).c_str() );
+                              FMT_IU( pt.x ).c_str(),
+                              FMT_IU( pt.y ).c_str() );
             newLine = 0;
             lineCount += 1;
         }
         else
         {
             aFormatter.Print( 0, " (xy %s %s)",
-                              FormatInternalUnits( pt.x ).c_str(),
-                              FormatInternalUnits( pt.y ).c_str() );
+                              FMT_IU( pt.x ).c_str(),
+                              FMT_IU( pt.y ).c_str() );
         }
 
         newLine += 1;
@@ -1949,7 +1949,7 @@ void SCH_SEXPR_PLUGIN_CACHE::savePolyLine( LIB_POLYLINE* aPolyLine,
     if( aPolyLine->GetWidth() != 0 && aPolyLine->GetWidth() != Mils2iu( DEFAULT_LINE_THICKNESS ) )
     {
         aFormatter.Print( aNestLevel + 1, "(stroke (width %s))",
-                          FormatInternalUnits( aPolyLine->GetWidth() ).c_str() );
+                          FMT_IU( aPolyLine->GetWidth() ).c_str() );
         needsSpace = true;
 
         if( aPolyLine->GetFillMode() == NO_FILL )
@@ -1983,17 +1983,17 @@ void SCH_SEXPR_PLUGIN_CACHE::saveRectangle( LIB_RECTANGLE* aRectangle,
                  "Invalid LIB_RECTANGLE object." );
 
     aFormatter.Print( aNestLevel, "(rectangle (start %s %s) (end %s %s)",
-                      FormatInternalUnits( aRectangle->GetPosition().x ).c_str(),
-                      FormatInternalUnits( aRectangle->GetPosition().y ).c_str(),
-                      FormatInternalUnits( aRectangle->GetEnd().x ).c_str(),
-                      FormatInternalUnits( aRectangle->GetEnd().y ).c_str() );
+                      FMT_IU( aRectangle->GetPosition().x ).c_str(),
+                      FMT_IU( aRectangle->GetPosition().y ).c_str(),
+                      FMT_IU( aRectangle->GetEnd().x ).c_str(),
+                      FMT_IU( aRectangle->GetEnd().y ).c_str() );
 
     bool needsSpace = false;
 
     if( aRectangle->GetWidth() != 0 && aRectangle->GetWidth() != Mils2iu( DEFAULT_LINE_THICKNESS ) )
     {
         aFormatter.Print( 0, " (stroke (width %s))",
-                          FormatInternalUnits( aRectangle->GetWidth() ).c_str() );
+                          FMT_IU( aRectangle->GetWidth() ).c_str() );
         needsSpace = true;
     }
 
@@ -2017,8 +2017,8 @@ void SCH_SEXPR_PLUGIN_CACHE::saveText( LIB_TEXT* aText,
 
     aFormatter.Print( aNestLevel, "(text %s (at %s %s %g)\n",
                       aFormatter.Quotew( aText->GetText() ).c_str(),
-                      FormatInternalUnits( aText->GetPosition().x ).c_str(),
-                      FormatInternalUnits( aText->GetPosition().y ).c_str(),
+                      FMT_IU( aText->GetPosition().x ).c_str(),
+                      FMT_IU( aText->GetPosition().y ).c_str(),
                       aText->GetTextAngle() );
     aText->Format( &aFormatter, aNestLevel, 0 );
     aFormatter.Print( aNestLevel, ")\n" );
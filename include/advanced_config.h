@@ -83,6 +83,18 @@ public:
      */
     int m_coroutineStackSize;
 
+    /**
+     * Save the filled zones of boards in a binary cache file next to the board file, and
+     * read them back from it when it matches the board file.
+     */
+    bool m_EnableZoneFillCache;
+
+    /**
+     * Record the events of the interactive router, so that the routing sessions can be saved
+     * and replayed by the router benchmarks.
+     */
+    bool m_RecordRouterEvents;
+
 
 private:
     ADVANCED_CFG();
@@ -229,5 +229,53 @@ std::string FormatInternalUnits( const wxSize& aSize );
 
 std::string FormatInternalUnits( const VECTOR2I& aPoint );
 
+/**
+ * Function FormatInternalUnits
+ * writes \a aValue like FormatInternalUnits( int ), into \a aBuffer, without allocating memory.
+ *
+ * @param aBuffer receives the nul terminated string, and must hold at least 13 chars.
+ * @return int - the length of the string.
+ */
+int FormatInternalUnits( int aValue, char* aBuffer );
+
+
+/**
+ * FMT_IU
+ * holds the string of a value or of a pair of values in internal units, as written by
+ * FormatInternalUnits(), in a buffer of its own.  It is meant to be used as a temporary in
+ * the arguments of OUTPUTFORMATTER::Print(), which then does not allocate memory:
+ *
+ *     aFormatter->Print( 0, "(at %s)", FMT_IU( aPosition ).c_str() );
+ */
+class FMT_IU
+{
+public:
+    FMT_IU( int aValue )
+    {
+        m_length = FormatInternalUnits( aValue, m_text );
+    }
+
+    FMT_IU( int aX, int aY )
+    {
+        m_length = FormatInternalUnits( aX, m_text );
+        m_text[m_length++] = ' ';
+        m_length += FormatInternalUnits( aY, m_text + m_length );
+    }
+
+    FMT_IU( const wxPoint& aPoint ) : FMT_IU( aPoint.x, aPoint.y ) {}
+
+    FMT_IU( const VECTOR2I& aPoint ) : FMT_IU( aPoint.x, aPoint.y ) {}
+
+    FMT_IU( const wxSize& aSize ) : FMT_IU( aSize.x, aSize.y ) {}
+
+    const char* c_str() const { return m_text; }
+
+    int Length() const { return m_length; }
+
+private:
+    char m_text[32];
+    int  m_length;
+};
+
 
 #endif   // _BASE_UNITS_H_
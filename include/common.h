@@ -336,6 +336,14 @@ wxString ExpandTextVars( const wxString& aSource,
  */
 const wxString ResolveUriByEnvVars( const wxString& aUri, PROJECT* aProject );
 
+/**
+ * Function GetUserCacheDir
+ * @return the KiCad directory in the user cache directory: ~/Library/Caches/kicad on OSX,
+ *         ${XDG_CACHE_HOME}/kicad or ~/.cache/kicad on Linux and AppData\Local\kicad on
+ *         Windows.  The directory may not exist yet.
+ */
+wxString GetUserCacheDir();
+
 
 #ifdef __WXMAC__
 /**
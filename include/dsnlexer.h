@@ -107,6 +107,7 @@ protected:
 
     int                 curTok;                 ///< the current token obtained on last NextTok()
     std::string         curText;                ///< the text of the current token
+    std::string         curLine;                ///< a nul terminated copy of the current line
 
     const KEYWORD*      keywords;               ///< table sorted by CMake for bsearch()
     unsigned            keywordCount;           ///< count of keywords table
@@ -516,7 +517,9 @@ public:
      */
     const char* CurLine()
     {
-        return (const char*)(*reader);
+        // Lines of a SPAN_LINE_READER are not nul terminated
+        curLine.assign( reader->Line(), reader->Length() );
+        return curLine.c_str();
     }
 
     /**
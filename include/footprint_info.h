@@ -341,7 +341,7 @@ public:
      * @param aTable defines all the libraries.
      * @param aNickname is the library to read from, or if NULL means read all
      *         footprints from all known libraries in aTable.
-     * @param aNThreads is the number of worker threads.
+     * @param aNThreads is the number of libraries loaded at the same time on the thread pool.
      */
     void Start( FP_LIB_TABLE* aTable, wxString const* aNickname = nullptr,
             unsigned aNThreads = DEFAULT_THREADS );
@@ -205,6 +205,18 @@ public:
      */
     const MODULE* GetEnumeratedFootprint( const wxString& aNickname,
                                           const wxString& aFootprintName );
+
+    /**
+     * Function GetEnumeratedFootprintSummary
+     *
+     * gets the keywords, description and pad counts of a footprint listed by
+     * FootprintEnumerate(), without loading it when the library plugin can avoid it.
+     *
+     * @return bool - false if the footprint was not found.
+     */
+    bool GetEnumeratedFootprintSummary( const wxString& aNickname,
+                                        const wxString& aFootprintName,
+                                        FOOTPRINT_SUMMARY& aSummary );
     /**
      * Enum SAVE_T
      * is the set of return values from FootprintSave() below.
@@ -247,6 +247,122 @@ public:
 };
 
 
+/**
+ * SPAN_LINE_READER
+ * is a LINE_READER over a span of memory which outlives it.  ReadLine() returns views into
+ * the span instead of copies, so its lines are <b>not</b> nul terminated and only the
+ * Length() bytes of a line are valid.  This suits DSNLEXER, which never reads a line past
+ * its length.
+ *
+ * Parts of the span can be skipped.  A skipped part reads as the line breaks it holds, so
+ * the line numbers of the other parts still point into the span.
+ */
+class SPAN_LINE_READER : public LINE_READER
+{
+protected:
+    const char* m_data;         ///< the span, or NULL for an empty span
+    size_t      m_size;         ///< the span size
+    size_t      m_ndx;          ///< offset of the next line in m_data
+    unsigned    m_firstColumn;  ///< column of the first char of the span
+    unsigned    m_breaks;       ///< line breaks of a skipped part not read yet
+    size_t      m_nextSkip;     ///< index in m_skips of the next part to skip
+    std::string m_buffer;       ///< the current line, when it is not a view into the span
+
+    std::vector<std::pair<size_t, size_t>> m_skips;  ///< skipped parts, in span order
+
+    /**
+     * Constructor SPAN_LINE_READER
+     * for derived classes setting the span themselves.
+     */
+    SPAN_LINE_READER();
+
+public:
+
+    /**
+     * Constructor SPAN_LINE_READER
+     *
+     * @param aData is the span, not necessarily nul terminated.
+     * @param aSize is the size of @a aData.
+     * @param aSource is the origin of the span, for error reporting purposes.
+     * @param aStartingLineNumber is the initial line number to report on error, see
+     *  FILE_LINE_READER.
+     * @param aFirstColumn is the column of @a aData in its first line.  The first line is
+     *  indented by as many spaces, so that errors report the right offset.
+     */
+    SPAN_LINE_READER( const char* aData, size_t aSize, const wxString& aSource,
+                      unsigned aStartingLineNumber = 0, unsigned aFirstColumn = 0 );
+
+    ~SPAN_LINE_READER();
+
+    char* ReadLine() override;
+
+    /**
+     * Function Skip
+     * skips the part [@a aStart, @a aEnd) of the span.  Parts must be given in span order,
+     * before reading the lines.
+     */
+    void Skip( size_t aStart, size_t aEnd );
+
+    /**
+     * Function Rewind
+     * goes back to the start of the span and resets the line number back to zero.
+     */
+    void Rewind()
+    {
+        m_ndx = 0;
+        m_breaks = 0;
+        m_nextSkip = 0;
+        m_lineNum = 0;
+    }
+
+    /**
+     * Function Data
+     * returns the whole span, skipped parts included.
+     */
+    const char* Data() const
+    {
+        return m_data;
+    }
+
+    /**
+     * Function Size
+     * returns the number of bytes of the span.
+     */
+    size_t Size() const
+    {
+        return m_size;
+    }
+};
+
+
+/**
+ * MAPPED_FILE_LINE_READER
+ * is a SPAN_LINE_READER over a whole file mapped in memory.  The content of the file is
+ * available as one span with Data() and Size().
+ */
+class MAPPED_FILE_LINE_READER : public SPAN_LINE_READER
+{
+protected:
+    void*       m_mapping;      ///< platform specific handle of the mapping
+
+public:
+
+    /**
+     * Constructor MAPPED_FILE_LINE_READER
+     * maps the file @a aFileName in memory.
+     *
+     * @param aFileName is the name of the file to map and to use for error reporting purposes.
+     * @param aStartingLineNumber is the initial line number to report on error, see
+     *  FILE_LINE_READER.
+     *
+     * @throw IO_ERROR if @a aFileName cannot be opened or mapped.
+     */
+    MAPPED_FILE_LINE_READER( const wxString& aFileName, unsigned aStartingLineNumber = 0 );
+
+    ~MAPPED_FILE_LINE_READER();
+};
+
+
 /**
  * STRING_LINE_READER
  * is a LINE_READER that reads from a multiline 8 bit wide std::string
@@ -327,6 +443,7 @@ public:
 class OUTPUTFORMATTER
 {
     std::vector<char>   m_buffer;
+    std::string         m_printBuffer;      ///< output of Print() when not using vprint()
     char                quoteChar[2];
 
     int sprint( const char* fmt, ... );
@@ -0,0 +1,197 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class TASK_GROUP;
+
+
+/**
+ * THREAD_POOL
+ * is the pool of worker threads shared by all the parallel algorithms, so that they do not
+ * start threads of their own for each operation, and so that nested parallel work does not
+ * run more threads than there are cores.
+ *
+ * Tasks are submitted through a TASK_GROUP.  Each worker has its own queue of tasks: it runs
+ * the tasks it submitted itself last in, first out, and steals the oldest tasks of the other
+ * workers when its queue is empty.  Tasks submitted by other threads, e.g. the GUI thread,
+ * go to a shared queue.
+ *
+ * The pool of the process is created on first use and is never destroyed: its workers must
+ * not be joined during the destruction of the static objects.  Other pools, e.g. with a given
+ * number of workers for the tests, can be created and destroyed once their groups are done.
+ */
+class THREAD_POOL
+{
+public:
+    ///> Starts aThreadCount workers.  The algorithms use the pool of the process, see Get().
+    THREAD_POOL( size_t aThreadCount );
+
+    ///> Stops and joins the workers, once the queued tasks are run.
+    ~THREAD_POOL();
+
+    /**
+     * Function Get
+     * returns the thread pool of the process.
+     */
+    static THREAD_POOL& Get();
+
+    /**
+     * Function GetThreadCount
+     * returns the number of tasks which can run at the same time, i.e. the number of workers.
+     * Algorithms splitting their work in chunks use it to size their chunks.
+     */
+    size_t GetThreadCount() const
+    {
+        return m_threads.size();
+    }
+
+    /**
+     * Function ParallelFor
+     * runs aJob( i ) for every i in [0, aCount) on the pool and waits for them, calling
+     * aProgress (if any) about every 100ms while waiting, see TASK_GROUP::Wait().  The jobs
+     * are run in increasing order of i, but not one after the other.
+     * @return bool - false if aProgress cancelled the jobs.
+     * @throw the first exception thrown by aJob.
+     */
+    static bool ParallelFor( size_t aCount, const std::function<void( size_t )>& aJob,
+                             const std::function<bool()>& aProgress = nullptr );
+
+private:
+    friend class TASK_GROUP;
+
+    struct TASK
+    {
+        TASK_GROUP*           m_group;
+        std::function<void()> m_func;
+    };
+
+    struct TASK_QUEUE
+    {
+        std::mutex       m_mutex;
+        std::deque<TASK> m_tasks;
+    };
+
+    void submit( TASK_GROUP* aGroup, std::function<void()>&& aFunc );
+
+    /**
+     * Function popTask
+     * takes a task to run.  A worker (aWorker >= 0) takes the newest task of its own queue,
+     * or else the oldest task of the shared queue or of another worker.  A thread waiting
+     * for aGroup only takes the tasks of aGroup.
+     */
+    bool popTask( TASK& aTask, int aWorker, const TASK_GROUP* aGroup );
+
+    bool popFrom( TASK_QUEUE& aQueue, TASK& aTask, bool aNewest, const TASK_GROUP* aGroup );
+
+    void runTask( TASK& aTask );
+
+    void workerLoop( int aWorker );
+
+    std::vector<std::thread>                 m_threads;
+    std::vector<std::unique_ptr<TASK_QUEUE>> m_queues;      ///< one per worker, then the
+                                                            ///< shared queue
+    std::atomic<size_t>                      m_queued;      ///< tasks in the queues
+
+    std::mutex                               m_sleepMutex;
+    std::condition_variable                  m_wakeUp;
+    bool                                     m_stopping;    ///< the workers must exit
+};
+
+
+/**
+ * TASK_GROUP
+ * is a set of tasks run on the THREAD_POOL, which can be waited for and cancelled together.
+ *
+ * Wait() runs the tasks of the group which are still queued on the waiting thread, so that a
+ * task can itself wait for a nested group without blocking a worker.  A group must be waited
+ * for before its destruction; the destructor waits for the running tasks otherwise.
+ */
+class TASK_GROUP
+{
+public:
+    TASK_GROUP( THREAD_POOL& aPool = THREAD_POOL::Get() );
+
+    ~TASK_GROUP();
+
+    /**
+     * Function Run
+     * queues aTask on the thread pool.
+     */
+    void Run( std::function<void()> aTask );
+
+    /**
+     * Function Cancel
+     * prevents the queued tasks of the group from starting.  Running tasks are expected to
+     * check IsCancelled() in their loops.
+     */
+    void Cancel()
+    {
+        m_cancelled = true;
+    }
+
+    bool IsCancelled() const
+    {
+        return m_cancelled;
+    }
+
+    /**
+     * Function Wait
+     * waits for all the tasks of the group.
+     *
+     * Without aProgress, the waiting thread runs the queued tasks of the group itself.  With
+     * aProgress, it only calls aProgress about every aInterval ms, e.g. to refresh a progress
+     * reporter, so that it stays responsive; the group is cancelled when aProgress returns
+     * false.
+     *
+     * @return bool - false if the group was cancelled.
+     * @throw the first exception thrown by a task of the group.
+     */
+    bool Wait( const std::function<bool()>& aProgress = nullptr, int aInterval = 100 );
+
+private:
+    friend class THREAD_POOL;
+
+    void taskDone( std::exception_ptr aException );
+
+    THREAD_POOL&            m_pool;
+    std::atomic<size_t>     m_unfinished;   ///< tasks queued or running
+    std::atomic<bool>       m_cancelled;
+    std::exception_ptr      m_exception;    ///< the first exception thrown by a task
+
+    std::mutex              m_mutex;
+    std::condition_variable m_done;
+};
+
+#endif  // THREAD_POOL_H
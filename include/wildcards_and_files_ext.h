@@ -126,6 +126,7 @@ extern const std::string EquFileExtension;
 extern const std::string LegacyPcbFileExtension;
 extern const std::string KiCadPcbFileExtension;
 #define PcbFileExtension    KiCadPcbFileExtension       // symlink choice
+extern const std::string ZoneFillCacheFileExtension;
 extern const std::string KiCadSymbolLibFileExtension;
 extern const std::string PageLayoutDescrFileExtension;
 
@@ -0,0 +1,146 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __POLY_EDGE_INDEX_H
+#define __POLY_EDGE_INDEX_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include <geometry/seg.h>
+#include <math/vector2d.h>
+
+
+/**
+ * POLY_EDGE_INDEX
+ *
+ * Splits the edges of a set of polygons into a uniform rectangular grid, so that the queries
+ * about a point or a segment only test the edges which are near it.  Each edge is listed in
+ * all the cells touched by its bounding box.
+ *
+ * The index does not follow the changes of the polygons; SHAPE_POLY_SET rebuilds it when
+ * needed.
+ */
+class POLY_EDGE_INDEX
+{
+public:
+    struct EDGE
+    {
+        SEG m_Seg;
+        int m_Polygon;      ///< index of the polygon of the edge in the set
+        int m_Contour;      ///< 0 for the outline of the polygon, 1 + the hole index otherwise
+    };
+
+    /**
+     * Function Add
+     * adds an edge to the index, before Build().
+     */
+    void Add( const SEG& aSeg, int aPolygon, int aContour )
+    {
+        m_edges.push_back( EDGE{ aSeg, aPolygon, aContour } );
+    }
+
+    /**
+     * Function Build
+     * sizes the grid after the edges added so far, and sorts them into its cells.
+     */
+    void Build();
+
+    int EdgeCount() const
+    {
+        return m_edges.size();
+    }
+
+    /**
+     * Function Query
+     * calls aFunc( const EDGE& ) for each edge which may touch the box between aMin and
+     * aMax, until aFunc returns true.  Each edge is reported once at most.
+     * @return bool - true if aFunc returned true.
+     */
+    template <class FUNC>
+    bool Query( const VECTOR2I& aMin, const VECTOR2I& aMax, FUNC aFunc ) const
+    {
+        if( m_edges.empty() || aMax.x < m_min.x || aMin.x > m_max.x || aMax.y < m_min.y
+                || aMin.y > m_max.y )
+            return false;
+
+        int col0 = column( aMin.x );
+        int col1 = column( aMax.x );
+        int row0 = row( aMin.y );
+        int row1 = row( aMax.y );
+
+        for( int r = row0; r <= row1; r++ )
+        {
+            for( int c = col0; c <= col1; c++ )
+            {
+                int cell = r * m_cols + c;
+
+                for( int ii = m_cellStart[cell]; ii < m_cellStart[cell + 1]; ii++ )
+                {
+                    const EDGE& edge = m_edges[m_cellEdges[ii]];
+
+                    // An edge spanning several cells is only reported in the first cell of
+                    // the query it belongs to
+                    int edgeCol = column( std::min( edge.m_Seg.A.x, edge.m_Seg.B.x ) );
+                    int edgeRow = row( std::min( edge.m_Seg.A.y, edge.m_Seg.B.y ) );
+
+                    if( std::max( edgeCol, col0 ) != c || std::max( edgeRow, row0 ) != r )
+                        continue;
+
+                    if( aFunc( edge ) )
+                        return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+private:
+    int column( int aX ) const
+    {
+        int64_t c = ( (int64_t) aX - m_min.x ) / m_cellWidth;
+        return (int) std::max<int64_t>( 0, std::min<int64_t>( c, m_cols - 1 ) );
+    }
+
+    int row( int aY ) const
+    {
+        int64_t r = ( (int64_t) aY - m_min.y ) / m_cellHeight;
+        return (int) std::max<int64_t>( 0, std::min<int64_t>( r, m_rows - 1 ) );
+    }
+
+    std::vector<EDGE> m_edges;
+    std::vector<int>  m_cellStart;          ///< first entry of each cell in m_cellEdges, and
+                                            ///< the end of the last cell
+    std::vector<int>  m_cellEdges;          ///< indices in m_edges, cell after cell
+
+    VECTOR2I          m_min;
+    VECTOR2I          m_max;
+    int64_t           m_cellWidth = 1;
+    int64_t           m_cellHeight = 1;
+    int               m_cols = 0;
+    int               m_rows = 0;
+};
+
+#endif  // __POLY_EDGE_INDEX_H
@@ -466,6 +466,15 @@ public:
      */
     void Append( const SHAPE_LINE_CHAIN& aOtherLine );
 
+    /**
+     * Function Append()
+     *
+     * Appends a list of points at the end of the line chain, skipping the points which are
+     * the same as the previous one.
+     * @param aPoints the points to be appended.
+     */
+    void Append( const std::vector<VECTOR2I>& aPoints );
+
     void Append( const SHAPE_ARC& aArc );
 
     void Insert( size_t aVertex, const VECTOR2I& aP );
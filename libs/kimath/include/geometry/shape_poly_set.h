@@ -26,10 +26,12 @@
 #ifndef __SHAPE_POLY_SET_H
 #define __SHAPE_POLY_SET_H
 
+#include <atomic>
 #include <cstdio>
 #include <deque>                        // for deque
 #include <iosfwd>                       // for string, stringstream
 #include <memory>
+#include <mutex>
 #include <set>                          // for set
 #include <stdexcept>                    // for out_of_range
 #include <stdlib.h>                     // for abs
@@ -43,6 +45,8 @@
 #include <math/vector2d.h>              // for VECTOR2I
 #include <md5_hash.h>
 
+class POLY_EDGE_INDEX;
+
 
 /**
  * SHAPE_POLY_SET
@@ -119,6 +123,16 @@ class SHAPE_POLY_SET : public SHAPE
                 return m_vertices.size();
             }
 
+            const VECTOR2I& GetVertex( int index ) const
+            {
+                return m_vertices[ index ];
+            }
+
+            const TRI& GetTriangleIndices( int index ) const
+            {
+                return m_triangles[ index ];
+            }
+
         private:
 
             std::deque<TRI> m_triangles;
@@ -240,7 +254,7 @@ class SHAPE_POLY_SET : public SHAPE
 
             const T& Get()
             {
-                return m_poly->Polygon( m_currentPolygon )[m_currentContour].CPoint(
+                return m_poly->CPolygon( m_currentPolygon )[m_currentContour].CPoint(
                         m_currentVertex );
             }
 
@@ -363,7 +377,8 @@ class SHAPE_POLY_SET : public SHAPE
 
             T Get()
             {
-                return m_poly->Polygon( m_currentPolygon )[m_currentContour].Segment( m_currentSegment );
+                return m_poly->CPolygon( m_currentPolygon )[m_currentContour].CSegment(
+                        m_currentSegment );
             }
 
             T operator*()
@@ -584,9 +599,14 @@ class SHAPE_POLY_SET : public SHAPE
             return m_polys[aOutline].size() - 1;
         }
 
-        ///> Returns the reference to aIndex-th outline in the set
+        /**
+         * Returns the reference to aIndex-th outline in the set.  The set may be changed through
+         * this reference, so the edge index of the set is dropped, see edgeIndex(); use
+         * COutline() to only read the outline.
+         */
         SHAPE_LINE_CHAIN& Outline( int aIndex )
         {
+            invalidateEdgeIndex();
             return m_polys[aIndex][0];
         }
 
@@ -606,15 +626,17 @@ class SHAPE_POLY_SET : public SHAPE
             return Subset( aPolygonIndex, aPolygonIndex + 1 );
         }
 
-        ///> Returns the reference to aHole-th hole in the aIndex-th outline
+        ///> Returns the reference to aHole-th hole in the aIndex-th outline, see Outline()
         SHAPE_LINE_CHAIN& Hole( int aOutline, int aHole )
         {
+            invalidateEdgeIndex();
             return m_polys[aOutline][aHole + 1];
         }
 
-        ///> Returns the aIndex-th subpolygon in the set
+        ///> Returns the aIndex-th subpolygon in the set, see Outline()
         POLYGON& Polygon( int aIndex )
         {
+            invalidateEdgeIndex();
             return m_polys[aIndex];
         }
 
@@ -651,12 +673,15 @@ class SHAPE_POLY_SET : public SHAPE
          * @param  aLast         is the last polygon whose points will be iterated.
          * @param  aIterateHoles is a flag to indicate whether the points of the holes should be
          *                       iterated.
-         * @return ITERATOR - the iterator object.
+         * @return ITERATOR - the iterator object.  As for Outline(), the edge index of the set
+         *                  is dropped; use CIterate() to only read the points.
          */
         ITERATOR Iterate( int aFirst, int aLast, bool aIterateHoles = false )
         {
             ITERATOR iter;
 
+            invalidateEdgeIndex();
+
             iter.m_poly = this;
             iter.m_currentPolygon = aFirst;
             iter.m_lastPolygon = aLast < 0 ? OutlineCount() - 1 : aLast;
@@ -905,6 +930,10 @@ class SHAPE_POLY_SET : public SHAPE
             Inflate( -aAmount, aCircleSegmentsCount, aCornerStrategy );
         }
 
+        ///> Chains boolean operations and inflations without converting back the intermediate
+        ///> results, see below
+        class BOOLEAN_BUILDER;
+
         /**
          * Performs outline inflation/deflation, using round corners.  Polygons can have holes,
          * and/or linked holes with main outlines.  The resulting polygons are laso polygons with
@@ -1051,6 +1080,9 @@ class SHAPE_POLY_SET : public SHAPE
          *                       editing in between, but the caller MUST cache the bbox caches
          *                       before calling (via BuildBBoxCaches(), above)
          * @return true if the polygon contains the point
+         *
+         * Like Collide() and PointOnEdge(), Contains() uses an index of the edges of the
+         * polygons when the set is large enough, see edgeIndex().
          */
         bool Contains( const VECTOR2I& aP, int aSubpolyIndex = -1, int aAccuracy = 0,
                        bool aUseBBoxCaches = false ) const;
@@ -1257,6 +1289,32 @@ class SHAPE_POLY_SET : public SHAPE
         bool containsSingle( const VECTOR2I& aP, int aSubpolyIndex, int aAccuracy,
                              bool aUseBBoxCaches = false ) const;
 
+        /**
+         * Function containsIndexed
+         * is Contains() using the edge index of the set: a point is inside a polygon when a ray
+         * cast from it crosses its outline an odd number of times and each of its holes an even
+         * number of times, with the same edge cases as SHAPE_LINE_CHAIN::PointInside().
+         */
+        bool containsIndexed( const POLY_EDGE_INDEX& aIndex, const VECTOR2I& aP,
+                              int aSubpolyIndex, int aAccuracy ) const;
+
+        /**
+         * Function edgeIndex
+         * returns the index of the edges of the polygons, building it if the polygons changed
+         * since it was built, or NULL if the set is too small to be worth indexing.  The methods
+         * changing the polygons, and the non const accessors through which they can be
+         * changed, drop the index.  The index returned stays alive for the whole query of the
+         * caller, even if another thread builds a new one meanwhile.
+         */
+        std::shared_ptr<const POLY_EDGE_INDEX> edgeIndex() const;
+
+        void invalidateEdgeIndex()
+        {
+            // Called by each non const accessor, so kept cheap: a set is not changed while
+            // another thread queries it
+            m_edgeIndexValid.store( false, std::memory_order_relaxed );
+        }
+
         /**
          * Operations ChamferPolygon and FilletPolygon are computed under the private chamferFillet
          * method; this enum is defined to make the necessary distinction when calling this method
@@ -1298,19 +1356,105 @@ class SHAPE_POLY_SET : public SHAPE
 
         SHAPE_POLY_SET& operator=( const SHAPE_POLY_SET& );
 
+        typedef std::vector<std::unique_ptr<TRIANGULATED_POLYGON>> TRIANGULATION;
+
         void CacheTriangulation();
         bool IsTriangulationUpToDate() const;
 
+        /**
+         * Function SetTriangulation
+         * Installs a triangulation of the current polygons computed elsewhere, e.g. read from a
+         * cache file, instead of calling CacheTriangulation().
+         */
+        void SetTriangulation( TRIANGULATION&& aTriangulation );
+
         MD5_HASH GetHash() const;
 
     private:
 
         MD5_HASH checksum() const;
 
-        std::vector<std::unique_ptr<TRIANGULATED_POLYGON>> m_triangulatedPolys;
+        TRIANGULATION m_triangulatedPolys;
         bool m_triangulationValid = false;
         MD5_HASH m_hash;
 
+        ///> only accessed with std::atomic_load() and std::atomic_store()
+        mutable std::shared_ptr<const POLY_EDGE_INDEX> m_edgeIndex;
+        mutable std::atomic<bool>                      m_edgeIndexValid { false };
+        mutable std::mutex                             m_edgeIndexMutex;   ///< to build the index
+
+};
+
+
+/**
+ * SHAPE_POLY_SET::BOOLEAN_BUILDER
+ *
+ * Runs a chain of boolean operations and inflations on a polygon set.  Each method of
+ * SHAPE_POLY_SET converts the polygons to Clipper paths and the result back; the builder keeps
+ * the intermediate results in Clipper form, and only converts the operands and the final
+ * result.  Consecutive unions, or consecutive differences, are run as a single operation.
+ *
+ * For instance:
+ *      SHAPE_POLY_SET::BOOLEAN_BUILDER builder( outline );
+ *      builder.Subtract( holes, SHAPE_POLY_SET::PM_FAST );
+ *      builder.Deflate( half_width, segCount );
+ *      builder.Inflate( half_width, segCount );
+ *      builder.Result( outline );
+ */
+class SHAPE_POLY_SET::BOOLEAN_BUILDER
+{
+public:
+    BOOLEAN_BUILDER( const SHAPE_POLY_SET& aShape );
+
+    void Add( const SHAPE_POLY_SET& aShape, POLYGON_MODE aFastMode );
+
+    void Subtract( const SHAPE_POLY_SET& aShape, POLYGON_MODE aFastMode );
+
+    void Intersect( const SHAPE_POLY_SET& aShape, POLYGON_MODE aFastMode );
+
+    /**
+     * Function Simplify
+     * merges the overlapping polygons, like SHAPE_POLY_SET::Simplify().  The results of the
+     * other operations are already simplified, so this only runs an operation of its own when
+     * there is nothing to simplify yet, or to get strictly simple polygons.
+     */
+    void Simplify( POLYGON_MODE aFastMode );
+
+    ///> See SHAPE_POLY_SET::Inflate()
+    void Inflate( int aAmount, int aCircleSegmentsCount,
+                  CORNER_STRATEGY aCornerStrategy = ROUND_ALL_CORNERS );
+
+    void Deflate( int aAmount, int aCircleSegmentsCount,
+                  CORNER_STRATEGY aCornerStrategy = ROUND_ALL_CORNERS )
+    {
+        Inflate( -aAmount, aCircleSegmentsCount, aCornerStrategy );
+    }
+
+    /**
+     * Function Result
+     * runs the pending operation and stores the polygons in aResult.  More operations can be
+     * chained afterwards.
+     */
+    void Result( SHAPE_POLY_SET& aResult );
+
+private:
+    void addOperand( ClipperLib::ClipType aType, const SHAPE_POLY_SET& aShape,
+                     POLYGON_MODE aFastMode );
+
+    ///> Runs the pending boolean operation, leaving its result in m_tree
+    void execute();
+
+    ///> Returns the current polygons, as paths
+    const ClipperLib::Paths& current();
+
+    ClipperLib::Paths    m_paths;           ///< the current polygons, unless m_inTree
+    ClipperLib::PolyTree m_tree;            ///< the result of the last operation
+    bool                 m_inTree;          ///< the current polygons are m_tree
+
+    ClipperLib::Paths    m_operands;        ///< the clip paths of the pending operation
+    ClipperLib::ClipType m_operation;
+    bool                 m_pending;         ///< m_operation is waiting for more operands
+    bool                 m_strictlySimple;
 };
 
 #endif
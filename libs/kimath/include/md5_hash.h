@@ -5,6 +5,7 @@
 #ifndef __MD5_HASH_H
 #define __MD5_HASH_H
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 
@@ -35,6 +36,11 @@ public:
      */
     std::string Format();
 
+    /** @return the Format() of the hash of the @a aSize bytes of @a aData, which unlike
+     *  Hash() may be more than 4 GB.
+     */
+    static std::string FormatData( const void* aData, size_t aSize );
+
 private:
     struct MD5_CTX {
        uint8_t data[64];
@@ -0,0 +1,98 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+#include <geometry/poly_edge_index.h>
+
+
+///> Upper bound of the number of cells along each axis of the grid
+static const int MAX_CELLS_PER_AXIS = 1024;
+
+
+void POLY_EDGE_INDEX::Build()
+{
+    m_cellStart.clear();
+    m_cellEdges.clear();
+
+    if( m_edges.empty() )
+        return;
+
+    m_min = m_max = m_edges[0].m_Seg.A;
+
+    for( const EDGE& edge : m_edges )
+    {
+        for( const VECTOR2I& p : { edge.m_Seg.A, edge.m_Seg.B } )
+        {
+            m_min.x = std::min( m_min.x, p.x );
+            m_min.y = std::min( m_min.y, p.y );
+            m_max.x = std::max( m_max.x, p.x );
+            m_max.y = std::max( m_max.y, p.y );
+        }
+    }
+
+    // About one cell per edge, shaped after the bounding box of the edges
+    int64_t width = (int64_t) m_max.x - m_min.x + 1;
+    int64_t height = (int64_t) m_max.y - m_min.y + 1;
+    double  cols = std::sqrt( (double) m_edges.size() * width / height );
+
+    m_cols = std::max( 1, std::min( MAX_CELLS_PER_AXIS, (int) std::ceil( cols ) ) );
+    m_rows = std::max( 1, std::min<int>( MAX_CELLS_PER_AXIS,
+                                         ( m_edges.size() + m_cols - 1 ) / m_cols ) );
+    m_cellWidth = ( width + m_cols - 1 ) / m_cols;
+    m_cellHeight = ( height + m_rows - 1 ) / m_rows;
+
+    // Count the edges of each cell, then fill the cells in a single array
+    std::vector<int> counts( m_cols * m_rows + 1, 0 );
+
+    auto forEachCell = [&]( const EDGE& aEdge, const std::function<void( int )>& aFunc )
+    {
+        int col0 = column( std::min( aEdge.m_Seg.A.x, aEdge.m_Seg.B.x ) );
+        int col1 = column( std::max( aEdge.m_Seg.A.x, aEdge.m_Seg.B.x ) );
+        int row0 = row( std::min( aEdge.m_Seg.A.y, aEdge.m_Seg.B.y ) );
+        int row1 = row( std::max( aEdge.m_Seg.A.y, aEdge.m_Seg.B.y ) );
+
+        for( int r = row0; r <= row1; r++ )
+        {
+            for( int c = col0; c <= col1; c++ )
+                aFunc( r * m_cols + c );
+        }
+    };
+
+    for( const EDGE& edge : m_edges )
+        forEachCell( edge, [&]( int aCell ) { counts[aCell]++; } );
+
+    m_cellStart.resize( m_cols * m_rows + 1 );
+    m_cellStart[0] = 0;
+
+    for( int cell = 0; cell < m_cols * m_rows; cell++ )
+        m_cellStart[cell + 1] = m_cellStart[cell] + counts[cell];
+
+    m_cellEdges.resize( m_cellStart.back() );
+    std::copy( m_cellStart.begin(), m_cellStart.end() - 1, counts.begin() );
+
+    for( int ii = 0; ii < (int) m_edges.size(); ii++ )
+        forEachCell( m_edges[ii], [&]( int aCell ) { m_cellEdges[counts[aCell]++] = ii; } );
+}
@@ -392,6 +392,16 @@ void SHAPE_LINE_CHAIN::Append( const SHAPE_LINE_CHAIN& aOtherLine )
 }
 
 
+void SHAPE_LINE_CHAIN::Append( const std::vector<VECTOR2I>& aPoints )
+{
+    m_points.reserve( m_points.size() + aPoints.size() );
+    m_shapes.reserve( m_shapes.size() + aPoints.size() );
+
+    for( const VECTOR2I& p : aPoints )
+        Append( p );
+}
+
+
 void SHAPE_LINE_CHAIN::Append( const SHAPE_ARC& aArc )
 {
     auto& chain = aArc.ConvertToPolyline();
@@ -33,6 +33,7 @@
 #include <istream>                           // for operator<<, operator>>
 #include <limits>                            // for numeric_limits
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>                            // for char_traits, operator!=
 #include <type_traits>                       // for swap, move
@@ -41,6 +42,7 @@
 
 #include <clipper.hpp>                       // for Clipper, PolyNode, Clipp...
 #include <geometry/geometry_utils.h>
+#include <geometry/poly_edge_index.h>
 #include <geometry/polygon_triangulation.h>
 #include <geometry/seg.h>                    // for SEG, OPT_VECTOR2I
 #include <geometry/shape.h>
@@ -79,6 +81,15 @@ SHAPE_POLY_SET::SHAPE_POLY_SET( const SHAPE_POLY_SET& aOther, bool aDeepCopy ) :
         m_hash = aOther.GetHash();
         m_triangulationValid = true;
     }
+
+    // The edge index is never modified, only replaced, so copies can share it: each copy
+    // drops it when it is changed, or may be changed through its non const accessors.  Another
+    // thread may replace the index of aOther meanwhile, so its pointer is loaded atomically.
+    if( aOther.m_edgeIndexValid )
+    {
+        m_edgeIndex = std::atomic_load( &aOther.m_edgeIndex );
+        m_edgeIndexValid = true;
+    }
 }
 
 
@@ -178,6 +189,8 @@ bool SHAPE_POLY_SET::GetGlobalIndex( SHAPE_POLY_SET::VERTEX_INDEX aRelativeIndic
 
 int SHAPE_POLY_SET::NewOutline()
 {
+    invalidateEdgeIndex();
+
     SHAPE_LINE_CHAIN empty_path;
     POLYGON poly;
 
@@ -190,6 +203,8 @@ int SHAPE_POLY_SET::NewOutline()
 
 int SHAPE_POLY_SET::NewHole( int aOutline )
 {
+    invalidateEdgeIndex();
+
     SHAPE_LINE_CHAIN empty_path;
 
     empty_path.SetClosed( true );
@@ -207,6 +222,8 @@ int SHAPE_POLY_SET::NewHole( int aOutline )
 
 int SHAPE_POLY_SET::Append( int x, int y, int aOutline, int aHole, bool aAllowDuplication )
 {
+    invalidateEdgeIndex();
+
     assert( m_polys.size() );
 
     if( aOutline < 0 )
@@ -230,6 +247,8 @@ int SHAPE_POLY_SET::Append( int x, int y, int aOutline, int aHole, bool aAllowDu
 
 void SHAPE_POLY_SET::InsertVertex( int aGlobalIndex, VECTOR2I aNewVertex )
 {
+    invalidateEdgeIndex();
+
     VERTEX_INDEX index;
 
     if( aGlobalIndex < 0 )
@@ -415,6 +434,8 @@ bool SHAPE_POLY_SET::IsSelfIntersecting() const
 
 int SHAPE_POLY_SET::AddOutline( const SHAPE_LINE_CHAIN& aOutline )
 {
+    invalidateEdgeIndex();
+
     assert( aOutline.IsClosed() );
 
     POLYGON poly;
@@ -429,6 +450,8 @@ int SHAPE_POLY_SET::AddOutline( const SHAPE_LINE_CHAIN& aOutline )
 
 int SHAPE_POLY_SET::AddHole( const SHAPE_LINE_CHAIN& aHole, int aOutline )
 {
+    invalidateEdgeIndex();
+
     assert( m_polys.size() );
 
     if( aOutline < 0 )
@@ -533,8 +556,12 @@ void SHAPE_POLY_SET::InflateWithLinkedHoles( int aFactor, int aCircleSegmentsCou
 }
 
 
-void SHAPE_POLY_SET::Inflate( int aAmount, int aCircleSegmentsCount,
-                              CORNER_STRATEGY aCornerStrategy )
+/**
+ * Function setupOffset
+ * configures aOffset for an inflation by aAmount, and returns the join type of its paths.
+ */
+static JoinType setupOffset( ClipperOffset& aOffset, int aAmount, int aCircleSegmentsCount,
+                             SHAPE_POLY_SET::CORNER_STRATEGY aCornerStrategy )
 {
     // A static table to avoid repetitive calculations of the coefficient
     // 1.0 - cos( M_PI / aCircleSegmentsCount )
@@ -542,8 +569,6 @@ void SHAPE_POLY_SET::Inflate( int aAmount, int aCircleSegmentsCount,
     #define SEG_CNT_MAX 64
     static double arc_tolerance_factor[SEG_CNT_MAX + 1];
 
-    ClipperOffset c;
-
     // N.B. see the Clipper documentation for jtSquare/jtMiter/jtRound.  They are poorly named
     // and are not what you'd think they are.
     // http://www.angusj.com/delphi/clipper/documentation/Docs/Units/ClipperLib/Types/JoinType.htm
@@ -553,41 +578,33 @@ void SHAPE_POLY_SET::Inflate( int aAmount, int aCircleSegmentsCount,
 
     switch( aCornerStrategy )
     {
-    case ALLOW_ACUTE_CORNERS:
+    case SHAPE_POLY_SET::ALLOW_ACUTE_CORNERS:
         joinType = jtMiter;
         miterLimit = 10;        // Allows large spikes
         miterFallback = jtSquare;
         break;
 
-    case CHAMFER_ACUTE_CORNERS: // Acute angles are chamfered
+    case SHAPE_POLY_SET::CHAMFER_ACUTE_CORNERS: // Acute angles are chamfered
         joinType = jtMiter;
         miterFallback = jtRound;
         break;
 
-    case ROUND_ACUTE_CORNERS:   // Acute angles are rounded
+    case SHAPE_POLY_SET::ROUND_ACUTE_CORNERS:   // Acute angles are rounded
         joinType = jtMiter;
         miterFallback = jtSquare;
         break;
 
-    case CHAMFER_ALL_CORNERS:   // All angles are chamfered.
+    case SHAPE_POLY_SET::CHAMFER_ALL_CORNERS:   // All angles are chamfered.
         joinType = jtSquare;
         miterFallback = jtSquare;
         break;
 
-    case ROUND_ALL_CORNERS:     // All angles are rounded.
+    case SHAPE_POLY_SET::ROUND_ALL_CORNERS:     // All angles are rounded.
         joinType = jtRound;
         miterFallback = jtSquare;
         break;
     }
 
-    for( const POLYGON& poly : m_polys )
-    {
-        for( size_t i = 0; i < poly.size(); i++ )
-            c.AddPath( poly[i].convertToClipper( i == 0 ), joinType, etClosedPolygon );
-    }
-
-    PolyTree solution;
-
     // Calculate the arc tolerance (arc error) from the seg count by circle. The seg count is
     // nn = M_PI / acos(1.0 - c.ArcTolerance / abs(aAmount))
     // http://www.angusj.com/delphi/clipper/documentation/Docs/Units/ClipperLib/Classes/ClipperOffset/Properties/ArcTolerance.htm
@@ -607,17 +624,176 @@ void SHAPE_POLY_SET::Inflate( int aAmount, int aCircleSegmentsCount,
     else
         coeff = arc_tolerance_factor[aCircleSegmentsCount];
 
-    c.ArcTolerance = std::abs( aAmount ) * coeff;
-    c.MiterLimit = miterLimit;
-    c.MiterFallback = miterFallback;
+    aOffset.ArcTolerance = std::abs( aAmount ) * coeff;
+    aOffset.MiterLimit = miterLimit;
+    aOffset.MiterFallback = miterFallback;
+
+    return joinType;
+}
+
+
+void SHAPE_POLY_SET::Inflate( int aAmount, int aCircleSegmentsCount,
+                              CORNER_STRATEGY aCornerStrategy )
+{
+    ClipperOffset c;
+    JoinType      joinType = setupOffset( c, aAmount, aCircleSegmentsCount, aCornerStrategy );
+
+    for( const POLYGON& poly : m_polys )
+    {
+        for( size_t i = 0; i < poly.size(); i++ )
+            c.AddPath( poly[i].convertToClipper( i == 0 ), joinType, etClosedPolygon );
+    }
+
+    PolyTree solution;
+
     c.Execute( solution, aAmount );
 
     importTree( &solution );
 }
 
 
+/**
+ * Function appendPaths
+ * converts the contours of aShape to Clipper paths, the outlines in the positive orientation
+ * and the holes in the negative one.
+ */
+static void appendPaths( Paths& aPaths, const SHAPE_POLY_SET& aShape )
+{
+    for( int ii = 0; ii < aShape.OutlineCount(); ii++ )
+    {
+        const SHAPE_POLY_SET::POLYGON& poly = aShape.CPolygon( ii );
+
+        for( size_t jj = 0; jj < poly.size(); jj++ )
+            aPaths.push_back( poly[jj].convertToClipper( jj == 0 ) );
+    }
+}
+
+
+SHAPE_POLY_SET::BOOLEAN_BUILDER::BOOLEAN_BUILDER( const SHAPE_POLY_SET& aShape ) :
+        m_inTree( false ),
+        m_operation( ctUnion ),
+        m_pending( false ),
+        m_strictlySimple( false )
+{
+    appendPaths( m_paths, aShape );
+}
+
+
+void SHAPE_POLY_SET::BOOLEAN_BUILDER::Add( const SHAPE_POLY_SET& aShape, POLYGON_MODE aFastMode )
+{
+    addOperand( ctUnion, aShape, aFastMode );
+}
+
+
+void SHAPE_POLY_SET::BOOLEAN_BUILDER::Subtract( const SHAPE_POLY_SET& aShape,
+                                                POLYGON_MODE aFastMode )
+{
+    addOperand( ctDifference, aShape, aFastMode );
+}
+
+
+void SHAPE_POLY_SET::BOOLEAN_BUILDER::Intersect( const SHAPE_POLY_SET& aShape,
+                                                 POLYGON_MODE aFastMode )
+{
+    addOperand( ctIntersection, aShape, aFastMode );
+}
+
+
+void SHAPE_POLY_SET::BOOLEAN_BUILDER::addOperand( ClipType aType, const SHAPE_POLY_SET& aShape,
+                                                  POLYGON_MODE aFastMode )
+{
+    // A union of several clip paths is the union of all of them, and a difference removes all
+    // of them, but an intersection with several clip paths is the intersection with their
+    // union: only unions and differences can be merged.
+    if( m_pending && ( aType != m_operation || aType == ctIntersection ) )
+        execute();
+
+    if( !m_pending )
+    {
+        m_operation = aType;
+        m_pending = true;
+        m_strictlySimple = false;
+    }
+
+    m_strictlySimple |= ( aFastMode == PM_STRICTLY_SIMPLE );
+    appendPaths( m_operands, aShape );
+}
+
+
+void SHAPE_POLY_SET::BOOLEAN_BUILDER::Simplify( POLYGON_MODE aFastMode )
+{
+    if( m_pending || ( m_inTree && aFastMode == PM_FAST ) )
+    {
+        m_strictlySimple |= m_pending && ( aFastMode == PM_STRICTLY_SIMPLE );
+        return;
+    }
+
+    // A union without clip paths merges the overlapping polygons
+    m_operation = ctUnion;
+    m_pending = true;
+    m_strictlySimple = ( aFastMode == PM_STRICTLY_SIMPLE );
+}
+
+
+void SHAPE_POLY_SET::BOOLEAN_BUILDER::Inflate( int aAmount, int aCircleSegmentsCount,
+                                               CORNER_STRATEGY aCornerStrategy )
+{
+    if( m_pending )
+        execute();
+
+    ClipperOffset c;
+    JoinType      joinType = setupOffset( c, aAmount, aCircleSegmentsCount, aCornerStrategy );
+
+    c.AddPaths( current(), joinType, etClosedPolygon );
+    c.Execute( m_tree, aAmount );
+    m_inTree = true;
+}
+
+
+void SHAPE_POLY_SET::BOOLEAN_BUILDER::Result( SHAPE_POLY_SET& aResult )
+{
+    // The polygons are only sorted into outlines and holes by an operation
+    if( !m_pending && !m_inTree )
+        Simplify( PM_FAST );
+
+    if( m_pending )
+        execute();
+
+    aResult.importTree( &m_tree );
+}
+
+
+void SHAPE_POLY_SET::BOOLEAN_BUILDER::execute()
+{
+    Clipper c;
+
+    c.StrictlySimple( m_strictlySimple );
+    c.AddPaths( current(), ptSubject, true );
+    c.AddPaths( m_operands, ptClip, true );
+    c.Execute( m_operation, m_tree, pftNonZero, pftNonZero );
+
+    m_inTree = true;
+    m_operands.clear();
+    m_pending = false;
+}
+
+
+const Paths& SHAPE_POLY_SET::BOOLEAN_BUILDER::current()
+{
+    if( m_inTree )
+    {
+        PolyTreeToPaths( m_tree, m_paths );
+        m_inTree = false;
+    }
+
+    return m_paths;
+}
+
+
 void SHAPE_POLY_SET::importTree( PolyTree* tree )
 {
+    invalidateEdgeIndex();
+
     m_polys.clear();
 
     for( PolyNode* n = tree->GetFirst(); n; n = n->GetNext() )
@@ -847,6 +1023,8 @@ void SHAPE_POLY_SET::fractureSingle( POLYGON& paths )
 
 void SHAPE_POLY_SET::Fracture( POLYGON_MODE aFastMode )
 {
+    invalidateEdgeIndex();
+
     Simplify( aFastMode );    // remove overlapping holes/degeneracy
 
     for( POLYGON& paths : m_polys )
@@ -1034,6 +1212,8 @@ bool SHAPE_POLY_SET::HasHoles() const
 
 void SHAPE_POLY_SET::Unfracture( POLYGON_MODE aFastMode )
 {
+    invalidateEdgeIndex();
+
     for( POLYGON& path : m_polys )
     {
         unfractureSingle( path );
@@ -1058,6 +1238,8 @@ int SHAPE_POLY_SET::NormalizeAreaOutlines()
     // Note also we are using SHAPE_POLY_SET::PM_STRICTLY_SIMPLE in polygon
     // calculations, but it is not mandatory. It is used mainly
     // because there is usually only very few vertices in area outlines
+    invalidateEdgeIndex();
+
     SHAPE_POLY_SET::POLYGON& outline = Polygon( 0 );
     SHAPE_POLY_SET holesBuffer;
 
@@ -1111,6 +1293,8 @@ const std::string SHAPE_POLY_SET::Format() const
 
 bool SHAPE_POLY_SET::Parse( std::stringstream& aStream )
 {
+    invalidateEdgeIndex();
+
     std::string tmp;
 
     aStream >> tmp;
@@ -1185,8 +1369,27 @@ const BOX2I SHAPE_POLY_SET::BBox( int aClearance ) const
 }
 
 
+/**
+ * Function pointOnSegment
+ * is the test of SHAPE_LINE_CHAIN::EdgeContainingPoint() for a single segment.
+ */
+static bool pointOnSegment( const SEG& aSeg, const VECTOR2I& aP, int aAccuracy )
+{
+    return aSeg.A == aP || aSeg.B == aP || aSeg.Distance( aP ) <= aAccuracy + 1;
+}
+
+
 bool SHAPE_POLY_SET::PointOnEdge( const VECTOR2I& aP ) const
 {
+    if( std::shared_ptr<const POLY_EDGE_INDEX> index = edgeIndex() )
+    {
+        return index->Query( aP - VECTOR2I( 2, 2 ), aP + VECTOR2I( 2, 2 ),
+                             [&]( const POLY_EDGE_INDEX::EDGE& aEdge )
+                             {
+                                 return pointOnSegment( aEdge.m_Seg, aP, 0 );
+                             } );
+    }
+
     // Iterate through all the polygons in the set
     for( const POLYGON& polygon : m_polys )
     {
@@ -1204,28 +1407,42 @@ bool SHAPE_POLY_SET::PointOnEdge( const VECTOR2I& aP ) const
 
 bool SHAPE_POLY_SET::Collide( const SEG& aSeg, int aClearance ) const
 {
+    // The same index is used for the whole query, even if another thread replaces it
+    std::shared_ptr<const POLY_EDGE_INDEX> index = edgeIndex();
 
-    SHAPE_POLY_SET polySet = SHAPE_POLY_SET( *this );
+    // We are going to check to see if the segment crosses an external boundary, or passes
+    // closer to it than aClearance.  However, if the full segment is inside the polyset,
+    // this will not be true.  So we first test to see if one of the points is inside.  If
+    // true, then we collide
+    if( index ? containsIndexed( *index, aSeg.A, -1, 0 ) : Contains( aSeg.A ) )
+        return true;
 
-    // Inflate the polygon if necessary.
-    if( aClearance > 0 )
-    {
-        // fixme: the number of arc segments should not be hardcoded
-        polySet.Inflate( aClearance, 8 );
-    }
+    SEG::ecoord clearanceSq = (SEG::ecoord) aClearance * aClearance;
 
-    // We are going to check to see if the segment crosses an external
-    // boundary.  However, if the full segment is inside the polyset, this
-    // will not be true.  So we first test to see if one of the points is
-    // inside.  If true, then we collide
-    if( polySet.Contains( aSeg.A ) )
-        return true;
+    auto collideEdge = [&]( const SEG& aEdge ) -> bool
+    {
+        if( aClearance > 0 )
+            return aEdge.SquaredDistance( aSeg ) < clearanceSq;
+        else
+            return (bool) aEdge.Intersect( aSeg, true );
+    };
 
-    for( SEGMENT_ITERATOR it = ( (SHAPE_POLY_SET*) this )->IterateSegmentsWithHoles(); it; it++ )
+    if( index )
     {
-        SEG polygonEdge = *it;
+        VECTOR2I margin( std::max( aClearance, 0 ) + 1, std::max( aClearance, 0 ) + 1 );
+        VECTOR2I min( std::min( aSeg.A.x, aSeg.B.x ), std::min( aSeg.A.y, aSeg.B.y ) );
+        VECTOR2I max( std::max( aSeg.A.x, aSeg.B.x ), std::max( aSeg.A.y, aSeg.B.y ) );
 
-        if( polygonEdge.Intersect( aSeg, true ) )
+        return index->Query( min - margin, max + margin,
+                             [&]( const POLY_EDGE_INDEX::EDGE& aEdge )
+                             {
+                                 return collideEdge( aEdge.m_Seg );
+                             } );
+    }
+
+    for( CONST_SEGMENT_ITERATOR it = CIterateSegments( 0, OutlineCount() - 1, true ); it; it++ )
+    {
+        if( collideEdge( *it ) )
             return true;
     }
 
@@ -1235,28 +1452,51 @@ bool SHAPE_POLY_SET::Collide( const SEG& aSeg, int aClearance ) const
 
 bool SHAPE_POLY_SET::Collide( const VECTOR2I& aP, int aClearance ) const
 {
-    SHAPE_POLY_SET polySet = SHAPE_POLY_SET( *this );
+    std::shared_ptr<const POLY_EDGE_INDEX> index = edgeIndex();
+
+    // There is a collision if the point is inside of the polygon, or closer to one of its edges
+    // than aClearance
+    if( index ? containsIndexed( *index, aP, -1, 0 ) : Contains( aP ) )
+        return true;
+
+    if( aClearance <= 0 )
+        return false;
 
-    // Inflate the polygon if necessary.
-    if( aClearance > 0 )
+    SEG::ecoord clearanceSq = (SEG::ecoord) aClearance * aClearance;
+
+    if( index )
     {
-        // fixme: the number of arc segments should not be hardcoded
-        polySet.Inflate( aClearance, 8 );
+        VECTOR2I margin( aClearance + 1, aClearance + 1 );
+
+        return index->Query( aP - margin, aP + margin,
+                             [&]( const POLY_EDGE_INDEX::EDGE& aEdge )
+                             {
+                                 return aEdge.m_Seg.SquaredDistance( aP ) < clearanceSq;
+                             } );
     }
 
-    // There is a collision if and only if the point is inside of the polygon.
-    return polySet.Contains( aP );
+    for( CONST_SEGMENT_ITERATOR it = CIterateSegments( 0, OutlineCount() - 1, true ); it; it++ )
+    {
+        if( ( *it ).SquaredDistance( aP ) < clearanceSq )
+            return true;
+    }
+
+    return false;
 }
 
 
 void SHAPE_POLY_SET::RemoveAllContours()
 {
+    invalidateEdgeIndex();
+
     m_polys.clear();
 }
 
 
 void SHAPE_POLY_SET::RemoveContour( int aContourIdx, int aPolygonIdx )
 {
+    invalidateEdgeIndex();
+
     // Default polygon is the last one
     if( aPolygonIdx < 0 )
         aPolygonIdx += m_polys.size();
@@ -1320,12 +1560,16 @@ int SHAPE_POLY_SET::RemoveNullSegments()
 
 void SHAPE_POLY_SET::DeletePolygon( int aIdx )
 {
+    invalidateEdgeIndex();
+
     m_polys.erase( m_polys.begin() + aIdx );
 }
 
 
 void SHAPE_POLY_SET::Append( const SHAPE_POLY_SET& aSet )
 {
+    invalidateEdgeIndex();
+
     m_polys.insert( m_polys.end(), aSet.m_polys.begin(), aSet.m_polys.end() );
 }
 
@@ -1422,6 +1666,9 @@ bool SHAPE_POLY_SET::Contains( const VECTOR2I& aP, int aSubpolyIndex, int aAccur
     if( m_polys.empty() )
         return false;
 
+    if( std::shared_ptr<const POLY_EDGE_INDEX> index = edgeIndex() )
+        return containsIndexed( *index, aP, aSubpolyIndex, aAccuracy );
+
     // If there is a polygon specified, check the condition against that polygon
     if( aSubpolyIndex >= 0 )
         return containsSingle( aP, aSubpolyIndex, aAccuracy, aUseBBoxCaches );
@@ -1451,6 +1698,8 @@ void SHAPE_POLY_SET::RemoveVertex( int aGlobalIndex )
 
 void SHAPE_POLY_SET::RemoveVertex( VERTEX_INDEX aIndex )
 {
+    invalidateEdgeIndex();
+
     m_polys[aIndex.m_polygon][aIndex.m_contour].Remove( aIndex.m_vertex );
 }
 
@@ -1468,6 +1717,8 @@ void SHAPE_POLY_SET::SetVertex( int aGlobalIndex, const VECTOR2I& aPos )
 
 void SHAPE_POLY_SET::SetVertex( const VERTEX_INDEX& aIndex, const VECTOR2I& aPos )
 {
+    invalidateEdgeIndex();
+
     m_polys[aIndex.m_polygon][aIndex.m_contour].SetPoint( aIndex.m_vertex, aPos );
 }
 
@@ -1496,8 +1747,165 @@ bool SHAPE_POLY_SET::containsSingle( const VECTOR2I& aP, int aSubpolyIndex, int
 }
 
 
+bool SHAPE_POLY_SET::containsIndexed( const POLY_EDGE_INDEX& aIndex, const VECTOR2I& aP,
+                                      int aSubpolyIndex, int aAccuracy ) const
+{
+    typedef std::pair<int, int> CONTOUR;       // polygon and contour indices
+
+    auto wanted = [&]( const POLY_EDGE_INDEX::EDGE& aEdge )
+    {
+        return aSubpolyIndex < 0 || aEdge.m_Polygon == aSubpolyIndex;
+    };
+
+    // Count the crossings of each contour with a ray going from aP in the positive x
+    // direction, exactly as SHAPE_LINE_CHAIN::PointInside() does
+    std::vector<CONTOUR> crossings;
+
+    aIndex.Query( aP, VECTOR2I( std::numeric_limits<int>::max(), aP.y ),
+                  [&]( const POLY_EDGE_INDEX::EDGE& aEdge )
+                  {
+                      const VECTOR2I& p1 = aEdge.m_Seg.A;
+                      const VECTOR2I& p2 = aEdge.m_Seg.B;
+                      const VECTOR2I  diff = p2 - p1;
+
+                      if( diff.y != 0 && ( p1.y > aP.y ) != ( p2.y > aP.y ) && wanted( aEdge )
+                              && aP.x - p1.x < rescale( diff.x, ( aP.y - p1.y ), diff.y ) )
+                      {
+                          crossings.emplace_back( aEdge.m_Polygon, aEdge.m_Contour );
+                      }
+
+                      return false;
+                  } );
+
+    std::sort( crossings.begin(), crossings.end() );
+
+    std::vector<CONTOUR> inside;     // the contours crossed an odd number of times
+
+    for( size_t ii = 0; ii < crossings.size(); )
+    {
+        size_t jj = ii;
+
+        while( jj < crossings.size() && crossings[jj] == crossings[ii] )
+            jj++;
+
+        if( ( jj - ii ) % 2 )
+            inside.push_back( crossings[ii] );
+
+        ii = jj;
+    }
+
+    // The outlines on which aP lies, for the edge cases of the accuracy, see PointInside()
+    std::vector<int> onOutline;
+
+    if( aAccuracy != 1 )
+    {
+        int      accuracy = std::max( aAccuracy - 1, 0 );
+        VECTOR2I margin( accuracy + 2, accuracy + 2 );
+
+        aIndex.Query( aP - margin, aP + margin,
+                      [&]( const POLY_EDGE_INDEX::EDGE& aEdge )
+                      {
+                          if( aEdge.m_Contour == 0 && wanted( aEdge )
+                                  && pointOnSegment( aEdge.m_Seg, aP, accuracy ) )
+                          {
+                              onOutline.push_back( aEdge.m_Polygon );
+                          }
+
+                          return false;
+                      } );
+
+        std::sort( onOutline.begin(), onOutline.end() );
+    }
+
+    std::vector<int> candidates;
+
+    for( const CONTOUR& contour : inside )
+    {
+        if( contour.second == 0 )
+            candidates.push_back( contour.first );
+    }
+
+    if( aAccuracy > 1 )
+        candidates.insert( candidates.end(), onOutline.begin(), onOutline.end() );
+
+    for( int polygonIdx : candidates )
+    {
+        bool inOutline = std::binary_search( inside.begin(), inside.end(),
+                                             CONTOUR( polygonIdx, 0 ) );
+        bool onEdge = std::binary_search( onOutline.begin(), onOutline.end(), polygonIdx );
+
+        if( aAccuracy == 0 )
+            inOutline = inOutline && !onEdge;
+        else if( aAccuracy > 1 )
+            inOutline = inOutline || onEdge;
+
+        if( !inOutline )
+            continue;
+
+        // The holes of the polygon follow its outline in the sorted contours
+        auto hole = std::upper_bound( inside.begin(), inside.end(), CONTOUR( polygonIdx, 0 ) );
+
+        if( hole == inside.end() || hole->first != polygonIdx )
+            return true;
+    }
+
+    return false;
+}
+
+
+///> Sets with fewer vertices are scanned faster than they are indexed and hashed
+static const int EDGE_INDEX_MIN_VERTICES = 1000;
+
+
+std::shared_ptr<const POLY_EDGE_INDEX> SHAPE_POLY_SET::edgeIndex() const
+{
+    // A rebuild by another thread replaces the index, the callers keep the one they got
+    if( m_edgeIndexValid )
+        return std::atomic_load( &m_edgeIndex );
+
+    if( TotalVertices() < EDGE_INDEX_MIN_VERTICES )
+        return nullptr;
+
+    // Concurrent queries of the set build its index once
+    std::lock_guard<std::mutex> lock( m_edgeIndexMutex );
+
+    if( m_edgeIndexValid )
+        return std::atomic_load( &m_edgeIndex );
+
+    auto index = std::make_shared<POLY_EDGE_INDEX>();
+
+    for( int polygonIdx = 0; polygonIdx < OutlineCount() && index; polygonIdx++ )
+    {
+        for( size_t contourIdx = 0; contourIdx < m_polys[polygonIdx].size(); contourIdx++ )
+        {
+            const SHAPE_LINE_CHAIN& contour = m_polys[polygonIdx][contourIdx];
+
+            // PointInside() ignores these contours but PointOnEdge() does not; leave
+            // such unusual sets to the plain scans
+            if( !contour.IsClosed() || contour.PointCount() < 3 )
+            {
+                index.reset();
+                break;
+            }
+
+            for( int ii = 0; ii < contour.SegmentCount(); ii++ )
+                index->Add( contour.CSegment( ii ), polygonIdx, contourIdx );
+        }
+    }
+
+    if( index )
+        index->Build();
+
+    std::atomic_store( &m_edgeIndex, std::shared_ptr<const POLY_EDGE_INDEX>( index ) );
+    m_edgeIndexValid = true;
+    return index;
+}
+
+
 void SHAPE_POLY_SET::Move( const VECTOR2I& aVector )
 {
+    invalidateEdgeIndex();
+
     for( POLYGON& poly : m_polys )
     {
         for( SHAPE_LINE_CHAIN& path : poly )
@@ -1508,6 +1916,8 @@ void SHAPE_POLY_SET::Move( const VECTOR2I& aVector )
 
 void SHAPE_POLY_SET::Mirror( bool aX, bool aY, const VECTOR2I& aRef )
 {
+    invalidateEdgeIndex();
+
     for( POLYGON& poly : m_polys )
     {
         for( SHAPE_LINE_CHAIN& path : poly )
@@ -1520,6 +1930,8 @@ void SHAPE_POLY_SET::Mirror( bool aX, bool aY, const VECTOR2I& aRef )
 
 void SHAPE_POLY_SET::Rotate( double aAngle, const VECTOR2I& aCenter )
 {
+    invalidateEdgeIndex();
+
     for( POLYGON& poly : m_polys )
     {
         for( SHAPE_LINE_CHAIN& path : poly )
@@ -1862,6 +2274,15 @@ SHAPE_POLY_SET &SHAPE_POLY_SET::operator=( const SHAPE_POLY_SET& aOther )
     m_hash = MD5_HASH{};
     m_triangulationValid = false;
     m_triangulatedPolys.clear();
+
+    invalidateEdgeIndex();
+
+    if( aOther.m_edgeIndexValid )
+    {
+        std::atomic_store( &m_edgeIndex, std::atomic_load( &aOther.m_edgeIndex ) );
+        m_edgeIndexValid = true;
+    }
+
     return *this;
 }
 
@@ -1942,6 +2363,14 @@ void SHAPE_POLY_SET::CacheTriangulation()
 }
 
 
+void SHAPE_POLY_SET::SetTriangulation( TRIANGULATION&& aTriangulation )
+{
+    m_triangulatedPolys = std::move( aTriangulation );
+    m_triangulationValid = true;
+    m_hash = checksum();
+}
+
+
 MD5_HASH SHAPE_POLY_SET::checksum() const
 {
     MD5_HASH hash;
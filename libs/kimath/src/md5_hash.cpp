@@ -118,6 +118,23 @@ std::string MD5_HASH::Format()
 }
 
 
+std::string MD5_HASH::FormatData( const void* aData, size_t aSize )
+{
+    // Hash() takes a 32 bits length
+    const size_t chunkSize = 1 << 30;
+    MD5_HASH     hash;
+
+    for( size_t pos = 0; pos < aSize; pos += chunkSize )
+    {
+        hash.Hash( (uint8_t*) aData + pos,
+                   (uint32_t) ( aSize - pos < chunkSize ? aSize - pos : chunkSize ) );
+    }
+
+    hash.Finalize();
+    return hash.Format();
+}
+
+
 void MD5_HASH::md5_transform(MD5_CTX *ctx, uint8_t data[])
 {
    uint32_t a,b,c,d,m[16],i,j;
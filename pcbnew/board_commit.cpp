@@ -32,12 +32,58 @@
 #include <tools/pcb_tool_base.h>
 #include <tools/pcb_actions.h>
 #include <connectivity/connectivity_data.h>
+#include <drc/drc.h>
 
 #include <functional>
 using namespace std::placeholders;
 
 #include "pcb_draw_panel_gal.h"
 
+
+/**
+ * Add the area of the board whose zone fills can be affected by aItem to aAreas.
+ * @return false if the item can affect zone fills anywhere on the board (board edges).
+ */
+static bool addZoneFillDirtyArea( const BOARD_ITEM* aItem, std::vector<EDA_RECT>& aAreas )
+{
+    // Markers never take part in zone fills
+    if( aItem->Type() == PCB_MARKER_T )
+        return true;
+
+    // Board outlines clip every zone, and may open or close the outline itself
+    if( aItem->IsOnLayer( Edge_Cuts ) )
+        return false;
+
+    EDA_RECT area = aItem->GetBoundingBox();
+
+    if( aItem->Type() == PCB_MODULE_T )
+    {
+        const MODULE* module = static_cast<const MODULE*>( aItem );
+
+        for( const BOARD_ITEM* item : module->GraphicalItems() )
+        {
+            if( item->IsOnLayer( Edge_Cuts ) )
+                return false;
+        }
+
+        // Pads can have local clearances and thermal gaps larger than the netclass ones
+        for( const D_PAD* pad : module->Pads() )
+        {
+            EDA_RECT padArea = pad->GetBoundingBox();
+            padArea.Inflate( std::max( pad->GetClearance(), pad->GetThermalGap() ) );
+            area.Merge( padArea );
+        }
+    }
+    else if( const BOARD_CONNECTED_ITEM* item = dynamic_cast<const BOARD_CONNECTED_ITEM*>( aItem ) )
+    {
+        area.Inflate( item->GetClearance() );
+    }
+
+    aAreas.push_back( area );
+    return true;
+}
+
+
 BOARD_COMMIT::BOARD_COMMIT( PCB_TOOL_BASE* aTool )
 {
     m_toolMgr = aTool->GetManager();
@@ -92,6 +138,10 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
     std::set<EDA_ITEM*> savedModules;
     SELECTION_TOOL*     selTool = m_toolMgr->GetTool<SELECTION_TOOL>();
     bool                itemsDeselected = false;
+    std::vector<EDA_RECT> zoneFillDirtyAreas;
+    bool                zoneFillDirtyAreasValid = true;
+    std::set<KIID>      removedItems;       // for the online DRC
+    bool                markersOnly = true;
 
     if( Empty() )
         return;
@@ -134,6 +184,20 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
             }
         }
 
+        if( !m_editModules )
+        {
+            if( boardItem->Type() != PCB_MARKER_T )
+                markersOnly = false;
+
+            zoneFillDirtyAreasValid &= addZoneFillDirtyArea( boardItem, zoneFillDirtyAreas );
+
+            if( changeType == CHT_MODIFY && ent.m_copy )
+            {
+                BOARD_ITEM* copy = static_cast<BOARD_ITEM*>( ent.m_copy );
+                zoneFillDirtyAreasValid &= addZoneFillDirtyArea( copy, zoneFillDirtyAreas );
+            }
+        }
+
         switch( changeType )
         {
             case CHT_ADD:
@@ -172,6 +236,17 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
                 if( !m_editModules && aCreateUndoEntry )
                     undoList.PushItem( ITEM_PICKER( boardItem, UR_DELETED ) );
 
+                if( !m_editModules )
+                {
+                    removedItems.insert( boardItem->m_Uuid );
+
+                    if( boardItem->Type() == PCB_MODULE_T )
+                    {
+                        for( D_PAD* pad : static_cast<MODULE*>( boardItem )->Pads() )
+                            removedItems.insert( pad->m_Uuid );
+                    }
+                }
+
                 if( boardItem->IsSelected() )
                 {
                     selTool->RemoveItemFromSel( boardItem, true /* quiet mode */ );
@@ -296,6 +371,8 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
 
                 auto boardItem = static_cast<BOARD_ITEM*>( ent.m_item );
 
+                zoneFillDirtyAreasValid &= addZoneFillDirtyArea( boardItem, zoneFillDirtyAreas );
+
                 if( aCreateUndoEntry )
                 {
                     ITEM_PICKER itemWrapper( boardItem, UR_CHANGED );
@@ -322,11 +399,30 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
         m_toolMgr->PostEvent( EVENTS::UnselectedEvent );
 
     if( aSetDirtyBit )
-        frame->OnModify();
+    {
+        PCB_EDIT_FRAME* editFrame = dynamic_cast<PCB_EDIT_FRAME*>( frame );
+
+        if( editFrame && zoneFillDirtyAreasValid )
+            editFrame->OnModify( zoneFillDirtyAreas );
+        else
+            frame->OnModify();
+    }
 
     frame->UpdateMsgPanel();
 
     clear();
+
+    // Markers are added and removed by the DRC itself, and never need to be tested
+    if( !m_editModules && !markersOnly )
+    {
+        DRC* drcTool = m_toolMgr->GetTool<DRC>();
+
+        if( drcTool && drcTool->IsOnlineDrcEnabled() )
+        {
+            drcTool->RunOnlineDrc( zoneFillDirtyAreasValid ? &zoneFillDirtyAreas : nullptr,
+                                   removedItems );
+        }
+    }
 }
 
 
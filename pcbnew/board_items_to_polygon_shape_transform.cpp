@@ -599,7 +599,8 @@ void D_PAD::TransformShapeWithClearanceToPolygon( SHAPE_POLY_SET& aCornerBuffer,
         outline.Append( m_customShapeAsPolygon );
         CustomShapeAsPolygonToBoardPosition( &outline, GetPosition(), GetOrientation() );
         // TODO: do we need the Simplify() & Fracture() if we're not inflating?
-        outline.Simplify( SHAPE_POLY_SET::PM_FAST );
+        SHAPE_POLY_SET::BOOLEAN_BUILDER builder( outline );
+        builder.Simplify( SHAPE_POLY_SET::PM_FAST );
 
         if( aClearanceValue )
         {
@@ -608,9 +609,10 @@ void D_PAD::TransformShapeWithClearanceToPolygon( SHAPE_POLY_SET& aCornerBuffer,
             double correction = GetCircletoPolyCorrectionFactor( numSegs );
             int    clearance = KiROUND( aClearanceValue * correction );
 
-            outline.Inflate( clearance, numSegs );
+            builder.Inflate( clearance, numSegs );
         }
 
+        builder.Result( outline );
         outline.Fracture( SHAPE_POLY_SET::PM_FAST );
         aCornerBuffer.Append( outline );
     }
@@ -53,6 +53,7 @@
 #include <connectivity/connectivity_data.h>
 #include <pgm_base.h>
 #include <pcbnew_settings.h>
+#include <zone_knockout_cache.h>
 
 /**
  * A singleton item of this class is returned for a weak reference that no longer exists.
@@ -136,6 +137,8 @@ BOARD::BOARD() :
 
     // Initialize ratsnest
     m_connectivity.reset( new CONNECTIVITY_DATA() );
+
+    m_knockoutCache.reset( new KNOCKOUT_CACHE() );
 }
 
 
@@ -52,6 +52,7 @@ class TRACK;
 class D_PAD;
 class MARKER_PCB;
 class MSG_PANEL_ITEM;
+class KNOCKOUT_CACHE;
 class NETLIST;
 class REPORTER;
 class SHAPE_POLY_SET;
@@ -212,6 +213,7 @@ private:
     int                     m_fileFormatVersionAtLoad;  // the version loaded from the file
 
     std::shared_ptr<CONNECTIVITY_DATA>      m_connectivity;
+    std::shared_ptr<KNOCKOUT_CACHE>         m_knockoutCache;
 
     BOARD_DESIGN_SETTINGS   m_designSettings;
     PCBNEW_SETTINGS*        m_generalSettings;      // reference only; I have no ownership
@@ -336,6 +338,13 @@ public:
      */
     std::shared_ptr<CONNECTIVITY_DATA> GetConnectivity() const { return m_connectivity; }
 
+    /**
+     * Function GetKnockoutCache()
+     * @return the knockouts of the pads, tracks and vias kept by the zone filler across the
+     * fills of this board.
+     */
+    std::shared_ptr<KNOCKOUT_CACHE> GetKnockoutCache() const { return m_knockoutCache; }
+
     /**
      * Builds or rebuilds the board connectivity database for the board,
      * especially the list of connected items, list of nets and rastnest data
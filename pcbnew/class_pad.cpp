@@ -567,12 +567,8 @@ void D_PAD::MirrorXPrimitives( int aX )
         }
     }
 
-    // Mirror the local coordinates in merged Polygon
-    for( int cnt = 0; cnt < m_customShapeAsPolygon.OutlineCount(); ++cnt )
-    {
-        SHAPE_LINE_CHAIN& poly = m_customShapeAsPolygon.Outline( cnt );
-        poly.Mirror( true, false );
-    }
+    // Mirror the local coordinates in merged Polygon (which has no holes)
+    m_customShapeAsPolygon.Mirror( true, false );
 }
 
 
@@ -577,6 +577,16 @@ public:
      */
     void CacheTriangulation();
 
+    /**
+     * Function SetFilledPolysTriangulation
+     * installs a triangulation of the current filled polygons, e.g. read from the zone fill
+     * cache, so that CacheTriangulation() has nothing to do.
+     */
+    void SetFilledPolysTriangulation( SHAPE_POLY_SET::TRIANGULATION&& aTriangulation )
+    {
+        m_FilledPolysList.SetTriangulation( std::move( aTriangulation ) );
+    }
+
    /**
      * Function SetFilledPolysList
      * sets the list of filled polygons.
@@ -27,13 +27,13 @@
 #include <geometry/geometry_utils.h>
 #include <board_commit.h>
 
-#include <thread>
 #include <mutex>
 #include <algorithm>
-#include <future>
+#include <unordered_set>
 
 #ifdef PROFILE
 #include <profile.h>
+#include <thread_pool.h>
 #endif
 
 
@@ -46,6 +46,7 @@ bool CN_CONNECTIVITY_ALGO::Remove( BOARD_ITEM* aItem )
     case PCB_MODULE_T:
         for( auto pad : static_cast<MODULE*>( aItem ) -> Pads() )
         {
+            addPropagationSeeds( m_itemMap[ static_cast<BOARD_CONNECTED_ITEM*>( pad ) ] );
             m_itemMap[ static_cast<BOARD_CONNECTED_ITEM*>( pad ) ].MarkItemsAsInvalid();
             m_itemMap.erase( static_cast<BOARD_CONNECTED_ITEM*>( pad ) );
         }
@@ -54,6 +55,7 @@ bool CN_CONNECTIVITY_ALGO::Remove( BOARD_ITEM* aItem )
         break;
 
     case PCB_PAD_T:
+        addPropagationSeeds( m_itemMap[ static_cast<BOARD_CONNECTED_ITEM*>( aItem ) ] );
         m_itemMap[ static_cast<BOARD_CONNECTED_ITEM*>( aItem ) ].MarkItemsAsInvalid();
         m_itemMap.erase( static_cast<BOARD_CONNECTED_ITEM*>( aItem ) );
         m_itemList.SetDirty( true );
@@ -61,12 +63,14 @@ bool CN_CONNECTIVITY_ALGO::Remove( BOARD_ITEM* aItem )
 
     case PCB_TRACE_T:
     case PCB_ARC_T:
+        addPropagationSeeds( m_itemMap[ static_cast<BOARD_CONNECTED_ITEM*>( aItem ) ] );
         m_itemMap[ static_cast<BOARD_CONNECTED_ITEM*>( aItem ) ].MarkItemsAsInvalid();
         m_itemMap.erase( static_cast<BOARD_CONNECTED_ITEM*>( aItem ) );
         m_itemList.SetDirty( true );
         break;
 
     case PCB_VIA_T:
+        addPropagationSeeds( m_itemMap[ static_cast<BOARD_CONNECTED_ITEM*>( aItem ) ] );
         m_itemMap[ static_cast<BOARD_CONNECTED_ITEM*>( aItem ) ].MarkItemsAsInvalid();
         m_itemMap.erase( static_cast<BOARD_CONNECTED_ITEM*>( aItem ) );
         m_itemList.SetDirty( true );
@@ -74,6 +78,7 @@ bool CN_CONNECTIVITY_ALGO::Remove( BOARD_ITEM* aItem )
 
     case PCB_ZONE_AREA_T:
     {
+        addPropagationSeeds( m_itemMap[ static_cast<BOARD_CONNECTED_ITEM*>( aItem ) ] );
         m_itemMap[ static_cast<BOARD_CONNECTED_ITEM*>( aItem ) ].MarkItemsAsInvalid();
         m_itemMap.erase ( static_cast<BOARD_CONNECTED_ITEM*>( aItem ) );
         m_itemList.SetDirty( true );
@@ -111,6 +116,19 @@ void CN_CONNECTIVITY_ALGO::markItemNetAsDirty( const BOARD_ITEM* aItem )
 }
 
 
+void CN_CONNECTIVITY_ALGO::addPropagationSeeds( const ITEM_MAP_ENTRY& aEntry )
+{
+    if( m_fullPropagation )
+        return;
+
+    for( auto item : aEntry.m_items )
+    {
+        for( auto connected : item->ConnectedItems() )
+            m_propagationSeeds.push_back( connected );
+    }
+}
+
+
 bool CN_CONNECTIVITY_ALGO::Add( BOARD_ITEM* aItem )
 {
     if( !aItem->IsOnCopperLayer() )
@@ -209,6 +227,19 @@ void CN_CONNECTIVITY_ALGO::searchConnections()
 
     m_itemList.RemoveInvalidItems( garbage );
 
+    if( !garbage.empty() && !m_propagationSeeds.empty() )
+    {
+        std::sort( garbage.begin(), garbage.end() );
+
+        auto last = std::remove_if( m_propagationSeeds.begin(), m_propagationSeeds.end(),
+                [&garbage] ( CN_ITEM* aItem )
+                {
+                    return std::binary_search( garbage.begin(), garbage.end(), aItem );
+                } );
+
+        m_propagationSeeds.erase( last, m_propagationSeeds.end() );
+    }
+
     for( auto item : garbage )
         delete item;
 
@@ -221,6 +252,13 @@ void CN_CONNECTIVITY_ALGO::searchConnections()
     std::copy_if( m_itemList.begin(), m_itemList.end(), std::back_inserter( dirtyItems ),
             [] ( CN_ITEM* aItem ) { return aItem->Dirty(); } );
 
+    // Newly added or modified items may merge clusters, so their nets must be propagated again
+    if( !m_fullPropagation )
+    {
+        m_propagationSeeds.insert( m_propagationSeeds.end(), dirtyItems.begin(),
+                                   dirtyItems.end() );
+    }
+
     if( m_progressReporter )
     {
         m_progressReporter->SetMaxProgress( dirtyItems.size() );
@@ -229,47 +267,39 @@ void CN_CONNECTIVITY_ALGO::searchConnections()
 
     if( m_itemList.IsDirty() )
     {
-        size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
-                ( dirtyItems.size() + 7 ) / 8 );
-
-        std::atomic<size_t> nextItem( 0 );
-        std::vector<std::future<size_t>> returns( parallelThreadCount );
+        CN_LIST*           itemList = &m_itemList;
+        PROGRESS_REPORTER* reporter = m_progressReporter;
 
-        auto conn_lambda = [&nextItem, &dirtyItems]
-                            ( CN_LIST* aItemList, PROGRESS_REPORTER* aReporter) -> size_t
+        auto conn = [&dirtyItems, itemList, reporter]( size_t aIndex )
         {
-            for( size_t i = nextItem++; i < dirtyItems.size(); i = nextItem++ )
-            {
-                CN_VISITOR visitor( dirtyItems[i] );
-                aItemList->FindNearby( dirtyItems[i], visitor );
-
-                if( aReporter )
-                    aReporter->AdvanceProgress();
-            }
+            CN_VISITOR visitor( dirtyItems[aIndex] );
+            itemList->FindNearby( dirtyItems[aIndex], visitor );
 
-            return 1;
+            if( reporter )
+                reporter->AdvanceProgress();
         };
 
-        if( parallelThreadCount <= 1 )
-            conn_lambda( &m_itemList, m_progressReporter );
+        // Queuing the items on the thread pool is not worth it for a few items
+        if( dirtyItems.size() <= 8 )
+        {
+            for( size_t ii = 0; ii < dirtyItems.size(); ++ii )
+                conn( ii );
+        }
         else
         {
-            for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-                returns[ii] = std::async( std::launch::async, conn_lambda,
-                        &m_itemList, m_progressReporter );
+            std::function<bool()> progress;
 
-            for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            if( reporter )
             {
-                // Here we balance returns with a 100ms timeout to allow UI updating
-                std::future_status status;
-                do
-                {
-                    if( m_progressReporter )
-                        m_progressReporter->KeepRefreshing();
-
-                    status = returns[ii].wait_for( std::chrono::milliseconds( 100 ) );
-                } while( status != std::future_status::ready );
+                // Refresh the UI while waiting for the workers
+                progress = [reporter]() -> bool
+                           {
+                               reporter->KeepRefreshing();
+                               return true;
+                           };
             }
+
+            THREAD_POOL::ParallelFor( dirtyItems.size(), conn, progress );
         }
 
         if( m_progressReporter )
@@ -305,6 +335,13 @@ const CN_CONNECTIVITY_ALGO::CLUSTERS CN_CONNECTIVITY_ALGO::SearchClusters( CLUST
 
 const CN_CONNECTIVITY_ALGO::CLUSTERS CN_CONNECTIVITY_ALGO::SearchClusters( CLUSTER_SEARCH_MODE aMode,
         const KICAD_T aTypes[], int aSingleNet )
+{
+    return searchClusters( aMode, aTypes, aSingleNet, false );
+}
+
+
+const CN_CONNECTIVITY_ALGO::CLUSTERS CN_CONNECTIVITY_ALGO::searchClusters( CLUSTER_SEARCH_MODE aMode,
+        const KICAD_T aTypes[], int aSingleNet, bool aDirtyNetsOnly )
 {
     bool withinAnyNet = ( aMode != CSM_PROPAGATE );
 
@@ -315,7 +352,8 @@ const CN_CONNECTIVITY_ALGO::CLUSTERS CN_CONNECTIVITY_ALGO::SearchClusters( CLUST
     if( m_itemList.IsDirty() )
         searchConnections();
 
-    auto addToSearchList = [&head, withinAnyNet, aSingleNet, aTypes] ( CN_ITEM *aItem )
+    auto addToSearchList = [this, &head, withinAnyNet, aSingleNet, aTypes, aDirtyNetsOnly]
+                           ( CN_ITEM *aItem )
     {
         if( withinAnyNet && aItem->Net() <= 0 )
             return;
@@ -326,6 +364,11 @@ const CN_CONNECTIVITY_ALGO::CLUSTERS CN_CONNECTIVITY_ALGO::SearchClusters( CLUST
         if( aSingleNet >=0 && aItem->Net() != aSingleNet )
             return;
 
+        // Nets beyond the dirty flag table have never been clustered, so treat them as dirty
+        if( aDirtyNetsOnly && aItem->Net() < (int) m_dirtyNets.size()
+                && !m_dirtyNets[ aItem->Net() ] )
+            return;
+
         bool found = false;
 
         for( int i = 0; aTypes[i] != EOT; i++ )
@@ -406,8 +449,62 @@ const CN_CONNECTIVITY_ALGO::CLUSTERS CN_CONNECTIVITY_ALGO::SearchClusters( CLUST
 }
 
 
+const CN_CONNECTIVITY_ALGO::CLUSTERS CN_CONNECTIVITY_ALGO::searchClustersFrom(
+        const std::vector<CN_ITEM*>& aSeeds, const KICAD_T aTypes[] )
+{
+    CLUSTERS clusters;
+    std::unordered_set<CN_ITEM*> visited;
+    std::deque<CN_ITEM*> Q;
+
+    auto isSearched = [aTypes] ( CN_ITEM* aItem )
+    {
+        if( !aItem->Valid() )
+            return false;
+
+        for( int i = 0; aTypes[i] != EOT; i++ )
+        {
+            if( aItem->Parent()->Type() == aTypes[i] )
+                return true;
+        }
+
+        return false;
+    };
+
+    for( auto root : aSeeds )
+    {
+        if( !isSearched( root ) || !visited.insert( root ).second )
+            continue;
+
+        CN_CLUSTER_PTR cluster( new CN_CLUSTER() );
+
+        Q.clear();
+        Q.push_back( root );
+
+        while( Q.size() )
+        {
+            CN_ITEM* current = Q.front();
+
+            Q.pop_front();
+            cluster->Add( current );
+
+            for( auto n : current->ConnectedItems() )
+            {
+                if( isSearched( n ) && visited.insert( n ).second )
+                    Q.push_back( n );
+            }
+        }
+
+        clusters.push_back( cluster );
+    }
+
+    return clusters;
+}
+
+
 void CN_CONNECTIVITY_ALGO::Build( BOARD* aBoard )
 {
+    m_itemList.SetBulkLoad( true );
+
     for( int i = 0; i<aBoard->GetAreaCount(); i++ )
     {
         auto zone = aBoard->GetArea( i );
@@ -423,6 +520,8 @@ void CN_CONNECTIVITY_ALGO::Build( BOARD* aBoard )
             Add( pad );
     }
 
+    m_itemList.SetBulkLoad( false );
+
     /*wxLogTrace( "CN", "zones : %lu, pads : %lu vias : %lu tracks : %lu\n",
             m_zoneList.Size(), m_padList.Size(),
             m_viaList.Size(), m_trackList.Size() );*/
@@ -431,6 +530,8 @@ void CN_CONNECTIVITY_ALGO::Build( BOARD* aBoard )
 
 void CN_CONNECTIVITY_ALGO::Build( const std::vector<BOARD_ITEM*>& aItems )
 {
+    m_itemList.SetBulkLoad( true );
+
     for( auto item : aItems )
     {
         switch( item->Type() )
@@ -456,6 +557,8 @@ void CN_CONNECTIVITY_ALGO::Build( const std::vector<BOARD_ITEM*>& aItems )
                 break;
         }
     }
+
+    m_itemList.SetBulkLoad( false );
 }
 
 
@@ -513,7 +616,25 @@ void CN_CONNECTIVITY_ALGO::propagateConnections( BOARD_COMMIT* aCommit )
 
 void CN_CONNECTIVITY_ALGO::PropagateNets( BOARD_COMMIT* aCommit )
 {
-    m_connClusters = SearchClusters( CSM_PROPAGATE );
+    if( m_fullPropagation )
+    {
+        m_connClusters = SearchClusters( CSM_PROPAGATE );
+        m_fullPropagation = false;
+    }
+    else
+    {
+        constexpr KICAD_T no_zones[] =
+        { PCB_TRACE_T, PCB_ARC_T, PCB_PAD_T, PCB_VIA_T, PCB_MODULE_T, EOT };
+
+        if( m_itemList.IsDirty() )
+            searchConnections();
+
+        // Clusters that do not contain any added item or any neighbour of a removed item
+        // have not changed since the previous propagation, so there is nothing to do there.
+        m_connClusters = searchClustersFrom( m_propagationSeeds, no_zones );
+    }
+
+    m_propagationSeeds.clear();
     propagateConnections( aCommit );
 }
 
@@ -584,7 +705,40 @@ void CN_CONNECTIVITY_ALGO::FindIsolatedCopperIslands( std::vector<CN_ZONE_ISOLAT
 
 const CN_CONNECTIVITY_ALGO::CLUSTERS& CN_CONNECTIVITY_ALGO::GetClusters()
 {
-    m_ratsnestClusters = SearchClusters( CSM_RATSNEST );
+    constexpr KICAD_T types[] =
+    { PCB_TRACE_T, PCB_ARC_T, PCB_PAD_T, PCB_VIA_T, PCB_ZONE_AREA_T, PCB_MODULE_T, EOT };
+
+    // Ratsnest clusters never span several nets, so the clusters of a net which has not been
+    // marked as dirty are still valid and only the dirty nets need to be searched again.
+    auto clusters = searchClusters( CSM_RATSNEST, types, -1, true );
+
+    if( m_netClusters.size() < m_dirtyNets.size() )
+        m_netClusters.resize( m_dirtyNets.size() );
+
+    for( size_t net = 0; net < m_netClusters.size(); net++ )
+    {
+        if( net >= m_dirtyNets.size() || m_dirtyNets[net] )
+            m_netClusters[net].clear();
+    }
+
+    for( const auto& cluster : clusters )
+    {
+        int net = cluster->OriginNet();
+
+        if( net >= (int) m_netClusters.size() )
+            m_netClusters.resize( net + 1 );
+
+        m_netClusters[net].push_back( cluster );
+    }
+
+    m_ratsnestClusters.clear();
+
+    for( const auto& netClusters : m_netClusters )
+    {
+        m_ratsnestClusters.insert( m_ratsnestClusters.end(), netClusters.begin(),
+                                   netClusters.end() );
+    }
+
     return m_ratsnestClusters;
 }
 
@@ -742,6 +896,9 @@ void CN_CONNECTIVITY_ALGO::Clear()
 {
     m_ratsnestClusters.clear();
     m_connClusters.clear();
+    m_netClusters.clear();
+    m_propagationSeeds.clear();
+    m_fullPropagation = true;
     m_itemMap.clear();
     m_itemList.Clear();
 
@@ -152,8 +152,33 @@ private:
     std::vector<bool> m_dirtyNets;
     PROGRESS_REPORTER* m_progressReporter = nullptr;
 
+    ///> ratsnest clusters indexed by net; only the dirty nets are searched again
+    std::vector<CLUSTERS> m_netClusters;
+
+    ///> items whose cluster may have changed since the last net propagation
+    std::vector<CN_ITEM*> m_propagationSeeds;
+
+    ///> set until the first propagation has covered every item of the board
+    bool m_fullPropagation = true;
+
     void    searchConnections();
 
+    /**
+     * Searches the clusters reachable from aSeeds, ignoring net codes (propagation mode).
+     * Clusters not containing any seed are left out, which makes the cost proportional to
+     * the size of the clusters touched by the last changes rather than to the board size.
+     */
+    const CLUSTERS searchClustersFrom( const std::vector<CN_ITEM*>& aSeeds,
+                                       const KICAD_T aTypes[] );
+
+    const CLUSTERS searchClusters( CLUSTER_SEARCH_MODE aMode, const KICAD_T aTypes[],
+                                   int aSingleNet, bool aDirtyNetsOnly );
+
+    /**
+     * Records the neighbours of items about to be removed, as their cluster may split.
+     */
+    void addPropagationSeeds( const ITEM_MAP_ENTRY& aEntry );
+
     void    update();
 
     void    propagateConnections( BOARD_COMMIT* aCommit = nullptr );
@@ -27,9 +27,8 @@
 #include <profile.h>
 #endif
 
-#include <thread>
 #include <algorithm>
-#include <future>
+#include <thread_pool.h>
 
 #include <connectivity/connectivity_data.h>
 #include <connectivity/connectivity_algo.h>
@@ -106,31 +105,20 @@ void CONNECTIVITY_DATA::updateRatsnest()
     std::copy_if( m_nets.begin() + 1, m_nets.end(), std::back_inserter( dirty_nets ),
             [] ( RN_NET* aNet ) { return aNet->IsDirty() && aNet->GetNodeCount() > 0; } );
 
-    // We don't want to spin up a new thread for fewer than 8 nets (overhead costs)
-    size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
-            ( dirty_nets.size() + 7 ) / 8 );
-
-    std::atomic<size_t> nextNet( 0 );
-    std::vector<std::future<size_t>> returns( parallelThreadCount );
-
-    auto update_lambda = [&nextNet, &dirty_nets]() -> size_t
+    auto update = [&dirty_nets]( size_t aIndex )
     {
-        for( size_t i = nextNet++; i < dirty_nets.size(); i = nextNet++ )
-            dirty_nets[i]->Update();
-
-        return 1;
+        dirty_nets[aIndex]->Update();
     };
 
-    if( parallelThreadCount == 1 )
-        update_lambda();
+    // Queuing the nets on the thread pool is not worth it for a few nets
+    if( dirty_nets.size() <= 8 )
+    {
+        for( size_t ii = 0; ii < dirty_nets.size(); ++ii )
+            update( ii );
+    }
     else
     {
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-            returns[ii] = std::async( std::launch::async, update_lambda );
-
-        // Finalize the ratsnest threads
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-            returns[ii].wait();
+        THREAD_POOL::ParallelFor( dirty_nets.size(), update );
     }
 
     #ifdef PROFILE
@@ -449,6 +449,15 @@ public:
         m_index.Query( aItem->BBox(), aItem->Layers(), aFunc );
     }
 
+    /**
+     * Defers the packing of the spatial index while a large number of items is being added.
+     * Turning it off packs the index once for all the added items.
+     */
+    void SetBulkLoad( bool aBulkLoad )
+    {
+        m_index.SetBulkLoad( aBulkLoad );
+    }
+
     void SetHasInvalid( bool aInvalid = true )
     {
         m_hasInvalid = aInvalid;
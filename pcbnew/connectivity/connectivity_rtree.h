@@ -24,15 +24,24 @@
 #ifndef PCBNEW_CONNECTIVITY_RTREE_H_
 #define PCBNEW_CONNECTIVITY_RTREE_H_
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
 #include <math/box2.h>
 #include <router/pns_layerset.h>
 
-#include <geometry/rtree.h>
-
 
 /**
  * CN_RTREE -
- * Implements an R-tree for fast spatial indexing of connectivity items.
+ * Implements a spatial index for fast lookup of connectivity items.
+ *
+ * Items lying on a single copper layer are kept in one tree per layer, items spanning several
+ * layers (through hole pads and vias) share an additional tree.  Each tree is a packed R-tree,
+ * bulk loaded with the Sort-Tile-Recursive algorithm and stored in two contiguous arrays (leaf
+ * entries and nodes).  Items inserted after the last packing are kept in a short unsorted list
+ * until the tree is packed again.
  * Non-owning.
  */
 template< class T >
@@ -40,14 +49,9 @@ class CN_RTREE
 {
 public:
 
-    CN_RTREE()
-    {
-        this->m_tree = new RTree<T, int, 3, double>();
-    }
-
-    ~CN_RTREE()
+    CN_RTREE() :
+        m_bulkLoad( false )
     {
-        delete this->m_tree;
     }
 
     /**
@@ -56,13 +60,13 @@ public:
      */
     void Insert( T aItem )
     {
-        const BOX2I&        bbox    = aItem->BBox();
-        const LAYER_RANGE   layers  = aItem->Layers();
+        ENTRY entry( aItem );
+        TREE& tree = treeFor( entry );
 
-        const int           mmin[3] = { layers.Start(), bbox.GetX(), bbox.GetY() };
-        const int           mmax[3] = { layers.End(), bbox.GetRight(), bbox.GetBottom() };
+        tree.m_pending.push_back( entry );
 
-        m_tree->Insert( mmin, mmax, aItem );
+        if( !m_bulkLoad && tree.NeedsPacking() )
+            tree.Pack();
     }
 
     /**
@@ -72,24 +76,21 @@ public:
      */
     void Remove( T aItem )
     {
+        ENTRY entry( aItem );
 
-        // First, attempt to remove the item using its given BBox
-        const BOX2I&        bbox    = aItem->BBox();
-        const LAYER_RANGE   layers  = aItem->Layers();
-        const int           mmin[3] = { layers.Start(), bbox.GetX(), bbox.GetY() };
-        const int           mmax[3] = { layers.End(), bbox.GetRight(), bbox.GetBottom() };
+        // First, attempt to remove the item using its given BBox and layers
+        if( treeFor( entry ).Remove( entry, false ) )
+            return;
 
-        // If we are not successful ( 1 == not found ), then we expand
-        // the search to the full tree
-        if( m_tree->Remove( mmin, mmax, aItem ) )
+        // N.B. We must search all the trees for the pointer to remove because the item
+        // may have been moved before we have the chance to delete it from the tree
+        for( TREE& tree : m_layerTrees )
         {
-            // N.B. We must search the whole tree for the pointer to remove
-            // because the item may have been moved before we have the chance to
-            // delete it from the tree
-            const int       mmin2[3] = { INT_MIN, INT_MIN, INT_MIN };
-            const int       mmax2[3] = { INT_MAX, INT_MAX, INT_MAX };
-            m_tree->Remove( mmin2, mmax2, aItem );
+            if( tree.Remove( entry, true ) )
+                return;
         }
+
+        m_multiLayerTree.Remove( entry, true );
     }
 
     /**
@@ -98,7 +99,30 @@ public:
      */
     void RemoveAll( )
     {
-        m_tree->RemoveAll();
+        m_layerTrees.clear();
+        m_multiLayerTree = TREE();
+    }
+
+    /**
+     * Function SetBulkLoad()
+     * While bulk loading, inserted items are not packed into the trees.  Leaving the bulk
+     * load mode packs every tree once, which is much faster than growing them gradually.
+     */
+    void SetBulkLoad( bool aBulkLoad )
+    {
+        m_bulkLoad = aBulkLoad;
+
+        if( m_bulkLoad )
+            return;
+
+        for( TREE& tree : m_layerTrees )
+        {
+            if( !tree.m_pending.empty() )
+                tree.Pack();
+        }
+
+        if( !m_multiLayerTree.m_pending.empty() )
+            m_multiLayerTree.Pack();
     }
 
     /**
@@ -109,15 +133,329 @@ public:
     template <class Visitor>
     void Query( const BOX2I& aBounds, const LAYER_RANGE& aRange, Visitor& aVisitor )
     {
-        const int   mmin[3] = { aRange.Start(), aBounds.GetX(), aBounds.GetY() };
-        const int   mmax[3] = { aRange.End(), aBounds.GetRight(), aBounds.GetBottom() };
+        const ENTRY bounds( aBounds, aRange );
+        const int   lastLayer = std::min( aRange.End(), (int) m_layerTrees.size() - 1 );
+
+        for( int layer = std::max( aRange.Start(), 0 ); layer <= lastLayer; layer++ )
+        {
+            if( !m_layerTrees[layer].Query( bounds, false, aVisitor ) )
+                return;
+        }
 
-        m_tree->Search( mmin, mmax, aVisitor );
+        m_multiLayerTree.Query( bounds, true, aVisitor );
     }
 
 private:
 
-    RTree<T, int, 3, double>* m_tree;
+    ///> Number of children of a tree node
+    static constexpr size_t NODE_SIZE = 16;
+
+    ///> Number of items that may be inserted in a tree before it has to be packed again
+    static constexpr size_t MIN_PENDING = 256;
+
+    struct BOUNDS
+    {
+        int m_minX;
+        int m_minY;
+        int m_maxX;
+        int m_maxY;
+
+        bool Intersects( const BOUNDS& aOther ) const
+        {
+            return m_minX <= aOther.m_maxX && aOther.m_minX <= m_maxX
+                   && m_minY <= aOther.m_maxY && aOther.m_minY <= m_maxY;
+        }
+
+        void Merge( const BOUNDS& aOther )
+        {
+            m_minX = std::min( m_minX, aOther.m_minX );
+            m_minY = std::min( m_minY, aOther.m_minY );
+            m_maxX = std::max( m_maxX, aOther.m_maxX );
+            m_maxY = std::max( m_maxY, aOther.m_maxY );
+        }
+
+        ///> Doubled center coordinates, avoiding the rounding of a division
+        int64_t CenterX2() const { return (int64_t) m_minX + m_maxX; }
+        int64_t CenterY2() const { return (int64_t) m_minY + m_maxY; }
+    };
+
+    struct ENTRY : public BOUNDS
+    {
+        int m_layerStart;
+        int m_layerEnd;
+        T   m_item;
+
+        ENTRY( T aItem ) :
+            ENTRY( aItem->BBox(), aItem->Layers() )
+        {
+            m_item = aItem;
+        }
+
+        ENTRY( const BOX2I& aBox, const LAYER_RANGE& aLayers )
+        {
+            this->m_minX = std::min( aBox.GetX(), aBox.GetRight() );
+            this->m_minY = std::min( aBox.GetY(), aBox.GetBottom() );
+            this->m_maxX = std::max( aBox.GetX(), aBox.GetRight() );
+            this->m_maxY = std::max( aBox.GetY(), aBox.GetBottom() );
+            m_layerStart = aLayers.Start();
+            m_layerEnd = aLayers.End();
+            m_item = T();
+        }
+
+        bool LayersOverlap( const ENTRY& aOther ) const
+        {
+            return m_layerEnd >= aOther.m_layerStart && m_layerStart <= aOther.m_layerEnd;
+        }
+    };
+
+    struct NODE : public BOUNDS
+    {
+        ///> index of the first child (an entry for leaf nodes, a node otherwise)
+        uint32_t m_first;
+        uint32_t m_count;
+    };
+
+    struct TREE
+    {
+        ///> packed entries, in leaf order.  Removed entries are left with a null item.
+        std::vector<ENTRY> m_entries;
+
+        ///> all the nodes, leaf level first and root last
+        std::vector<NODE>  m_nodes;
+
+        ///> entries inserted since the last packing
+        std::vector<ENTRY> m_pending;
+
+        size_t m_leafCount = 0;
+        size_t m_removedCount = 0;
+
+        bool NeedsPacking() const
+        {
+            return m_pending.size() > std::max( size_t( MIN_PENDING ), m_entries.size() / 16 );
+        }
+
+        template <class ITEM>
+        static void sortTiles( std::vector<ITEM>& aItems )
+        {
+            size_t nodeCount = ( aItems.size() + NODE_SIZE - 1 ) / NODE_SIZE;
+            size_t sliceCount = (size_t) std::ceil( std::sqrt( (double) nodeCount ) );
+            size_t sliceSize = std::max<size_t>( sliceCount, 1 ) * NODE_SIZE;
+
+            std::sort( aItems.begin(), aItems.end(), [] ( const ITEM& a, const ITEM& b )
+                    {
+                        return a.CenterX2() < b.CenterX2();
+                    } );
+
+            for( size_t i = 0; i < aItems.size(); i += sliceSize )
+            {
+                auto sliceEnd = aItems.begin() + std::min( i + sliceSize, aItems.size() );
+
+                std::sort( aItems.begin() + i, sliceEnd, [] ( const ITEM& a, const ITEM& b )
+                        {
+                            return a.CenterY2() < b.CenterY2();
+                        } );
+            }
+        }
+
+        template <class ITEM>
+        static std::vector<NODE> groupNodes( const std::vector<ITEM>& aChildren )
+        {
+            std::vector<NODE> nodes;
+            nodes.reserve( ( aChildren.size() + NODE_SIZE - 1 ) / NODE_SIZE );
+
+            for( size_t i = 0; i < aChildren.size(); i += NODE_SIZE )
+            {
+                NODE node;
+                static_cast<BOUNDS&>( node ) = aChildren[i];
+                node.m_first = i;
+                node.m_count = std::min( size_t( NODE_SIZE ), aChildren.size() - i );
+
+                for( size_t j = i + 1; j < i + node.m_count; j++ )
+                    node.Merge( aChildren[j] );
+
+                nodes.push_back( node );
+            }
+
+            return nodes;
+        }
+
+        void Pack()
+        {
+            m_entries.erase( std::remove_if( m_entries.begin(), m_entries.end(),
+                    [] ( const ENTRY& aEntry ) { return aEntry.m_item == T(); } ),
+                    m_entries.end() );
+
+            m_entries.insert( m_entries.end(), m_pending.begin(), m_pending.end() );
+            m_pending.clear();
+            m_nodes.clear();
+            m_removedCount = 0;
+
+            sortTiles( m_entries );
+
+            std::vector<NODE> level = groupNodes( m_entries );
+            m_leafCount = level.size();
+
+            // Each upper level is tiled from the nodes of the level below.  Sorting a level
+            // does not break it, as the children of its nodes are already in their place.
+            while( level.size() > 1 )
+            {
+                sortTiles( level );
+
+                std::vector<NODE> parents = groupNodes( level );
+                uint32_t          levelStart = m_nodes.size();
+
+                m_nodes.insert( m_nodes.end(), level.begin(), level.end() );
+
+                for( NODE& parent : parents )
+                    parent.m_first += levelStart;
+
+                level = std::move( parents );
+            }
+
+            m_nodes.insert( m_nodes.end(), level.begin(), level.end() );
+        }
+
+        ///> Returns the index of aEntry's item among the packed entries, or -1 if not found
+        int findPacked( const ENTRY& aEntry, bool aAnywhere ) const
+        {
+            if( aAnywhere )
+            {
+                for( size_t i = 0; i < m_entries.size(); i++ )
+                {
+                    if( m_entries[i].m_item == aEntry.m_item )
+                        return i;
+                }
+
+                return -1;
+            }
+
+            int found = -1;
+
+            walk( aEntry, [&] ( size_t aIndex )
+                    {
+                        if( m_entries[aIndex].m_item != aEntry.m_item )
+                            return true;
+
+                        found = aIndex;
+                        return false;
+                    } );
+
+            return found;
+        }
+
+        bool Remove( const ENTRY& aEntry, bool aAnywhere )
+        {
+            for( size_t i = 0; i < m_pending.size(); i++ )
+            {
+                if( m_pending[i].m_item == aEntry.m_item )
+                {
+                    m_pending[i] = m_pending.back();
+                    m_pending.pop_back();
+                    return true;
+                }
+            }
+
+            int index = findPacked( aEntry, aAnywhere );
+
+            if( index < 0 )
+                return false;
+
+            m_entries[index].m_item = T();
+
+            if( ++m_removedCount > m_entries.size() / 4 )
+                Pack();
+
+            return true;
+        }
+
+        /**
+         * Calls aFunc with the index of each packed entry whose bounding box intersects
+         * aBounds, until aFunc returns false.
+         * @return false if the walk was stopped by aFunc
+         */
+        template <class Func>
+        bool walk( const BOUNDS& aBounds, Func&& aFunc ) const
+        {
+            if( m_nodes.empty() )
+                return true;
+
+            // The depth of a packed tree is logarithmic, so a small fixed stack is plenty
+            uint32_t stack[256];
+            int      top = 0;
+
+            stack[top++] = m_nodes.size() - 1;
+
+            while( top > 0 )
+            {
+                uint32_t    index = stack[--top];
+                const NODE& node = m_nodes[index];
+                bool        isLeaf = index < m_leafCount;
+
+                if( !node.Intersects( aBounds ) )
+                    continue;
+
+                for( uint32_t i = node.m_first; i < node.m_first + node.m_count; i++ )
+                {
+                    if( isLeaf )
+                    {
+                        if( m_entries[i].Intersects( aBounds ) && !aFunc( i ) )
+                            return false;
+                    }
+                    else
+                    {
+                        stack[top++] = i;
+                    }
+                }
+            }
+
+            return true;
+        }
+
+        template <class Visitor>
+        bool Query( const ENTRY& aBounds, bool aCheckLayers, Visitor& aVisitor ) const
+        {
+            auto visit = [&] ( const ENTRY& aEntry )
+            {
+                if( aEntry.m_item == T() || !aEntry.Intersects( aBounds ) )
+                    return true;
+
+                if( aCheckLayers && !aEntry.LayersOverlap( aBounds ) )
+                    return true;
+
+                return (bool) aVisitor( aEntry.m_item );
+            };
+
+            if( !walk( aBounds, [&] ( size_t aIndex ) { return visit( m_entries[aIndex] ); } ) )
+                return false;
+
+            for( const ENTRY& entry : m_pending )
+            {
+                if( !visit( entry ) )
+                    return false;
+            }
+
+            return true;
+        }
+    };
+
+    TREE& treeFor( const ENTRY& aEntry )
+    {
+        if( aEntry.m_layerStart != aEntry.m_layerEnd || aEntry.m_layerStart < 0 )
+            return m_multiLayerTree;
+
+        if( (int) m_layerTrees.size() <= aEntry.m_layerStart )
+            m_layerTrees.resize( aEntry.m_layerStart + 1 );
+
+        return m_layerTrees[ aEntry.m_layerStart ];
+    }
+
+    ///> trees of the items lying on a single layer, indexed by layer
+    std::vector<TREE> m_layerTrees;
+
+    ///> tree of the items spanning several layers
+    TREE m_multiLayerTree;
+
+    bool m_bulkLoad;
 };
 
 
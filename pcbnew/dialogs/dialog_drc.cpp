@@ -95,6 +95,7 @@ DIALOG_DRC::~DIALOG_DRC()
     settings->m_DrcDialog.refill_zones       = m_cbRefillZones->GetValue();
     settings->m_DrcDialog.test_track_to_zone = m_cbReportAllTrackErrors->GetValue();
     settings->m_DrcDialog.test_footprints    = m_cbTestFootprints->GetValue();
+    settings->m_DrcDialog.online_drc         = m_cbOnlineDRC->GetValue();
     settings->m_DrcDialog.severities         = m_severities;
 
     m_markerTreeModel->DecRef();
@@ -148,6 +149,7 @@ void DIALOG_DRC::initValues()
     m_cbRefillZones->SetValue( cfg->m_DrcDialog.refill_zones );
     m_cbReportAllTrackErrors->SetValue( cfg->m_DrcDialog.test_track_to_zone );
     m_cbTestFootprints->SetValue( cfg->m_DrcDialog.test_footprints );
+    m_cbOnlineDRC->SetValue( cfg->m_DrcDialog.online_drc );
 
     m_severities = cfg->m_DrcDialog.severities;
     m_markerTreeModel->SetSeverities( m_severities );
@@ -408,6 +410,13 @@ void DIALOG_DRC::OnDRCItemRClick( wxDataViewEvent& aEvent )
 }
 
 
+void DIALOG_DRC::OnOnlineDRC( wxCommandEvent& aEvent )
+{
+    // Takes effect immediately, for the next edits made while the dialog is open
+    m_brdEditor->GetPcbNewSettings()->m_DrcDialog.online_drc = m_cbOnlineDRC->GetValue();
+}
+
+
 void DIALOG_DRC::OnSeverity( wxCommandEvent& aEvent )
 {
     int flag = 0;
@@ -78,6 +78,7 @@ private:
     void OnDRCItemRClick( wxDataViewEvent& aEvent ) override;
 
     void OnSeverity( wxCommandEvent& aEvent ) override;
+    void OnOnlineDRC( wxCommandEvent& aEvent ) override;
   	void OnSaveReport( wxCommandEvent& aEvent ) override;
 
     void OnDeleteOneClick( wxCommandEvent& aEvent ) override;
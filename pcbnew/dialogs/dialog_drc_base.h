@@ -55,6 +55,7 @@ class DIALOG_DRC_BASE : public DIALOG_SHIM
 		wxCheckBox* m_cbReportAllTrackErrors;
 		wxCheckBox* m_cbReportTracksToZonesErrors;
 		wxCheckBox* m_cbTestFootprints;
+		wxCheckBox* m_cbOnlineDRC;
 		wxTextCtrl* m_Messages;
 		wxNotebook* m_Notebook;
 		wxPanel* m_panelViolations;
@@ -81,6 +82,7 @@ class DIALOG_DRC_BASE : public DIALOG_SHIM
 
 		// Virtual event handlers, overide them in your derived class
 		virtual void OnActivateDlg( wxActivateEvent& event ) { event.Skip(); }
+		virtual void OnOnlineDRC( wxCommandEvent& event ) { event.Skip(); }
 		virtual void OnChangingNotebookPage( wxNotebookEvent& event ) { event.Skip(); }
 		virtual void OnDRCItemDClick( wxDataViewEvent& event ) { event.Skip(); }
 		virtual void OnDRCItemRClick( wxDataViewEvent& event ) { event.Skip(); }
@@ -54,6 +54,19 @@
 #include <drc/drc_item.h>
 #include <drc/drc_courtyard_tester.h>
 #include <tools/zone_filler_tool.h>
+#include <zone_filler.h>
+#include <pcbnew_settings.h>
+#include <thread_pool.h>
+
+#include <atomic>
+#include <numeric>
+
+
+// Markers reported by the DRC_JOB running on this thread, if any (see DRC::runJobs())
+static thread_local std::vector<MARKER_PCB*>* s_jobMarkers = nullptr;
+
+// Number of tracks tested by each job of DRC::testTracks()
+static const size_t TRACKS_PER_JOB = 100;
 
 DRC::DRC() :
         PCB_TOOL_BASE( "pcbnew.DRCTool" ),
@@ -72,6 +85,7 @@ DRC::DRC() :
 
     m_drcRun = false;
     m_footprintsTested = false;
+    m_testsRunning = false;
 }
 
 
@@ -158,12 +172,95 @@ void DRC::addMarkerToPcb( MARKER_PCB* aMarker )
         return;
     }
 
+    if( s_jobMarkers )
+    {
+        s_jobMarkers->push_back( aMarker );
+        return;
+    }
+
+    if( !m_pcbEditorFrame )
+    {
+        m_pcb->Add( aMarker );
+        return;
+    }
+
     BOARD_COMMIT commit( m_pcbEditorFrame );
     commit.Add( aMarker );
     commit.Push( wxEmptyString, false, false );
 }
 
 
+void DRC::runJobs( std::vector<DRC_JOB>& aJobs, const std::function<bool( size_t )>& aProgress )
+{
+    executeJobs( aJobs, aProgress );
+
+    if( !m_pcbEditorFrame )
+    {
+        for( DRC_JOB& job : aJobs )
+        {
+            for( MARKER_PCB* marker : job.m_markers )
+                m_pcb->Add( marker );
+
+            job.m_markers.clear();
+        }
+
+        return;
+    }
+
+    // Commit all the markers at once, in the order the tests would have reported them
+    // if they had been run one after the other
+    BOARD_COMMIT commit( m_pcbEditorFrame );
+    bool         hasMarkers = false;
+
+    for( DRC_JOB& job : aJobs )
+    {
+        for( MARKER_PCB* marker : job.m_markers )
+        {
+            commit.Add( marker );
+            hasMarkers = true;
+        }
+
+        job.m_markers.clear();
+    }
+
+    if( hasMarkers )
+        commit.Push( wxEmptyString, false, false );
+}
+
+
+void DRC::executeJobs( std::vector<DRC_JOB>& aJobs,
+                       const std::function<bool( size_t )>& aProgress )
+{
+    std::atomic<size_t> doneJobs( 0 );
+    bool                cancelled = false;
+
+    auto job = [&]( size_t i )
+    {
+        s_jobMarkers = &aJobs[i].m_markers;
+        aJobs[i].m_test();
+        s_jobMarkers = nullptr;
+
+        doneJobs++;
+    };
+
+    std::function<bool()> progress;
+
+    if( aProgress )
+    {
+        // Called from this thread only, about every 100ms to allow UI updating
+        progress = [&]() -> bool
+                   {
+                       if( !cancelled && !aProgress( doneJobs ) )
+                           cancelled = true;   // Aborted by user
+
+                       return !cancelled;
+                   };
+    }
+
+    THREAD_POOL::ParallelFor( aJobs.size(), job, progress );
+}
+
+
 void DRC::DestroyDRCDialog( int aReason )
 {
     if( m_drcDialog )
@@ -176,7 +273,7 @@ void DRC::DestroyDRCDialog( int aReason )
 
 int DRC::TestZoneToZoneOutlines()
 {
-    BOARD*   board = m_pcbEditorFrame->GetBoard();
+    BOARD*   board = m_pcb;
     int      nerrors = 0;
     wxString msg;
 
@@ -356,6 +453,26 @@ void DRC::RunTests( wxTextCtrl* aMessages )
     // ( the board can be reloaded )
     m_pcb = m_pcbEditorFrame->GetBoard();
 
+    // The zone fills push commits, which must not run the online DRC: it would add the
+    // track markers which the track tests add again.
+    m_testsRunning = true;
+    runTests( aMessages );
+    m_testsRunning = false;
+}
+
+
+void DRC::RunTestsOnBoard( BOARD* aBoard )
+{
+    m_pcb = aBoard;
+
+    m_testsRunning = true;
+    runTests( nullptr );
+    m_testsRunning = false;
+}
+
+
+void DRC::runTests( wxTextCtrl* aMessages )
+{
     if( aMessages )
     {
         aMessages->AppendText( _( "Board Outline...\n" ) );
@@ -380,36 +497,24 @@ void DRC::RunTests( wxTextCtrl* aMessages )
             aMessages->AppendText( _( "NETCLASS VIOLATIONS: Aborting DRC\n" ) );
 
         // update the m_drcDialog listboxes
-        updatePointers();
+        if( m_pcbEditorFrame )
+            updatePointers();
 
         return;
     }
 
-    // test pad to pad clearances, nothing to do with tracks, vias or zones.
-    if( m_doPad2PadTest )
+    // caller (a wxTopLevelFrame) is the wxDialog or the Pcb Editor frame that call DRC:
+    wxWindow* caller = aMessages ? aMessages->GetParent() : m_pcbEditorFrame;
+
+    if( !m_pcbEditorFrame )
     {
-        if( aMessages )
+        if( m_refillZones )
         {
-            aMessages->AppendText( _( "Pad clearances...\n" ) );
-            wxSafeYield();
+            ZONE_FILLER filler( m_pcb );
+            filler.Fill( m_pcb->Zones() );
         }
-
-        testPad2Pad();
     }
-
-    // test clearances between drilled holes
-    if( aMessages )
-    {
-        aMessages->AppendText( _( "Drill clearances...\n" ) );
-        wxSafeYield();
-    }
-
-    testDrilledHoles();
-
-    // caller (a wxTopLevelFrame) is the wxDialog or the Pcb Editor frame that call DRC:
-    wxWindow* caller = aMessages ? aMessages->GetParent() : m_pcbEditorFrame;
-
-    if( m_refillZones )
+    else if( m_refillZones )
     {
         if( aMessages )
             aMessages->AppendText( _( "Refilling all zones...\n" ) );
@@ -424,25 +529,8 @@ void DRC::RunTests( wxTextCtrl* aMessages )
         m_toolMgr->GetTool<ZONE_FILLER_TOOL>()->CheckAllZones( caller );
     }
 
-    // test track and via clearances to other tracks, pads, and vias
-    if( aMessages )
-    {
-        aMessages->AppendText( _( "Track clearances...\n" ) );
-        wxSafeYield();
-    }
-
-    testTracks( aMessages ? aMessages->GetParent() : m_pcbEditorFrame, true );
-
-    // test zone clearances to other zones
-    if( aMessages )
-    {
-        aMessages->AppendText( _( "Zone to zone clearances...\n" ) );
-        wxSafeYield();
-    }
-
-    testZones();
-
     // find and gather unconnected pads.
+    // This rebuilds the connectivity, so it must be done before the tests run in parallel
     if( m_doUnconnectedTest && !m_pcb->GetDesignSettings().Ignore( DRCE_UNCONNECTED_ITEMS ) )
     {
         if( aMessages )
@@ -454,48 +542,100 @@ void DRC::RunTests( wxTextCtrl* aMessages )
         testUnconnected();
     }
 
-    // find and gather vias, tracks, pads inside keepout areas.
-    if( m_doKeepoutTest )
-    {
-        if( aMessages )
-        {
-            aMessages->AppendText( _( "Keepout areas ...\n" ) );
-            aMessages->Refresh();
-        }
+    // The following tests only read the board; they are run concurrently, and their markers
+    // are added to the board in the order below once they are all done.
+    std::vector<DRC_JOB> jobs;
 
-        testKeepoutAreas();
-    }
+    auto addJob =
+            [&]( const wxString& aMessage, const std::function<void()>& aTest )
+            {
+                if( aMessages )
+                    aMessages->AppendText( aMessage );
 
-    // find and gather vias, tracks, pads inside text boxes.
+                jobs.push_back( { aTest, {} } );
+            };
+
+    // test pad to pad clearances, nothing to do with tracks, vias or zones.
+    if( m_doPad2PadTest )
+        addJob( _( "Pad clearances...\n" ), [this]() { testPad2Pad(); } );
+
+    // test clearances between drilled holes
+    addJob( _( "Drill clearances...\n" ), [this]() { testDrilledHoles(); } );
+
+    // test track and via clearances to other tracks, pads, and vias
     if( aMessages )
-    {
-        aMessages->AppendText( _( "Text and graphic clearances...\n" ) );
-        wxSafeYield();
-    }
+        aMessages->AppendText( _( "Track clearances...\n" ) );
+
+    std::vector<int> allTracks( m_pcb->Tracks().size() );
+    std::iota( allTracks.begin(), allTracks.end(), 0 );
+
+    buildTrackIndexes();
+    testTracks( jobs, allTracks );
+
+    // test zone clearances to other zones
+    addJob( _( "Zone to zone clearances...\n" ), [this]() { testZones(); } );
+
+    // find and gather vias, tracks, pads inside keepout areas.
+    if( m_doKeepoutTest )
+        addJob( _( "Keepout areas ...\n" ), [this]() { testKeepoutAreas(); } );
 
-    testCopperTextAndGraphics();
+    // find and gather vias, tracks, pads inside text boxes.
+    addJob( _( "Text and graphic clearances...\n" ),
+            [this]() { testCopperTextAndGraphics(); } );
 
     // test courtyards
     if( !m_pcb->GetDesignSettings().Ignore( DRCE_OVERLAPPING_FOOTPRINTS )
         || !m_pcb->GetDesignSettings().Ignore( DRCE_MISSING_COURTYARD_IN_FOOTPRINT )
         || !m_pcb->GetDesignSettings().Ignore( DRCE_MALFORMED_COURTYARD_IN_FOOTPRINT ) )
     {
-        if( aMessages )
-        {
-            aMessages->AppendText( _( "Courtyard areas...\n" ) );
-            aMessages->Refresh();
-        }
+        // Builds the footprint courtyards, which no other job uses
+        addJob( _( "Courtyard areas...\n" ), [this]() { doCourtyardsDrc(); } );
+    }
 
-        doCourtyardsDrc();
+    if( aMessages )
+        wxSafeYield();
+
+    wxProgressDialog* progressDialog = nullptr;
+
+    // Only bother the user with a progress bar when there are many tracks to test
+    if( m_pcb->Tracks().size() > 2000 )
+    {
+        // Do not use wxPD_APP_MODAL style here: it is not necessary and create issues
+        // on OSX
+        progressDialog = new wxProgressDialog( _( "Design Rules Check" ), wxEmptyString,
+                                               jobs.size(), caller,
+                                               wxPD_AUTO_HIDE | wxPD_CAN_ABORT
+                                                       | wxPD_ELAPSED_TIME );
+        progressDialog->Update( 0, wxEmptyString );
     }
 
+    runJobs( jobs,
+             [&]( size_t aDone ) -> bool
+             {
+                 if( !progressDialog )
+                     return true;
+
+                 bool ok = progressDialog->Update( aDone, wxEmptyString );
+#ifdef __WXMAC__
+                 // Work around a dialog z-order issue on OS X
+                 if( aDone == jobs.size() )
+                     caller->Raise();
+#endif
+                 return ok;
+             } );
+
+    if( progressDialog )
+        progressDialog->Destroy();
+
+    clearTrackIndexes();
+
     for( DRC_ITEM* footprintItem : m_footprints )
         delete footprintItem;
 
     m_footprints.clear();
     m_footprintsTested = false;
 
-    if( m_testFootprints && !Kiface().IsSingle() )
+    if( m_testFootprints && m_pcbEditorFrame && !Kiface().IsSingle() )
     {
         if( aMessages )
         {
@@ -529,7 +669,8 @@ void DRC::RunTests( wxTextCtrl* aMessages )
     m_drcRun = true;
 
     // update the m_drcDialog listboxes
-    updatePointers();
+    if( m_pcbEditorFrame )
+        updatePointers();
 
     if( aMessages )
     {
@@ -540,6 +681,156 @@ void DRC::RunTests( wxTextCtrl* aMessages )
 }
 
 
+/**
+ * @return true if aErrorCode is reported by DRC::doTrackDrc(), with the tested track as
+ * main item.
+ */
+static bool isTrackErrorCode( int aErrorCode )
+{
+    switch( aErrorCode )
+    {
+    case DRCE_TOO_SMALL_MICROVIA:
+    case DRCE_TOO_SMALL_VIA:
+    case DRCE_VIA_HOLE_BIGGER:
+    case DRCE_MICRO_VIA_NOT_ALLOWED:
+    case DRCE_BURIED_VIA_NOT_ALLOWED:
+    case DRCE_MICRO_VIA_INCORRECT_LAYER_PAIR:
+    case DRCE_TOO_SMALL_TRACK_WIDTH:
+    case DRCE_TRACK_NEAR_THROUGH_HOLE:
+    case DRCE_TRACK_NEAR_PAD:
+    case DRCE_TRACKS_CROSSING:
+    case DRCE_TRACK_ENDS:
+    case DRCE_VIA_NEAR_VIA:
+    case DRCE_VIA_NEAR_TRACK:
+    case DRCE_TRACK_SEGMENTS_TOO_CLOSE:
+    case DRCE_TRACK_NEAR_ZONE:
+    case DRCE_TRACK_NEAR_EDGE:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+
+bool DRC::IsOnlineDrcEnabled() const
+{
+    // A full run tests every track anyway
+    if( m_testsRunning )
+        return false;
+
+    return m_pcbEditorFrame && m_pcbEditorFrame->GetPcbNewSettings()->m_DrcDialog.online_drc;
+}
+
+
+void DRC::RunOnlineDrc( const std::vector<EDA_RECT>* aAreas, const std::set<KIID>& aRemovedItems )
+{
+    if( m_testsRunning )
+        return;
+
+    std::vector<MARKER_PCB*> staleMarkers;
+    std::vector<MARKER_PCB*> newMarkers;
+
+    TestTracksOnline( m_pcbEditorFrame->GetBoard(), aAreas, aRemovedItems, staleMarkers,
+                      newMarkers );
+
+    if( staleMarkers.empty() && newMarkers.empty() )
+        return;
+
+    m_pcbEditorFrame->RecordDRCExclusions();
+
+    BOARD_COMMIT commit( m_pcbEditorFrame );
+
+    for( MARKER_PCB* marker : staleMarkers )
+        commit.Remove( marker );
+
+    for( MARKER_PCB* marker : newMarkers )
+        commit.Add( marker );
+
+    commit.Push( wxEmptyString, false, false );
+
+    // Without an undo entry, nothing else owns the removed markers
+    for( MARKER_PCB* marker : staleMarkers )
+        delete marker;
+
+    // Restores the exclusions and refreshes the DRC dialog lists
+    updatePointers();
+}
+
+
+void DRC::TestTracksOnline( BOARD* aBoard, const std::vector<EDA_RECT>* aAreas,
+                            const std::set<KIID>& aRemovedItems,
+                            std::vector<MARKER_PCB*>& aStaleMarkers,
+                            std::vector<MARKER_PCB*>& aNewMarkers )
+{
+    m_pcb = aBoard;
+
+    // The edge clearance tests need the outline which testOutline() builds in a full run.
+    // An invalid outline is reported by the full DRC only.
+    m_board_outlines.RemoveAllContours();
+    m_pcb->GetBoardPolygonOutlines( m_board_outlines );
+
+    // Rebuilding the indexes is cheap compared to the tests themselves
+    buildTrackIndexes();
+
+    // The tracks close enough to a changed item to violate their clearance.  Any other pair
+    // of items, and therefore any other marker, is left unchanged by the commit.
+    TRACKS&          tracks = m_pcb->Tracks();
+    std::vector<int> retest;
+
+    if( aAreas )
+    {
+        std::vector<int> candidates;
+
+        for( const EDA_RECT& area : *aAreas )
+        {
+            m_trackIndex.Query( area, LSET::AllCuMask(), candidates );
+            retest.insert( retest.end(), candidates.begin(), candidates.end() );
+        }
+
+        std::sort( retest.begin(), retest.end() );
+        retest.erase( std::unique( retest.begin(), retest.end() ), retest.end() );
+    }
+    else
+    {
+        retest.resize( tracks.size() );
+        std::iota( retest.begin(), retest.end(), 0 );
+    }
+
+    std::set<KIID> retestIds;
+
+    for( int index : retest )
+        retestIds.insert( tracks[index]->m_Uuid );
+
+    // doTrackDrc() reports the pairs of tracks from the first one in the board list, so the
+    // markers of a retested track are all the ones it is the main item of.
+    for( MARKER_PCB* marker : m_pcb->Markers() )
+    {
+        const RC_ITEM* rcItem = marker->GetRCItem();
+
+        if( !isTrackErrorCode( rcItem->GetErrorCode() ) )
+            continue;
+
+        if( retestIds.count( rcItem->GetMainItemID() )
+                || aRemovedItems.count( rcItem->GetMainItemID() )
+                || aRemovedItems.count( rcItem->GetAuxItemID() ) )
+        {
+            aStaleMarkers.push_back( marker );
+        }
+    }
+
+    std::vector<DRC_JOB> jobs;
+
+    testTracks( jobs, retest );
+    executeJobs( jobs, nullptr );
+
+    for( DRC_JOB& job : jobs )
+        aNewMarkers.insert( aNewMarkers.end(), job.m_markers.begin(), job.m_markers.end() );
+
+    clearTrackIndexes();
+}
+
+
 void DRC::updatePointers()
 {
     // update my pointers, m_pcbEditorFrame is the only unchangeable one
@@ -850,53 +1141,68 @@ void DRC::testDrilledHoles()
 }
 
 
-void DRC::testTracks( wxWindow *aActiveWindow, bool aShowProgressBar )
+void DRC::buildTrackIndexes()
 {
-    wxProgressDialog * progressDialog = NULL;
-    const int delta = 500;  // This is the number of tests between 2 calls to the
-                            // progress bar
-    int count = m_pcb->Tracks().size();
-
-    int deltamax = count/delta;
+    m_trackIndex.Clear();
+    m_padIndex.Clear();
+    m_pads.clear();
 
-    if( aShowProgressBar && deltamax > 3 )
+    for( size_t ii = 0; ii < m_pcb->Tracks().size(); ii++ )
     {
-        // Do not use wxPD_APP_MODAL style here: it is not necessary and create issues
-        // on OSX
-        progressDialog = new wxProgressDialog( _( "Track clearances" ), wxEmptyString,
-                                               deltamax, aActiveWindow,
-                                               wxPD_AUTO_HIDE | wxPD_CAN_ABORT | wxPD_ELAPSED_TIME );
-        progressDialog->Update( 0, wxEmptyString );
-    }
+        TRACK*   track = m_pcb->Tracks()[ii];
+        EDA_RECT bbox = track->GetBoundingBox();
 
-    int ii = 0;
-    count = 0;
+        bbox.Inflate( track->GetClearance() );
+        m_trackIndex.Insert( (int) ii, bbox, track->GetLayerSet() );
+    }
 
-    for( auto seg_it = m_pcb->Tracks().begin(); seg_it != m_pcb->Tracks().end(); seg_it++ )
+    for( MODULE* mod : m_pcb->Modules() )
     {
-        if( ii++ > delta )
+        for( D_PAD* pad : mod->Pads() )
         {
-            ii = 0;
-            count++;
+            int      radius = pad->GetBoundingRadius() + pad->GetClearance();
+            EDA_RECT bbox( pad->GetPosition(), wxSize( 0, 0 ) );
 
-            if( progressDialog )
-            {
-                if( !progressDialog->Update( count, wxEmptyString ) )
-                    break;  // Aborted by user
-#ifdef __WXMAC__
-                // Work around a dialog z-order issue on OS X
-                if( count == deltamax )
-                    aActiveWindow->Raise();
-#endif
-            }
+            bbox.Inflate( radius );
+            m_padIndex.Insert( (int) m_pads.size(), bbox, pad->GetLayerSet() );
+            m_pads.push_back( pad );
         }
-
-        // Test new segment against tracks and pads, optionally against copper zones
-        doTrackDrc( *seg_it, seg_it + 1, m_pcb->Tracks().end(), m_doZonesTest );
     }
+}
 
-    if( progressDialog )
-        progressDialog->Destroy();
+
+void DRC::clearTrackIndexes()
+{
+    m_trackIndex.Clear();
+    m_padIndex.Clear();
+    m_pads.clear();
+}
+
+
+void DRC::testTracks( std::vector<DRC_JOB>& aJobs, const std::vector<int>& aTracks )
+{
+    for( size_t first = 0; first < aTracks.size(); first += TRACKS_PER_JOB )
+    {
+        size_t last = std::min( first + TRACKS_PER_JOB, aTracks.size() );
+
+        auto test =
+                [this, &aTracks, first, last]()
+                {
+                    TRACKS& tracks = m_pcb->Tracks();
+
+                    // Test each segment against the next tracks and pads, optionally against
+                    // copper zones
+                    for( size_t ii = first; ii < last; ii++ )
+                    {
+                        int index = aTracks[ii];
+
+                        doTrackDrc( tracks[index], tracks.begin() + index + 1, tracks.end(),
+                                    m_doZonesTest );
+                    }
+                };
+
+        aJobs.push_back( { test, {} } );
+    }
 }
 
 
@@ -1393,7 +1699,7 @@ void DRC::testOutline()
 
 void DRC::testDisabledLayers()
 {
-    BOARD*   board = m_pcbEditorFrame->GetBoard();
+    BOARD*   board = m_pcb;
     wxCHECK( board, /*void*/ );
 
     LSET     disabledLayers = board->GetEnabledLayers().flip();
@@ -1461,7 +1767,7 @@ void DRC::testDisabledLayers()
 
 void DRC::testTextVars()
 {
-    BOARD* board = m_pcbEditorFrame->GetBoard();
+    BOARD* board = m_pcb;
 
     for( MODULE* module : board->Modules() )
     {
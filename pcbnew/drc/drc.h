@@ -28,9 +28,12 @@
 #include <class_board.h>
 #include <class_track.h>
 #include <class_marker_pcb.h>
+#include <drc/drc_rtree.h>
 #include <geometry/seg.h>
 #include <geometry/shape_poly_set.h>
+#include <functional>
 #include <memory>
+#include <set>
 #include <vector>
 #include <tools/pcb_tool_base.h>
 
@@ -157,10 +160,16 @@ private:
     SHAPE_POLY_SET         m_board_outlines;   // The board outline including cutouts
     DIALOG_DRC*    m_drcDialog;
 
+    // Spatial indexes used by doTrackDrc(), see buildTrackIndexes()
+    DRC_RTREE              m_trackIndex;       // m_pcb->Tracks(), by index
+    DRC_RTREE              m_padIndex;         // m_pads, by index
+    std::vector<D_PAD*>    m_pads;             // the board pads, in footprints order
+
     std::vector<DRC_ITEM*> m_unconnected;      // list of unconnected pads
     std::vector<DRC_ITEM*> m_footprints;       // list of footprint warnings
     bool                   m_drcRun;
     bool                   m_footprintsTested;
+    bool                   m_testsRunning;     // RunTests() is in progress
 
     ///> Sets up handlers for various events.
     void setTransitions() override;
@@ -170,10 +179,20 @@ private:
      */
     void updatePointers();
 
-    EDA_UNITS userUnits() const { return m_pcbEditorFrame->GetUserUnits(); }
+    /**
+     * The tests of RunTests() and RunTestsOnBoard(), on m_pcb.
+     */
+    void runTests( wxTextCtrl* aMessages );
+
+    EDA_UNITS userUnits() const
+    {
+        return m_pcbEditorFrame ? m_pcbEditorFrame->GetUserUnits() : EDA_UNITS::MILLIMETRES;
+    }
 
     /**
      * Adds a DRC marker to the PCB through the COMMIT mechanism.
+     * When called from a job run by runJobs(), the marker is kept in the job until all the
+     * jobs are done.
      */
     void addMarkerToPcb( MARKER_PCB* aMarker );
 
@@ -197,14 +216,48 @@ private:
     bool testNetClasses();
 
     /**
-     * Perform the DRC on all tracks.
+     * A test, or a slice of a test, which does not modify the board and therefore can be run
+     * concurrently with the other ones.
+     */
+    struct DRC_JOB
+    {
+        std::function<void()>    m_test;
+        std::vector<MARKER_PCB*> m_markers;     // markers reported by m_test, not yet committed
+    };
+
+    /**
+     * Run aJobs on the available cores, then add the markers they reported to the board in
+     * the order of aJobs, so that the markers do not depend on the threads scheduling.
+     *
+     * @param aJobs = the jobs to run
+     * @param aProgress = if not empty, called periodically from the calling thread with the
+     * number of finished jobs; returning false cancels the jobs which are not started yet
+     */
+    void runJobs( std::vector<DRC_JOB>& aJobs, const std::function<bool( size_t )>& aProgress );
+
+    /**
+     * Run aJobs on the available cores, and leave the markers they reported in the jobs.
+     * @see runJobs()
+     */
+    void executeJobs( std::vector<DRC_JOB>& aJobs,
+                      const std::function<bool( size_t )>& aProgress );
+
+    /**
+     * Build the spatial indexes of the board tracks and pads used by doTrackDrc().
+     */
+    void buildTrackIndexes();
+
+    void clearTrackIndexes();
+
+    /**
+     * Queue the DRC of some tracks, split into jobs of a few tracks each.
      *
-     * This test can take a while, a progress bar can be displayed
-     * @param aActiveWindow = the active window ued as parent for the progress bar
-     * @param aShowProgressBar = true to show a progress bar
-     * (Note: it is shown only if there are many tracks)
+     * Each track is tested against the tracks following it, so the jobs are not of equal cost;
+     * keeping them small lets runJobs() balance them.
+     * @param aTracks = the indexes of the tracks to test in m_pcb->Tracks(), in ascending
+     * order.  The jobs refer to this list, which must be kept until they are run.
      */
-    void testTracks( wxWindow * aActiveWindow, bool aShowProgressBar );
+    void testTracks( std::vector<DRC_JOB>& aJobs, const std::vector<int>& aTracks );
 
     void testPad2Pad();
 
@@ -254,6 +307,7 @@ private:
 
     /**
      * Test the current segment.
+     * Only the pads and tracks found near it in m_padIndex and m_trackIndex are tested.
      *
      * @param aRefSeg The segment to test
      * @param aStartIt the iterator to the first track to test
@@ -360,6 +414,42 @@ public:
      * @param aMessages = a wxTextControl where to display some activity messages. Can be NULL
      */
     void RunTests( wxTextCtrl* aMessages = NULL );
+
+    /**
+     * Run all the tests on aBoard without an editor frame, as the QA tests do: zones are
+     * refilled without a commit, and markers are added to aBoard directly.
+     */
+    void RunTestsOnBoard( BOARD* aBoard );
+
+    /**
+     * @return true if the tracks should be tested after each BOARD_COMMIT (online DRC).
+     */
+    bool IsOnlineDrcEnabled() const;
+
+    /**
+     * Test again the tracks which may be affected by a BOARD_COMMIT, and replace their
+     * markers, instead of running all the tests.
+     *
+     * @param aAreas = the board areas touched by the commit, each one inflated by the clearance
+     * of the item it comes from, or nullptr if the commit may affect the whole board
+     * @param aRemovedItems = the items removed from the board by the commit
+     */
+    void RunOnlineDrc( const std::vector<EDA_RECT>* aAreas, const std::set<KIID>& aRemovedItems );
+
+    /**
+     * The tests of RunOnlineDrc(), without changing the board: finds the track markers of
+     * aBoard which a commit makes stale, and the markers which replace them.
+     *
+     * @param aBoard = the board the commit was applied to
+     * @param aAreas = see RunOnlineDrc()
+     * @param aRemovedItems = see RunOnlineDrc()
+     * @param aStaleMarkers = filled with the markers of aBoard to remove
+     * @param aNewMarkers = filled with the new markers, owned by the caller
+     */
+    void TestTracksOnline( BOARD* aBoard, const std::vector<EDA_RECT>* aAreas,
+                           const std::set<KIID>& aRemovedItems,
+                           std::vector<MARKER_PCB*>& aStaleMarkers,
+                           std::vector<MARKER_PCB*>& aNewMarkers );
 };
 
 
@@ -296,81 +296,58 @@ void DRC::doTrackDrc( TRACK* aRefSeg, TRACKS::iterator aStartIt, TRACKS::iterato
     /* Phase 1 : test DRC track to pads :     */
     /******************************************/
 
-    // Compute the min distance to pads
-    for( MODULE* mod : m_pcb->Modules() )
-    {
-        // Don't preflight at the module level.  Getting a module's bounding box goes
-        // through all its pads anyway (so it's no faster), and also all its drawings
-        // (so it's in fact slower).
-
-        for( D_PAD* pad : mod->Pads() )
-        {
-            // Preflight based on bounding boxes.
-            EDA_RECT inflatedBB = refSegBB;
-            inflatedBB.Inflate( pad->GetBoundingRadius() + aRefSeg->GetClearance( pad, nullptr ) );
+    // Compute the min distance to the pads near the reference segment
+    std::vector<int> candidates;
+    EDA_RECT         searchBB = refSegBB;
 
-            if( !inflatedBB.Contains( pad->GetPosition() ) )
-                continue;
-
-            if( !( pad->GetLayerSet() & layerMask ).any() )
-                continue;
+    searchBB.Inflate( aRefSeg->GetClearance() );
+    m_padIndex.Query( searchBB, layerMask, candidates );
 
-            // No need to check pads with the same net as the refSeg.
-            if( pad->GetNetCode() && aRefSeg->GetNetCode() == pad->GetNetCode() )
-                continue;
-
-            if( pad->GetDrillSize().x > 0 )
-            {
-                wxString clearanceSource;
-                int      minClearance = aRefSeg->GetClearance( nullptr, &clearanceSource );
-
-                /* Treat an oval hole as a line segment along the hole's major axis,
-                 * shortened by half its minor axis.
-                 * A circular hole is just a degenerate case of an oval hole.
-                 */
-                wxPoint slotStart, slotEnd;
-                int     slotWidth;
+    for( int padIndex : candidates )
+    {
+        D_PAD* pad = m_pads[padIndex];
 
-                pad->GetOblongGeometry( pad->GetDrillSize(), &slotStart, &slotEnd, &slotWidth );
-                slotStart += pad->GetPosition();
-                slotEnd += pad->GetPosition();
+        // Preflight based on bounding boxes.
+        EDA_RECT inflatedBB = refSegBB;
+        inflatedBB.Inflate( pad->GetBoundingRadius() + aRefSeg->GetClearance( pad, nullptr ) );
 
-                SEG     slotSeg( slotStart, slotEnd );
-                int     widths = ( slotWidth + refSegWidth ) / 2;
-                int     center2centerAllowed = minClearance + widths;
+        if( !inflatedBB.Contains( pad->GetPosition() ) )
+            continue;
 
-                // Avoid square-roots if possible (for performance)
-                SEG::ecoord center2center_squared = refSeg.SquaredDistance( slotSeg );
+        if( !( pad->GetLayerSet() & layerMask ).any() )
+            continue;
 
-                if( center2center_squared < SEG::Square( center2centerAllowed ) )
-                {
-                    int       actual = std::max( 0.0, sqrt( center2center_squared ) - widths );
-                    DRC_ITEM* drcItem = new DRC_ITEM( DRCE_TRACK_NEAR_THROUGH_HOLE );
+        // No need to check pads with the same net as the refSeg.
+        if( pad->GetNetCode() && aRefSeg->GetNetCode() == pad->GetNetCode() )
+            continue;
 
-                    msg.Printf( drcItem->GetErrorText() + _( " (%s %s; actual %s)" ),
-                                clearanceSource,
-                                MessageTextFromValue( userUnits(), minClearance, true ),
-                                MessageTextFromValue( userUnits(), actual, true ) );
+        if( pad->GetDrillSize().x > 0 )
+        {
+            wxString clearanceSource;
+            int      minClearance = aRefSeg->GetClearance( nullptr, &clearanceSource );
 
-                    drcItem->SetErrorMessage( msg );
-                    drcItem->SetItems( aRefSeg, pad );
+            /* Treat an oval hole as a line segment along the hole's major axis,
+             * shortened by half its minor axis.
+             * A circular hole is just a degenerate case of an oval hole.
+             */
+            wxPoint slotStart, slotEnd;
+            int     slotWidth;
 
-                    MARKER_PCB* marker = new MARKER_PCB( drcItem, getLocation( aRefSeg, slotSeg ) );
-                    addMarkerToPcb( marker );
+            pad->GetOblongGeometry( pad->GetDrillSize(), &slotStart, &slotEnd, &slotWidth );
+            slotStart += pad->GetPosition();
+            slotEnd += pad->GetPosition();
 
-                    if( !m_reportAllTrackErrors )
-                        return;
-                }
-            }
+            SEG     slotSeg( slotStart, slotEnd );
+            int     widths = ( slotWidth + refSegWidth ) / 2;
+            int     center2centerAllowed = minClearance + widths;
 
-            wxString clearanceSource;
-            int      minClearance = aRefSeg->GetClearance( pad, &clearanceSource );
-            int      actual;
+            // Avoid square-roots if possible (for performance)
+            SEG::ecoord center2center_squared = refSeg.SquaredDistance( slotSeg );
 
-            if( !checkClearanceSegmToPad( refSeg, refSegWidth, pad, minClearance, &actual ) )
+            if( center2center_squared < SEG::Square( center2centerAllowed ) )
             {
-                SEG       padSeg( pad->GetPosition(), pad->GetPosition() );
-                DRC_ITEM* drcItem = new DRC_ITEM( DRCE_TRACK_NEAR_PAD );
+                int       actual = std::max( 0.0, sqrt( center2center_squared ) - widths );
+                DRC_ITEM* drcItem = new DRC_ITEM( DRCE_TRACK_NEAR_THROUGH_HOLE );
 
                 msg.Printf( drcItem->GetErrorText() + _( " (%s %s; actual %s)" ),
                             clearanceSource,
@@ -380,23 +357,56 @@ void DRC::doTrackDrc( TRACK* aRefSeg, TRACKS::iterator aStartIt, TRACKS::iterato
                 drcItem->SetErrorMessage( msg );
                 drcItem->SetItems( aRefSeg, pad );
 
-                MARKER_PCB* marker = new MARKER_PCB( drcItem, getLocation( aRefSeg, padSeg ) );
+                MARKER_PCB* marker = new MARKER_PCB( drcItem, getLocation( aRefSeg, slotSeg ) );
                 addMarkerToPcb( marker );
 
                 if( !m_reportAllTrackErrors )
                     return;
             }
         }
+
+        wxString clearanceSource;
+        int      minClearance = aRefSeg->GetClearance( pad, &clearanceSource );
+        int      actual;
+
+        if( !checkClearanceSegmToPad( refSeg, refSegWidth, pad, minClearance, &actual ) )
+        {
+            SEG       padSeg( pad->GetPosition(), pad->GetPosition() );
+            DRC_ITEM* drcItem = new DRC_ITEM( DRCE_TRACK_NEAR_PAD );
+
+            msg.Printf( drcItem->GetErrorText() + _( " (%s %s; actual %s)" ),
+                        clearanceSource,
+                        MessageTextFromValue( userUnits(), minClearance, true ),
+                        MessageTextFromValue( userUnits(), actual, true ) );
+
+            drcItem->SetErrorMessage( msg );
+            drcItem->SetItems( aRefSeg, pad );
+
+            MARKER_PCB* marker = new MARKER_PCB( drcItem, getLocation( aRefSeg, padSeg ) );
+            addMarkerToPcb( marker );
+
+            if( !m_reportAllTrackErrors )
+                return;
+        }
     }
 
     /***********************************************/
     /* Phase 2: test DRC with other track segments */
     /***********************************************/
 
-    // Test the reference segment with other track segments
-    for( auto it = aStartIt; it != aEndIt; it++ )
+    // Test the reference segment with the other track segments near it
+    TRACKS& tracks = m_pcb->Tracks();
+    int     startIndex = aStartIt - tracks.begin();
+    int     endIndex = aEndIt - tracks.begin();
+
+    m_trackIndex.Query( searchBB, layerMask, candidates );
+
+    for( int trackIndex : candidates )
     {
-        TRACK* track = *it;
+        if( trackIndex < startIndex || trackIndex >= endIndex )
+            continue;
+
+        TRACK* track = tracks[trackIndex];
 
         // No problem if segments have the same net code:
         if( aRefSeg->GetNetCode() == track->GetNetCode() )
@@ -0,0 +1,129 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef PCBNEW_DRC_RTREE_H_
+#define PCBNEW_DRC_RTREE_H_
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <eda_rect.h>
+#include <layers_id_colors_and_visibility.h>
+
+#include <geometry/rtree.h>
+
+/**
+ * DRC_RTREE -
+ * Implements one R-tree per copper layer for fast lookup of the board items close to a DRC
+ * reference item.  Items are stored as their index in a list owned by the caller (e.g. the
+ * board tracks), with a bounding box inflated by their clearance, so a query with the
+ * bounding box of the reference item inflated by its own clearance returns every item which
+ * may violate the clearance between them.
+ * Queries do not modify the trees and can be run concurrently.
+ */
+class DRC_RTREE
+{
+private:
+    using drc_rtree = RTree<int, int, 2, double>;
+
+public:
+    DRC_RTREE()
+    {
+    }
+
+    /**
+     * Function Insert()
+     * Inserts the item of index aIndex on the copper layers of aLayers.
+     */
+    void Insert( int aIndex, const EDA_RECT& aBBox, LSET aLayers )
+    {
+        EDA_RECT  bbox = aBBox;
+        bbox.Normalize();
+
+        const int mmin[2] = { bbox.GetX(), bbox.GetY() };
+        const int mmax[2] = { bbox.GetRight(), bbox.GetBottom() };
+
+        for( PCB_LAYER_ID layer : ( aLayers & LSET::AllCuMask() ).Seq() )
+        {
+            if( !m_trees[layer] )
+                m_trees[layer].reset( new drc_rtree() );
+
+            m_trees[layer]->Insert( mmin, mmax, aIndex );
+        }
+    }
+
+    /**
+     * Function Clear()
+     * Removes all items from the trees
+     */
+    void Clear()
+    {
+        for( std::unique_ptr<drc_rtree>& tree : m_trees )
+            tree.reset();
+    }
+
+    /**
+     * Function Query()
+     * Collects the indexes of the items on the copper layers of aLayers whose bounding box
+     * intersects aBBox.  The indexes are sorted and unique, so that the caller can test the
+     * items in the order of its list.
+     */
+    void Query( const EDA_RECT& aBBox, LSET aLayers, std::vector<int>& aIndexes ) const
+    {
+        EDA_RECT  bbox = aBBox;
+        bbox.Normalize();
+
+        const int mmin[2] = { bbox.GetX(), bbox.GetY() };
+        const int mmax[2] = { bbox.GetRight(), bbox.GetBottom() };
+        int       layerCount = 0;
+
+        aIndexes.clear();
+
+        auto visitor = [&aIndexes]( const int& aIndex ) -> bool
+        {
+            aIndexes.push_back( aIndex );
+            return true;
+        };
+
+        for( PCB_LAYER_ID layer : ( aLayers & LSET::AllCuMask() ).Seq() )
+        {
+            if( m_trees[layer] )
+            {
+                m_trees[layer]->Search( mmin, mmax, visitor );
+                layerCount++;
+            }
+        }
+
+        std::sort( aIndexes.begin(), aIndexes.end() );
+
+        // Items spanning several layers are found once per layer
+        if( layerCount > 1 )
+            aIndexes.erase( std::unique( aIndexes.begin(), aIndexes.end() ), aIndexes.end() );
+    }
+
+private:
+    std::unique_ptr<drc_rtree> m_trees[MAX_CU_LAYERS];
+};
+
+#endif /* PCBNEW_DRC_RTREE_H_ */
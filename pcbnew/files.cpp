@@ -45,6 +45,7 @@
 #include <pcbnew_id.h>
 #include <io_mgr.h>
 #include <wildcards_and_files_ext.h>
+#include <zone_fill_cache.h>
 
 #include <class_board.h>
 #include <build_version.h>      // LEGACY_BOARD_FILE_VERSION
@@ -526,6 +527,14 @@ bool PCB_EDIT_FRAME::OpenProjectFiles( const std::vector<wxString>& aFileSet, in
         // This will rename the file if there is an autosave and the user want to recover
 		CheckForAutoSaveFile( fullFileName );
 
+        // The auto save file is gone now, whether it was recovered or not
+        {
+            wxFileName autoSaveFileName = fullFileName;
+
+            autoSaveFileName.SetName( GetAutoSaveFilePrefix() + autoSaveFileName.GetName() );
+            ZONE_FILL_CACHE::Remove( autoSaveFileName.GetFullPath() );
+        }
+
         try
         {
             PROPERTIES  props;
@@ -787,6 +796,9 @@ bool PCB_EDIT_FRAME::SavePcbFile( const wxString& aFileName, bool aCreateBackupF
     if( autoSaveFileName.FileExists() )
         wxRemoveFile( autoSaveFileName.GetFullPath() );
 
+    // The zone fill cache saved with the auto save file is of no use either
+    ZONE_FILL_CACHE::Remove( autoSaveFileName.GetFullPath() );
+
     if( !!backupFileName )
         upperTxt.Printf( _( "Backup file: \"%s\"" ), GetChars( backupFileName ) );
 
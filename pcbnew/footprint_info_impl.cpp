@@ -37,7 +37,6 @@
 #include <wildcards_and_files_ext.h>
 #include <widgets/progress_reporter.h>
 
-#include <thread>
 #include <mutex>
 
 
@@ -47,19 +46,20 @@ void FOOTPRINT_INFO_IMPL::load()
 
     wxASSERT( fptable );
 
-    const MODULE* footprint = fptable->GetEnumeratedFootprint( m_nickname, m_fpname );
+    FOOTPRINT_SUMMARY summary;
 
-    if( footprint == NULL ) // Should happen only with malformed/broken libraries
+    // Should fail only with malformed/broken libraries
+    if( fptable->GetEnumeratedFootprintSummary( m_nickname, m_fpname, summary ) )
     {
-        m_pad_count = 0;
-        m_unique_pad_count = 0;
+        m_pad_count = summary.m_PadCount;
+        m_unique_pad_count = summary.m_UniquePadCount;
+        m_keywords = summary.m_Keywords;
+        m_doc = summary.m_Doc;
     }
     else
     {
-        m_pad_count = footprint->GetPadCount( DO_NOT_INCLUDE_NPTH );
-        m_unique_pad_count = footprint->GetUniquePadCount( DO_NOT_INCLUDE_NPTH );
-        m_keywords = footprint->GetKeywords();
-        m_doc = footprint->GetDescription();
+        m_pad_count = 0;
+        m_unique_pad_count = 0;
     }
 
     m_loaded = true;
@@ -183,7 +183,7 @@ void FOOTPRINT_LIST_IMPL::StartWorkers( FP_LIB_TABLE* aTable, wxString const* aN
     m_count_finished.store( 0 );
     m_errors.clear();
     m_list.clear();
-    m_threads.clear();
+    m_workers.reset();
     m_queue_in.clear();
     m_queue_out.clear();
 
@@ -197,10 +197,10 @@ void FOOTPRINT_LIST_IMPL::StartWorkers( FP_LIB_TABLE* aTable, wxString const* aN
 
     m_loader->m_total_libs = m_queue_in.size();
 
+    m_workers = std::make_unique<TASK_GROUP>();
+
     for( unsigned i = 0; i < aNThreads; ++i )
-    {
-        m_threads.emplace_back( &FOOTPRINT_LIST_IMPL::loader_job, this );
-    }
+        m_workers->Run( [this]() { loader_job(); } );
 }
 
 void FOOTPRINT_LIST_IMPL::StopWorkers()
@@ -211,10 +211,10 @@ void FOOTPRINT_LIST_IMPL::StopWorkers()
     // exit on their next safe loop location when this is set).  Then we need to wait
     // for all threads to finish as closing the implementation will free the queues
     // that the threads write to.
-    for( auto& i : m_threads )
-        i.join();
+    if( m_workers )
+        m_workers->Wait();
 
-    m_threads.clear();
+    m_workers.reset();
     m_queue_in.clear();
     m_count_finished.store( 0 );
 
@@ -228,16 +228,14 @@ bool FOOTPRINT_LIST_IMPL::JoinWorkers()
     {
         std::lock_guard<std::mutex> lock1( m_join );
 
-        for( auto& i : m_threads )
-            i.join();
+        if( m_workers )
+            m_workers->Wait();
 
-        m_threads.clear();
+        m_workers.reset();
         m_queue_in.clear();
         m_count_finished.store( 0 );
     }
 
-    size_t total_count = m_queue_out.size();
-
     LOCALE_IO toggle_locale;
 
     // Parse the footprints in parallel. WARNING! This requires changing the locale, which is
@@ -248,11 +246,11 @@ bool FOOTPRINT_LIST_IMPL::JoinWorkers()
     // TODO: blast LOCALE_IO into the sun
 
     SYNC_QUEUE<std::unique_ptr<FOOTPRINT_INFO>> queue_parsed;
-    std::vector<std::thread>                    threads;
+    TASK_GROUP                                  workers;
 
-    for( size_t ii = 0; ii < std::thread::hardware_concurrency() + 1; ++ii )
+    for( size_t ii = 0; ii < THREAD_POOL::Get().GetThreadCount(); ++ii )
     {
-        threads.emplace_back( [this, &queue_parsed]() {
+        workers.Run( [this, &queue_parsed]() {
             wxString nickname;
 
             while( this->m_queue_out.pop( nickname ) && !m_cancelled )
@@ -296,16 +294,21 @@ bool FOOTPRINT_LIST_IMPL::JoinWorkers()
         } );
     }
 
-    while( !m_cancelled && (size_t)m_count_finished.load() < total_count )
-    {
-        if( m_progress_reporter && !m_progress_reporter->KeepRefreshing() )
-            m_cancelled = true;
+    std::function<bool()> progress;
 
-        wxMilliSleep( 30 );
+    if( m_progress_reporter )
+    {
+        progress = [this]() -> bool
+                   {
+                       // The workers check m_cancelled between libraries
+                       if( !m_progress_reporter->KeepRefreshing() )
+                           m_cancelled = true;
+
+                       return true;
+                   };
     }
 
-    for( auto& thr : threads )
-        thr.join();
+    workers.Wait( progress, 30 );
 
     std::unique_ptr<FOOTPRINT_INFO> fpi;
 
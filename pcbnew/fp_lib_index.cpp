@@ -0,0 +1,299 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <cstdlib>
+#include <vector>
+
+#include <wx/ffile.h>
+#include <wx/filename.h>
+
+#include <common.h>
+#include <macros.h>
+#include <md5_hash.h>
+#include <richio.h>
+#include <fp_lib_index.h>
+
+
+///> First field of the header line of an index file
+static const char* const INDEX_MAGIC = "kicad_fp_index";
+
+///> Version of the index file format, bumped when the fields of a line change
+static const int INDEX_VERSION = 2;
+
+///> Number of tab separated fields of an entry line
+static const size_t INDEX_FIELDS = 7;
+
+
+/**
+ * Function indexDirectory
+ * returns the directory of the footprint library indexes, in the user cache directory.
+ */
+static const wxString& indexDirectory()
+{
+    static const wxString dir = GetUserCacheDir() + wxFileName::GetPathSeparator() + "fp-index";
+
+    return dir;
+}
+
+
+/**
+ * Function escapeField
+ * appends @a aField to @a aLine, escaping the characters which separate fields and lines.
+ */
+static void escapeField( std::string& aLine, const wxString& aField )
+{
+    for( char c : std::string( aField.ToUTF8() ) )
+    {
+        switch( c )
+        {
+        case '\\': aLine += "\\\\"; break;
+        case '\t': aLine += "\\t";  break;
+        case '\n': aLine += "\\n";  break;
+        case '\r': aLine += "\\r";  break;
+        default:   aLine += c;      break;
+        }
+    }
+}
+
+
+static wxString unescapeField( const std::string& aField )
+{
+    std::string result;
+
+    result.reserve( aField.size() );
+
+    for( size_t ii = 0; ii < aField.size(); ++ii )
+    {
+        char c = aField[ii];
+
+        if( c == '\\' && ii + 1 < aField.size() )
+        {
+            switch( aField[++ii] )
+            {
+            case 't': c = '\t'; break;
+            case 'n': c = '\n'; break;
+            case 'r': c = '\r'; break;
+            default:  c = aField[ii]; break;
+            }
+        }
+
+        result += c;
+    }
+
+    return FROM_UTF8( result.c_str() );
+}
+
+
+/**
+ * Function splitLine
+ * splits a line of an index file at its tabs, dropping the line ending.
+ */
+static std::vector<std::string> splitLine( const char* aLine, unsigned aLength )
+{
+    std::vector<std::string> fields( 1 );
+
+    for( unsigned ii = 0; ii < aLength; ++ii )
+    {
+        char c = aLine[ii];
+
+        if( c == '\t' )
+            fields.emplace_back();
+        else if( c != '\n' && c != '\r' )
+            fields.back() += c;
+    }
+
+    return fields;
+}
+
+
+FP_LIB_INDEX::FP_LIB_INDEX( const wxString& aLibraryPath ) :
+        m_libraryPath( aLibraryPath ),
+        m_modified( false )
+{
+    // One index file per library, named after the hash of the library path
+    std::string path( aLibraryPath.ToUTF8() );
+
+    m_fileName = indexDirectory() + wxFileName::GetPathSeparator()
+                 + MD5_HASH::FormatData( path.c_str(), path.size() );
+}
+
+
+void FP_LIB_INDEX::Read()
+{
+    m_entries.clear();
+    m_modified = false;
+
+    if( !wxFileName::FileExists( m_fileName ) )
+        return;
+
+    try
+    {
+        FILE_LINE_READER reader( m_fileName );
+
+        if( !reader.ReadLine() )
+            return;
+
+        std::vector<std::string> header = splitLine( reader.Line(), reader.Length() );
+
+        // A stale format, or a hash collision between two library paths
+        if( header.size() != 3 || header[0] != INDEX_MAGIC
+                || atoi( header[1].c_str() ) != INDEX_VERSION
+                || unescapeField( header[2] ) != m_libraryPath )
+            return;
+
+        while( reader.ReadLine() )
+        {
+            std::vector<std::string> fields = splitLine( reader.Line(), reader.Length() );
+
+            if( fields.size() != INDEX_FIELDS )
+                continue;
+
+            ENTRY entry;
+
+            entry.m_Timestamp = strtoll( fields[1].c_str(), NULL, 10 );
+            entry.m_Hash = fields[2];
+            entry.m_Summary.m_PadCount = strtoul( fields[3].c_str(), NULL, 10 );
+            entry.m_Summary.m_UniquePadCount = strtoul( fields[4].c_str(), NULL, 10 );
+            entry.m_Summary.m_Keywords = unescapeField( fields[5] );
+            entry.m_Summary.m_Doc = unescapeField( fields[6] );
+
+            m_entries[ unescapeField( fields[0] ) ] = entry;
+        }
+    }
+    catch( const IO_ERROR& )
+    {
+        // An unreadable index is only a missing cache
+        m_entries.clear();
+    }
+}
+
+
+void FP_LIB_INDEX::Write()
+{
+    if( !m_modified )
+        return;
+
+    m_modified = false;
+
+    wxFileName dir( indexDirectory(), wxEmptyString );
+
+    if( !dir.DirExists() && !dir.Mkdir( wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL ) )
+        return;
+
+    std::string content = StrPrintf( "%s\t%d\t", INDEX_MAGIC, INDEX_VERSION );
+
+    escapeField( content, m_libraryPath );
+    content += '\n';
+
+    for( const std::pair<const wxString, ENTRY>& pair : m_entries )
+    {
+        const ENTRY&             entry = pair.second;
+        const FOOTPRINT_SUMMARY& summary = entry.m_Summary;
+
+        escapeField( content, pair.first );
+        content += StrPrintf( "\t%lld\t%s\t%u\t%u\t", entry.m_Timestamp, entry.m_Hash.c_str(),
+                              summary.m_PadCount, summary.m_UniquePadCount );
+        escapeField( content, summary.m_Keywords );
+        content += '\t';
+        escapeField( content, summary.m_Doc );
+        content += '\n';
+    }
+
+    // Write a temporary file and rename it, so that another instance never reads a partial
+    // index.  The index is only a cache, so failures are silently ignored.
+    wxFFile  file;
+    wxString tempName = wxFileName::CreateTempFileName( m_fileName, &file );
+
+    if( tempName.IsEmpty() )
+        return;
+
+    bool written = file.Write( content.data(), content.size() ) == content.size();
+
+    written &= file.Close();
+
+    if( !written || !wxRenameFile( tempName, m_fileName, true ) )
+        wxRemoveFile( tempName );
+}
+
+
+const FP_LIB_INDEX::ENTRY* FP_LIB_INDEX::Find( const wxString& aFootprintName,
+                                               long long aTimestamp ) const
+{
+    auto it = m_entries.find( aFootprintName );
+
+    if( it == m_entries.end() || it->second.m_Timestamp != aTimestamp )
+        return NULL;
+
+    return &it->second;
+}
+
+
+const FP_LIB_INDEX::ENTRY* FP_LIB_INDEX::FindContent( const wxString& aFootprintName,
+                                                      long long aTimestamp,
+                                                      const std::string& aHash )
+{
+    auto it = m_entries.find( aFootprintName );
+
+    if( it == m_entries.end() || it->second.m_Hash != aHash )
+        return NULL;
+
+    if( it->second.m_Timestamp != aTimestamp )
+    {
+        it->second.m_Timestamp = aTimestamp;
+        m_modified = true;
+    }
+
+    return &it->second;
+}
+
+
+void FP_LIB_INDEX::Set( const wxString& aFootprintName, const ENTRY& aEntry )
+{
+    m_entries[ aFootprintName ] = aEntry;
+    m_modified = true;
+}
+
+
+void FP_LIB_INDEX::Remove( const wxString& aFootprintName )
+{
+    if( m_entries.erase( aFootprintName ) )
+        m_modified = true;
+}
+
+
+void FP_LIB_INDEX::Prune( const std::function<bool( const wxString& )>& aKeep )
+{
+    for( auto it = m_entries.begin(); it != m_entries.end(); )
+    {
+        if( aKeep( it->first ) )
+        {
+            ++it;
+        }
+        else
+        {
+            it = m_entries.erase( it );
+            m_modified = true;
+        }
+    }
+}
+
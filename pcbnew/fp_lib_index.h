@@ -0,0 +1,110 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef FP_LIB_INDEX_H
+#define FP_LIB_INDEX_H
+
+#include <functional>
+#include <map>
+#include <string>
+
+#include <io_mgr.h>
+
+
+/**
+ * FP_LIB_INDEX
+ * is the persistent index of a footprint library directory.  It holds, for each footprint
+ * file, its modification time, the hash of its content and the summary of its footprint, so
+ * that the footprints of a library can be listed and searched without parsing their files.
+ *
+ * An entry is valid as long as the timestamp of its file did not change, or else as long as
+ * the content of its file did not change, e.g. after a checkout of the library.
+ *
+ * The index of each library is kept in the user cache directory, so that libraries are
+ * indexed even when their directory is read only.  The index is only a cache: failing to
+ * read or write it is not an error.
+ */
+class FP_LIB_INDEX
+{
+public:
+    struct ENTRY
+    {
+        long long         m_Timestamp = 0;  ///< modification time of the footprint file
+        std::string       m_Hash;           ///< MD5_HASH::FormatData() of the file content
+        FOOTPRINT_SUMMARY m_Summary;
+    };
+
+    FP_LIB_INDEX( const wxString& aLibraryPath );
+
+    /**
+     * Function Read
+     * reads the index of the library from the user cache directory, if there is one.
+     */
+    void Read();
+
+    /**
+     * Function Write
+     * writes the index of the library to the user cache directory, if it was modified.
+     */
+    void Write();
+
+    /**
+     * Function Find
+     * @return the entry of the footprint \a aFootprintName if its file still has the time
+     *         stamp \a aTimestamp, NULL otherwise.
+     */
+    const ENTRY* Find( const wxString& aFootprintName, long long aTimestamp ) const;
+
+    /**
+     * Function FindContent
+     * @return the entry of the footprint \a aFootprintName if its file still has the content
+     *         hash \a aHash, NULL otherwise.  The time stamp of the entry is then updated to
+     *         \a aTimestamp.
+     */
+    const ENTRY* FindContent( const wxString& aFootprintName, long long aTimestamp,
+                              const std::string& aHash );
+
+    void Set( const wxString& aFootprintName, const ENTRY& aEntry );
+
+    void Remove( const wxString& aFootprintName );
+
+    /**
+     * Function Prune
+     * removes the entries of the footprints for which \a aKeep returns false.
+     */
+    void Prune( const std::function<bool( const wxString& )>& aKeep );
+
+    /**
+     * Function GetFileName
+     * @return the index file of the library, in the user cache directory.
+     */
+    const wxString& GetFileName() const { return m_fileName; }
+
+private:
+    wxString                  m_libraryPath;
+    wxString                  m_fileName;       ///< the index file in the user cache directory
+    std::map<wxString, ENTRY> m_entries;
+    bool                      m_modified;
+};
+
+#endif  // FP_LIB_INDEX_H
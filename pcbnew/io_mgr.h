@@ -248,6 +248,23 @@ public:
 };
 
 
+/**
+ * FOOTPRINT_SUMMARY
+ * holds what the lists of footprints show of a footprint, so that they can be built without
+ * loading the footprints themselves, see PLUGIN::GetEnumeratedFootprintSummary().
+ */
+struct FOOTPRINT_SUMMARY
+{
+    wxString m_Keywords;
+    wxString m_Doc;
+    unsigned m_PadCount = 0;        ///< pads, not counting the NPTH pads
+    unsigned m_UniquePadCount = 0;  ///< pad names, not counting the NPTH pads
+
+    /// Sets the summary of \a aFootprint
+    void Assign( const MODULE* aFootprint );
+};
+
+
 /**
  * PLUGIN
  * is a base class that BOARD loading and saving plugins should derive from.
@@ -424,6 +441,19 @@ public:
                                                   const wxString& aFootprintName,
                                                   const PROPERTIES* aProperties = NULL );
 
+    /**
+     * Function GetEnumeratedFootprintSummary
+     * gets the summary of a footprint, for use after FootprintEnumerate().  Plugins keeping
+     * an index of their libraries can provide it without loading the footprint.  The default
+     * implementation gets it from GetEnumeratedFootprint().
+     *
+     * @return bool - false if the footprint was not found.
+     */
+    virtual bool GetEnumeratedFootprintSummary( const wxString& aLibraryPath,
+                                                const wxString& aFootprintName,
+                                                FOOTPRINT_SUMMARY& aSummary,
+                                                const PROPERTIES* aProperties = NULL );
+
     /**
      * Function FootprintExists
      * check for the existence of a footprint.
@@ -22,6 +22,7 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <atomic>
 #include <fctsys.h>
 #include <kicad_string.h>
 #include <common.h>
@@ -41,6 +42,9 @@
 #include <class_edge_mod.h>
 #include <pcb_plot_params.h>
 #include <zones.h>
+#include <zone_fill_cache.h>
+#include <fp_lib_index.h>
+#include <md5_hash.h>
 #include <kicad_plugin.h>
 #include <pcb_parser.h>
 #include <pcbnew_settings.h>
@@ -52,6 +56,7 @@
 #include <connectivity/connectivity_data.h>
 #include <convert_basic_shapes_to_polygon.h>    // for enum RECT_CHAMFER_POSITIONS definition
 #include <kiface_i.h>
+#include <thread_pool.h>
 
 #include <advanced_config.h> // for pad pin function and pad property feature management
 
@@ -86,19 +91,41 @@ void filterNetClass( const BOARD& aBoard, NETCLASS& aNetClass )
 class FP_CACHE_ITEM
 {
     WX_FILENAME             m_filename;
-    std::unique_ptr<MODULE> m_module;
+    std::unique_ptr<MODULE> m_module;       // NULL until the footprint file is parsed
+    FOOTPRINT_SUMMARY       m_summary;
 
 public:
     FP_CACHE_ITEM( MODULE* aModule, const WX_FILENAME& aFileName );
 
-    const WX_FILENAME& GetFileName() const { return m_filename; }
-    const MODULE*      GetModule()   const { return m_module.get(); }
+    /**
+     * Constructor for a footprint known from the library index, whose file is not parsed
+     * until its MODULE is needed.
+     */
+    FP_CACHE_ITEM( const WX_FILENAME& aFileName, const FOOTPRINT_SUMMARY& aSummary );
+
+    const WX_FILENAME&       GetFileName() const { return m_filename; }
+    const MODULE*            GetModule()   const { return m_module.get(); }
+    const FOOTPRINT_SUMMARY& GetSummary()  const { return m_summary; }
+
+    void SetModule( MODULE* aModule )
+    {
+        m_module.reset( aModule );
+        m_summary.Assign( aModule );
+    }
 };
 
 
 FP_CACHE_ITEM::FP_CACHE_ITEM( MODULE* aModule, const WX_FILENAME& aFileName ) :
     m_filename( aFileName ),
     m_module( aModule )
+{
+    m_summary.Assign( aModule );
+}
+
+
+FP_CACHE_ITEM::FP_CACHE_ITEM( const WX_FILENAME& aFileName, const FOOTPRINT_SUMMARY& aSummary ) :
+    m_filename( aFileName ),
+    m_summary( aSummary )
 { }
 
 
@@ -118,6 +145,8 @@ class FP_CACHE
                                         // m_cache_timestamp against all the files.
     long long       m_cache_timestamp;  // A hash of the timestamps for all the footprint
                                         // files.
+    FP_LIB_INDEX    m_index;            // Summaries of the footprint files, to parse only
+                                        // the files which changed since the last Load().
 
 public:
     FP_CACHE( PCB_IO* aOwner, const wxString& aLibraryPath );
@@ -143,6 +172,14 @@ public:
 
     void Remove( const wxString& aFootprintName );
 
+    /**
+     * Function GetModule
+     * returns the MODULE of \a aItem, parsing its footprint file if it was loaded from the
+     * library index.
+     * @throw IO_ERROR if the footprint file cannot be read or parsed.
+     */
+    const MODULE* GetModule( FP_CACHE_ITEM* aItem );
+
     /**
      * Function GetTimestamp
      * Generate a timestamp representing all source files in the cache (including the
@@ -173,7 +210,8 @@ public:
 };
 
 
-FP_CACHE::FP_CACHE( PCB_IO* aOwner, const wxString& aLibraryPath )
+FP_CACHE::FP_CACHE( PCB_IO* aOwner, const wxString& aLibraryPath ) :
+    m_index( aLibraryPath )
 {
     m_owner = aOwner;
     m_lib_raw_path = aLibraryPath;
@@ -206,6 +244,13 @@ void FP_CACHE::Save( MODULE* aModule )
 
         WX_FILENAME fn = it->second->GetFileName();
 
+        // A footprint which was never parsed is unchanged since it was read from its file
+        if( !it->second->GetModule() )
+        {
+            m_cache_timestamp += fn.GetTimestamp();
+            continue;
+        }
+
         wxString tempFileName =
 #ifdef USE_TMP_FILE
         wxFileName::CreateTempFileName( fn.GetPath() );
@@ -241,9 +286,19 @@ void FP_CACHE::Save( MODULE* aModule )
             THROW_IO_ERROR( msg );
         }
 #endif
-        m_cache_timestamp += fn.GetTimestamp();
+        FP_LIB_INDEX::ENTRY       entry;
+        MAPPED_FILE_LINE_READER   reader( fn.GetFullPath() );
+
+        entry.m_Timestamp = fn.GetTimestamp();
+        entry.m_Hash = MD5_HASH::FormatData( reader.Data(), reader.Size() );
+        entry.m_Summary = it->second->GetSummary();
+        m_index.Set( it->first, entry );
+
+        m_cache_timestamp += entry.m_Timestamp;
     }
 
+    m_index.Write();
+
     m_cache_timestamp += m_lib_path.GetModificationTime().GetValue().GetValue();
 
     // If we've saved the full cache, we clear the dirty flag.
@@ -274,6 +329,8 @@ void FP_CACHE::Load()
     // the filename thereafter.
     WX_FILENAME fn( m_lib_raw_path, wxT( "dummyName" ) );
 
+    m_index.Read();
+
     if( dir.GetFirst( &fullName, fileSpec ) )
     {
         wxString cacheError;
@@ -285,17 +342,47 @@ void FP_CACHE::Load()
             // Queue I/O errors so only files that fail to parse don't get loaded.
             try
             {
-                FILE_LINE_READER    reader( fn.GetFullPath() );
+                wxString    fpName = fn.GetName();
+                long long   timestamp = fn.GetTimestamp();
 
-                m_owner->m_parser->SetLineReader( &reader );
+                // Footprints unchanged since they were indexed are only parsed on demand.
+                // A file with a new time stamp but the same content, e.g. after a checkout of
+                // the library, is recognized by its hash.
+                const FP_LIB_INDEX::ENTRY* entry = m_index.Find( fpName, timestamp );
+                std::unique_ptr<MAPPED_FILE_LINE_READER> reader;
+                std::string hash;
 
-                MODULE*     footprint = (MODULE*) m_owner->m_parser->Parse();
-                wxString    fpName = fn.GetName();
+                if( !entry )
+                {
+                    reader.reset( new MAPPED_FILE_LINE_READER( fn.GetFullPath() ) );
+                    hash = MD5_HASH::FormatData( reader->Data(), reader->Size() );
+                    entry = m_index.FindContent( fpName, timestamp, hash );
+                }
+
+                if( entry )
+                {
+                    m_modules.insert( fpName, new FP_CACHE_ITEM( fn, entry->m_Summary ) );
+                }
+                else
+                {
+                    m_owner->m_parser->SetLineReader( reader.get() );
 
-                footprint->SetFPID( LIB_ID( wxEmptyString, fpName ) );
-                m_modules.insert( fpName, new FP_CACHE_ITEM( footprint, fn ) );
+                    MODULE* footprint = (MODULE*) m_owner->m_parser->Parse();
 
-                m_cache_timestamp += fn.GetTimestamp();
+                    footprint->SetFPID( LIB_ID( wxEmptyString, fpName ) );
+
+                    FP_CACHE_ITEM*      item = new FP_CACHE_ITEM( footprint, fn );
+                    FP_LIB_INDEX::ENTRY newEntry;
+
+                    newEntry.m_Timestamp = timestamp;
+                    newEntry.m_Hash = hash;
+                    newEntry.m_Summary = item->GetSummary();
+                    m_index.Set( fpName, newEntry );
+
+                    m_modules.insert( fpName, item );
+                }
+
+                m_cache_timestamp += timestamp;
             }
             catch( const IO_ERROR& ioe )
             {
@@ -306,12 +393,38 @@ void FP_CACHE::Load()
             }
         } while( dir.GetNext( &fullName ) );
 
+        // Forget the footprints which were removed from the library, then save the index
+        // before reporting the files which could not be parsed.
+        m_index.Prune( [&]( const wxString& aName )
+                       {
+                           return m_modules.find( aName ) != m_modules.end();
+                       } );
+        m_index.Write();
+
         if( !cacheError.IsEmpty() )
             THROW_IO_ERROR( cacheError );
     }
 }
 
 
+const MODULE* FP_CACHE::GetModule( FP_CACHE_ITEM* aItem )
+{
+    if( !aItem->GetModule() )
+    {
+        FILE_LINE_READER reader( aItem->GetFileName().GetFullPath() );
+
+        m_owner->m_parser->SetLineReader( &reader );
+
+        MODULE* footprint = (MODULE*) m_owner->m_parser->Parse();
+
+        footprint->SetFPID( LIB_ID( wxEmptyString, aItem->GetFileName().GetName() ) );
+        aItem->SetModule( footprint );
+    }
+
+    return aItem->GetModule();
+}
+
+
 void FP_CACHE::Remove( const wxString& aFootprintName )
 {
     MODULE_CITER it = m_modules.find( aFootprintName );
@@ -328,6 +441,9 @@ void FP_CACHE::Remove( const wxString& aFootprintName )
     wxString fullPath = it->second->GetFileName().GetFullPath();
     m_modules.erase( aFootprintName );
     wxRemoveFile( fullPath );
+
+    m_index.Remove( aFootprintName );
+    m_index.Write();
 }
 
 
@@ -364,16 +480,25 @@ void PCB_IO::Save( const wxString& aFileName, BOARD* aBoard, const PROPERTIES* a
     // Prepare net mapping that assures that net codes saved in a file are consecutive integers
     m_mapping->SetBoard( aBoard );
 
-    FILE_OUTPUTFORMATTER    formatter( aFileName );
+    {
+        FILE_OUTPUTFORMATTER    formatter( aFileName );
 
-    m_out = &formatter;     // no ownership
+        m_out = &formatter;     // no ownership
 
-    m_out->Print( 0, "(kicad_pcb (version %d) (host pcbnew %s)\n", SEXPR_BOARD_FILE_VERSION,
-                  formatter.Quotew( GetBuildVersion() ).c_str() );
+        m_out->Print( 0, "(kicad_pcb (version %d) (host pcbnew %s)\n", SEXPR_BOARD_FILE_VERSION,
+                      formatter.Quotew( GetBuildVersion() ).c_str() );
 
-    Format( aBoard, 1 );
+        Format( aBoard, 1 );
 
-    m_out->Print( 0, ")\n" );
+        m_out->Print( 0, ")\n" );
+    }
+
+    m_out = NULL;
+
+    // The cache is hashed from the file, so it must be closed first.  The cache is optional,
+    // failing to write it is not an error.
+    if( ADVANCED_CFG::GetCfg().m_EnableZoneFillCache )
+        ZONE_FILL_CACHE::Save( aFileName, aBoard );
 }
 
 
@@ -487,52 +612,52 @@ void PCB_IO::formatSetup( BOARD* aBoard, int aNestLevel ) const
 
     // Save current default track width, for compatibility with older Pcbnew version;
     m_out->Print( aNestLevel+1, "(last_trace_width %s)\n",
-                  FormatInternalUnits( dsnSettings.GetCurrentTrackWidth() ).c_str() );
+                  FMT_IU( dsnSettings.GetCurrentTrackWidth() ).c_str() );
 
     // Save custom track widths list (the first is not saved here: it's the netclass value)
     for( unsigned ii = 1; ii < dsnSettings.m_TrackWidthList.size(); ii++ )
     {
         m_out->Print( aNestLevel+1, "(user_trace_width %s)\n",
-                      FormatInternalUnits( dsnSettings.m_TrackWidthList[ii] ).c_str() );
+                      FMT_IU( dsnSettings.m_TrackWidthList[ii] ).c_str() );
     }
 
     m_out->Print( aNestLevel+1, "(trace_clearance %s)\n",
-                  FormatInternalUnits( dsnSettings.GetDefault()->GetClearance() ).c_str() );
+                  FMT_IU( dsnSettings.GetDefault()->GetClearance() ).c_str() );
 
     // ZONE_SETTINGS
     m_out->Print( aNestLevel+1, "(zone_clearance %s)\n",
-                  FormatInternalUnits( aBoard->GetZoneSettings().m_ZoneClearance ).c_str() );
+                  FMT_IU( aBoard->GetZoneSettings().m_ZoneClearance ).c_str() );
     m_out->Print( aNestLevel+1, "(zone_45_only %s)\n",
                   aBoard->GetZoneSettings().m_Zone_45_Only ? "yes" : "no" );
 
     m_out->Print( aNestLevel+1, "(trace_min %s)\n",
-                  FormatInternalUnits( dsnSettings.m_TrackMinWidth ).c_str() );
+                  FMT_IU( dsnSettings.m_TrackMinWidth ).c_str() );
     m_out->Print( aNestLevel+1, "(clearance_min %s)\n",
-                  FormatInternalUnits( dsnSettings.m_MinClearance ).c_str() );
+                  FMT_IU( dsnSettings.m_MinClearance ).c_str() );
     m_out->Print( aNestLevel+1, "(via_min_size %s)\n",
-                  FormatInternalUnits( dsnSettings.m_ViasMinSize ).c_str() );
+                  FMT_IU( dsnSettings.m_ViasMinSize ).c_str() );
     m_out->Print( aNestLevel+1, "(through_hole_min %s)\n",
-                  FormatInternalUnits( dsnSettings.m_MinThroughDrill ).c_str() );
+                  FMT_IU( dsnSettings.m_MinThroughDrill ).c_str() );
 
     // Save current default via size, for compatibility with older Pcbnew version;
     m_out->Print( aNestLevel+1, "(via_size %s)\n",
-                  FormatInternalUnits( dsnSettings.GetDefault()->GetViaDiameter() ).c_str() );
+                  FMT_IU( dsnSettings.GetDefault()->GetViaDiameter() ).c_str() );
     m_out->Print( aNestLevel+1, "(via_drill %s)\n",
-                  FormatInternalUnits( dsnSettings.GetDefault()->GetViaDrill() ).c_str() );
+                  FMT_IU( dsnSettings.GetDefault()->GetViaDrill() ).c_str() );
 
     // Save custom via dimensions list (the first is not saved here: it's the netclass value)
     for( unsigned ii = 1; ii < dsnSettings.m_ViasDimensionsList.size(); ii++ )
         m_out->Print( aNestLevel+1, "(user_via %s %s)\n",
-                      FormatInternalUnits( dsnSettings.m_ViasDimensionsList[ii].m_Diameter ).c_str(),
-                      FormatInternalUnits( dsnSettings.m_ViasDimensionsList[ii].m_Drill ).c_str() );
+                      FMT_IU( dsnSettings.m_ViasDimensionsList[ii].m_Diameter ).c_str(),
+                      FMT_IU( dsnSettings.m_ViasDimensionsList[ii].m_Drill ).c_str() );
 
     // Save custom diff-pair dimensions (the first is not saved here: it's the netclass value)
     for( unsigned ii = 1; ii < dsnSettings.m_DiffPairDimensionsList.size(); ii++ )
     {
         m_out->Print( aNestLevel+1, "(user_diff_pair %s %s %s)\n",
-                      FormatInternalUnits( dsnSettings.m_DiffPairDimensionsList[ii].m_Width ).c_str(),
-                      FormatInternalUnits( dsnSettings.m_DiffPairDimensionsList[ii].m_Gap ).c_str(),
-                      FormatInternalUnits( dsnSettings.m_DiffPairDimensionsList[ii].m_ViaGap ).c_str() );
+                      FMT_IU( dsnSettings.m_DiffPairDimensionsList[ii].m_Width ).c_str(),
+                      FMT_IU( dsnSettings.m_DiffPairDimensionsList[ii].m_Gap ).c_str(),
+                      FMT_IU( dsnSettings.m_DiffPairDimensionsList[ii].m_ViaGap ).c_str() );
     }
 
     // for old versions compatibility:
@@ -540,18 +665,18 @@ void PCB_IO::formatSetup( BOARD* aBoard, int aNestLevel ) const
         m_out->Print( aNestLevel+1, "(blind_buried_vias_allowed yes)\n" );
 
     m_out->Print( aNestLevel+1, "(uvia_size %s)\n",
-                  FormatInternalUnits( dsnSettings.GetDefault()->GetuViaDiameter() ).c_str() );
+                  FMT_IU( dsnSettings.GetDefault()->GetuViaDiameter() ).c_str() );
     m_out->Print( aNestLevel+1, "(uvia_drill %s)\n",
-                  FormatInternalUnits( dsnSettings.GetDefault()->GetuViaDrill() ).c_str() );
+                  FMT_IU( dsnSettings.GetDefault()->GetuViaDrill() ).c_str() );
     m_out->Print( aNestLevel+1, "(uvias_allowed %s)\n",
                   ( dsnSettings.m_MicroViasAllowed ) ? "yes" : "no" );
     m_out->Print( aNestLevel+1, "(uvia_min_size %s)\n",
-                  FormatInternalUnits( dsnSettings.m_MicroViasMinSize ).c_str() );
+                  FMT_IU( dsnSettings.m_MicroViasMinSize ).c_str() );
     m_out->Print( aNestLevel+1, "(uvia_min_drill %s)\n",
-                  FormatInternalUnits( dsnSettings.m_MicroViasMinDrill ).c_str() );
+                  FMT_IU( dsnSettings.m_MicroViasMinDrill ).c_str() );
 
     m_out->Print( aNestLevel+1, "(max_error %s)\n",
-                  FormatInternalUnits( dsnSettings.m_MaxError ).c_str() );
+                  FMT_IU( dsnSettings.m_MaxError ).c_str() );
 
     // Store this option only if it is not the legacy option:
     if( dsnSettings.m_ZoneUseNoOutlineInFill )
@@ -560,34 +685,34 @@ void PCB_IO::formatSetup( BOARD* aBoard, int aNestLevel ) const
     formatDefaults( dsnSettings, aNestLevel+1 );
 
     m_out->Print( aNestLevel+1, "(pad_size %s %s)\n",
-                  FormatInternalUnits( dsnSettings.m_Pad_Master.GetSize().x ).c_str(),
-                  FormatInternalUnits( dsnSettings.m_Pad_Master.GetSize().y ).c_str() );
+                  FMT_IU( dsnSettings.m_Pad_Master.GetSize().x ).c_str(),
+                  FMT_IU( dsnSettings.m_Pad_Master.GetSize().y ).c_str() );
     m_out->Print( aNestLevel+1, "(pad_drill %s)\n",
-                  FormatInternalUnits( dsnSettings.m_Pad_Master.GetDrillSize().x ).c_str() );
+                  FMT_IU( dsnSettings.m_Pad_Master.GetDrillSize().x ).c_str() );
 
     m_out->Print( aNestLevel+1, "(pad_to_mask_clearance %s)\n",
-                  FormatInternalUnits( dsnSettings.m_SolderMaskMargin ).c_str() );
+                  FMT_IU( dsnSettings.m_SolderMaskMargin ).c_str() );
 
     if( dsnSettings.m_SolderMaskMinWidth )
         m_out->Print( aNestLevel+1, "(solder_mask_min_width %s)\n",
-                      FormatInternalUnits( dsnSettings.m_SolderMaskMinWidth ).c_str() );
+                      FMT_IU( dsnSettings.m_SolderMaskMinWidth ).c_str() );
 
     if( dsnSettings.m_SolderPasteMargin != 0 )
         m_out->Print( aNestLevel+1, "(pad_to_paste_clearance %s)\n",
-                      FormatInternalUnits( dsnSettings.m_SolderPasteMargin ).c_str() );
+                      FMT_IU( dsnSettings.m_SolderPasteMargin ).c_str() );
 
     if( dsnSettings.m_SolderPasteMarginRatio != 0 )
         m_out->Print( aNestLevel+1, "(pad_to_paste_clearance_ratio %s)\n",
                       Double2Str( dsnSettings.m_SolderPasteMarginRatio ).c_str() );
 
     m_out->Print( aNestLevel+1, "(aux_axis_origin %s %s)\n",
-                  FormatInternalUnits( aBoard->GetAuxOrigin().x ).c_str(),
-                  FormatInternalUnits( aBoard->GetAuxOrigin().y ).c_str() );
+                  FMT_IU( aBoard->GetAuxOrigin().x ).c_str(),
+                  FMT_IU( aBoard->GetAuxOrigin().y ).c_str() );
 
     if( aBoard->GetGridOrigin().x || aBoard->GetGridOrigin().y )
         m_out->Print( aNestLevel+1, "(grid_origin %s %s)\n",
-                      FormatInternalUnits( aBoard->GetGridOrigin().x ).c_str(),
-                      FormatInternalUnits( aBoard->GetGridOrigin().y ).c_str() );
+                      FMT_IU( aBoard->GetGridOrigin().x ).c_str(),
+                      FMT_IU( aBoard->GetGridOrigin().y ).c_str() );
 
     m_out->Print( aNestLevel+1, "(visible_elements %X)\n",
                   dsnSettings.GetVisibleElements() );
@@ -603,47 +728,47 @@ void PCB_IO::formatDefaults( const BOARD_DESIGN_SETTINGS& aSettings, int aNestLe
     m_out->Print( aNestLevel, "(defaults\n" );
 
     m_out->Print( aNestLevel+1, "(edge_clearance %s)\n",
-                  FormatInternalUnits( aSettings.m_CopperEdgeClearance ).c_str() );
+                  FMT_IU( aSettings.m_CopperEdgeClearance ).c_str() );
 
     m_out->Print( aNestLevel+1, "(edge_cuts_line_width %s)\n",
-                  FormatInternalUnits( aSettings.m_LineThickness[ LAYER_CLASS_EDGES ] ).c_str() );
+                  FMT_IU( aSettings.m_LineThickness[ LAYER_CLASS_EDGES ] ).c_str() );
 
     m_out->Print( aNestLevel+1, "(courtyard_line_width %s)\n",
-                  FormatInternalUnits( aSettings.m_LineThickness[ LAYER_CLASS_COURTYARD ] ).c_str() );
+                  FMT_IU( aSettings.m_LineThickness[ LAYER_CLASS_COURTYARD ] ).c_str() );
 
     m_out->Print( aNestLevel+1, "(copper_line_width %s)\n",
-                  FormatInternalUnits( aSettings.m_LineThickness[ LAYER_CLASS_COPPER ] ).c_str() );
+                  FMT_IU( aSettings.m_LineThickness[ LAYER_CLASS_COPPER ] ).c_str() );
     m_out->Print( aNestLevel+1, "(copper_text_dims (size %s %s) (thickness %s)%s%s)\n",
-                  FormatInternalUnits( aSettings.m_TextSize[ LAYER_CLASS_COPPER ].x ).c_str(),
-                  FormatInternalUnits( aSettings.m_TextSize[ LAYER_CLASS_COPPER ].y ).c_str(),
-                  FormatInternalUnits( aSettings.m_TextThickness[ LAYER_CLASS_COPPER ] ).c_str(),
+                  FMT_IU( aSettings.m_TextSize[ LAYER_CLASS_COPPER ].x ).c_str(),
+                  FMT_IU( aSettings.m_TextSize[ LAYER_CLASS_COPPER ].y ).c_str(),
+                  FMT_IU( aSettings.m_TextThickness[ LAYER_CLASS_COPPER ] ).c_str(),
                   aSettings.m_TextItalic[ LAYER_CLASS_COPPER ] ? " italic" : "",
                   aSettings.m_TextUpright[ LAYER_CLASS_COPPER ] ? " keep_upright" : "" );
 
     m_out->Print( aNestLevel+1, "(silk_line_width %s)\n",
-                  FormatInternalUnits( aSettings.m_LineThickness[ LAYER_CLASS_SILK ] ).c_str() );
+                  FMT_IU( aSettings.m_LineThickness[ LAYER_CLASS_SILK ] ).c_str() );
     m_out->Print( aNestLevel+1, "(silk_text_dims (size %s %s) (thickness %s)%s%s)\n",
-                  FormatInternalUnits( aSettings.m_TextSize[ LAYER_CLASS_SILK ].x ).c_str(),
-                  FormatInternalUnits( aSettings.m_TextSize[ LAYER_CLASS_SILK ].y ).c_str(),
-                  FormatInternalUnits( aSettings.m_TextThickness[ LAYER_CLASS_SILK ] ).c_str(),
+                  FMT_IU( aSettings.m_TextSize[ LAYER_CLASS_SILK ].x ).c_str(),
+                  FMT_IU( aSettings.m_TextSize[ LAYER_CLASS_SILK ].y ).c_str(),
+                  FMT_IU( aSettings.m_TextThickness[ LAYER_CLASS_SILK ] ).c_str(),
                   aSettings.m_TextItalic[ LAYER_CLASS_SILK ] ? " italic" : "",
                   aSettings.m_TextUpright[ LAYER_CLASS_SILK ] ? " keep_upright" : "" );
 
     m_out->Print( aNestLevel+1, "(fab_layers_line_width %s)\n",
-                  FormatInternalUnits( aSettings.m_LineThickness[ LAYER_CLASS_FAB ] ).c_str() );
+                  FMT_IU( aSettings.m_LineThickness[ LAYER_CLASS_FAB ] ).c_str() );
     m_out->Print( aNestLevel+1, "(fab_layers_text_dims (size %s %s) (thickness %s)%s%s)\n",
-                  FormatInternalUnits( aSettings.m_TextSize[ LAYER_CLASS_FAB ].x ).c_str(),
-                  FormatInternalUnits( aSettings.m_TextSize[ LAYER_CLASS_FAB ].y ).c_str(),
-                  FormatInternalUnits( aSettings.m_TextThickness[ LAYER_CLASS_FAB ] ).c_str(),
+                  FMT_IU( aSettings.m_TextSize[ LAYER_CLASS_FAB ].x ).c_str(),
+                  FMT_IU( aSettings.m_TextSize[ LAYER_CLASS_FAB ].y ).c_str(),
+                  FMT_IU( aSettings.m_TextThickness[ LAYER_CLASS_FAB ] ).c_str(),
                   aSettings.m_TextItalic[ LAYER_CLASS_OTHERS ] ? " italic" : "",
                   aSettings.m_TextUpright[ LAYER_CLASS_OTHERS ] ? " keep_upright" : "" );
 
     m_out->Print( aNestLevel+1, "(other_layers_line_width %s)\n",
-                  FormatInternalUnits( aSettings.m_LineThickness[ LAYER_CLASS_OTHERS ] ).c_str() );
+                  FMT_IU( aSettings.m_LineThickness[ LAYER_CLASS_OTHERS ] ).c_str() );
     m_out->Print( aNestLevel+1, "(other_layers_text_dims (size %s %s) (thickness %s)%s%s)\n",
-                  FormatInternalUnits( aSettings.m_TextSize[ LAYER_CLASS_OTHERS ].x ).c_str(),
-                  FormatInternalUnits( aSettings.m_TextSize[ LAYER_CLASS_OTHERS ].y ).c_str(),
-                  FormatInternalUnits( aSettings.m_TextThickness[ LAYER_CLASS_OTHERS ] ).c_str(),
+                  FMT_IU( aSettings.m_TextSize[ LAYER_CLASS_OTHERS ].x ).c_str(),
+                  FMT_IU( aSettings.m_TextSize[ LAYER_CLASS_OTHERS ].y ).c_str(),
+                  FMT_IU( aSettings.m_TextThickness[ LAYER_CLASS_OTHERS ] ).c_str(),
                   aSettings.m_TextItalic[ LAYER_CLASS_OTHERS ] ? " italic" : "",
                   aSettings.m_TextUpright[ LAYER_CLASS_OTHERS ] ? " keep_upright" : "" );
 
@@ -662,7 +787,7 @@ void PCB_IO::formatGeneral( BOARD* aBoard, int aNestLevel ) const
     m_out->Print( aNestLevel, "(general\n" );
     // Write Bounding box info
     m_out->Print( aNestLevel+1, "(thickness %s)\n",
-                  FormatInternalUnits( dsnSettings.GetBoardThickness() ).c_str() );
+                  FMT_IU( dsnSettings.GetBoardThickness() ).c_str() );
 
     m_out->Print( aNestLevel+1, "(drawings %u)\n", (unsigned)aBoard->Drawings().size() );
     m_out->Print( aNestLevel + 1, "(tracks %u)\n", (unsigned)aBoard->Tracks().size() );
@@ -781,40 +906,83 @@ void PCB_IO::format( BOARD* aBoard, int aNestLevel ) const
 {
     formatHeader( aBoard, aNestLevel );
 
-    // Save the modules.
-    for( auto module : aBoard->Modules() )
+    // The modules, the graphical items on the board (not owned by a module), the tracks and
+    // vias, and the polygon (which are the newer technology) zones.
+    // Do not save MARKER_PCBs, they can be regenerated easily.
+    std::vector<BOARD_ITEM*> items;
+
+    items.insert( items.end(), aBoard->Modules().begin(), aBoard->Modules().end() );
+    items.insert( items.end(), aBoard->Drawings().begin(), aBoard->Drawings().end() );
+
+    const size_t drawingsEnd = items.size();
+
+    items.insert( items.end(), aBoard->Tracks().begin(), aBoard->Tracks().end() );
+
+    const size_t tracksEnd = items.size();
+
+    items.insert( items.end(), aBoard->Zones().begin(), aBoard->Zones().end() );
+
+    // Each module is followed by a blank line, and so are the drawings and the tracks
+    auto formatItems = [&]( const PCB_IO& aFormatter, size_t aFirst, size_t aLast )
     {
-        Format( module, aNestLevel );
-        m_out->Print( 0, "\n" );
+        for( size_t ii = aFirst; ii < aLast; ++ii )
+        {
+            aFormatter.Format( items[ii], aNestLevel );
+
+            if( items[ii]->Type() == PCB_MODULE_T || ii + 1 == drawingsEnd
+                    || ii + 1 == tracksEnd )
+            {
+                aFormatter.m_out->Print( 0, "\n" );
+            }
+        }
+    };
+
+    // Runs of consecutive items are formatted on the thread pool, each run into its own
+    // buffer.  The buffers are then output in the order of the items, so the file is the
+    // same as when formatting the items one after another.
+    const size_t             runSize = 32;
+    std::vector<std::string> runs( ( items.size() + runSize - 1 ) / runSize );
+    size_t                   parallelTaskCount =
+            std::min<size_t>( THREAD_POOL::Get().GetThreadCount(), runs.size() );
+
+    if( parallelTaskCount <= 1 )
+    {
+        formatItems( *this, 0, items.size() );
+        return;
     }
 
-    // Save the graphical items on the board (not owned by a module)
-    for( auto item : aBoard->Drawings() )
-        Format( item, aNestLevel );
+    std::atomic<size_t> nextRun( 0 );
+    TASK_GROUP          tasks;
 
-    if( aBoard->Drawings().size() )
-        m_out->Print( 0, "\n" );
+    auto formatRuns = [&]()
+    {
+        PCB_IO worker( *this );
 
-    // Do not save MARKER_PCBs, they can be regenerated easily.
+        for( size_t i = nextRun++; i < runs.size(); i = nextRun++ )
+        {
+            formatItems( worker, i * runSize, std::min( ( i + 1 ) * runSize, items.size() ) );
 
-    // Save the tracks and vias.
-    for( auto track : aBoard->Tracks() )
-        Format( track, aNestLevel );
+            runs[i] = worker.m_sf.GetString();
+            worker.m_sf.Clear();
+        }
+    };
 
-    if( aBoard->Tracks().size() )
-        m_out->Print( 0, "\n" );
+    for( size_t ii = 0; ii < parallelTaskCount; ++ii )
+        tasks.Run( formatRuns );
 
-    // Save the polygon (which are the newer technology) zones.
-    for( int i = 0; i < aBoard->GetAreaCount();  ++i )
-        Format( aBoard->GetArea( i ), aNestLevel );
+    // Rethrows the first error of the tasks, once they are all done
+    tasks.Wait();
+
+    for( const std::string& run : runs )
+        m_out->Print( 0, "%s", run.c_str() );
 }
 
 
 void PCB_IO::format( DIMENSION* aDimension, int aNestLevel ) const
 {
     m_out->Print( aNestLevel, "(dimension %s (width %s)",
-                  FormatInternalUnits( aDimension->GetValue() ).c_str(),
-                  FormatInternalUnits( aDimension->GetWidth() ).c_str() );
+                  FMT_IU( aDimension->GetValue() ).c_str(),
+                  FMT_IU( aDimension->GetWidth() ).c_str() );
 
     formatLayer( aDimension );
 
@@ -825,46 +993,46 @@ void PCB_IO::format( DIMENSION* aDimension, int aNestLevel ) const
     Format( &aDimension->Text(), aNestLevel+1 );
 
     m_out->Print( aNestLevel+1, "(feature1 (pts (xy %s %s) (xy %s %s)))\n",
-                  FormatInternalUnits( aDimension->m_featureLineDO.x ).c_str(),
-                  FormatInternalUnits( aDimension->m_featureLineDO.y ).c_str(),
-                  FormatInternalUnits( aDimension->m_featureLineDF.x ).c_str(),
-                  FormatInternalUnits( aDimension->m_featureLineDF.y ).c_str() );
+                  FMT_IU( aDimension->m_featureLineDO.x ).c_str(),
+                  FMT_IU( aDimension->m_featureLineDO.y ).c_str(),
+                  FMT_IU( aDimension->m_featureLineDF.x ).c_str(),
+                  FMT_IU( aDimension->m_featureLineDF.y ).c_str() );
 
     m_out->Print( aNestLevel+1, "(feature2 (pts (xy %s %s) (xy %s %s)))\n",
-                  FormatInternalUnits( aDimension->m_featureLineGO.x ).c_str(),
-                  FormatInternalUnits( aDimension->m_featureLineGO.y ).c_str(),
-                  FormatInternalUnits( aDimension->m_featureLineGF.x ).c_str(),
-                  FormatInternalUnits( aDimension->m_featureLineGF.y ).c_str() );
+                  FMT_IU( aDimension->m_featureLineGO.x ).c_str(),
+                  FMT_IU( aDimension->m_featureLineGO.y ).c_str(),
+                  FMT_IU( aDimension->m_featureLineGF.x ).c_str(),
+                  FMT_IU( aDimension->m_featureLineGF.y ).c_str() );
 
     m_out->Print( aNestLevel+1, "(crossbar (pts (xy %s %s) (xy %s %s)))\n",
-                  FormatInternalUnits( aDimension->m_crossBarO.x ).c_str(),
-                  FormatInternalUnits( aDimension->m_crossBarO.y ).c_str(),
-                  FormatInternalUnits( aDimension->m_crossBarF.x ).c_str(),
-                  FormatInternalUnits( aDimension->m_crossBarF.y ).c_str() );
+                  FMT_IU( aDimension->m_crossBarO.x ).c_str(),
+                  FMT_IU( aDimension->m_crossBarO.y ).c_str(),
+                  FMT_IU( aDimension->m_crossBarF.x ).c_str(),
+                  FMT_IU( aDimension->m_crossBarF.y ).c_str() );
 
     m_out->Print( aNestLevel+1, "(arrow1a (pts (xy %s %s) (xy %s %s)))\n",
-                  FormatInternalUnits( aDimension->m_crossBarF.x ).c_str(),
-                  FormatInternalUnits( aDimension->m_crossBarF.y ).c_str(),
-                  FormatInternalUnits( aDimension->m_arrowD1F.x ).c_str(),
-                  FormatInternalUnits( aDimension->m_arrowD1F.y ).c_str() );
+                  FMT_IU( aDimension->m_crossBarF.x ).c_str(),
+                  FMT_IU( aDimension->m_crossBarF.y ).c_str(),
+                  FMT_IU( aDimension->m_arrowD1F.x ).c_str(),
+                  FMT_IU( aDimension->m_arrowD1F.y ).c_str() );
 
     m_out->Print( aNestLevel+1, "(arrow1b (pts (xy %s %s) (xy %s %s)))\n",
-                  FormatInternalUnits( aDimension->m_crossBarF.x ).c_str(),
-                  FormatInternalUnits( aDimension->m_crossBarF.y ).c_str(),
-                  FormatInternalUnits( aDimension->m_arrowD2F.x ).c_str(),
-                  FormatInternalUnits( aDimension->m_arrowD2F.y ).c_str() );
+                  FMT_IU( aDimension->m_crossBarF.x ).c_str(),
+                  FMT_IU( aDimension->m_crossBarF.y ).c_str(),
+                  FMT_IU( aDimension->m_arrowD2F.x ).c_str(),
+                  FMT_IU( aDimension->m_arrowD2F.y ).c_str() );
 
     m_out->Print( aNestLevel+1, "(arrow2a (pts (xy %s %s) (xy %s %s)))\n",
-                  FormatInternalUnits( aDimension->m_crossBarO.x ).c_str(),
-                  FormatInternalUnits( aDimension->m_crossBarO.y ).c_str(),
-                  FormatInternalUnits( aDimension->m_arrowG1F.x ).c_str(),
-                  FormatInternalUnits( aDimension->m_arrowG1F.y ).c_str() );
+                  FMT_IU( aDimension->m_crossBarO.x ).c_str(),
+                  FMT_IU( aDimension->m_crossBarO.y ).c_str(),
+                  FMT_IU( aDimension->m_arrowG1F.x ).c_str(),
+                  FMT_IU( aDimension->m_arrowG1F.y ).c_str() );
 
     m_out->Print( aNestLevel+1, "(arrow2b (pts (xy %s %s) (xy %s %s)))\n",
-                  FormatInternalUnits( aDimension->m_crossBarO.x ).c_str(),
-                  FormatInternalUnits( aDimension->m_crossBarO.y ).c_str(),
-                  FormatInternalUnits( aDimension->m_arrowG2F.x ).c_str(),
-                  FormatInternalUnits( aDimension->m_arrowG2F.y ).c_str() );
+                  FMT_IU( aDimension->m_crossBarO.x ).c_str(),
+                  FMT_IU( aDimension->m_crossBarO.y ).c_str(),
+                  FMT_IU( aDimension->m_arrowG2F.x ).c_str(),
+                  FMT_IU( aDimension->m_arrowG2F.y ).c_str() );
 
     m_out->Print( aNestLevel, ")\n" );
 }
@@ -876,8 +1044,8 @@ void PCB_IO::format( DRAWSEGMENT* aSegment, int aNestLevel ) const
     {
     case S_SEGMENT:  // Line
         m_out->Print( aNestLevel, "(gr_line (start %s) (end %s)",
-                      FormatInternalUnits( aSegment->GetStart() ).c_str(),
-                      FormatInternalUnits( aSegment->GetEnd() ).c_str() );
+                      FMT_IU( aSegment->GetStart() ).c_str(),
+                      FMT_IU( aSegment->GetEnd() ).c_str() );
 
         if( aSegment->GetAngle() != 0.0 )
             m_out->Print( 0, " (angle %s)", FormatAngle( aSegment->GetAngle() ).c_str() );
@@ -886,14 +1054,14 @@ void PCB_IO::format( DRAWSEGMENT* aSegment, int aNestLevel ) const
 
     case S_CIRCLE:  // Circle
         m_out->Print( aNestLevel, "(gr_circle (center %s) (end %s)",
-                      FormatInternalUnits( aSegment->GetStart() ).c_str(),
-                      FormatInternalUnits( aSegment->GetEnd() ).c_str() );
+                      FMT_IU( aSegment->GetStart() ).c_str(),
+                      FMT_IU( aSegment->GetEnd() ).c_str() );
         break;
 
     case S_ARC:     // Arc
         m_out->Print( aNestLevel, "(gr_arc (start %s) (end %s) (angle %s)",
-                      FormatInternalUnits( aSegment->GetStart() ).c_str(),
-                      FormatInternalUnits( aSegment->GetEnd() ).c_str(),
+                      FMT_IU( aSegment->GetStart() ).c_str(),
+                      FMT_IU( aSegment->GetEnd() ).c_str(),
                       FormatAngle( aSegment->GetAngle() ).c_str() );
         break;
 
@@ -908,7 +1076,7 @@ void PCB_IO::format( DRAWSEGMENT* aSegment, int aNestLevel ) const
 
             for( int ii = 0; ii < pointsCount;  ++ii )
             {
-                m_out->Print( 0, " (xy %s)", FormatInternalUnits( outline.CPoint( ii ) ).c_str() );
+                m_out->Print( 0, " (xy %s)", FMT_IU( outline.CPoint( ii ) ).c_str() );
             }
 
             m_out->Print( 0, ")" );
@@ -923,10 +1091,10 @@ void PCB_IO::format( DRAWSEGMENT* aSegment, int aNestLevel ) const
 
     case S_CURVE:   // Bezier curve
         m_out->Print( aNestLevel, "(gr_curve (pts (xy %s) (xy %s) (xy %s) (xy %s))",
-                      FormatInternalUnits( aSegment->GetStart() ).c_str(),
-                      FormatInternalUnits( aSegment->GetBezControl1() ).c_str(),
-                      FormatInternalUnits( aSegment->GetBezControl2() ).c_str(),
-                      FormatInternalUnits( aSegment->GetEnd() ).c_str() );
+                      FMT_IU( aSegment->GetStart() ).c_str(),
+                      FMT_IU( aSegment->GetBezControl1() ).c_str(),
+                      FMT_IU( aSegment->GetBezControl2() ).c_str(),
+                      FMT_IU( aSegment->GetEnd() ).c_str() );
         break;
 
     default:
@@ -936,7 +1104,7 @@ void PCB_IO::format( DRAWSEGMENT* aSegment, int aNestLevel ) const
 
     formatLayer( aSegment );
 
-    m_out->Print( 0, " (width %s)", FormatInternalUnits( aSegment->GetWidth() ).c_str() );
+    m_out->Print( 0, " (width %s)", FMT_IU( aSegment->GetWidth() ).c_str() );
 
     m_out->Print( 0, " (tstamp %s)", TO_UTF8( aSegment->m_Uuid.AsString() ) );
 
@@ -953,20 +1121,20 @@ void PCB_IO::format( EDGE_MODULE* aModuleDrawing, int aNestLevel ) const
     {
     case S_SEGMENT:  // Line
         m_out->Print( aNestLevel, "(fp_line (start %s) (end %s)",
-                      FormatInternalUnits( aModuleDrawing->GetStart0() ).c_str(),
-                      FormatInternalUnits( aModuleDrawing->GetEnd0() ).c_str() );
+                      FMT_IU( aModuleDrawing->GetStart0() ).c_str(),
+                      FMT_IU( aModuleDrawing->GetEnd0() ).c_str() );
         break;
 
     case S_CIRCLE:  // Circle
         m_out->Print( aNestLevel, "(fp_circle (center %s) (end %s)",
-                      FormatInternalUnits( aModuleDrawing->GetStart0() ).c_str(),
-                      FormatInternalUnits( aModuleDrawing->GetEnd0() ).c_str() );
+                      FMT_IU( aModuleDrawing->GetStart0() ).c_str(),
+                      FMT_IU( aModuleDrawing->GetEnd0() ).c_str() );
         break;
 
     case S_ARC:     // Arc
         m_out->Print( aNestLevel, "(fp_arc (start %s) (end %s) (angle %s)",
-                      FormatInternalUnits( aModuleDrawing->GetStart0() ).c_str(),
-                      FormatInternalUnits( aModuleDrawing->GetEnd0() ).c_str(),
+                      FMT_IU( aModuleDrawing->GetStart0() ).c_str(),
+                      FMT_IU( aModuleDrawing->GetEnd0() ).c_str(),
                       FormatAngle( aModuleDrawing->GetAngle() ).c_str() );
         break;
 
@@ -990,7 +1158,7 @@ void PCB_IO::format( EDGE_MODULE* aModuleDrawing, int aNestLevel ) const
                 }
 
                 m_out->Print( nestLevel, "%s(xy %s)",
-                              nestLevel ? "" : " ", FormatInternalUnits( outline.CPoint( ii ) ).c_str() );
+                              nestLevel ? "" : " ", FMT_IU( outline.CPoint( ii ) ).c_str() );
             }
 
             m_out->Print( 0, ")" );
@@ -1004,10 +1172,10 @@ void PCB_IO::format( EDGE_MODULE* aModuleDrawing, int aNestLevel ) const
 
     case S_CURVE:   // Bezier curve
         m_out->Print( aNestLevel, "(fp_curve (pts (xy %s) (xy %s) (xy %s) (xy %s))",
-                      FormatInternalUnits( aModuleDrawing->GetStart0() ).c_str(),
-                      FormatInternalUnits( aModuleDrawing->GetBezier0_C1() ).c_str(),
-                      FormatInternalUnits( aModuleDrawing->GetBezier0_C2() ).c_str(),
-                      FormatInternalUnits( aModuleDrawing->GetEnd0() ).c_str() );
+                      FMT_IU( aModuleDrawing->GetStart0() ).c_str(),
+                      FMT_IU( aModuleDrawing->GetBezier0_C1() ).c_str(),
+                      FMT_IU( aModuleDrawing->GetBezier0_C2() ).c_str(),
+                      FMT_IU( aModuleDrawing->GetEnd0() ).c_str() );
         break;
 
     default:
@@ -1017,7 +1185,7 @@ void PCB_IO::format( EDGE_MODULE* aModuleDrawing, int aNestLevel ) const
 
     formatLayer( aModuleDrawing );
 
-    m_out->Print( 0, " (width %s)", FormatInternalUnits( aModuleDrawing->GetWidth() ).c_str() );
+    m_out->Print( 0, " (width %s)", FMT_IU( aModuleDrawing->GetWidth() ).c_str() );
 
     m_out->Print( 0, ")\n" );
 }
@@ -1027,11 +1195,11 @@ void PCB_IO::format( PCB_TARGET* aTarget, int aNestLevel ) const
 {
     m_out->Print( aNestLevel, "(target %s (at %s) (size %s)",
                   ( aTarget->GetShape() ) ? "x" : "plus",
-                  FormatInternalUnits( aTarget->GetPosition() ).c_str(),
-                  FormatInternalUnits( aTarget->GetSize() ).c_str() );
+                  FMT_IU( aTarget->GetPosition() ).c_str(),
+                  FMT_IU( aTarget->GetSize() ).c_str() );
 
     if( aTarget->GetWidth() != 0 )
-        m_out->Print( 0, " (width %s)", FormatInternalUnits( aTarget->GetWidth() ).c_str() );
+        m_out->Print( 0, " (width %s)", FMT_IU( aTarget->GetWidth() ).c_str() );
 
     formatLayer( aTarget );
 
@@ -1076,7 +1244,7 @@ void PCB_IO::format( MODULE* aModule, int aNestLevel ) const
 
     if( !( m_ctl & CTL_OMIT_AT ) )
     {
-        m_out->Print( aNestLevel+1, "(at %s", FormatInternalUnits( aModule->GetPosition() ).c_str() );
+        m_out->Print( aNestLevel+1, "(at %s", FMT_IU( aModule->GetPosition() ).c_str() );
 
         if( aModule->GetOrientation() != 0.0 )
             m_out->Print( 0, " %s", FormatAngle( aModule->GetOrientation() ).c_str() );
@@ -1104,11 +1272,11 @@ void PCB_IO::format( MODULE* aModule, int aNestLevel ) const
 
     if( aModule->GetLocalSolderMaskMargin() != 0 )
         m_out->Print( aNestLevel+1, "(solder_mask_margin %s)\n",
-                      FormatInternalUnits( aModule->GetLocalSolderMaskMargin() ).c_str() );
+                      FMT_IU( aModule->GetLocalSolderMaskMargin() ).c_str() );
 
     if( aModule->GetLocalSolderPasteMargin() != 0 )
         m_out->Print( aNestLevel+1, "(solder_paste_margin %s)\n",
-                      FormatInternalUnits( aModule->GetLocalSolderPasteMargin() ).c_str() );
+                      FMT_IU( aModule->GetLocalSolderPasteMargin() ).c_str() );
 
     if( aModule->GetLocalSolderPasteMarginRatio() != 0 )
         m_out->Print( aNestLevel+1, "(solder_paste_ratio %s)\n",
@@ -1116,7 +1284,7 @@ void PCB_IO::format( MODULE* aModule, int aNestLevel ) const
 
     if( aModule->GetLocalClearance() != 0 )
         m_out->Print( aNestLevel+1, "(clearance %s)\n",
-                      FormatInternalUnits( aModule->GetLocalClearance() ).c_str() );
+                      FMT_IU( aModule->GetLocalClearance() ).c_str() );
 
     if( aModule->GetZoneConnection() != ZONE_CONNECTION::INHERITED )
         m_out->Print( aNestLevel+1, "(zone_connect %d)\n",
@@ -1124,11 +1292,11 @@ void PCB_IO::format( MODULE* aModule, int aNestLevel ) const
 
     if( aModule->GetThermalWidth() != 0 )
         m_out->Print( aNestLevel+1, "(thermal_width %s)\n",
-                      FormatInternalUnits( aModule->GetThermalWidth() ).c_str() );
+                      FMT_IU( aModule->GetThermalWidth() ).c_str() );
 
     if( aModule->GetThermalGap() != 0 )
         m_out->Print( aNestLevel+1, "(thermal_gap %s)\n",
-                      FormatInternalUnits( aModule->GetThermalGap() ).c_str() );
+                      FMT_IU( aModule->GetThermalGap() ).c_str() );
 
     // Attributes
     if( aModule->GetAttributes() != MOD_DEFAULT )
@@ -1358,16 +1526,16 @@ void PCB_IO::format( D_PAD* aPad, int aNestLevel ) const
     m_out->Print( aNestLevel, "(pad %s %s %s",
                   m_out->Quotew( aPad->GetName() ).c_str(),
                   type, shape );
-    m_out->Print( 0, " (at %s", FormatInternalUnits( aPad->GetPos0() ).c_str() );
+    m_out->Print( 0, " (at %s", FMT_IU( aPad->GetPos0() ).c_str() );
 
     if( aPad->GetOrientation() != 0.0 )
         m_out->Print( 0, " %s", FormatAngle( aPad->GetOrientation() ).c_str() );
 
     m_out->Print( 0, ")" );
-    m_out->Print( 0, " (size %s)", FormatInternalUnits( aPad->GetSize() ).c_str() );
+    m_out->Print( 0, " (size %s)", FMT_IU( aPad->GetSize() ).c_str() );
 
     if( (aPad->GetDelta().GetWidth()) != 0 || (aPad->GetDelta().GetHeight() != 0 ) )
-        m_out->Print( 0, " (rect_delta %s )", FormatInternalUnits( aPad->GetDelta() ).c_str() );
+        m_out->Print( 0, " (rect_delta %s )", FMT_IU( aPad->GetDelta() ).c_str() );
 
     wxSize sz = aPad->GetDrillSize();
     wxPoint shapeoffset = aPad->GetOffset();
@@ -1381,13 +1549,13 @@ void PCB_IO::format( D_PAD* aPad, int aNestLevel ) const
             m_out->Print( 0, " oval" );
 
         if( sz.GetWidth() > 0 )
-            m_out->Print( 0,  " %s", FormatInternalUnits( sz.GetWidth() ).c_str() );
+            m_out->Print( 0,  " %s", FMT_IU( sz.GetWidth() ).c_str() );
 
         if( sz.GetHeight() > 0  && sz.GetWidth() != sz.GetHeight() )
-            m_out->Print( 0,  " %s", FormatInternalUnits( sz.GetHeight() ).c_str() );
+            m_out->Print( 0,  " %s", FMT_IU( sz.GetHeight() ).c_str() );
 
         if( (shapeoffset.x != 0) || (shapeoffset.y != 0) )
-            m_out->Print( 0, " (offset %s)", FormatInternalUnits( aPad->GetOffset() ).c_str() );
+            m_out->Print( 0, " (offset %s)", FMT_IU( aPad->GetOffset() ).c_str() );
 
         m_out->Print( 0, ")" );
     }
@@ -1448,31 +1616,31 @@ void PCB_IO::format( D_PAD* aPad, int aNestLevel ) const
 
     if( aPad->GetPadToDieLength() != 0 )
         StrPrintf( &output, " (die_length %s)",
-                   FormatInternalUnits( aPad->GetPadToDieLength() ).c_str() );
+                   FMT_IU( aPad->GetPadToDieLength() ).c_str() );
 
     if( aPad->GetLocalSolderMaskMargin() != 0 )
         StrPrintf( &output, " (solder_mask_margin %s)",
-                   FormatInternalUnits( aPad->GetLocalSolderMaskMargin() ).c_str() );
+                   FMT_IU( aPad->GetLocalSolderMaskMargin() ).c_str() );
 
     if( aPad->GetLocalSolderPasteMargin() != 0 )
         StrPrintf( &output, " (solder_paste_margin %s)",
-                   FormatInternalUnits( aPad->GetLocalSolderPasteMargin() ).c_str() );
+                   FMT_IU( aPad->GetLocalSolderPasteMargin() ).c_str() );
 
     if( aPad->GetLocalSolderPasteMarginRatio() != 0 )
         StrPrintf( &output, " (solder_paste_margin_ratio %s)",
                    Double2Str( aPad->GetLocalSolderPasteMarginRatio() ).c_str() );
 
     if( aPad->GetLocalClearance() != 0 )
-        StrPrintf( &output, " (clearance %s)", FormatInternalUnits( aPad->GetLocalClearance() ).c_str() );
+        StrPrintf( &output, " (clearance %s)", FMT_IU( aPad->GetLocalClearance() ).c_str() );
 
     if( aPad->GetZoneConnection() != ZONE_CONNECTION::INHERITED )
         StrPrintf( &output, " (zone_connect %d)", static_cast<int>( aPad->GetZoneConnection() ) );
 
     if( aPad->GetThermalWidth() != 0 )
-        StrPrintf( &output, " (thermal_width %s)", FormatInternalUnits( aPad->GetThermalWidth() ).c_str() );
+        StrPrintf( &output, " (thermal_width %s)", FMT_IU( aPad->GetThermalWidth() ).c_str() );
 
     if( aPad->GetThermalGap() != 0 )
-        StrPrintf( &output, " (thermal_gap %s)", FormatInternalUnits( aPad->GetThermalGap() ).c_str() );
+        StrPrintf( &output, " (thermal_gap %s)", FMT_IU( aPad->GetThermalGap() ).c_str() );
 
     if( output.size() )
     {
@@ -1519,34 +1687,34 @@ void PCB_IO::format( D_PAD* aPad, int aNestLevel ) const
             {
             case S_SEGMENT:         // usual segment : line with rounded ends
                 m_out->Print( nested_level, "(gr_line (start %s) (end %s) (width %s))",
-                              FormatInternalUnits( primitive.m_Start ).c_str(),
-                              FormatInternalUnits( primitive.m_End ).c_str(),
-                              FormatInternalUnits( primitive.m_Thickness ).c_str() );
+                              FMT_IU( primitive.m_Start ).c_str(),
+                              FMT_IU( primitive.m_End ).c_str(),
+                              FMT_IU( primitive.m_Thickness ).c_str() );
                 break;
 
             case S_ARC:             // Arc with rounded ends
                 m_out->Print( nested_level, "(gr_arc (start %s) (end %s) (angle %s) (width %s))",
-                              FormatInternalUnits( primitive.m_Start ).c_str(),
-                              FormatInternalUnits( primitive.m_End ).c_str(),
+                              FMT_IU( primitive.m_Start ).c_str(),
+                              FMT_IU( primitive.m_End ).c_str(),
                               FormatAngle( primitive.m_ArcAngle ).c_str(),
-                              FormatInternalUnits( primitive.m_Thickness ).c_str() );
+                              FMT_IU( primitive.m_Thickness ).c_str() );
                 break;
 
             case S_CIRCLE:          //  ring or circle (circle if width == 0
                 m_out->Print( nested_level, "(gr_circle (center %s) (end %s %s) (width %s))",
-                              FormatInternalUnits( primitive.m_Start ).c_str(),
-                              FormatInternalUnits( primitive.m_Start.x + primitive.m_Radius ).c_str(),
-                              FormatInternalUnits( primitive.m_Start.y ).c_str(),
-                              FormatInternalUnits( primitive.m_Thickness ).c_str() );
+                              FMT_IU( primitive.m_Start ).c_str(),
+                              FMT_IU( primitive.m_Start.x + primitive.m_Radius ).c_str(),
+                              FMT_IU( primitive.m_Start.y ).c_str(),
+                              FMT_IU( primitive.m_Thickness ).c_str() );
                 break;
 
             case S_CURVE:          //  Bezier Curve
                 m_out->Print( aNestLevel, "(gr_curve (pts (xy %s) (xy %s) (xy %s) (xy %s)) (width %s))",
-                              FormatInternalUnits( primitive.m_Start ).c_str(),
-                              FormatInternalUnits( primitive.m_Ctrl1 ).c_str(),
-                              FormatInternalUnits( primitive.m_Ctrl2 ).c_str(),
-                              FormatInternalUnits( primitive.m_End ).c_str(),
-                              FormatInternalUnits( primitive.m_Thickness ).c_str() );
+                              FMT_IU( primitive.m_Start ).c_str(),
+                              FMT_IU( primitive.m_Ctrl1 ).c_str(),
+                              FMT_IU( primitive.m_Ctrl2 ).c_str(),
+                              FMT_IU( primitive.m_End ).c_str(),
+                              FMT_IU( primitive.m_Thickness ).c_str() );
                 break;
 
             case S_POLYGON:         // polygon
@@ -1564,10 +1732,10 @@ void PCB_IO::format( D_PAD* aPad, int aNestLevel ) const
                 {
                     if( newLine == 0 )
                         m_out->Print( nested_level+1, " (xy %s)",
-                                      FormatInternalUnits( wxPoint( poly[ii].x, poly[ii].y ) ).c_str() );
+                                      FMT_IU( wxPoint( poly[ii].x, poly[ii].y ) ).c_str() );
                     else
                         m_out->Print( 0, " (xy %s)",
-                                      FormatInternalUnits( wxPoint( poly[ii].x, poly[ii].y ) ).c_str() );
+                                      FMT_IU( wxPoint( poly[ii].x, poly[ii].y ) ).c_str() );
 
                     if( ++newLine > 4 )
                     {
@@ -1576,7 +1744,7 @@ void PCB_IO::format( D_PAD* aPad, int aNestLevel ) const
                     }
                 }
 
-                m_out->Print( 0, ") (width %s))", FormatInternalUnits( primitive.m_Thickness ).c_str() );
+                m_out->Print( 0, ") (width %s))", FMT_IU( primitive.m_Thickness ).c_str() );
                 }
                 break;
 
@@ -1599,7 +1767,7 @@ void PCB_IO::format( TEXTE_PCB* aText, int aNestLevel ) const
 {
     m_out->Print( aNestLevel, "(gr_text %s (at %s",
                   m_out->Quotew( aText->GetText() ).c_str(),
-                  FormatInternalUnits( aText->GetTextPos() ).c_str() );
+                  FMT_IU( aText->GetTextPos() ).c_str() );
 
     if( aText->GetTextAngle() != 0.0 )
         m_out->Print( 0, " %s", FormatAngle( aText->GetTextAngle() ).c_str() );
@@ -1632,7 +1800,7 @@ void PCB_IO::format( TEXTE_MODULE* aText, int aNestLevel ) const
     m_out->Print( aNestLevel, "(fp_text %s %s (at %s",
                   type.c_str(),
                   m_out->Quotew( aText->GetText() ).c_str(),
-                  FormatInternalUnits( aText->GetPos0() ).c_str() );
+                  FMT_IU( aText->GetPos0() ).c_str() );
 
     // Due to Pcbnew history, fp_text angle is saved as an absolute on screen angle,
     // but internally the angle is held relative to its parent footprint.  parent
@@ -1712,11 +1880,11 @@ void PCB_IO::format( TRACK* aTrack, int aNestLevel ) const
         }
 
         m_out->Print( 0, " (at %s) (size %s)",
-                      FormatInternalUnits( aTrack->GetStart() ).c_str(),
-                      FormatInternalUnits( aTrack->GetWidth() ).c_str() );
+                      FMT_IU( aTrack->GetStart() ).c_str(),
+                      FMT_IU( aTrack->GetWidth() ).c_str() );
 
         if( via->GetDrill() != UNDEFINED_DRILL_DIAMETER )
-            m_out->Print( 0, " (drill %s)", FormatInternalUnits( via->GetDrill() ).c_str() );
+            m_out->Print( 0, " (drill %s)", FMT_IU( via->GetDrill() ).c_str() );
 
         m_out->Print( 0, " (layers %s %s)",
                       m_out->Quotew( m_board->GetLayerName( layer1 ) ).c_str(),
@@ -1727,18 +1895,18 @@ void PCB_IO::format( TRACK* aTrack, int aNestLevel ) const
         const ARC* arc = static_cast<const ARC*>( aTrack );
 
         m_out->Print( aNestLevel, "(arc (start %s) (mid %s) (end %s) (width %s)",
-                FormatInternalUnits( arc->GetStart() ).c_str(),
-                FormatInternalUnits( arc->GetMid() ).c_str(),
-                FormatInternalUnits( arc->GetEnd() ).c_str(),
-                FormatInternalUnits( arc->GetWidth() ).c_str() );
+                FMT_IU( arc->GetStart() ).c_str(),
+                FMT_IU( arc->GetMid() ).c_str(),
+                FMT_IU( arc->GetEnd() ).c_str(),
+                FMT_IU( arc->GetWidth() ).c_str() );
 
         m_out->Print( 0, " (layer %s)", m_out->Quotew( aTrack->GetLayerName() ).c_str() );
     }
     else
     {
         m_out->Print( aNestLevel, "(segment (start %s) (end %s) (width %s)",
-                      FormatInternalUnits( aTrack->GetStart() ).c_str(), FormatInternalUnits( aTrack->GetEnd() ).c_str(),
-                      FormatInternalUnits( aTrack->GetWidth() ).c_str() );
+                      FMT_IU( aTrack->GetStart() ).c_str(), FMT_IU( aTrack->GetEnd() ).c_str(),
+                      FMT_IU( aTrack->GetWidth() ).c_str() );
 
         m_out->Print( 0, " (layer %s)", m_out->Quotew( aTrack->GetLayerName() ).c_str() );
     }
@@ -1793,7 +1961,7 @@ void PCB_IO::format( ZONE_CONTAINER* aZone, int aNestLevel ) const
     }
 
     m_out->Print( 0, " (hatch %s %s)\n", hatch.c_str(),
-                  FormatInternalUnits( aZone->GetHatchPitch() ).c_str() );
+                  FMT_IU( aZone->GetHatchPitch() ).c_str() );
 
     if( aZone->GetPriority() > 0 )
         m_out->Print( aNestLevel+1, "(priority %d)\n", aZone->GetPriority() );
@@ -1820,10 +1988,10 @@ void PCB_IO::format( ZONE_CONTAINER* aZone, int aNestLevel ) const
     }
 
     m_out->Print( 0, " (clearance %s))\n",
-                  FormatInternalUnits( aZone->GetZoneClearance() ).c_str() );
+                  FMT_IU( aZone->GetZoneClearance() ).c_str() );
 
     m_out->Print( aNestLevel+1, "(min_thickness %s)",
-                  FormatInternalUnits( aZone->GetMinThickness() ).c_str() );
+                  FMT_IU( aZone->GetMinThickness() ).c_str() );
 
     // write it only if V 6.O version option is not used (i.e. do not write if the
     // "legacy" algorithm is used)
@@ -1851,8 +2019,8 @@ void PCB_IO::format( ZONE_CONTAINER* aZone, int aNestLevel ) const
         m_out->Print( 0, " (mode hatch)" );
 
     m_out->Print( 0, " (thermal_gap %s) (thermal_bridge_width %s)",
-                  FormatInternalUnits( aZone->GetThermalReliefGap() ).c_str(),
-                  FormatInternalUnits( aZone->GetThermalReliefCopperBridge() ).c_str() );
+                  FMT_IU( aZone->GetThermalReliefGap() ).c_str(),
+                  FMT_IU( aZone->GetThermalReliefCopperBridge() ).c_str() );
 
     if( aZone->GetCornerSmoothingType() != ZONE_SETTINGS::SMOOTHING_NONE )
     {
@@ -1876,15 +2044,15 @@ void PCB_IO::format( ZONE_CONTAINER* aZone, int aNestLevel ) const
 
         if( aZone->GetCornerRadius() != 0 )
             m_out->Print( 0, " (radius %s)",
-                          FormatInternalUnits( aZone->GetCornerRadius() ).c_str() );
+                          FMT_IU( aZone->GetCornerRadius() ).c_str() );
     }
 
     if( aZone->GetFillMode() == ZONE_FILL_MODE::HATCH_PATTERN )
     {
         m_out->Print( 0, "\n" );
         m_out->Print( aNestLevel+2, "(hatch_thickness %s) (hatch_gap %s) (hatch_orientation %s)",
-                         FormatInternalUnits( aZone->GetHatchFillTypeThickness() ).c_str(),
-                         FormatInternalUnits( aZone->GetHatchFillTypeGap() ).c_str(),
+                         FMT_IU( aZone->GetHatchFillTypeThickness() ).c_str(),
+                         FMT_IU( aZone->GetHatchFillTypeGap() ).c_str(),
                          Double2Str( aZone->GetHatchFillTypeOrientation() ).c_str() );
 
         if( aZone->GetHatchFillTypeSmoothingLevel() > 0 )
@@ -1918,10 +2086,10 @@ void PCB_IO::format( ZONE_CONTAINER* aZone, int aNestLevel ) const
 
             if( newLine == 0 )
                 m_out->Print( aNestLevel+3, "(xy %s %s)",
-                              FormatInternalUnits( iterator->x ).c_str(), FormatInternalUnits( iterator->y ).c_str() );
+                              FMT_IU( iterator->x ).c_str(), FMT_IU( iterator->y ).c_str() );
             else
                 m_out->Print( 0, " (xy %s %s)",
-                              FormatInternalUnits( iterator->x ).c_str(), FormatInternalUnits( iterator->y ).c_str() );
+                              FMT_IU( iterator->x ).c_str(), FMT_IU( iterator->y ).c_str() );
 
             if( newLine < 4 )
             {
@@ -1978,10 +2146,10 @@ void PCB_IO::format( ZONE_CONTAINER* aZone, int aNestLevel ) const
 
             if( newLine == 0 )
                 m_out->Print( aNestLevel+3, "(xy %s %s)",
-                              FormatInternalUnits( it->x ).c_str(), FormatInternalUnits( it->y ).c_str() );
+                              FMT_IU( it->x ).c_str(), FMT_IU( it->y ).c_str() );
             else
                 m_out->Print( 0, " (xy %s %s)",
-                              FormatInternalUnits( it->x ) .c_str(), FormatInternalUnits( it->y ).c_str() );
+                              FMT_IU( it->x ).c_str(), FMT_IU( it->y ).c_str() );
 
             if( newLine < 4 )
             {
@@ -2020,8 +2188,8 @@ void PCB_IO::format( ZONE_CONTAINER* aZone, int aNestLevel ) const
         for( ZONE_SEGMENT_FILL::const_iterator it = segs.begin();  it != segs.end();  ++it )
         {
             m_out->Print( aNestLevel+2, "(pts (xy %s) (xy %s))\n",
-                          FormatInternalUnits( wxPoint( it->A ) ).c_str(),
-                          FormatInternalUnits( wxPoint( it->B ) ).c_str() );
+                          FMT_IU( wxPoint( it->A ) ).c_str(),
+                          FMT_IU( wxPoint( it->B ) ).c_str() );
         }
 
         m_out->Print( aNestLevel+1, ")\n" );
@@ -2042,6 +2210,18 @@ PCB_IO::PCB_IO( int aControlFlags ) :
 }
 
 
+PCB_IO::PCB_IO( const PCB_IO& aParent ) :
+    m_cache( 0 ),
+    m_ctl( aParent.m_ctl ),
+    m_parser( NULL ),
+    m_mapping( new NETINFO_MAPPING( *aParent.m_mapping ) )
+{
+    init( aParent.m_props );
+    m_board = aParent.m_board;
+    m_out = &m_sf;
+}
+
+
 PCB_IO::~PCB_IO()
 {
     delete m_cache;
@@ -2052,13 +2232,25 @@ PCB_IO::~PCB_IO()
 
 BOARD* PCB_IO::Load( const wxString& aFileName, BOARD* aAppendToMe, const PROPERTIES* aProperties )
 {
-    FILE_LINE_READER    reader( aFileName );
+    MAPPED_FILE_LINE_READER fileReader( aFileName );
 
     init( aProperties );
 
-    m_parser->SetLineReader( &reader );
     m_parser->SetBoard( aAppendToMe );
 
+    ZONE_FILL_CACHE fillCache;
+
+    // The zone fills saved with the file are read from the cache, if it still matches
+    if( ADVANCED_CFG::GetCfg().m_EnableZoneFillCache
+            && fillCache.Load( aFileName, fileReader.Data(), fileReader.Size() ) )
+    {
+        m_parser->SetZoneFillCache( &fillCache );
+    }
+
+    // Footprints, tracks and zones are cut out of the file, to be parsed on several threads
+    m_parser->SplitBoardItems( fileReader );
+    m_parser->SetLineReader( &fileReader );
+
     BOARD* board;
 
     try
@@ -2162,14 +2354,14 @@ const MODULE* PCB_IO::getFootprint( const wxString& aLibraryPath,
         // do nothing with the error
     }
 
-    const MODULE_MAP& mods = m_cache->GetModules();
+    MODULE_MAP& mods = m_cache->GetModules();
 
-    MODULE_CITER it = mods.find( aFootprintName );
+    MODULE_ITER it = mods.find( aFootprintName );
 
     if( it == mods.end() )
         return nullptr;
 
-    return it->second->GetModule();
+    return m_cache->GetModule( it->second );
 }
 
 
@@ -2181,6 +2373,37 @@ const MODULE* PCB_IO::GetEnumeratedFootprint( const wxString& aLibraryPath,
 }
 
 
+bool PCB_IO::GetEnumeratedFootprintSummary( const wxString& aLibraryPath,
+                                            const wxString& aFootprintName,
+                                            FOOTPRINT_SUMMARY& aSummary,
+                                            const PROPERTIES* aProperties )
+{
+    LOCALE_IO   toggle;     // toggles on, then off, the C locale.
+
+    init( aProperties );
+
+    try
+    {
+        validateCache( aLibraryPath, false );
+    }
+    catch( const IO_ERROR& )
+    {
+        // do nothing with the error
+    }
+
+    const MODULE_MAP& mods = m_cache->GetModules();
+
+    MODULE_CITER it = mods.find( aFootprintName );
+
+    if( it == mods.end() )
+        return false;
+
+    // The summary comes from the library index, so the footprint file is not parsed
+    aSummary = it->second->GetSummary();
+    return true;
+}
+
+
 bool PCB_IO::FootprintExists( const wxString& aLibraryPath, const wxString& aFootprintName,
                               const PROPERTIES* aProperties )
 {
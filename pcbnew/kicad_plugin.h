@@ -132,6 +132,11 @@ public:
                                           const wxString& aFootprintName,
                                           const PROPERTIES* aProperties = NULL ) override;
 
+    bool GetEnumeratedFootprintSummary( const wxString& aLibraryPath,
+                                        const wxString& aFootprintName,
+                                        FOOTPRINT_SUMMARY& aSummary,
+                                        const PROPERTIES* aProperties = NULL ) override;
+
     bool FootprintExists( const wxString& aLibraryPath, const wxString& aFootprintName,
                           const PROPERTIES* aProperties = NULL ) override;
 
@@ -228,6 +233,13 @@ protected:
     void formatHeader( BOARD* aBoard, int aNestLevel = 0 ) const;
 
 private:
+    /**
+     * Creates a PCB_IO formatting the items of the board of \a aParent, with the same
+     * settings and a copy of its net mapping, to its own STRING_FORMATTER.  Used to format
+     * items on worker threads, see format( BOARD* ).
+     */
+    PCB_IO( const PCB_IO& aParent );
+
     void format( BOARD* aBoard, int aNestLevel = 0 ) const;
 
     void format( DIMENSION* aDimension, int aNestLevel = 0 ) const;
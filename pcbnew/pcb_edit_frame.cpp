@@ -181,6 +181,7 @@ PCB_EDIT_FRAME::PCB_EDIT_FRAME( KIWAY* aKiway, wxWindow* aParent ) :
     // We don't know what state board was in when it was lasat saved, so we have to
     // assume dirty
     m_ZoneFillsDirty = true;
+    m_ZoneFillDirtyAreasValid = false;
 
     m_rotationAngle = 900;
     m_AboutTitle = "Pcbnew";
@@ -841,6 +842,31 @@ void PCB_EDIT_FRAME::OnModify( )
     Update3DView( false );
 
     m_ZoneFillsDirty = true;
+
+    // We don't know what was changed, so the next fill has to consider the whole board
+    m_ZoneFillDirtyAreasValid = false;
+}
+
+
+void PCB_EDIT_FRAME::OnModify( const std::vector<EDA_RECT>& aDirtyAreas )
+{
+    // Clean zone fills are the starting point of a new dirty-area list
+    if( !m_ZoneFillsDirty )
+    {
+        m_ZoneFillDirtyAreas.clear();
+        m_ZoneFillDirtyAreasValid = true;
+    }
+
+    bool dirtyAreasValid = m_ZoneFillDirtyAreasValid;
+
+    OnModify();
+
+    if( dirtyAreasValid )
+    {
+        m_ZoneFillDirtyAreas.insert( m_ZoneFillDirtyAreas.end(), aDirtyAreas.begin(),
+                                     aDirtyAreas.end() );
+        m_ZoneFillDirtyAreasValid = true;
+    }
 }
 
 
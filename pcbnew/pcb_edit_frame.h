@@ -275,6 +275,11 @@ public:
 
     bool m_ZoneFillsDirty;                  // Board has been modified since last zone fill.
 
+    // Board areas touched by BOARD_COMMITs since the last zone fill.  Only meaningful while
+    // m_ZoneFillDirtyAreasValid is true, ie: no modification has bypassed the commit mechanism.
+    std::vector<EDA_RECT> m_ZoneFillDirtyAreas;
+    bool m_ZoneFillDirtyAreasValid;
+
     virtual ~PCB_EDIT_FRAME();
 
     /**
@@ -481,6 +486,15 @@ public:
      */
     void OnModify() override;
 
+    /**
+     * Function OnModify
+     * variant used by BOARD_COMMIT, which also knows which areas of the board it touched.
+     * As long as every change since the last zone fill went through a commit, these areas
+     * allow the next fill to skip the zones they cannot affect.
+     * @param aDirtyAreas are the bounding boxes (inflated by clearance) of the changed items.
+     */
+    void OnModify( const std::vector<EDA_RECT>& aDirtyAreas );
+
     /**
      * Function SetActiveLayer
      * will change the currently active layer to \a aLayer and also
@@ -1138,6 +1138,11 @@ void PCB_PAINTER::draw( const ZONE_CONTAINER* aZone, int aLayer )
         if( polySet.OutlineCount() == 0 )  // Nothing to draw
             return;
 
+        // Zone fills are not triangulated when filled, but on first use: here by Opengl,
+        // which draws non-convex polygons using triangles as primitives.
+        if( m_gal->IsOpenGlEngine() && !polySet.IsTriangulationUpToDate() )
+            const_cast<ZONE_CONTAINER*>( aZone )->CacheTriangulation();
+
         // Set up drawing options
         int outline_thickness = aZone->GetFilledPolysUseThickness() ? aZone->GetMinThickness() : 0;
         m_gal->SetStrokeColor( color );
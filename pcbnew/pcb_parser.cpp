@@ -27,7 +27,10 @@
  * @brief Pcbnew s-expression file format parser implementation.
  */
 
+#include <atomic>
 #include <cerrno>
+#include <cmath>
+#include <limits>
 #include <common.h>
 #include <confirm.h>
 #include <macros.h>
@@ -48,9 +51,11 @@
 #include <pcb_plot_params_parser.h>
 #include <pcb_plot_params.h>
 #include <zones.h>
+#include <zone_fill_cache.h>
 #include <pcb_parser.h>
 #include <convert_basic_shapes_to_polygon.h>    // for RECT_CHAMFER_POSITIONS definition
 #include <template_fieldnames.h>
+#include <thread_pool.h>
 
 using namespace PCB_KEYS_T;
 
@@ -58,6 +63,7 @@ using namespace PCB_KEYS_T;
 void PCB_PARSER::init()
 {
     m_showLegacyZoneWarning = true;
+    m_deferredItems.clear();
     m_tooRecent = false;
     m_requiredVersion = 0;
     m_layerIndices.clear();
@@ -135,6 +141,76 @@ void PCB_PARSER::skipCurrent()
 }
 
 
+///> Blank chars between tokens, see DSNLEXER
+static inline bool isBlank( char cc )
+{
+    return cc == ' ' || cc == '\t' || cc == '\n' || cc == '\r' || cc == '\0';
+}
+
+
+void PCB_PARSER::skipCurrentRaw()
+{
+    const char* cur = next;
+    int         level = 0;
+    bool        inQuote = false;
+
+    prevTok = CurTok();
+
+    while( true )
+    {
+        if( cur >= limit )
+        {
+            if( readLine() == 0 )
+            {
+                curTok = DSN_EOF;
+                next = start;
+                return;
+            }
+
+            cur = start;
+            inQuote = false;
+
+            while( cur < limit && isBlank( *cur ) )
+                ++cur;
+
+            // Comment lines cannot hold parentheses
+            if( cur < limit && *cur == '#' )
+            {
+                cur = limit;
+                continue;
+            }
+        }
+
+        for( ; cur < limit; ++cur )
+        {
+            if( inQuote )
+            {
+                if( *cur == '\\' && cur + 1 < limit )
+                    ++cur;
+                else if( *cur == '"' )
+                    inQuote = false;
+            }
+            else if( *cur == '"' )
+            {
+                inQuote = true;
+            }
+            else if( *cur == '(' )
+            {
+                level++;
+            }
+            else if( *cur == ')' && --level < 0 )
+            {
+                curText = *cur;
+                curTok = DSN_RIGHT;
+                curOffset = cur - start;
+                next = cur + 1;
+                return;
+            }
+        }
+    }
+}
+
+
 void PCB_PARSER::pushValueIntoMap( int aIndex, int aValue )
 {
     // Add aValue in netcode mapping (m_netCodes) at index aNetCode
@@ -147,8 +223,101 @@ void PCB_PARSER::pushValueIntoMap( int aIndex, int aValue )
 }
 
 
+///> Exact powers of ten, for the numbers read by parseFixedPoint()
+static const double s_pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+                                  1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15 };
+
+///> Number of decimals of a mm in internal units, which is a power of ten per mm
+static const int IU_DECIMALS = KiROUND( log10( IU_PER_MM ) );
+
+///> Largest board coordinate, which is the diagonal distance of the full screen ~1.5m
+static const double BOARD_UNITS_LIMIT = std::numeric_limits<int>::max() * 0.7071;
+
+
+/**
+ * Reads a plain decimal number as KiCad writes them, e.g. "-12.345": an optional sign,
+ * digits and an optional decimal point.  Numbers of more than 15 digits, exponents or any
+ * other syntax are left to strtod().
+ *
+ * @param aDigits receives all the digits as an integer, e.g. 12345.
+ * @param aDecimals receives the number of digits after the decimal point, e.g. 3.
+ * @return true if the text is such a number.
+ */
+static bool parseFixedPoint( const char* aStart, const char* aEnd, bool& aNegative,
+                             int64_t& aDigits, int& aDecimals )
+{
+    const char* dot = nullptr;
+    int         count = 0;
+
+    aNegative = false;
+    aDigits = 0;
+
+    if( aStart < aEnd && ( *aStart == '-' || *aStart == '+' ) )
+        aNegative = *aStart++ == '-';
+
+    for( const char* p = aStart; p < aEnd; ++p )
+    {
+        if( *p >= '0' && *p <= '9' )
+        {
+            // 15 digits always fit exactly in a double
+            if( ++count > 15 )
+                return false;
+
+            aDigits = aDigits * 10 + ( *p - '0' );
+        }
+        else if( *p == '.' && !dot )
+        {
+            dot = p;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    aDecimals = dot ? int( aEnd - dot - 1 ) : 0;
+
+    return count > 0;
+}
+
+
+/**
+ * Converts a plain decimal number of mm to board units, with the same result as strtod(),
+ * scaling and rounding, but without going through a double as long as the number has no
+ * more decimals than the internal units.
+ *
+ * @return false if the text is not such a number.
+ */
+static bool parseFixedPointBoardUnits( const char* aStart, const char* aEnd, int& aValue )
+{
+    bool    negative;
+    int64_t digits;
+    int     decimals;
+
+    if( !parseFixedPoint( aStart, aEnd, negative, digits, decimals ) || decimals > IU_DECIMALS )
+        return false;
+
+    // An exact integer count of internal units, up to far beyond the limit
+    double value = digits * s_pow10[IU_DECIMALS - decimals];
+
+    aValue = KiROUND( Clamp<double>( -BOARD_UNITS_LIMIT, negative ? -value : value,
+                                     BOARD_UNITS_LIMIT ) );
+    return true;
+}
+
+
 double PCB_PARSER::parseDouble()
 {
+    const std::string& text = CurStr();
+    bool               negative;
+    int64_t            digits;
+    int                decimals;
+
+    // Fast path for the usual numbers: both the digits and the power of ten are exact
+    // doubles, so their quotient is correctly rounded, just as strtod() does.
+    if( parseFixedPoint( text.data(), text.data() + text.size(), negative, digits, decimals ) )
+        return negative ? -( digits / s_pow10[decimals] ) : digits / s_pow10[decimals];
+
     char* tmp;
 
     errno = 0;
@@ -177,6 +346,29 @@ double PCB_PARSER::parseDouble()
 }
 
 
+int PCB_PARSER::parseBoardUnits()
+{
+    const std::string& text = CurStr();
+    int                value;
+
+    if( parseFixedPointBoardUnits( text.data(), text.data() + text.size(), value ) )
+        return value;
+
+    // There should be no major rounding issues here, since the values in
+    // the file are in mm and get converted to nano-meters.
+    // See test program tools/test-nm-biu-to-ascii-mm-round-tripping.cpp
+    // to confirm or experiment.  Use a similar strategy in both places, here
+    // and in the test program. Make that program with:
+    // $ make test-nm-biu-to-ascii-mm-round-tripping
+    auto retval = parseDouble() * IU_PER_MM;
+
+    // N.B. we currently represent board units as integers.  Any values that are
+    // larger or smaller than those board units represent undefined behavior for
+    // the system.  We limit values to the largest that is visible on the screen
+    return KiROUND( Clamp<double>( -BOARD_UNITS_LIMIT, retval, BOARD_UNITS_LIMIT ) );
+}
+
+
 bool PCB_PARSER::parseBool()
 {
     T token = NextTok();
@@ -261,6 +453,63 @@ void PCB_PARSER::parseXY( int* aX, int* aY )
 }
 
 
+void PCB_PARSER::parseXYList( SHAPE_LINE_CHAIN& aChain )
+{
+    std::vector<VECTOR2I> points;
+
+    // Reads a coordinate at aPos in the current line, and moves aPos past it
+    auto readCoord = [&]( const char*& aPos, int& aValue ) -> bool
+    {
+        while( aPos < limit && isBlank( *aPos ) )
+            ++aPos;
+
+        const char* tokenStart = aPos;
+
+        while( aPos < limit && !isBlank( *aPos ) && *aPos != '(' && *aPos != ')' )
+            ++aPos;
+
+        return parseFixedPointBoardUnits( tokenStart, aPos, aValue );
+    };
+
+    for( ;; )
+    {
+        // Fast path: a "(xy X Y)" point in the rest of the current line
+        const char* pos = next;
+        int         x, y;
+
+        while( pos < limit && isBlank( *pos ) )
+            ++pos;
+
+        if( limit - pos > 3 && pos[0] == '(' && pos[1] == 'x' && pos[2] == 'y'
+                && isBlank( pos[3] ) )
+        {
+            pos += 3;
+
+            if( readCoord( pos, x ) && readCoord( pos, y ) )
+            {
+                while( pos < limit && isBlank( *pos ) )
+                    ++pos;
+
+                if( pos < limit && *pos == ')' )
+                {
+                    points.emplace_back( x, y );
+                    next = pos + 1;
+                    continue;
+                }
+            }
+        }
+
+        // Anything else, e.g. the end of the line or of the list, goes through the lexer
+        if( NextTok() == T_RIGHT )
+            break;
+
+        points.emplace_back( parseXY() );
+    }
+
+    aChain.Append( points );
+}
+
+
 void PCB_PARSER::parseEDA_TEXT( EDA_TEXT* aText )
 {
     wxCHECK_RET( CurTok() == T_effects,
@@ -484,6 +733,13 @@ BOARD_ITEM* PCB_PARSER::Parse()
     BOARD_ITEM*     item;
     LOCALE_IO       toggle;
 
+    // The zone fill cache is only valid for this call
+    struct CACHE_RELEASER
+    {
+        const ZONE_FILL_CACHE*& m_cache;
+        ~CACHE_RELEASER() { m_cache = NULL; }
+    } cacheReleaser{ m_zoneFillCache };
+
     // MODULEs can be prefixed with an initial block of single line comments and these
     // are kept for Format() so they round trip in s-expression form.  BOARDs might
     // eventually do the same, but currently do not.
@@ -623,6 +879,9 @@ BOARD* PCB_PARSER::parseBOARD_unchecked()
         }
     }
 
+    if( !m_deferredItems.empty() )
+        parseDeferredItems();
+
     if( m_undefinedLayers.size() > 0 )
     {
         bool deleteItems;
@@ -706,6 +965,316 @@ BOARD* PCB_PARSER::parseBOARD_unchecked()
 }
 
 
+/**
+ * Tells if the top level board item starting with aKeyword can be parsed on a worker thread.
+ */
+static bool isDeferredItem( const char* aKeyword, size_t aLength )
+{
+    static const char* const deferred[] = { "module", "segment", "arc", "via", "zone" };
+
+    for( const char* keyword : deferred )
+    {
+        if( strlen( keyword ) == aLength && !strncmp( keyword, aKeyword, aLength ) )
+            return true;
+    }
+
+    return false;
+}
+
+
+bool PCB_PARSER::SplitBoardItems( SPAN_LINE_READER& aReader )
+{
+    // Long runs of items are cut in pieces of about this size, to balance the threads
+    const size_t maxRunSize = 256 * 1024;
+    const char   header[] = "(kicad_pcb";
+    const char*  text = aReader.Data();
+    const size_t size = aReader.Size();
+    size_t       pos = 0;
+
+    m_deferredItems.clear();
+
+    while( pos < size && isspace( (unsigned char) text[pos] ) )
+        ++pos;
+
+    if( size - pos < sizeof( header ) - 1 || strncmp( text + pos, header, sizeof( header ) - 1 ) )
+        return false;
+
+    unsigned    line = 1;
+    size_t      lineStart = 0;          // offset of the current line
+    bool        lineStarted = false;    // a non blank char was found on the current line
+    int         depth = 0;
+
+    // The run of consecutive items being cut out, if any
+    bool        inRun = false;
+    size_t      runStart = 0;
+    size_t      runEnd = 0;
+    size_t      runColumn = 0;
+    unsigned    runFirstLine = 0;
+
+    auto endRun = [&]()
+    {
+        if( inRun && runEnd > runStart )
+        {
+            m_deferredItems.emplace_back();
+
+            DEFERRED_ITEMS& run = m_deferredItems.back();
+
+            // The first item is indented as in the file, to report the right offset in errors
+            run.m_text = text + runStart;
+            run.m_size = runEnd - runStart;
+            run.m_column = runColumn;
+            run.m_firstLine = runFirstLine;
+            run.m_legacyZoneFill = false;
+
+            // Parse() reads the rest of the file, where the run keeps its line breaks
+            aReader.Skip( runStart, runEnd );
+        }
+
+        inRun = false;
+    };
+
+    for( ; pos < size && depth >= 0; ++pos )
+    {
+        char c = text[pos];
+
+        if( c == '\n' )
+        {
+            line++;
+            lineStart = pos + 1;
+            lineStarted = false;
+            continue;
+        }
+
+        if( c == ' ' || c == '\t' || c == '\r' )
+            continue;
+
+        if( !lineStarted )
+        {
+            lineStarted = true;
+
+            // Lines starting with '#' are comments, see DSNLEXER::NextTok()
+            if( c == '#' )
+            {
+                while( pos + 1 < size && text[pos + 1] != '\n' )
+                    ++pos;
+
+                continue;
+            }
+        }
+
+        if( c == '"' )
+        {
+            // Quoted strings may hold parentheses and escaped quotes, but do not span lines
+            while( pos + 1 < size && text[pos + 1] != '\n' )
+            {
+                ++pos;
+
+                if( text[pos] == '\\' && pos + 1 < size && text[pos + 1] != '\n' )
+                    ++pos;
+                else if( text[pos] == '"' )
+                    break;
+            }
+        }
+        else if( c == '(' )
+        {
+            if( ++depth == 2 )
+            {
+                // A top level item of the board
+                size_t keywordEnd = pos + 1;
+
+                while( keywordEnd < size
+                        && ( islower( text[keywordEnd] ) || text[keywordEnd] == '_' ) )
+                    ++keywordEnd;
+
+                if( isDeferredItem( text + pos + 1, keywordEnd - pos - 1 ) )
+                {
+                    if( inRun && pos - runStart >= maxRunSize )
+                        endRun();
+
+                    if( !inRun )
+                    {
+                        inRun = true;
+                        runStart = runEnd = pos;
+                        runColumn = pos - lineStart;
+                        runFirstLine = line;
+                    }
+                }
+                else
+                {
+                    endRun();
+                }
+            }
+        }
+        else if( c == ')' )
+        {
+            if( depth == 2 && inRun )
+                runEnd = pos + 1;
+
+            if( --depth == 0 )
+                break;
+        }
+        else if( depth == 1 )
+        {
+            endRun();   // something else than an item at the board level
+        }
+    }
+
+    // An unterminated item is left to Parse() to report the error
+    endRun();
+
+    return true;
+}
+
+
+void PCB_PARSER::parseDeferredItems()
+{
+    std::atomic<size_t> nextRun( 0 );
+    size_t              parallelTaskCount =
+            std::min<size_t>( THREAD_POOL::Get().GetThreadCount(), m_deferredItems.size() );
+    std::vector<std::unique_ptr<PCB_PARSER>> workers;
+    const wxString                           source = CurSource();
+
+    // Each task has its own parser, knowing the layers and nets of the board
+    for( size_t ii = 0; ii < std::max<size_t>( parallelTaskCount, 1 ); ++ii )
+    {
+        PCB_PARSER* worker = new PCB_PARSER();
+
+        worker->m_board = m_board;
+        worker->m_layerIndices = m_layerIndices;
+        worker->m_layerMasks = m_layerMasks;
+        worker->m_netCodes = m_netCodes;
+        worker->m_tooRecent = m_tooRecent;
+        worker->m_requiredVersion = m_requiredVersion;
+        worker->m_zoneFillCache = m_zoneFillCache;
+
+        workers.emplace_back( worker );
+    }
+
+    auto lambda = [&]( PCB_PARSER* aParser )
+    {
+        for( size_t i = nextRun++; i < m_deferredItems.size(); i = nextRun++ )
+        {
+            DEFERRED_ITEMS&  run = m_deferredItems[i];
+            SPAN_LINE_READER reader( run.m_text, run.m_size, source, run.m_firstLine - 1,
+                                     run.m_column );
+
+            aParser->m_worker = &run;
+            aParser->PushReader( &reader );
+
+            try
+            {
+                for( T token = aParser->NextTok();  token != T_EOF;  token = aParser->NextTok() )
+                {
+                    if( token != T_LEFT )
+                        aParser->Expecting( T_LEFT );
+
+                    switch( aParser->NextTok() )
+                    {
+                    case T_module:
+                        run.m_items.push_back( aParser->parseMODULE() );
+                        break;
+
+                    case T_segment:
+                        run.m_items.push_back( aParser->parseTRACK() );
+                        break;
+
+                    case T_arc:
+                        run.m_items.push_back( aParser->parseARC() );
+                        break;
+
+                    case T_via:
+                        run.m_items.push_back( aParser->parseVIA() );
+                        break;
+
+                    case T_zone:
+                        run.m_items.push_back( aParser->parseZONE_CONTAINER( m_board ) );
+                        break;
+
+                    default:
+                        aParser->Expecting( "module, segment, arc, via or zone" );
+                    }
+                }
+            }
+            catch( ... )
+            {
+                run.m_error = std::current_exception();
+            }
+
+            aParser->PopReader();
+            aParser->m_worker = NULL;
+        }
+    };
+
+    if( parallelTaskCount <= 1 )
+        lambda( workers[0].get() );
+    else
+    {
+        TASK_GROUP tasks;
+
+        for( size_t ii = 0; ii < parallelTaskCount; ++ii )
+        {
+            PCB_PARSER* worker = workers[ii].get();
+
+            tasks.Run( [&lambda, worker]() { lambda( worker ); } );
+        }
+
+        tasks.Wait();
+    }
+
+    // A footprint may require a newer format than the header, which turns the parse errors
+    // into FUTURE_FORMAT_ERRORs
+    for( const std::unique_ptr<PCB_PARSER>& worker : workers )
+    {
+        m_undefinedLayers.insert( worker->m_undefinedLayers.begin(),
+                                  worker->m_undefinedLayers.end() );
+
+        m_requiredVersion = std::max( m_requiredVersion, worker->m_requiredVersion );
+        m_tooRecent |= worker->m_tooRecent;
+    }
+
+    try
+    {
+        bool legacyZoneFill = false;
+
+        // The runs are in file order, and each one stops at its first error: this is the
+        // first error of the deferred items.  Errors in the other items were already thrown
+        // while they were parsed, even when they come later in the file.
+        for( DEFERRED_ITEMS& run : m_deferredItems )
+        {
+            if( run.m_error )
+                std::rethrow_exception( run.m_error );
+
+            legacyZoneFill |= run.m_legacyZoneFill;
+        }
+
+        if( legacyZoneFill )
+            acceptLegacyZoneFill();
+    }
+    catch( ... )
+    {
+        for( DEFERRED_ITEMS& run : m_deferredItems )
+        {
+            for( BOARD_ITEM* item : run.m_items )
+                delete item;
+        }
+
+        m_deferredItems.clear();
+        throw;
+    }
+
+    for( DEFERRED_ITEMS& run : m_deferredItems )
+    {
+        for( BOARD_ITEM* item : run.m_items )
+            m_board->Add( item, ADD_MODE::APPEND );
+
+        for( const std::pair<ZONE_CONTAINER*, wxString>& zoneNet : run.m_zoneNets )
+            fixZoneNet( zoneNet.first, zoneNet.second );
+    }
+
+    m_deferredItems.clear();
+}
+
+
 void PCB_PARSER::parseHeader()
 {
     wxCHECK_RET( CurTok() == T_kicad_pcb,
@@ -3654,6 +4223,7 @@ ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER( BOARD_ITEM_CONTAINER* aParent )
 
     // bigger scope since each filled_polygon is concatenated in here
     SHAPE_POLY_SET pts;
+    bool fillFromCache = false;
     bool inModule = false;
 
     if( dynamic_cast<MODULE*>( aParent ) )      // The zone belongs a footprint
@@ -3803,24 +4373,12 @@ ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER( BOARD_ITEM_CONTAINER* aParent )
                     if( token == T_segment )    // deprecated
                     {
                         // SEGMENT fill mode no longer supported.  Make sure user is OK with converting them.
-                        if( m_showLegacyZoneWarning )
-                        {
-                            KIDIALOG dlg( nullptr,
-                                          _( "The legacy segment fill mode is no longer supported.\n"
-                                             "Convert zones to polygon fills?"),
-                                          _( "Legacy Zone Warning" ),
-                                          wxYES_NO | wxICON_WARNING );
-
-                            dlg.DoNotShowCheckbox( __FILE__, __LINE__ );
-
-                            if( dlg.ShowModal() == wxID_NO )
-                                THROW_IO_ERROR( wxT( "CANCEL" ) );
-
-                            m_showLegacyZoneWarning = false;
-                        }
+                        if( m_worker )
+                            m_worker->m_legacyZoneFill = true;
+                        else
+                            acceptLegacyZoneFill();
 
                         zone->SetFillMode( ZONE_FILL_MODE::POLYGONS );
-                        m_board->SetModified();
                     }
                     else if( token == T_hatch )
                         zone->SetFillMode( ZONE_FILL_MODE::HATCH_PATTERN );
@@ -3974,6 +4532,14 @@ ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER( BOARD_ITEM_CONTAINER* aParent )
             break;
 
         case T_filled_polygon:
+            // The zone fill cache holds the fills of this zone
+            if( m_zoneFillCache && m_zoneFillCache->Contains( zone->m_Uuid ) )
+            {
+                fillFromCache = true;
+                skipCurrentRaw();
+                break;
+            }
+
             {
                 // "(filled_polygon (pts"
                 NeedLEFT();
@@ -3983,11 +4549,7 @@ ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER( BOARD_ITEM_CONTAINER* aParent )
                     Expecting( T_pts );
 
                 pts.NewOutline();
-
-                for( token = NextTok();  token != T_RIGHT;  token = NextTok() )
-                {
-                    pts.Append( parseXY() );
-                }
+                parseXYList( pts.Outline( pts.OutlineCount() - 1 ) );
 
                 NeedRIGHT();
             }
@@ -4034,7 +4596,14 @@ ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER( BOARD_ITEM_CONTAINER* aParent )
         zone->SetHatch( hatchStyle, hatchPitch, true );
     }
 
-    if( !pts.IsEmpty() )
+    if( fillFromCache )
+    {
+        // ZONE_FILL_CACHE::Load() has checked the entry, and the fills of the board file are
+        // skipped already
+        if( !m_zoneFillCache->Apply( zone.get() ) )
+            THROW_IO_ERROR( _( "Invalid zone fill cache" ) );
+    }
+    else if( !pts.IsEmpty() )
     {
         zone->SetFilledPolysList( pts );
         zone->CalculateFilledArea();
@@ -4054,31 +4623,10 @@ ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER( BOARD_ITEM_CONTAINER* aParent )
         // Can happens which old boards, with nonexistent nets ...
         // or after being edited by hand
         // We try to fix the mismatch.
-        NETINFO_ITEM* net = m_board->FindNet( netnameFromfile );
-
-        if( net )   // An existing net has the same net name. use it for the zone
-            zone->SetNetCode( net->GetNet() );
-        else    // Not existing net: add a new net to keep trace of the zone netname
-        {
-            int newnetcode = m_board->GetNetCount();
-            net = new NETINFO_ITEM( m_board, netnameFromfile, newnetcode );
-            m_board->Add( net );
-
-            // Store the new code mapping
-            pushValueIntoMap( newnetcode, net->GetNet() );
-            // and update the zone netcode
-            zone->SetNetCode( net->GetNet() );
-
-            // FIXME: a call to any GUI item is not allowed in io plugins:
-            // Change this code to generate a warning message outside this plugin
-            // Prompt the user
-            wxString msg;
-            msg.Printf( _( "There is a zone that belongs to a not existing net\n"
-                           "\"%s\"\n"
-                           "you should verify and edit it (run DRC test)." ),
-                           GetChars( netnameFromfile ) );
-            DisplayError( NULL, msg );
-        }
+        if( m_worker )
+            m_worker->m_zoneNets.emplace_back( zone.get(), netnameFromfile );
+        else
+            fixZoneNet( zone.get(), netnameFromfile );
     }
 
     // Clear flags used in zone edition:
@@ -4088,6 +4636,58 @@ ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER( BOARD_ITEM_CONTAINER* aParent )
 }
 
 
+void PCB_PARSER::acceptLegacyZoneFill()
+{
+    if( m_showLegacyZoneWarning )
+    {
+        KIDIALOG dlg( nullptr,
+                      _( "The legacy segment fill mode is no longer supported.\n"
+                         "Convert zones to polygon fills?"),
+                      _( "Legacy Zone Warning" ),
+                      wxYES_NO | wxICON_WARNING );
+
+        dlg.DoNotShowCheckbox( __FILE__, __LINE__ );
+
+        if( dlg.ShowModal() == wxID_NO )
+            THROW_IO_ERROR( wxT( "CANCEL" ) );
+
+        m_showLegacyZoneWarning = false;
+    }
+
+    m_board->SetModified();
+}
+
+
+void PCB_PARSER::fixZoneNet( ZONE_CONTAINER* aZone, const wxString& aNetname )
+{
+    NETINFO_ITEM* net = m_board->FindNet( aNetname );
+
+    if( net )   // An existing net has the same net name. use it for the zone
+        aZone->SetNetCode( net->GetNet() );
+    else    // Not existing net: add a new net to keep trace of the zone netname
+    {
+        int newnetcode = m_board->GetNetCount();
+        net = new NETINFO_ITEM( m_board, aNetname, newnetcode );
+        m_board->Add( net );
+
+        // Store the new code mapping
+        pushValueIntoMap( newnetcode, net->GetNet() );
+        // and update the zone netcode
+        aZone->SetNetCode( net->GetNet() );
+
+        // FIXME: a call to any GUI item is not allowed in io plugins:
+        // Change this code to generate a warning message outside this plugin
+        // Prompt the user
+        wxString msg;
+        msg.Printf( _( "There is a zone that belongs to a not existing net\n"
+                       "\"%s\"\n"
+                       "you should verify and edit it (run DRC test)." ),
+                       GetChars( aNetname ) );
+        DisplayError( NULL, msg );
+    }
+}
+
+
 PCB_TARGET* PCB_PARSER::parsePCB_TARGET()
 {
     wxCHECK_MSG( CurTok() == T_target, NULL,
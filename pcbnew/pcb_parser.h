@@ -36,6 +36,7 @@
 #include <math/util.h>                           // KiROUND, Clamp
 #include <pcb_lexer.h>
 
+#include <exception>
 #include <unordered_map>
 
 
@@ -58,6 +59,8 @@ class VIA;
 class ZONE_CONTAINER;
 class MARKER_PCB;
 class MODULE_3D_SETTINGS;
+class SHAPE_LINE_CHAIN;
+class ZONE_FILL_CACHE;
 struct LAYER;
 
 
@@ -81,6 +84,34 @@ class PCB_PARSER : public PCB_LEXER
 
     bool                m_showLegacyZoneWarning;
 
+    /**
+     * DEFERRED_ITEMS
+     * holds a run of consecutive footprints, tracks and zones cut out of a board file by
+     * SplitBoardItems(), and the results of their parsing on a worker thread.
+     */
+    struct DEFERRED_ITEMS
+    {
+        const char*              m_text;            ///< the items, in the file span
+        size_t                   m_size;            ///< the size of m_text
+        unsigned                 m_column;          ///< column of m_text in its first line
+        unsigned                 m_firstLine;       ///< line number of m_text in the file
+        std::vector<BOARD_ITEM*> m_items;           ///< the parsed items, in file order
+        bool                     m_legacyZoneFill;  ///< a zone uses the legacy segment fill
+        std::exception_ptr       m_error;           ///< the parse error, if any
+
+        ///> zones whose net name does not match their net code, see fixZoneNet()
+        std::vector<std::pair<ZONE_CONTAINER*, wxString>> m_zoneNets;
+    };
+
+    std::vector<DEFERRED_ITEMS> m_deferredItems;    ///< items to parse on worker threads
+
+    ///> the items being parsed when running on a worker thread, NULL on the main thread.
+    ///> Board changes and user prompts are then recorded in it for the main thread.
+    DEFERRED_ITEMS*     m_worker;
+
+    ///> the fills of the zones of the board being parsed, NULL if none, see SetZoneFillCache()
+    const ZONE_FILL_CACHE* m_zoneFillCache;
+
     ///> Converts net code using the mapping table if available,
     ///> otherwise returns unchanged net code if < 0 or if is is out of range
     inline int getNetCode( int aNetCode )
@@ -123,6 +154,13 @@ class PCB_PARSER : public PCB_LEXER
      */
     void skipCurrent();
 
+    /**
+     * Function skipCurrentRaw
+     * does the same as skipCurrent() by scanning the parentheses of the input text instead
+     * of reading tokens, which is much quicker for large blocks such as zone fills.
+     */
+    void skipCurrentRaw();
+
     void parseHeader();
     void parseGeneralSection();
     void parsePAGE_INFO();
@@ -171,6 +209,30 @@ class PCB_PARSER : public PCB_LEXER
      */
     BOARD*          parseBOARD_unchecked();
 
+    /**
+     * Function parseDeferredItems
+     * parses the items cut out by SplitBoardItems() on worker threads, and adds them to the
+     * board in file order.
+     *
+     * @throw IO_ERROR or PARSE_ERROR of the first faulty deferred item in the file.
+     */
+    void            parseDeferredItems();
+
+    /**
+     * Function acceptLegacyZoneFill
+     * asks the user, once, whether zones with the legacy segment fill mode can be converted
+     * to polygon fills.
+     *
+     * @throw IO_ERROR if the user refuses.
+     */
+    void            acceptLegacyZoneFill();
+
+    /**
+     * Function fixZoneNet
+     * gives aZone the net named aNetname, which is created if the board does not have it.
+     */
+    void            fixZoneNet( ZONE_CONTAINER* aZone, const wxString& aNetname );
+
 
     /**
      * Function lookUpLayer
@@ -220,6 +282,17 @@ class PCB_PARSER : public PCB_LEXER
 
     void parseXY( int* aX, int* aY );
 
+    /**
+     * Function parseXYList
+     * parses the (xy X Y) points of a (pts ...) list up to and including its closing
+     * parenthesis, and appends them to @a aChain.  Points whose coordinates are plain
+     * fixed point numbers, as KiCad writes them, are read straight from the lexer buffer
+     * without making tokens.
+     *
+     * @throw PARSE_ERROR if the coordinate pair syntax is incorrect.
+     */
+    void parseXYList( SHAPE_LINE_CHAIN& aChain );
+
     /**
      * Function parseEDA_TEXT
      * parses the common settings for any object derived from #EDA_TEXT.
@@ -252,37 +325,19 @@ class PCB_PARSER : public PCB_LEXER
         return parseDouble( GetTokenText( aToken ) );
     }
 
-    inline int parseBoardUnits()
-    {
-        // There should be no major rounding issues here, since the values in
-        // the file are in mm and get converted to nano-meters.
-        // See test program tools/test-nm-biu-to-ascii-mm-round-tripping.cpp
-        // to confirm or experiment.  Use a similar strategy in both places, here
-        // and in the test program. Make that program with:
-        // $ make test-nm-biu-to-ascii-mm-round-tripping
-        auto retval = parseDouble() * IU_PER_MM;
-
-        // N.B. we currently represent board units as integers.  Any values that are
-        // larger or smaller than those board units represent undefined behavior for
-        // the system.  We limit values to the largest that is visible on the screen
-        // This is the diagonal distance of the full screen ~1.5m
-        double int_limit = std::numeric_limits<int>::max() * 0.7071;    // 0.7071 = roughly 1/sqrt(2)
-        return KiROUND( Clamp<double>( -int_limit, retval, int_limit ) );
-    }
+    /**
+     * Function parseBoardUnits
+     * parses the current token as a length in mm and converts it to board units.
+     *
+     * @throw IO_ERROR if an error occurs attempting to convert the current token.
+     * @return The length in board units.
+     */
+    int parseBoardUnits();
 
     inline int parseBoardUnits( const char* aExpected )
     {
-        auto retval = parseDouble( aExpected ) * IU_PER_MM;
-
-        // N.B. we currently represent board units as integers.  Any values that are
-        // larger or smaller than those board units represent undefined behavior for
-        // the system.  We limit values to the largest that is visible on the screen
-        double int_limit = std::numeric_limits<int>::max() * 0.7071;
-
-        // Use here KiROUND, not KIROUND (see comments about them)
-        // when having a function as argument, because it will be called twice
-        // with KIROUND
-        return KiROUND( Clamp<double>( -int_limit, retval, int_limit ) );
+        NeedNUMBER( aExpected );
+        return parseBoardUnits();
     }
 
     inline int parseBoardUnits( PCB_KEYS_T::T aToken )
@@ -319,7 +374,9 @@ public:
 
     PCB_PARSER( LINE_READER* aReader = NULL ) :
         PCB_LEXER( aReader ),
-        m_board( 0 )
+        m_board( 0 ),
+        m_worker( NULL ),
+        m_zoneFillCache( NULL )
     {
         init();
     }
@@ -345,7 +402,35 @@ public:
         m_board = aBoard;
     }
 
+    /**
+     * Function SetZoneFillCache
+     * gives the cached fills of the zones of the board to parse.  The filled polygons of
+     * the zones found in @a aCache are then skipped in the board file, and taken from the
+     * cache instead.  The cache is only used by the next call to Parse().
+     */
+    void SetZoneFillCache( const ZONE_FILL_CACHE* aCache )
+    {
+        m_zoneFillCache = aCache;
+    }
+
     BOARD_ITEM* Parse();
+
+    /**
+     * Function SplitBoardItems
+     * prepares the loading of a whole board file held in memory.  A quick scan of the
+     * parentheses cuts the footprints, tracks and zones out of the file.  They are parsed
+     * on several threads by Parse(), once the other items of the board have been read.
+     * Must be called after SetBoard().
+     *
+     * The cut out items are skipped by @a aReader, which must then be given to Parse().
+     * Nothing is copied: the items are parsed in place, so the span of @a aReader must
+     * outlive Parse().  Line numbers are kept, so parse errors still point into the file.
+     *
+     * @param aReader is the reader of the board file, before any line was read.
+     * @return bool - false if @a aReader does not hold a board, in which case it is left as
+     *                is.
+     */
+    bool SplitBoardItems( SPAN_LINE_READER& aReader );
     /**
      * Function parseMODULE
      * @param aInitialComments may be a pointer to a heap allocated initial comment block
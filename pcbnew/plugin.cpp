@@ -24,6 +24,7 @@
 
 #include <io_mgr.h>
 #include <properties.h>
+#include <class_module.h>
 
 
 #define FMT_UNIMPLEMENTED   _( "Plugin \"%s\" does not implement the \"%s\" function." )
@@ -81,6 +82,31 @@ const MODULE* PLUGIN::GetEnumeratedFootprint( const wxString& aLibraryPath,
 }
 
 
+bool PLUGIN::GetEnumeratedFootprintSummary( const wxString& aLibraryPath,
+                                            const wxString& aFootprintName,
+                                            FOOTPRINT_SUMMARY& aSummary,
+                                            const PROPERTIES* aProperties )
+{
+    // default implementation
+    const MODULE* footprint = GetEnumeratedFootprint( aLibraryPath, aFootprintName, aProperties );
+
+    if( !footprint )
+        return false;
+
+    aSummary.Assign( footprint );
+    return true;
+}
+
+
+void FOOTPRINT_SUMMARY::Assign( const MODULE* aFootprint )
+{
+    m_Keywords = aFootprint->GetKeywords();
+    m_Doc = aFootprint->GetDescription();
+    m_PadCount = aFootprint->GetPadCount( DO_NOT_INCLUDE_NPTH );
+    m_UniquePadCount = aFootprint->GetUniquePadCount( DO_NOT_INCLUDE_NPTH );
+}
+
+
 bool PLUGIN::FootprintExists( const wxString& aLibraryPath, const wxString& aFootprintName,
                               const PROPERTIES* aProperties )
 {
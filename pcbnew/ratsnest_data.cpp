@@ -38,7 +38,11 @@ using namespace std::placeholders;
 
 #include <cassert>
 #include <algorithm>
+#include <cmath>
 #include <limits>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
 
 static uint64_t getDistance( const CN_ANCHOR_PTR& aNode1, const CN_ANCHOR_PTR& aNode2 )
 {
@@ -49,9 +53,42 @@ static uint64_t getDistance( const CN_ANCHOR_PTR& aNode1, const CN_ANCHOR_PTR& a
 }
 
 
+static bool lessPosition( const VECTOR2I& aPos1, const VECTOR2I& aPos2 )
+{
+    if( aPos1.y != aPos2.y )
+        return aPos1.y < aPos2.y;
+
+    return aPos1.x < aPos2.x;
+}
+
+
 static bool sortWeight( const CN_EDGE& aEdge1, const CN_EDGE& aEdge2 )
 {
-    return aEdge1.GetWeight() < aEdge2.GetWeight();
+    if( aEdge1.GetWeight() != aEdge2.GetWeight() )
+        return aEdge1.GetWeight() < aEdge2.GetWeight();
+
+    // Edges of equal weight are ordered by their exact length, then by their end positions,
+    // so that the spanning tree is the same whatever the order the edges were found in
+    const VECTOR2I& src1 = aEdge1.GetSourceNode()->Pos();
+    const VECTOR2I& dst1 = aEdge1.GetTargetNode()->Pos();
+    const VECTOR2I& src2 = aEdge2.GetSourceNode()->Pos();
+    const VECTOR2I& dst2 = aEdge2.GetTargetNode()->Pos();
+
+    VECTOR2I::extended_type len1 = ( dst1 - src1 ).SquaredEuclideanNorm();
+    VECTOR2I::extended_type len2 = ( dst2 - src2 ).SquaredEuclideanNorm();
+
+    if( len1 != len2 )
+        return len1 < len2;
+
+    bool swap1 = lessPosition( dst1, src1 );
+    bool swap2 = lessPosition( dst2, src2 );
+    const VECTOR2I& first1 = swap1 ? dst1 : src1;
+    const VECTOR2I& first2 = swap2 ? dst2 : src2;
+
+    if( first1 != first2 )
+        return lessPosition( first1, first2 );
+
+    return lessPosition( swap1 ? src1 : dst1, swap2 ? src2 : dst2 );
 }
 
 
@@ -67,82 +104,96 @@ static const std::vector<CN_EDGE> kruskalMST( std::list<CN_EDGE>& aEdges,
     std::vector<CN_EDGE> mst;
 
     // Set tags for marking cycles
-    std::unordered_map<CN_ANCHOR_PTR, int> tags;
+    std::unordered_map<const CN_ANCHOR*, int> tags;
     unsigned int tag = 0;
 
     for( auto& node : aNodes )
     {
         node->SetTag( tag );
-        tags[node] = tag++;
+        tags[node.get()] = tag++;
     }
 
-    // Lists of nodes connected together (subtrees) to detect cycles in the graph
-    std::vector<std::list<int> > cycles( nodeNumber );
+    // Disjoint sets of nodes connected together (subtrees) to detect cycles in the graph
+    std::vector<int> parents( nodeNumber );
+    std::vector<int> ranks( nodeNumber, 0 );
 
     for( unsigned int i = 0; i < nodeNumber; ++i )
-        cycles[i].push_back( i );
+        parents[i] = i;
+
+    auto findSet = [&parents] ( int aTag )
+    {
+        while( parents[aTag] != aTag )
+        {
+            parents[aTag] = parents[ parents[aTag] ];
+            aTag = parents[aTag];
+        }
+
+        return aTag;
+    };
+
+    // Connected items are processed first, so once the first ratsnest line is found the
+    // subtrees are the groups of connected nodes, which is what the node tags stand for
+    auto tagConnectedNodes = [&] ()
+    {
+        for( unsigned int i = 0; i < nodeNumber; ++i )
+            aNodes[i]->SetTag( findSet( i ) );
+    };
 
     // Kruskal algorithm requires edges to be sorted by their weight
     aEdges.sort( sortWeight );
 
-    while( mstSize < mstExpectedSize && !aEdges.empty() )
+    for( auto it = aEdges.begin(); mstSize < mstExpectedSize && it != aEdges.end(); ++it )
     {
-        //printf("mstSize %d %d\n", mstSize, mstExpectedSize);
-        auto& dt = aEdges.front();
+        const auto& dt = *it;
 
-        int srcTag  = tags[dt.GetSourceNode()];
-        int trgTag  = tags[dt.GetTargetNode()];
+        int srcTag  = findSet( tags[dt.GetSourceNode().get()] );
+        int trgTag  = findSet( tags[dt.GetTargetNode().get()] );
 
         // Check if by adding this edge we are going to join two different forests
-        if( srcTag != trgTag )
+        if( srcTag == trgTag )
+            continue;
+
+        // Because edges are sorted by their weight, first we always process connected
+        // items (weight == 0). Once we stumble upon an edge with non-zero weight,
+        // it means that the rest of the lines are ratsnest.
+        if( !ratsnestLines && dt.GetWeight() != 0 )
         {
-            // Because edges are sorted by their weight, first we always process connected
-            // items (weight == 0). Once we stumble upon an edge with non-zero weight,
-            // it means that the rest of the lines are ratsnest.
-            if( !ratsnestLines && dt.GetWeight() != 0 )
-                ratsnestLines = true;
-
-            // Update tags
-            if( ratsnestLines )
-            {
-                for( auto it = cycles[trgTag].begin(); it != cycles[trgTag].end(); ++it )
-                {
-                    tags[aNodes[*it]] = srcTag;
-                }
+            ratsnestLines = true;
+            tagConnectedNodes();
+        }
 
-                // Do a copy of edge, but make it RN_EDGE_MST. In contrary to RN_EDGE,
-                // RN_EDGE_MST saves both source and target node and does not require any other
-                // edges to exist for getting source/target nodes
-                CN_EDGE newEdge ( dt.GetSourceNode(), dt.GetTargetNode(), dt.GetWeight() );
+        if( ratsnestLines )
+        {
+            // Do a copy of edge, but make it RN_EDGE_MST. In contrary to RN_EDGE,
+            // RN_EDGE_MST saves both source and target node and does not require any other
+            // edges to exist for getting source/target nodes
+            CN_EDGE newEdge ( dt.GetSourceNode(), dt.GetTargetNode(), dt.GetWeight() );
 
-                assert( newEdge.GetSourceNode()->GetTag() != newEdge.GetTargetNode()->GetTag() );
-                assert( newEdge.GetWeight() > 0 );
+            assert( newEdge.GetSourceNode()->GetTag() != newEdge.GetTargetNode()->GetTag() );
+            assert( newEdge.GetWeight() > 0 );
 
-                mst.push_back( newEdge );
-                ++mstSize;
-            }
-            else
-            {
-                // for( it = cycles[trgTag].begin(), itEnd = cycles[trgTag].end(); it != itEnd; ++it )
-                // for( auto it : cycles[trgTag] )
-                for( auto it = cycles[trgTag].begin(); it != cycles[trgTag].end(); ++it )
-                {
-                    tags[aNodes[*it]] = srcTag;
-                    aNodes[*it]->SetTag( srcTag );
-                }
+            mst.push_back( newEdge );
+            ++mstSize;
+        }
+        else
+        {
+            // Processing a connection, decrease the expected size of the ratsnest MST
+            --mstExpectedSize;
+        }
 
-                // Processing a connection, decrease the expected size of the ratsnest MST
-                --mstExpectedSize;
-            }
+        // Join the subtrees, attaching the shallower one to the deeper one
+        if( ranks[srcTag] < ranks[trgTag] )
+            std::swap( srcTag, trgTag );
 
-            // Move nodes that were marked with old tag to the list marked with the new tag
-            cycles[srcTag].splice( cycles[srcTag].end(), cycles[trgTag] );
-        }
+        parents[trgTag] = srcTag;
 
-        // Remove the edge that was just processed
-        aEdges.erase( aEdges.begin() );
+        if( ranks[srcTag] == ranks[trgTag] )
+            ranks[srcTag]++;
     }
 
+    if( !ratsnestLines )
+        tagConnectedNodes();
+
     // Probably we have discarded some of edges, so reduce the size
     mst.resize( mstSize );
 
@@ -155,16 +206,29 @@ class RN_NET::TRIANGULATOR_STATE
 private:
     std::vector<CN_ANCHOR_PTR>  m_allNodes;
 
-    std::list<hed::EDGE_PTR> hedTriangulation( std::vector<hed::NODE_PTR>& aNodes )
+    ///> Vertex positions of the previous triangulation
+    std::vector<VECTOR2I>       m_prevVertices;
+
+    ///> Edges of the previous triangulation, as pairs of vertex positions
+    std::vector<std::pair<VECTOR2I, VECTOR2I>> m_prevEdges;
+
+    static bool sortPosition( const CN_ANCHOR_PTR& aNode1, const CN_ANCHOR_PTR& aNode2 )
     {
-        hed::TRIANGULATION triangulator;
-        triangulator.CreateDelaunay( aNodes.begin(), aNodes.end() );
-        std::list<hed::EDGE_PTR> edges;
-        triangulator.GetEdges( edges );
+        return lessPosition( aNode1->Pos(), aNode2->Pos() );
+    }
 
-        return edges;
+    static uint64_t positionKey( const VECTOR2I& aPos )
+    {
+        return ( uint64_t( uint32_t( aPos.x ) ) << 32 ) | uint32_t( aPos.y );
     }
 
+    static std::pair<uint64_t, uint64_t> edgeKey( const VECTOR2I& aPos1, const VECTOR2I& aPos2 )
+    {
+        uint64_t key1 = positionKey( aPos1 );
+        uint64_t key2 = positionKey( aPos2 );
+
+        return std::make_pair( std::min( key1, key2 ), std::max( key1, key2 ) );
+    }
 
     // Checks if all nodes in aNodes lie on a single line. Requires the nodes to
     // have unique coordinates!
@@ -189,113 +253,305 @@ private:
         return true;
     }
 
-public:
-
-    void Clear()
+    /**
+     * Builds the Delaunay triangulation edges of aVertices, which must have unique positions
+     * and be sorted with sortPosition().
+     */
+    void triangulate( const std::vector<CN_ANCHOR_PTR>& aVertices,
+                      std::vector<CN_EDGE>& aEdges ) const
     {
-        m_allNodes.clear();
+        std::vector<hed::NODE_PTR> triNodes;
+        triNodes.reserve( aVertices.size() );
+
+        for( unsigned int i = 0; i < aVertices.size(); i++ )
+        {
+            auto tn = std::make_shared<hed::NODE> ( aVertices[i]->Pos().x, aVertices[i]->Pos().y );
+
+            tn->SetId( i );
+            triNodes.push_back( tn );
+        }
+
+        if( triNodes.size() <= 1 )
+        {
+            return;
+        }
+        else if( areNodesColinear( triNodes ) )
+        {
+            // special case: all nodes are on the same line - there's no
+            // triangulation for such set. In this case, we sort along any coordinate
+            // and chain the nodes together.
+            for(int i = 0; i < (int)triNodes.size() - 1; i++ )
+            {
+                const auto& src = aVertices[i];
+                const auto& dst = aVertices[i + 1];
+                aEdges.emplace_back( src, dst, getDistance( src, dst ) );
+            }
+        }
+        else
+        {
+            std::list<hed::EDGE_PTR> triangEdges;
+            hed::TRIANGULATION triangulator;
+            triangulator.CreateDelaunay( triNodes.begin(), triNodes.end() );
+            triangulator.GetEdges( triangEdges );
+
+            for( const auto& e : triangEdges )
+            {
+                const auto& src = aVertices[ e->GetSourceNode()->Id() ];
+                const auto& dst = aVertices[ e->GetTargetNode()->Id() ];
+
+                aEdges.emplace_back( src, dst, getDistance( src, dst ) );
+            }
+        }
     }
 
-    void AddNode( CN_ANCHOR_PTR aNode )
+    /**
+     * Checks if every disk of diameter aDiameter having aCenter on its border holds one of the
+     * positions found by aQuery (other than aCenter) strictly inside.
+     */
+    template <typename QUERY>
+    static bool isSurrounded( const VECTOR2I& aCenter, double aDiameter, QUERY aQuery )
     {
-        m_allNodes.push_back( aNode );
+        // A position at distance d and angle phi from aCenter lies inside the disks pointing
+        // less than acos( d / aDiameter ) away from phi.  The arcs are slightly shrunk, so
+        // that rounding errors can only make the test fail.
+        const double twoPi = 2.0 * M_PI;
+        std::vector<std::pair<double, double>> arcs;
+
+        aQuery( aCenter, aDiameter,
+                [&] ( const VECTOR2I& aPos )
+                {
+                    VECTOR2D d( aPos - aCenter );
+                    double   dist = d.EuclideanNorm();
+
+                    if( dist == 0.0 || dist >= aDiameter )
+                        return;
+
+                    double halfWidth = acos( dist / aDiameter ) - 1e-6;
+
+                    if( halfWidth <= 0.0 )
+                        return;
+
+                    double start = atan2( d.y, d.x ) - halfWidth;
+                    start -= twoPi * floor( start / twoPi );
+                    double end = start + 2.0 * halfWidth;
+
+                    if( end > twoPi )
+                    {
+                        arcs.emplace_back( start, twoPi );
+                        arcs.emplace_back( 0.0, end - twoPi );
+                    }
+                    else
+                    {
+                        arcs.emplace_back( start, end );
+                    }
+                } );
+
+        std::sort( arcs.begin(), arcs.end() );
+
+        double reach = 0.0;
+
+        for( const auto& arc : arcs )
+        {
+            if( arc.first > reach )
+                return false;
+
+            reach = std::max( reach, arc.second );
+        }
+
+        return reach >= twoPi;
     }
 
-    const std::list<CN_EDGE> Triangulate()
+    /**
+     * Updates the previous triangulation to aVertices instead of triangulating them again.
+     *
+     * The spanning tree only uses edges whose diametral disk holds no other vertex, and such
+     * edges belong to every Delaunay triangulation.  The updated edge set keeps all of them:
+     * - an edge between unchanged vertices whose disk held no changed vertex was already
+     *   found by the previous triangulation;
+     * - the disk of any other such edge is empty and touches an added or removed position.
+     *   When the vertices around that position leave no empty disk of diameter r touching
+     *   it, both ends of the edge lie within 2r of it, so triangulating the vertices within
+     *   2r of each changed position finds the edge.
+     * Edges of the previous triangulation which are no longer Delaunay edges are kept; they
+     * have the right length and cannot be picked by the spanning tree.
+     * @return false if the update cannot be done locally, and a full triangulation is needed
+     */
+    bool updateTriangulation( const std::vector<CN_ANCHOR_PTR>& aVertices,
+                              std::vector<CN_EDGE>& aEdges ) const
     {
-        std::list<CN_EDGE> mstEdges;
-        std::list<hed::EDGE_PTR> triangEdges;
-        std::vector<hed::NODE_PTR> triNodes;
+        if( m_prevVertices.empty() )
+            return false;
+
+        std::unordered_map<uint64_t, size_t> curIndex;
+        std::unordered_set<uint64_t> prevSet;
+        std::vector<VECTOR2I> changed;
+
+        for( size_t i = 0; i < aVertices.size(); i++ )
+            curIndex.emplace( positionKey( aVertices[i]->Pos() ), i );
+
+        for( const auto& pos : m_prevVertices )
+        {
+            prevSet.insert( positionKey( pos ) );
+
+            if( !curIndex.count( positionKey( pos ) ) )
+                changed.push_back( pos );
+        }
+
+        for( const auto& v : aVertices )
+        {
+            if( !prevSet.count( positionKey( v->Pos() ) ) )
+                changed.push_back( v->Pos() );
+        }
+
+        if( changed.size() * 4 > aVertices.size() )
+            return false;
 
-        using ANCHOR_LIST = std::vector<CN_ANCHOR_PTR>;
-        std::vector<ANCHOR_LIST> anchorChains;
+        // Vertices sorted by abscissa, to quickly find the ones lying in an area
+        std::vector<size_t> byX( aVertices.size() );
 
-        triNodes.reserve( m_allNodes.size() );
-        anchorChains.resize( m_allNodes.size() );
+        for( size_t i = 0; i < byX.size(); i++ )
+            byX[i] = i;
 
-        std::sort( m_allNodes.begin(), m_allNodes.end(),
-                [] ( const CN_ANCHOR_PTR& aNode1, const CN_ANCHOR_PTR& aNode2 )
+        std::sort( byX.begin(), byX.end(),
+                [&] ( size_t a, size_t b ) {
+            return aVertices[a]->Pos().x < aVertices[b]->Pos().x;
+        } );
+
+        // Calls aFunc for the index of each vertex at most aRadius away from aCenter along
+        // each axis
+        auto queryIndices = [&] ( const VECTOR2I& aCenter, double aRadius, auto aFunc )
         {
-            if( aNode1->Pos().y < aNode2->Pos().y )
-                return true;
-            else if( aNode1->Pos().y == aNode2->Pos().y )
+            double left = aCenter.x - aRadius;
+            double right = aCenter.x + aRadius;
+
+            auto it = std::lower_bound( byX.begin(), byX.end(), left,
+                    [&] ( size_t a, double x ) { return aVertices[a]->Pos().x < x; } );
+
+            for( ; it != byX.end() && aVertices[*it]->Pos().x <= right; ++it )
             {
-                return aNode1->Pos().x < aNode2->Pos().x;
+                if( std::abs( double( aVertices[*it]->Pos().y ) - aCenter.y ) <= aRadius )
+                    aFunc( *it );
             }
+        };
 
-            return false;
-        }
-                );
+        auto queryPositions = [&] ( const VECTOR2I& aCenter, double aRadius, auto aFunc )
+        {
+            queryIndices( aCenter, aRadius,
+                    [&] ( size_t i ) { aFunc( aVertices[i]->Pos() ); } );
+        };
 
-        CN_ANCHOR_PTR prev, last;
-        int id = 0;
+        // Start from a few times the mean distance between vertices
+        double width = aVertices[byX.back()]->Pos().x - aVertices[byX.front()]->Pos().x;
+        double height = aVertices.back()->Pos().y - aVertices.front()->Pos().y;
+        double maxDiameter = 2.0 * hypot( width, height );
+        double startDiameter = std::max( { 1.0, 2.0 * sqrt( width * height / aVertices.size() ),
+                                           2.0 * ( width + height ) / aVertices.size() } );
 
-        for( const auto& n : m_allNodes )
+        std::unordered_set<size_t> localSet;
+        std::vector<CN_ANCHOR_PTR> local;
+
+        for( const auto& pos : changed )
         {
-            if( !prev || prev->Pos() != n->Pos() )
+            double diameter = startDiameter;
+
+            // Positions on the border of the net, or in a sparse area, are not local
+            while( !isSurrounded( pos, diameter, queryPositions ) )
             {
-                auto tn = std::make_shared<hed::NODE> ( n->Pos().x, n->Pos().y );
+                diameter *= 2.0;
 
-                tn->SetId( id );
-                triNodes.push_back( tn );
+                if( diameter > maxDiameter )
+                    return false;
             }
 
-            id++;
-            prev = n;
+            queryIndices( pos, ceil( 2.0 * diameter ),
+                    [&] ( size_t i )
+                    {
+                        if( localSet.insert( i ).second )
+                            local.push_back( aVertices[i] );
+                    } );
+
+            if( local.size() * 2 > aVertices.size() )
+                return false;
         }
 
-        int prevId = 0;
+        std::set<std::pair<uint64_t, uint64_t>> kept;
 
-        for( const auto& n : triNodes )
+        for( const auto& e : m_prevEdges )
         {
-            for( int i = prevId; i < n->Id(); i++ )
-                anchorChains[prevId].push_back( m_allNodes[ i ] );
+            auto src = curIndex.find( positionKey( e.first ) );
+            auto dst = curIndex.find( positionKey( e.second ) );
 
-            prevId = n->Id();
-        }
+            if( src == curIndex.end() || dst == curIndex.end() )
+                continue;
 
-        for( int i = prevId; i < id; i++ )
-            anchorChains[prevId].push_back( m_allNodes[ i ] );
+            const auto& srcNode = aVertices[src->second];
+            const auto& dstNode = aVertices[dst->second];
 
-        if( triNodes.size() == 1 )
-        {
-            return mstEdges;
+            aEdges.emplace_back( srcNode, dstNode, getDistance( srcNode, dstNode ) );
+
+            // Only the edges between local vertices may be found again
+            if( localSet.count( src->second ) && localSet.count( dst->second ) )
+                kept.insert( edgeKey( e.first, e.second ) );
         }
-        else if( areNodesColinear( triNodes ) )
+
+        std::vector<CN_EDGE> localEdges;
+
+        std::sort( local.begin(), local.end(), sortPosition );
+        triangulate( local, localEdges );
+
+        for( const auto& e : localEdges )
         {
-            // special case: all nodes are on the same line - there's no
-            // triangulation for such set. In this case, we sort along any coordinate
-            // and chain the nodes together.
-            for(int i = 0; i < (int)triNodes.size() - 1; i++ )
-            {
-                auto src = m_allNodes[ triNodes[i]->Id() ];
-                auto dst = m_allNodes[ triNodes[i + 1]->Id() ];
-                mstEdges.emplace_back( src, dst, getDistance( src, dst ) );
-            }
+            if( !kept.count( edgeKey( e.GetSourceNode()->Pos(), e.GetTargetNode()->Pos() ) ) )
+                aEdges.push_back( e );
         }
-        else
-        {
-            hed::TRIANGULATION triangulator;
-            triangulator.CreateDelaunay( triNodes.begin(), triNodes.end() );
-            triangulator.GetEdges( triangEdges );
 
-            for( const auto& e : triangEdges )
-            {
-                auto    src = m_allNodes[ e->GetSourceNode()->Id() ];
-                auto    dst = m_allNodes[ e->GetTargetNode()->Id() ];
+        // Stale edges are harmless, but make the edge set grow over many updates
+        return aEdges.size() <= 4 * aVertices.size();
+    }
 
-                mstEdges.emplace_back( src, dst, getDistance( src, dst ) );
-            }
-        }
+public:
+
+    void Clear()
+    {
+        m_allNodes.clear();
+    }
+
+    ///> Drops the triangulation kept for incremental updates
+    void Reset()
+    {
+        m_prevVertices.clear();
+        m_prevEdges.clear();
+    }
+
+    void AddNode( CN_ANCHOR_PTR aNode )
+    {
+        m_allNodes.push_back( aNode );
+    }
+
+    const std::list<CN_EDGE> Triangulate()
+    {
+        std::list<CN_EDGE> mstEdges;
+        std::vector<CN_ANCHOR_PTR> vertices;
+
+        // Each distinct position is triangulated once, through the first of its anchors.
+        // The sort is stable so that this anchor does not depend on the previous updates.
+        std::stable_sort( m_allNodes.begin(), m_allNodes.end(), sortPosition );
 
-        for( unsigned int i = 0; i < anchorChains.size(); i++ )
+        for( size_t first = 0, last; first < m_allNodes.size(); first = last )
         {
-            auto& chain = anchorChains[i];
+            for( last = first; last < m_allNodes.size()
+                    && m_allNodes[last]->Pos() == m_allNodes[first]->Pos(); last++ )
+                ;
 
-            if( chain.size() < 2 )
+            vertices.push_back( m_allNodes[first] );
+
+            if( last - first < 2 )
                 continue;
 
-            std::sort( chain.begin(), chain.end(),
+            std::vector<CN_ANCHOR_PTR> chain( m_allNodes.begin() + first,
+                                              m_allNodes.begin() + last );
+
+            std::stable_sort( chain.begin(), chain.end(),
                     [] ( const CN_ANCHOR_PTR& a, const CN_ANCHOR_PTR& b ) {
                 return a->GetCluster().get() < b->GetCluster().get();
             } );
@@ -309,6 +565,25 @@ public:
             }
         }
 
+        std::vector<CN_EDGE> edges;
+
+        if( !updateTriangulation( vertices, edges ) )
+        {
+            edges.clear();
+            triangulate( vertices, edges );
+        }
+
+        mstEdges.insert( mstEdges.end(), edges.begin(), edges.end() );
+
+        m_prevVertices.clear();
+        m_prevEdges.clear();
+
+        for( const auto& v : vertices )
+            m_prevVertices.push_back( v->Pos() );
+
+        for( const auto& e : edges )
+            m_prevEdges.emplace_back( e.GetSourceNode()->Pos(), e.GetTargetNode()->Pos() );
+
         return mstEdges;
     }
 };
@@ -347,6 +622,7 @@ void RN_NET::compute()
                 node->SetTag( 0 );
         }
 
+        m_triangulator->Reset();
         return;
     }
 
@@ -145,7 +145,7 @@ public:
     bool NearestBicoloredPair( const RN_NET& aOtherNet, CN_ANCHOR_PTR& aNode1, CN_ANCHOR_PTR& aNode2 ) const;
 
 protected:
-    ///> Recomputes ratsnest from scratch.
+    ///> Recomputes ratsnest, reusing the triangulation of the anchors that did not change.
     void compute();
 
     ///> Vector of nodes
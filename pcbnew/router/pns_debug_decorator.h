@@ -22,6 +22,10 @@
 #ifndef __PNS_DEBUG_DECORATOR_H
 #define __PNS_DEBUG_DECORATOR_H
 
+#include <functional>
+#include <string>
+#include <vector>
+
 #include <math/vector2d.h>
 #include <math/box2.h>
 #include <geometry/seg.h>
@@ -46,6 +50,68 @@ public:
     virtual void Clear() {};
 };
 
+
+/**
+ * DEBUG_RECORDER
+ *
+ * Keeps the debug graphics of an algorithm running on a worker thread, until the thread
+ * owning the decorator of the router passes them to it with Replay().
+ */
+class DEBUG_RECORDER : public DEBUG_DECORATOR
+{
+public:
+    void AddPoint( VECTOR2I aP, int aColor, const std::string aName = "" ) override
+    {
+        record( [=]( DEBUG_DECORATOR* aDbg ) { aDbg->AddPoint( aP, aColor, aName ); } );
+    }
+
+    void AddLine( const SHAPE_LINE_CHAIN& aLine, int aType = 0, int aWidth = 0,
+                  const std::string aName = "" ) override
+    {
+        record( [=]( DEBUG_DECORATOR* aDbg ) { aDbg->AddLine( aLine, aType, aWidth, aName ); } );
+    }
+
+    void AddSegment( SEG aS, int aColor, const std::string aName = "" ) override
+    {
+        record( [=]( DEBUG_DECORATOR* aDbg ) { aDbg->AddSegment( aS, aColor, aName ); } );
+    }
+
+    void AddBox( BOX2I aB, int aColor, const std::string aName = "" ) override
+    {
+        record( [=]( DEBUG_DECORATOR* aDbg ) { aDbg->AddBox( aB, aColor, aName ); } );
+    }
+
+    void AddDirections( VECTOR2D aP, int aMask, int aColor, const std::string aName = "" ) override
+    {
+        record( [=]( DEBUG_DECORATOR* aDbg ) { aDbg->AddDirections( aP, aMask, aColor, aName ); } );
+    }
+
+    void Clear() override
+    {
+        record( []( DEBUG_DECORATOR* aDbg ) { aDbg->Clear(); } );
+    }
+
+    ///> Passes the recorded graphics to aTarget, in their order, and forgets them
+    void Replay( DEBUG_DECORATOR* aTarget )
+    {
+        if( aTarget )
+        {
+            for( const std::function<void( DEBUG_DECORATOR* )>& call : m_calls )
+                call( aTarget );
+        }
+
+        m_calls.clear();
+    }
+
+private:
+    void record( std::function<void( DEBUG_DECORATOR* )>&& aCall )
+    {
+        m_calls.push_back( std::move( aCall ) );
+    }
+
+    std::vector<std::function<void( DEBUG_DECORATOR* )>> m_calls;
+};
+
 }
 
 #endif
@@ -35,7 +35,77 @@ INDEX::~INDEX()
 }
 
 
-INDEX::ITEM_SHAPE_INDEX* INDEX::getSubindex( const ITEM* aItem )
+void INDEX::ITEM_GRID::Add( ITEM* aItem )
+{
+    BOX2I bbox = aItem->Shape()->BBox();
+    ENTRY entry = { bbox.GetX(), bbox.GetY(), bbox.GetRight(), bbox.GetBottom(), aItem };
+
+    int col0 = cell( entry.m_x0 );
+    int col1 = cell( entry.m_x1 );
+    int row0 = cell( entry.m_y0 );
+    int row1 = cell( entry.m_y1 );
+
+    if( (int64_t) ( col1 - col0 + 1 ) * ( row1 - row0 + 1 ) > MaxItemCells )
+    {
+        m_largeItems.push_back( entry );
+        return;
+    }
+
+    for( int row = row0; row <= row1; row++ )
+    {
+        for( int col = col0; col <= col1; col++ )
+            m_cells[cellKey( col, row )].push_back( entry );
+    }
+}
+
+
+void INDEX::ITEM_GRID::Remove( ITEM* aItem )
+{
+    auto removeFrom = [aItem]( std::vector<ENTRY>& aEntries )
+    {
+        for( size_t ii = 0; ii < aEntries.size(); ii++ )
+        {
+            if( aEntries[ii].m_item == aItem )
+            {
+                aEntries[ii] = aEntries.back();
+                aEntries.pop_back();
+                return true;
+            }
+        }
+
+        return false;
+    };
+
+    BOX2I bbox = aItem->Shape()->BBox();
+
+    int col0 = cell( bbox.GetX() );
+    int col1 = cell( bbox.GetRight() );
+    int row0 = cell( bbox.GetY() );
+    int row1 = cell( bbox.GetBottom() );
+
+    if( (int64_t) ( col1 - col0 + 1 ) * ( row1 - row0 + 1 ) > MaxItemCells )
+    {
+        removeFrom( m_largeItems );
+        return;
+    }
+
+    for( int row = row0; row <= row1; row++ )
+    {
+        for( int col = col0; col <= col1; col++ )
+        {
+            auto it = m_cells.find( cellKey( col, row ) );
+
+            if( it == m_cells.end() || !removeFrom( it->second ) )
+                continue;
+
+            if( it->second.empty() )
+                m_cells.erase( it );
+        }
+    }
+}
+
+
+INDEX::ITEM_GRID* INDEX::getSubindex( const ITEM* aItem )
 {
     int idx_n = -1;
 
@@ -78,14 +148,14 @@ INDEX::ITEM_SHAPE_INDEX* INDEX::getSubindex( const ITEM* aItem )
     }
 
     if( !m_subIndices[idx_n] )
-        m_subIndices[idx_n] = new ITEM_SHAPE_INDEX;
+        m_subIndices[idx_n] = new ITEM_GRID;
 
     return m_subIndices[idx_n];
 }
 
 void INDEX::Add( ITEM* aItem )
 {
-    ITEM_SHAPE_INDEX* idx = getSubindex( aItem );
+    ITEM_GRID* idx = getSubindex( aItem );
 
     if( !idx )
         return;
@@ -102,7 +172,7 @@ void INDEX::Add( ITEM* aItem )
 
 void INDEX::Remove( ITEM* aItem )
 {
-    ITEM_SHAPE_INDEX* idx = getSubindex( aItem );
+    ITEM_GRID* idx = getSubindex( aItem );
 
     if( !idx )
         return;
@@ -111,8 +181,19 @@ void INDEX::Remove( ITEM* aItem )
     m_allItems.erase( aItem );
     int net = aItem->Net();
 
-    if( net >= 0 && m_netMap.find( net ) != m_netMap.end() )
-        m_netMap[net].remove( aItem );
+    auto netItems = m_netMap.find( net );
+
+    if( net >= 0 && netItems != m_netMap.end() )
+    {
+        NET_ITEMS_LIST& list = netItems->second;
+        auto            it = std::find( list.begin(), list.end(), aItem );
+
+        if( it != list.end() )
+        {
+            *it = list.back();
+            list.pop_back();
+        }
+    }
 }
 
 void INDEX::Replace( ITEM* aOldItem, ITEM* aNewItem )
@@ -126,7 +207,7 @@ void INDEX::Clear()
 {
     for( int i = 0; i < MaxSubIndices; ++i )
     {
-        ITEM_SHAPE_INDEX* idx = m_subIndices[i];
+        ITEM_GRID* idx = m_subIndices[i];
 
         if( idx )
             delete idx;
@@ -138,10 +219,12 @@ void INDEX::Clear()
 
 INDEX::NET_ITEMS_LIST* INDEX::GetItemsForNet( int aNet )
 {
-    if( m_netMap.find( aNet ) == m_netMap.end() )
+    auto it = m_netMap.find( aNet );
+
+    if( it == m_netMap.end() )
         return NULL;
 
-    return &m_netMap[aNet];
+    return &it->second;
 }
 
 };
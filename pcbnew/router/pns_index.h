@@ -23,13 +23,13 @@
 #define __PNS_INDEX_H
 
 #include <layers_id_colors_and_visibility.h>
-#include <map>
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
-#include <boost/range/adaptor/map.hpp>
-
-#include <list>
-#include <geometry/shape_index.h>
+#include <math/box2.h>
 
 #include "pns_item.h"
 
@@ -40,14 +40,18 @@ namespace PNS {
  * INDEX
  *
  * Custom spatial index, holding our board items and allowing for very fast searches. Items
- * are assigned to separate R-Tree subindices depending on their type and spanned layers, reducing
+ * are assigned to separate subindices depending on their type and spanned layers, reducing
  * overlap and improving search time.
+ *
+ * Each subindex is a sparse uniform grid: the cells touched by the bounding box of an item
+ * list the item along with its bounding box, in a contiguous array, so that a query reads a
+ * few arrays instead of walking the nodes of a tree.  Items spanning too many cells are kept
+ * in a separate array, scanned by all the queries.
  **/
 class INDEX
 {
 public:
-    typedef std::list<ITEM*>            NET_ITEMS_LIST;
-    typedef SHAPE_INDEX<ITEM*>          ITEM_SHAPE_INDEX;
+    typedef std::vector<ITEM*>          NET_ITEMS_LIST;
     typedef std::unordered_set<ITEM*>   ITEM_SET;
 
     INDEX();
@@ -149,54 +153,195 @@ private:
     static const int    SI_PadsTop      = 0;
     static const int    SI_PadsBottom   = 1;
 
+    /**
+     * ITEM_GRID
+     *
+     * A subindex: the sparse grid of cells of CellSize, and the array of the larger items.
+     */
+    class ITEM_GRID
+    {
+    public:
+        void Add( ITEM* aItem );
+        void Remove( ITEM* aItem );
+
+        template <class Visitor>
+        int Query( const BOX2I& aBox, Visitor& aVisitor ) const;
+
+    private:
+        struct ENTRY
+        {
+            int   m_x0, m_y0, m_x1, m_y1;   ///< bounding box of the item
+            ITEM* m_item;
+        };
+
+        ///> Edge of the cells: about one pad of a fine pitch footprint and its tracks
+        static const int CellSize = 1000000;
+
+        ///> Items touching more cells are stored in m_largeItems
+        static const int MaxItemCells = 1024;
+
+        static int cell( int aCoord )
+        {
+            // Rounds towards negative infinity
+            return (int) ( aCoord >= 0 ? aCoord / CellSize : ( aCoord + 1 ) / CellSize - 1 );
+        }
+
+        static uint64_t cellKey( int aCol, int aRow )
+        {
+            return ( (uint64_t) (uint32_t) aCol << 32 ) | (uint32_t) aRow;
+        }
+
+        ///> Calls aVisitor on the entry if it overlaps aBox
+        template <class Visitor>
+        static bool visit( const ENTRY& aEntry, const BOX2I& aBox, Visitor& aVisitor,
+                           int& aCount );
+
+        ///> Calls aVisitor on the entries of a cell overlapping aBox.  Entries spanning several
+        ///> cells are only visited in the first cell of the query they belong to.
+        template <class Visitor>
+        static bool visitCell( const std::vector<ENTRY>& aEntries, const BOX2I& aBox, int aCol,
+                               int aRow, int aQueryCol, int aQueryRow, Visitor& aVisitor,
+                               int& aCount );
+
+        std::unordered_map<uint64_t, std::vector<ENTRY>> m_cells;
+        std::vector<ENTRY>                               m_largeItems;
+    };
+
     template <class Visitor>
-    int querySingle( int index, const SHAPE* aShape, int aMinDistance, Visitor& aVisitor );
+    int querySingle( int index, const BOX2I& aBox, Visitor& aVisitor );
 
-    ITEM_SHAPE_INDEX* getSubindex( const ITEM* aItem );
+    ITEM_GRID* getSubindex( const ITEM* aItem );
 
-    ITEM_SHAPE_INDEX* m_subIndices[MaxSubIndices];
-    std::map<int, NET_ITEMS_LIST> m_netMap;
+    ITEM_GRID* m_subIndices[MaxSubIndices];
+    std::unordered_map<int, NET_ITEMS_LIST> m_netMap;
     ITEM_SET m_allItems;
 };
 
 
+template <class Visitor>
+bool INDEX::ITEM_GRID::visit( const ENTRY& aEntry, const BOX2I& aBox, Visitor& aVisitor,
+                              int& aCount )
+{
+    if( aEntry.m_x1 < aBox.GetX() || aEntry.m_x0 > aBox.GetRight()
+            || aEntry.m_y1 < aBox.GetY() || aEntry.m_y0 > aBox.GetBottom() )
+        return true;
+
+    if( !aVisitor( aEntry.m_item ) )
+        return false;
+
+    aCount++;
+    return true;
+}
+
+
+template <class Visitor>
+bool INDEX::ITEM_GRID::visitCell( const std::vector<ENTRY>& aEntries, const BOX2I& aBox,
+                                  int aCol, int aRow, int aQueryCol, int aQueryRow,
+                                  Visitor& aVisitor, int& aCount )
+{
+    for( const ENTRY& entry : aEntries )
+    {
+        if( std::max( cell( entry.m_x0 ), aQueryCol ) != aCol
+                || std::max( cell( entry.m_y0 ), aQueryRow ) != aRow )
+            continue;
+
+        if( !visit( entry, aBox, aVisitor, aCount ) )
+            return false;
+    }
+
+    return true;
+}
+
+
+template <class Visitor>
+int INDEX::ITEM_GRID::Query( const BOX2I& aBox, Visitor& aVisitor ) const
+{
+    int count = 0;
+
+    for( const ENTRY& entry : m_largeItems )
+    {
+        if( !visit( entry, aBox, aVisitor, count ) )
+            return count;
+    }
+
+    int col0 = cell( aBox.GetX() );
+    int col1 = cell( aBox.GetRight() );
+    int row0 = cell( aBox.GetY() );
+    int row1 = cell( aBox.GetBottom() );
+
+    // Huge query boxes are cheaper to check against the cells which exist
+    if( (int64_t) ( col1 - col0 + 1 ) * ( row1 - row0 + 1 ) > (int64_t) m_cells.size() )
+    {
+        for( const auto& pair : m_cells )
+        {
+            int col = (int) ( pair.first >> 32 );
+            int row = (int) (uint32_t) pair.first;
+
+            if( col < col0 || col > col1 || row < row0 || row > row1 )
+                continue;
+
+            if( !visitCell( pair.second, aBox, col, row, col0, row0, aVisitor, count ) )
+                return count;
+        }
+
+        return count;
+    }
+
+    for( int row = row0; row <= row1; row++ )
+    {
+        for( int col = col0; col <= col1; col++ )
+        {
+            auto it = m_cells.find( cellKey( col, row ) );
+
+            if( it != m_cells.end()
+                    && !visitCell( it->second, aBox, col, row, col0, row0, aVisitor, count ) )
+                return count;
+        }
+    }
+
+    return count;
+}
+
+
 template<class Visitor>
-int INDEX::querySingle( int index, const SHAPE* aShape, int aMinDistance, Visitor& aVisitor )
+int INDEX::querySingle( int index, const BOX2I& aBox, Visitor& aVisitor )
 {
     if( !m_subIndices[index] )
         return 0;
 
-    return m_subIndices[index]->Query( aShape, aMinDistance, aVisitor, false );
+    return m_subIndices[index]->Query( aBox, aVisitor );
 }
 
 template<class Visitor>
 int INDEX::Query( const ITEM* aItem, int aMinDistance, Visitor& aVisitor )
 {
-    const SHAPE* shape = aItem->Shape();
+    BOX2I box = aItem->Shape()->BBox();
     int total = 0;
 
-    total += querySingle( SI_Multilayer, shape, aMinDistance, aVisitor );
+    box.Inflate( aMinDistance );
+
+    total += querySingle( SI_Multilayer, box, aVisitor );
 
     const LAYER_RANGE& layers = aItem->Layers();
 
     if( layers.IsMultilayer() )
     {
-        total += querySingle( SI_PadsTop, shape, aMinDistance, aVisitor );
-        total += querySingle( SI_PadsBottom, shape, aMinDistance, aVisitor );
+        total += querySingle( SI_PadsTop, box, aVisitor );
+        total += querySingle( SI_PadsBottom, box, aVisitor );
 
         for( int i = layers.Start(); i <= layers.End(); ++i )
-            total += querySingle( SI_Traces + 2 * i + SI_SegStraight, shape, aMinDistance, aVisitor );
+            total += querySingle( SI_Traces + 2 * i + SI_SegStraight, box, aVisitor );
     }
     else
     {
         int l = layers.Start();
 
         if( l == B_Cu )
-            total += querySingle( SI_PadsTop, shape, aMinDistance, aVisitor );
+            total += querySingle( SI_PadsTop, box, aVisitor );
         else if( l == F_Cu )
-            total += querySingle( SI_PadsBottom, shape, aMinDistance, aVisitor );
+            total += querySingle( SI_PadsBottom, box, aVisitor );
 
-        total += querySingle(  SI_Traces + 2 * l + SI_SegStraight, shape, aMinDistance, aVisitor );
+        total += querySingle(  SI_Traces + 2 * l + SI_SegStraight, box, aVisitor );
     }
 
     return total;
@@ -205,10 +350,13 @@ int INDEX::Query( const ITEM* aItem, int aMinDistance, Visitor& aVisitor )
 template<class Visitor>
 int INDEX::Query( const SHAPE* aShape, int aMinDistance, Visitor& aVisitor )
 {
+    BOX2I box = aShape->BBox();
     int total = 0;
 
+    box.Inflate( aMinDistance );
+
     for( int i = 0; i < MaxSubIndices; i++ )
-        total += querySingle( i, aShape, aMinDistance, aVisitor );
+        total += querySingle( i, box, aVisitor );
 
     return total;
 }
@@ -19,8 +19,13 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <fstream>
+
+#include <board_connected_item.h>
+
 #include "pns_logger.h"
 #include "pns_item.h"
+#include "pns_itemset.h"
 #include "pns_via.h"
 #include "pns_line.h"
 #include "pns_segment.h"
@@ -49,6 +54,7 @@ void LOGGER::Clear()
 {
     m_theLog.str( std::string() );
     m_groupOpened = false;
+    m_events.clear();
 }
 
 
@@ -139,6 +145,72 @@ void LOGGER::Log( const VECTOR2I& aStart, const VECTOR2I& aEnd,
 }
 
 
+void LOGGER::Log( EVENT_TYPE aType, const VECTOR2I& aPos, int aArg )
+{
+    m_events.push_back( EVENT_ENTRY{ aType, aPos, aArg, {} } );
+}
+
+
+void LOGGER::Log( EVENT_TYPE aType, const VECTOR2I& aPos, const ITEM* aItem, int aArg )
+{
+    EVENT_ENTRY event{ aType, aPos, aArg, {} };
+
+    if( aItem && aItem->Parent() )
+        event.m_Items.push_back( aItem->Parent()->m_Uuid );
+
+    m_events.push_back( event );
+}
+
+
+void LOGGER::Log( EVENT_TYPE aType, const VECTOR2I& aPos, const ITEM_SET& aItems, int aArg )
+{
+    EVENT_ENTRY event{ aType, aPos, aArg, {} };
+
+    for( const ITEM* item : aItems.CItems() )
+    {
+        if( item->Parent() )
+            event.m_Items.push_back( item->Parent()->m_Uuid );
+    }
+
+    m_events.push_back( event );
+}
+
+
+bool LOGGER::LoadEvents( const std::string& aFilename, std::vector<EVENT_ENTRY>& aEvents )
+{
+    std::ifstream file( aFilename );
+
+    if( !file )
+        return false;
+
+    std::string line;
+
+    while( std::getline( file, line ) )
+    {
+        std::istringstream tokens( line );
+        std::string        tag;
+        int                type;
+        size_t             count;
+        EVENT_ENTRY        event;
+
+        if( !( tokens >> tag ) || tag != "event" )
+            continue;
+
+        if( !( tokens >> type >> event.m_Pos.x >> event.m_Pos.y >> event.m_Arg >> count ) )
+            continue;
+
+        event.m_Type = static_cast<EVENT_TYPE>( type );
+
+        for( size_t ii = 0; ii < count && tokens >> tag; ii++ )
+            event.m_Items.emplace_back( wxString( tag ) );
+
+        aEvents.push_back( event );
+    }
+
+    return true;
+}
+
+
 void LOGGER::dumpShape( const SHAPE* aSh )
 {
     switch( aSh->Type() )
@@ -202,6 +274,19 @@ void LOGGER::Save( const std::string& aFilename )
     wxLogTrace( "PNS", "Saving to '%s' [%p]", aFilename.c_str(), f );
     const std::string s = m_theLog.str();
     fwrite( s.c_str(), 1, s.length(), f );
+
+    // The events are only kept as entries, and written out here
+    for( const EVENT_ENTRY& event : m_events )
+    {
+        fprintf( f, "event %d %d %d %d %d", event.m_Type, event.m_Pos.x, event.m_Pos.y,
+                 event.m_Arg, (int) event.m_Items.size() );
+
+        for( const KIID& uuid : event.m_Items )
+            fprintf( f, " %s", uuid.AsString().ToStdString().c_str() );
+
+        fprintf( f, "\n" );
+    }
+
     fclose( f );
 }
 
@@ -28,6 +28,7 @@
 #include <sstream>
 
 #include <math/vector2d.h>
+#include <common.h>
 
 class SHAPE_LINE_CHAIN;
 class SHAPE;
@@ -35,10 +36,41 @@ class SHAPE;
 namespace PNS {
 
 class ITEM;
+class ITEM_SET;
 
+/**
+ * LOGGER
+ *
+ * Records the items processed by the router algorithms, for debugging, and the events
+ * received by the router, so that a routing session can be replayed on the same board.
+ * The items are recorded as text, the events as entries which Save() writes after the items.
+ */
 class LOGGER
 {
 public:
+    ///> Events of the router, as passed to its public methods
+    enum EVENT_TYPE
+    {
+        EVT_START_ROUTE = 0,    ///< StartRouting(), the argument is the layer
+        EVT_START_DRAG,         ///< StartDragging(), the argument is the drag mode
+        EVT_MOVE,               ///< Move()
+        EVT_FIX,                ///< FixRoute(), the argument is the force finish flag
+        EVT_UNFIX,              ///< UndoLastSegment()
+        EVT_COMMIT,             ///< CommitRouting()
+        EVT_STOP,               ///< StopRouting()
+        EVT_SWITCH_LAYER,       ///< SwitchLayer(), the argument is the layer
+        EVT_TOGGLE_VIA,         ///< ToggleViaPlacement()
+        EVT_FLIP_POSTURE        ///< FlipPosture()
+    };
+
+    struct EVENT_ENTRY
+    {
+        EVENT_TYPE        m_Type;
+        VECTOR2I          m_Pos;
+        int               m_Arg;
+        std::vector<KIID> m_Items;      ///< the board items behind the items of the event
+    };
+
     LOGGER();
     ~LOGGER();
 
@@ -53,11 +85,32 @@ public:
     void Log( const VECTOR2I& aStart, const VECTOR2I& aEnd, int aKind = 0,
               const std::string& aName = std::string() );
 
+    /**
+     * Function Log()
+     * records an event of the router, with the items it was given.
+     */
+    void Log( EVENT_TYPE aType, const VECTOR2I& aPos, int aArg = 0 );
+    void Log( EVENT_TYPE aType, const VECTOR2I& aPos, const ITEM* aItem, int aArg = 0 );
+    void Log( EVENT_TYPE aType, const VECTOR2I& aPos, const ITEM_SET& aItems, int aArg = 0 );
+
+    const std::vector<EVENT_ENTRY>& GetEvents() const
+    {
+        return m_events;
+    }
+
+    /**
+     * Function LoadEvents()
+     * reads the events of a log saved by Save(), and skips its other records.
+     * @return false if the file cannot be read.
+     */
+    static bool LoadEvents( const std::string& aFilename, std::vector<EVENT_ENTRY>& aEvents );
+
 private:
     void dumpShape( const SHAPE* aSh );
 
     bool m_groupOpened;
     std::stringstream m_theLog;
+    std::vector<EVENT_ENTRY> m_events;
 };
 
 }
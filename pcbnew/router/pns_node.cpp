@@ -19,6 +19,7 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <atomic>
 #include <vector>
 #include <cassert>
 #include <utility>
@@ -44,6 +45,10 @@ namespace PNS {
 static std::unordered_set<NODE*> allocNodes;
 #endif
 
+///> the last revision given to a node, see NODE::Revision().  Routers may run on several
+///> threads, each one with its own world.
+static std::atomic<uint64_t> lastRevision( 0 );
+
 NODE::NODE()
 {
     wxLogTrace( "PNS", "NODE::create %p", this );
@@ -52,7 +57,10 @@ NODE::NODE()
     m_parent = NULL;
     m_maxClearance = 800000;    // fixme: depends on how thick traces are.
     m_ruleResolver = NULL;
-    m_index = new INDEX;
+    m_index = std::make_shared<INDEX>();
+    m_joints = std::make_shared<JOINT_MAP>();
+    m_override = std::make_shared<std::unordered_set<ITEM*>>();
+    touch();
 
 #ifdef DEBUG
     allocNodes.insert( this );
@@ -80,8 +88,9 @@ NODE::~NODE()
     allocNodes.erase( this );
 #endif
 
-    m_joints.clear();
+    m_joints.reset();
 
+    // The items of this node are only in its own index, the shared ones hold those of others
     for( ITEM* item : *m_index )
     {
         if( item->BelongsTo( this ) )
@@ -90,8 +99,6 @@ NODE::~NODE()
 
     releaseGarbage();
     unlinkParent();
-
-    delete m_index;
 }
 
 int NODE::GetClearance( const ITEM* aA, const ITEM* aB ) const
@@ -117,26 +124,68 @@ NODE* NODE::Branch()
     child->m_root = isRoot() ? this : m_root;
     child->m_maxClearance = m_maxClearance;
 
-    // Immmediate offspring of the root branch needs not copy anything. For the rest, deep-copy
-    // joints, overridden item maps and pointers to stored items.
+    // Immmediate offspring of the root branch needs not copy anything. The rest share the
+    // joints, overridden item maps and pointers to stored items with their parent, until
+    // either of them changes them.
     if( !isRoot() )
     {
-        JOINT_MAP::iterator j;
-
-        for( ITEM* item : *m_index )
-            child->m_index->Add( item );
-
+        child->m_index = m_index;
         child->m_joints = m_joints;
         child->m_override = m_override;
     }
 
     wxLogTrace( "PNS", "%d items, %d joints, %d overrides",
-            child->m_index->Size(), (int) child->m_joints.size(), (int) child->m_override.size() );
+            child->m_index->Size(), (int) child->m_joints->size(),
+            (int) child->m_override->size() );
 
     return child;
 }
 
 
+INDEX& NODE::writableIndex()
+{
+    touch();
+
+    if( m_index.use_count() > 1 )
+    {
+        std::shared_ptr<INDEX> index = std::make_shared<INDEX>();
+
+        for( ITEM* item : *m_index )
+            index->Add( item );
+
+        m_index = index;
+    }
+
+    return *m_index;
+}
+
+
+NODE::JOINT_MAP& NODE::writableJoints()
+{
+    if( m_joints.use_count() > 1 )
+        m_joints = std::make_shared<JOINT_MAP>( *m_joints );
+
+    return *m_joints;
+}
+
+
+std::unordered_set<ITEM*>& NODE::writableOverrides()
+{
+    touch();
+
+    if( m_override.use_count() > 1 )
+        m_override = std::make_shared<std::unordered_set<ITEM*>>( *m_override );
+
+    return *m_override;
+}
+
+
+void NODE::touch()
+{
+    m_revision = ++lastRevision;
+}
+
+
 void NODE::unlinkParent()
 {
     if( isRoot() )
@@ -541,7 +590,7 @@ void NODE::addSolid( SOLID* aSolid )
     if( aSolid->IsRoutable() )
         linkJoint( aSolid->Pos(), aSolid->Layers(), aSolid->Net(), aSolid );
 
-    m_index->Add( aSolid );
+    writableIndex().Add( aSolid );
 }
 
 void NODE::Add( std::unique_ptr< SOLID > aSolid )
@@ -553,7 +602,7 @@ void NODE::Add( std::unique_ptr< SOLID > aSolid )
 void NODE::addVia( VIA* aVia )
 {
     linkJoint( aVia->Pos(), aVia->Layers(), aVia->Net(), aVia );
-    m_index->Add( aVia );
+    writableIndex().Add( aVia );
 }
 
 void NODE::Add( std::unique_ptr< VIA > aVia )
@@ -614,7 +663,7 @@ void NODE::addSegment( SEGMENT* aSeg )
     linkJoint( aSeg->Seg().A, aSeg->Layers(), aSeg->Net(), aSeg );
     linkJoint( aSeg->Seg().B, aSeg->Layers(), aSeg->Net(), aSeg );
 
-    m_index->Add( aSeg );
+    writableIndex().Add( aSeg );
 }
 
 bool NODE::Add( std::unique_ptr< SEGMENT > aSegment, bool aAllowRedundant )
@@ -639,7 +688,7 @@ void NODE::addArc( ARC* aArc )
     linkJoint( aArc->Anchor( 0 ), aArc->Layers(), aArc->Net(), aArc );
     linkJoint( aArc->Anchor( 1 ), aArc->Layers(), aArc->Net(), aArc );
 
-    m_index->Add( aArc );
+    writableIndex().Add( aArc );
 }
 
 void NODE::Add( std::unique_ptr< ARC > aArc )
@@ -673,12 +722,12 @@ void NODE::doRemove( ITEM* aItem )
     // case 1: removing an item that is stored in the root node from any branch:
     // mark it as overridden, but do not remove
     if( aItem->BelongsTo( m_root ) && !isRoot() )
-        m_override.insert( aItem );
+        writableOverrides().insert( aItem );
 
     // case 2: the item belongs to this branch or a parent, non-root branch,
     // or the root itself and we are the root: remove from the index
     else if( !aItem->BelongsTo( m_root ) || isRoot() )
-        m_index->Remove( aItem );
+        writableIndex().Remove( aItem );
 
     // the item belongs to this particular branch: un-reference it
     if( aItem->BelongsTo( this ) )
@@ -715,13 +764,14 @@ void NODE::rebuildJoint( JOINT* aJoint, ITEM* aItem )
     tag.net = net;
     tag.pos = aJoint->Pos();
 
+    JOINT_MAP& joints = writableJoints();
     bool split;
     do
     {
         split = false;
-        auto range = m_joints.equal_range( tag );
+        auto range = joints.equal_range( tag );
 
-        if( range.first == m_joints.end() )
+        if( range.first == joints.end() )
             break;
 
         // find and remove all joints containing the via to be removed
@@ -730,7 +780,7 @@ void NODE::rebuildJoint( JOINT* aJoint, ITEM* aItem )
         {
             if( aItem->LayersOverlap( &f->second ) )
             {
-                m_joints.erase( f );
+                joints.erase( f );
                 split = true;
                 break;
             }
@@ -1031,12 +1081,12 @@ JOINT* NODE::FindJoint( const VECTOR2I& aPos, int aLayer, int aNet )
     tag.net = aNet;
     tag.pos = aPos;
 
-    JOINT_MAP::iterator f = m_joints.find( tag ), end = m_joints.end();
+    JOINT_MAP::iterator f = m_joints->find( tag ), end = m_joints->end();
 
     if( f == end && !isRoot() )
     {
-        end = m_root->m_joints.end();
-        f = m_root->m_joints.find( tag );    // m_root->FindJoint(aPos, aLayer, aNet);
+        end = m_root->m_joints->end();
+        f = m_root->m_joints->find( tag );    // m_root->FindJoint(aPos, aLayer, aNet);
     }
 
     if( f == end )
@@ -1068,18 +1118,20 @@ JOINT& NODE::touchJoint( const VECTOR2I& aPos, const LAYER_RANGE& aLayers, int a
     tag.pos = aPos;
     tag.net = aNet;
 
+    JOINT_MAP& joints = writableJoints();
+
     // try to find the joint in this node.
-    JOINT_MAP::iterator f = m_joints.find( tag );
+    JOINT_MAP::iterator f = joints.find( tag );
 
     std::pair<JOINT_MAP::iterator, JOINT_MAP::iterator> range;
 
     // not found and we are not root? find in the root and copy results here.
-    if( f == m_joints.end() && !isRoot() )
+    if( f == joints.end() && !isRoot() )
     {
-        range = m_root->m_joints.equal_range( tag );
+        range = m_root->m_joints->equal_range( tag );
 
         for( f = range.first; f != range.second; ++f )
-            m_joints.insert( *f );
+            joints.insert( *f );
     }
 
     // now insert and combine overlapping joints
@@ -1090,9 +1142,9 @@ JOINT& NODE::touchJoint( const VECTOR2I& aPos, const LAYER_RANGE& aLayers, int a
     do
     {
         merged  = false;
-        range   = m_joints.equal_range( tag );
+        range   = joints.equal_range( tag );
 
-        if( range.first == m_joints.end() )
+        if( range.first == joints.end() )
             break;
 
         for( f = range.first; f != range.second; ++f )
@@ -1100,7 +1152,7 @@ JOINT& NODE::touchJoint( const VECTOR2I& aPos, const LAYER_RANGE& aLayers, int a
             if( aLayers.Overlaps( f->second.Layers() ) )
             {
                 jt.Merge( f->second );
-                m_joints.erase( f );
+                joints.erase( f );
                 merged = true;
                 break;
             }
@@ -1108,7 +1160,7 @@ JOINT& NODE::touchJoint( const VECTOR2I& aPos, const LAYER_RANGE& aLayers, int a
     }
     while( merged );
 
-    return m_joints.insert( TagJointPair( tag, jt ) )->second;
+    return joints.insert( TagJointPair( tag, jt ) )->second;
 }
 
 
@@ -1224,13 +1276,13 @@ void NODE::GetUpdatedItems( ITEM_VECTOR& aRemoved, ITEM_VECTOR& aAdded )
     if( isRoot() )
         return;
 
-    if( m_override.size() )
-        aRemoved.reserve( m_override.size() );
+    if( m_override->size() )
+        aRemoved.reserve( m_override->size() );
     
     if( m_index->Size() )
         aAdded.reserve( m_index->Size() );
 
-    for( ITEM* item : m_override )
+    for( ITEM* item : *m_override )
         aRemoved.push_back( item );
 
     for( INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
@@ -1270,7 +1322,7 @@ void NODE::Commit( NODE* aNode )
         if( aNode->isRoot() )
             return;
 
-        for( ITEM* item : aNode->m_override )
+        for( ITEM* item : *aNode->m_override )
             Remove( item );
 
         for( auto i : *aNode->m_index )
@@ -1291,6 +1343,17 @@ void NODE::KillChildren()
 }
 
 
+int NODE::BranchCount() const
+{
+    int count = m_children.size();
+
+    for( const NODE* child : m_children )
+        count += child->BranchCount();
+
+    return count;
+}
+
+
 void NODE::AllItemsInNet( int aNet, std::set<ITEM*>& aItems )
 {
     INDEX::NET_ITEMS_LIST* l_cur = m_index->GetItemsForNet( aNet );
@@ -1410,7 +1473,7 @@ int NODE::QueryJoints( const BOX2I& aBox,
 
     aJoints.clear();
 
-    for( auto j = m_joints.begin(); j != m_joints.end(); ++j )
+    for( auto j = m_joints->begin(); j != m_joints->end(); ++j )
     {
         if ( aBox.Contains(j->second.Pos()) && j->second.LinkCount ( aKindMask ) )
         {
@@ -1423,7 +1486,7 @@ int NODE::QueryJoints( const BOX2I& aBox,
     if ( isRoot() )
         return n;
 
-    for( auto j = m_root->m_joints.begin(); j != m_root->m_joints.end(); ++j )
+    for( auto j = m_root->m_joints->begin(); j != m_root->m_joints->end(); ++j )
     {
         if( ! Overrides( &j->second) )
         {   if ( aBox.Contains(j->second.Pos()) && j->second.LinkCount ( aKindMask ) )
@@ -22,8 +22,11 @@
 #ifndef __PNS_NODE_H
 #define __PNS_NODE_H
 
+#include <algorithm>
+#include <cstdint>
 #include <vector>
 #include <list>
+#include <memory>
 #include <unordered_set>
 #include <unordered_map>
 
@@ -141,6 +144,11 @@ protected:
  * - assembly of lines connecting joints, finding loops and unique paths
  * - lightweight cloning/branching (for recursive optimization and shove
  * springback)
+ *
+ * A branch only stores its changes with respect to the root: the items it added, the root
+ * items it overrides and the joints it touched.  A branch made from another branch shares
+ * these with its parent, and whichever of them changes first takes a copy (copy-on-write),
+ * so branching is O(1) and the branches which are only queried never copy anything.
  **/
 class NODE
 {
@@ -165,12 +173,14 @@ public:
     void SetMaxClearance( int aClearance )
     {
         m_maxClearance = aClearance;
+        touch();
     }
 
     ///> Assigns a clerance resolution function object
     void SetRuleResolver( RULE_RESOLVER* aFunc )
     {
         m_ruleResolver = aFunc;
+        touch();
     }
 
     RULE_RESOLVER* GetRuleResolver() const
@@ -181,7 +191,7 @@ public:
     ///> Returns the number of joints
     int JointCount() const
     {
-        return m_joints.size();
+        return m_joints->size();
     }
 
     ///> Returns the number of nodes in the inheritance chain (wrs to the root node)
@@ -190,6 +200,22 @@ public:
         return m_depth;
     }
 
+    ///> Returns the number of branches derived from this node, at all depths
+    int BranchCount() const;
+
+    /**
+     * Function Revision()
+     *
+     * Returns a number which changes each time the items seen by the node, its own or those
+     * of the root node, or its clearance rules change. A new node starts with a revision no
+     * other node had before, so the results of the queries on a node can be reused for as
+     * long as the node and its revision stay the same.
+     */
+    uint64_t Revision() const
+    {
+        return std::max( m_revision, m_root->m_revision );
+    }
+
     /**
      * Function QueryColliding()
      *
@@ -433,7 +459,7 @@ public:
     ///> from the root branch.
     bool Overrides( ITEM* aItem ) const
     {
-        return m_override.find( aItem ) != m_override.end();
+        return m_override->find( aItem ) != m_override->end();
     }
 
 private:
@@ -469,6 +495,16 @@ private:
     void removeArcIndex( ARC* aVia );
 
     void doRemove( ITEM* aItem );
+
+    ///> copy-on-write accessors to the state of the node, which may be shared with the
+    ///> parent of the node or its branches
+    INDEX& writableIndex();
+    JOINT_MAP& writableJoints();
+    std::unordered_set<ITEM*>& writableOverrides();
+
+    ///> gives the node a new revision
+    void touch();
+
     void unlinkParent();
     void releaseChildren();
     void releaseGarbage();
@@ -493,7 +529,7 @@ private:
 
     ///> hash table with the joints, linking the items. Joints are hashed by
     ///> their position, layer set and net.
-    JOINT_MAP m_joints;
+    std::shared_ptr<JOINT_MAP> m_joints;
 
     ///> node this node was branched from
     NODE* m_parent;
@@ -505,7 +541,7 @@ private:
     std::set<NODE*> m_children;
 
     ///> hash of root's items that have been changed in this node
-    std::unordered_set<ITEM*> m_override;
+    std::shared_ptr<std::unordered_set<ITEM*>> m_override;
 
     ///> worst case item-item clearance
     int m_maxClearance;
@@ -514,11 +550,14 @@ private:
     RULE_RESOLVER* m_ruleResolver;
 
     ///> Geometric/Net index of the items
-    INDEX* m_index;
+    std::shared_ptr<INDEX> m_index;
 
     ///> depth of the node (number of parent nodes in the inheritance chain)
     int m_depth;
 
+    ///> revision of the items and rules of the node, see Revision()
+    uint64_t m_revision;
+
     std::unordered_set<ITEM*> m_garbageItems;
 };
 
@@ -30,6 +30,7 @@
 #include "pns_line.h"
 #include "pns_diff_pair.h"
 #include "pns_node.h"
+#include "pns_segment.h"
 #include "pns_solid.h"
 #include "pns_optimizer.h"
 
@@ -131,6 +132,9 @@ bool COST_ESTIMATOR::IsBetter( COST_ESTIMATOR& aOther,
  *  Optimizer
  **/
 OPTIMIZER::OPTIMIZER( NODE* aWorld ) :
+    m_collisionCacheWorld( nullptr ),
+    m_collisionCacheRevision( 0 ),
+    m_useCollisionCache( true ),
     m_world( aWorld ),
     m_collisionKindMask( ITEM::ANY_T ),
     m_effortLevel( MERGE_SEGMENTS ),
@@ -430,11 +434,80 @@ bool KEEP_TOPOLOGY_CONSTRAINT::Check ( int aVertex1, int aVertex2, LINE* aOrigin
 
 bool OPTIMIZER::checkColliding( ITEM* aItem, bool aUpdateCache )
 {
-    CACHE_VISITOR v( aItem, m_world, m_collisionKindMask );
+    if( m_useCollisionCache && aItem->Kind() == ITEM::LINE_T )
+        return checkCollidingCached( static_cast<LINE*>( aItem ) );
 
     return static_cast<bool>( m_world->CheckColliding( aItem ) );
 }
 
+
+std::size_t OPTIMIZER::COLLISION_KEY_HASH::operator()( const COLLISION_KEY& aKey ) const
+{
+    std::size_t seed = 0;
+
+    for( int v : { aKey.m_a.x, aKey.m_a.y, aKey.m_b.x, aKey.m_b.y, aKey.m_width, aKey.m_net,
+                   aKey.m_layerStart, aKey.m_layerEnd } )
+    {
+        seed ^= std::hash<int>()( v ) + 0x9e3779b9 + ( seed << 6 ) + ( seed >> 2 );
+    }
+
+    return seed;
+}
+
+
+/**
+ * Function checkCollidingCached()
+ *
+ * Does the same checks as NODE::CheckColliding() on a line, segment after segment, but
+ * remembers the results for the segments.  The merge passes try the same candidate segments
+ * over and over against a world which does not change while they run.
+ */
+bool OPTIMIZER::checkCollidingCached( const LINE* aLine )
+{
+    if( m_collisionCacheWorld != m_world || m_collisionCacheRevision != m_world->Revision()
+            || (int) m_collisionCache.size() > MaxCachedCollisions )
+    {
+        m_collisionCache.clear();
+        m_collisionCacheWorld = m_world;
+        m_collisionCacheRevision = m_world->Revision();
+    }
+
+    const SHAPE_LINE_CHAIN& l = aLine->CLine();
+
+    for( int i = 0; i < l.SegmentCount(); i++ )
+    {
+        const SEG     s = l.CSegment( i );
+        COLLISION_KEY key = { s.A, s.B, aLine->Width(), aLine->Net(), aLine->Layers().Start(),
+                              aLine->Layers().End() };
+        bool          colliding;
+
+        auto it = m_collisionCache.find( key );
+
+        if( it != m_collisionCache.end() )
+        {
+            m_collisionCacheStats.m_hits++;
+            colliding = it->second;
+        }
+        else
+        {
+            const SEGMENT seg( *aLine, s );
+
+            m_collisionCacheStats.m_misses++;
+            colliding = static_cast<bool>( m_world->CheckColliding( &seg ) );
+            m_collisionCache[key] = colliding;
+        }
+
+        if( colliding )
+            return true;
+    }
+
+    // a line ends with a single via at most, it is not worth caching
+    if( aLine->EndsWithVia() )
+        return static_cast<bool>( m_world->CheckColliding( &aLine->Via() ) );
+
+    return false;
+}
+
 void OPTIMIZER::ClearConstraints()
 {
     for (auto c : m_constraints)
@@ -1033,7 +1106,12 @@ bool OPTIMIZER::Optimize( LINE* aLine, int aEffortLevel, NODE* aWorld, const VEC
         opt.AddConstraint( c );
     }
 
-    return opt.Optimize( aLine );
+    bool rv = opt.Optimize( aLine );
+
+    wxLogTrace( "PNS", "optimizer collision cache: %d hits, %d misses",
+                opt.CollisionCacheStats().m_hits, opt.CollisionCacheStats().m_misses );
+
+    return rv;
 }
 
 
@@ -1073,7 +1151,7 @@ bool OPTIMIZER::fanoutCleanup( LINE* aLine )
             LINE repl;
             repl = LINE( *aLine, l2 );
 
-            if( !m_world->CheckColliding( &repl ) )
+            if( !checkColliding( &repl ) )
             {
                 aLine->SetShape( repl.CLine() );
                 return true;
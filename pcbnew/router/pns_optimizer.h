@@ -22,6 +22,7 @@
 #ifndef __PNS_OPTIMIZER_H
 #define __PNS_OPTIMIZER_H
 
+#include <cstdint>
 #include <unordered_map>
 #include <memory>
 
@@ -105,6 +106,14 @@ public:
         PRESERVE_VERTEX = 0x20
     };
 
+    ///> Counts of the collision checks answered by the cache of the optimizer, and of those
+    ///> which had to query the world
+    struct COLLISION_CACHE_STATS
+    {
+        int m_hits = 0;
+        int m_misses = 0;
+    };
+
     OPTIMIZER( NODE* aWorld );
     ~OPTIMIZER();
 
@@ -120,6 +129,18 @@ public:
     void CacheRemove( ITEM* aItem );
     void ClearCache( bool aStaticOnly = false );
 
+    const COLLISION_CACHE_STATS& CollisionCacheStats() const
+    {
+        return m_collisionCacheStats;
+    }
+
+    ///> Turns the cache of the collision checks of line segments on or off.  Both give the
+    ///> same results.
+    void SetCollisionCache( bool aEnabled )
+    {
+        m_useCollisionCache = aEnabled;
+    }
+
     void SetCollisionMask( int aMask )
     {
         m_collisionKindMask = aMask;
@@ -145,6 +166,7 @@ public:
 
 private:
     static const int MaxCachedItems = 256;
+    static const int MaxCachedCollisions = 16384;
 
     typedef std::vector<SHAPE_LINE_CHAIN> BREAKOUT_LIST;
 
@@ -156,6 +178,29 @@ private:
         bool m_isStatic;
     };
 
+    ///> A segment of a line checked for collisions, with what its clearances depend on
+    struct COLLISION_KEY
+    {
+        VECTOR2I m_a;
+        VECTOR2I m_b;
+        int m_width;
+        int m_net;
+        int m_layerStart;
+        int m_layerEnd;
+
+        bool operator==( const COLLISION_KEY& aOther ) const
+        {
+            return m_a == aOther.m_a && m_b == aOther.m_b && m_width == aOther.m_width
+                   && m_net == aOther.m_net && m_layerStart == aOther.m_layerStart
+                   && m_layerEnd == aOther.m_layerEnd;
+        }
+    };
+
+    struct COLLISION_KEY_HASH
+    {
+        std::size_t operator()( const COLLISION_KEY& aKey ) const;
+    };
+
     bool mergeObtuse( LINE* aLine );
     bool mergeFull( LINE* aLine );
     bool removeUglyCorners( LINE* aLine );
@@ -167,6 +212,7 @@ private:
 
     bool checkColliding( ITEM* aItem, bool aUpdateCache = true );
     bool checkColliding( LINE* aLine, const SHAPE_LINE_CHAIN& aOptPath );
+    bool checkCollidingCached( const LINE* aLine );
 
     void cacheAdd( ITEM* aItem, bool aIsStatic );
     void removeCachedSegments( LINE* aLine, int aStartVertex = 0, int aEndVertex = -1 );
@@ -190,6 +236,15 @@ private:
     std::vector<OPT_CONSTRAINT*> m_constraints;
     typedef std::unordered_map<ITEM*, CACHED_ITEM> CachedItemTags;
     CachedItemTags m_cacheTags;
+
+    ///> results of the collision checks of line segments against m_world, valid for as long
+    ///> as the world keeps the revision m_collisionCacheRevision
+    std::unordered_map<COLLISION_KEY, bool, COLLISION_KEY_HASH> m_collisionCache;
+    const NODE* m_collisionCacheWorld;
+    uint64_t m_collisionCacheRevision;
+    COLLISION_CACHE_STATS m_collisionCacheStats;
+    bool m_useCollisionCache;
+
     NODE* m_world;
     int m_collisionKindMask;
     int m_effortLevel;
@@ -23,6 +23,8 @@
 #include <memory>
 #include <vector>
 
+#include <wx/filename.h>
+
 #include <view/view.h>
 #include <view/view_item.h>
 #include <view/view_group.h>
@@ -55,6 +57,7 @@
 #include "pns_meander_placer.h"
 #include "pns_meander_skew_placer.h"
 #include "pns_dp_meander_placer.h"
+#include "pns_logger.h"
 
 namespace PNS {
 
@@ -77,6 +80,7 @@ ROUTER::ROUTER()
     m_snapshotIter = 0;
     m_violation = false;
     m_iface = nullptr;
+    m_logger = nullptr;
 }
 
 
@@ -136,6 +140,9 @@ bool ROUTER::StartDragging( const VECTOR2I& aP, ITEM* aItem, int aDragMode )
 
 bool ROUTER::StartDragging( const VECTOR2I& aP, ITEM_SET aStartItems, int aDragMode )
 {
+    if( m_logger )
+        m_logger->Log( LOGGER::EVT_START_DRAG, aP, aStartItems, aDragMode );
+
     if( aStartItems.Empty() )
         return false;
 
@@ -189,7 +196,9 @@ bool ROUTER::isStartingPointRoutable( const VECTOR2I& aWhere, int aLayer )
 }
 
 bool ROUTER::StartRouting( const VECTOR2I& aP, ITEM* aStartItem, int aLayer )
-{   
+{
+    if( m_logger )
+        m_logger->Log( LOGGER::EVT_START_ROUTE, aP, aStartItem, aLayer );
 
     if( ! isStartingPointRoutable( aP, aLayer ) )
     {
@@ -245,6 +254,9 @@ void ROUTER::DisplayItems( const ITEM_SET& aItems )
 
 void ROUTER::Move( const VECTOR2I& aP, ITEM* endItem )
 {
+    if( m_logger )
+        m_logger->Log( LOGGER::EVT_MOVE, aP, endItem );
+
     m_currentEnd = aP;
 
     switch( m_state )
@@ -392,6 +404,9 @@ bool ROUTER::FixRoute( const VECTOR2I& aP, ITEM* aEndItem, bool aForceFinish )
 {
     bool rv = false;
 
+    if( m_logger )
+        m_logger->Log( LOGGER::EVT_FIX, aP, aEndItem, aForceFinish ? 1 : 0 );
+
     switch( m_state )
     {
     case ROUTE_TRACK:
@@ -415,12 +430,18 @@ void ROUTER::UndoLastSegment()
     if( !RoutingInProgress() )
         return;
 
+    if( m_logger )
+        m_logger->Log( LOGGER::EVT_UNFIX, m_currentEnd );
+
     m_placer->UnfixRoute();
 }
 
 
 void ROUTER::CommitRouting()
 {
+    if( m_logger )
+        m_logger->Log( LOGGER::EVT_COMMIT, m_currentEnd );
+
     if( m_state == ROUTE_TRACK )
         m_placer->CommitPlacement();
 
@@ -430,6 +451,9 @@ void ROUTER::CommitRouting()
 
 void ROUTER::StopRouting()
 {
+    if( m_logger && RoutingInProgress() )
+        m_logger->Log( LOGGER::EVT_STOP, m_currentEnd );
+
     // Update the ratsnest with new changes
 
     if( m_placer )
@@ -458,6 +482,9 @@ void ROUTER::StopRouting()
 
 void ROUTER::FlipPosture()
 {
+    if( m_logger )
+        m_logger->Log( LOGGER::EVT_FLIP_POSTURE, m_currentEnd );
+
     if( m_state == ROUTE_TRACK )
     {
         m_placer->FlipPosture();
@@ -467,6 +494,9 @@ void ROUTER::FlipPosture()
 
 void ROUTER::SwitchLayer( int aLayer )
 {
+    if( m_logger )
+        m_logger->Log( LOGGER::EVT_SWITCH_LAYER, m_currentEnd, aLayer );
+
     switch( m_state )
     {
     case ROUTE_TRACK:
@@ -480,6 +510,9 @@ void ROUTER::SwitchLayer( int aLayer )
 
 void ROUTER::ToggleViaPlacement()
 {
+    if( m_logger )
+        m_logger->Log( LOGGER::EVT_TOGGLE_VIA, m_currentEnd );
+
     if( m_state == ROUTE_TRACK )
     {
         bool toggle = !m_placer->IsPlacingVia();
@@ -525,6 +558,17 @@ void ROUTER::DumpLog()
 
     if( logger )
         logger->Save( "/tmp/shove.log" );
+
+    if( m_logger )
+    {
+        wxFileName fn( wxFileName::GetTempDir(), wxT( "pns_events.log" ) );
+
+        m_logger->Save( fn.GetFullPath().ToStdString() );
+
+        // Each dump holds the events since the previous one, so the log does not grow
+        // for the whole session
+        m_logger->Clear();
+    }
 }
 
 
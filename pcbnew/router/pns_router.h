@@ -63,6 +63,7 @@ class RULE_RESOLVER;
 class SHOVE;
 class DRAGGER;
 class DRAG_ALGO;
+class LOGGER;
 
 enum ROUTER_MODE {
     PNS_MODE_ROUTE_SINGLE = 1,
@@ -171,6 +172,20 @@ public:
 
     void DumpLog();
 
+    /**
+     * Sets the logger recording the events of the router, so that they can be replayed.
+     * The router does not take the ownership of the logger; nullptr disables the recording.
+     */
+    void SetLogger( LOGGER* aLogger )
+    {
+        m_logger = aLogger;
+    }
+
+    LOGGER* Logger() const
+    {
+        return m_logger;
+    }
+
     RULE_RESOLVER* GetRuleResolver() const
     {
         return m_iface->GetRuleResolver();
@@ -270,6 +285,7 @@ private:
     std::unique_ptr< SHOVE >          m_shove;
 
     ROUTER_IFACE* m_iface;
+    LOGGER*       m_logger;
 
     int m_iterLimit;
     bool m_showInterSteps;
@@ -27,6 +27,7 @@ using namespace std::placeholders;
 #include "class_draw_panel_gal.h"
 #include "class_board.h"
 
+#include <advanced_config.h>
 #include <pcb_edit_frame.h>
 #include <id.h>
 #include <macros.h>
@@ -108,6 +109,17 @@ void TOOL_BASE::Reset( RESET_REASON aReason )
 
     m_router->UpdateSizes( m_savedSizes );
 
+    if( ADVANCED_CFG::GetCfg().m_RecordRouterEvents )
+    {
+        // The recorded events refer to the items of the board they were recorded on
+        if( !m_eventLog )
+            m_eventLog = std::make_unique<LOGGER>();
+        else if( aReason == MODEL_RELOAD )
+            m_eventLog->Clear();
+
+        m_router->SetLogger( m_eventLog.get() );
+    }
+
     PCBNEW_SETTINGS* settings = frame()->GetPcbNewSettings();
 
     if( !settings->m_PnsSettings )
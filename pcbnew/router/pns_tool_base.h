@@ -33,6 +33,7 @@
 #include <msgpanel.h>
 
 #include "pns_router.h"
+#include "pns_logger.h"
 
 class GRID_HELPER;
 
@@ -75,6 +76,7 @@ protected:
     GRID_HELPER* m_gridHelper;
     PNS_KICAD_IFACE* m_iface;
     ROUTER* m_router;
+    std::unique_ptr<LOGGER> m_eventLog;   ///< Events of the router since the last dump
 
     bool m_cancelled;
 };
@@ -22,6 +22,7 @@
 #include <core/optional.h>
 
 #include <geometry/shape_line_chain.h>
+#include <thread_pool.h>
 
 #include "pns_walkaround.h"
 #include "pns_optimizer.h"
@@ -33,11 +34,41 @@ namespace PNS {
 
 void WALKAROUND::start( const LINE& aInitialPath )
 {
-    m_iteration = 0;
     m_iterationLimit = 50;
 }
 
 
+void WALKAROUND::walkBoth( DIRECTION& aCw, DIRECTION& aCcw,
+                           const std::function<void( DIRECTION& )>& aWalk )
+{
+    THREAD_POOL& pool = m_threadPool ? *m_threadPool : THREAD_POOL::Get();
+
+    aCw.m_dbg = aCcw.m_dbg = Dbg();
+
+    // The logger cannot be shared between threads, and a stuck direction is not walked at all
+    if( m_logger || aCw.m_status == STUCK || aCcw.m_status == STUCK
+            || pool.GetThreadCount() < 2 )
+    {
+        aWalk( aCw );
+        aWalk( aCcw );
+        return;
+    }
+
+    // The debug graphics of the worker thread are drawn by the calling thread, once it is done
+    DEBUG_RECORDER recorder;
+    TASK_GROUP     group( pool );
+
+    if( Dbg() )
+        aCcw.m_dbg = &recorder;
+
+    group.Run( [&]() { aWalk( aCcw ); } );
+    aWalk( aCw );
+    group.Wait();
+
+    recorder.Replay( Dbg() );
+}
+
+
 NODE::OPT_OBSTACLE WALKAROUND::nearestObstacle( const LINE& aPath )
 {
     NODE::OPT_OBSTACLE obs = m_world->NearestObstacle( &aPath, m_itemMask, m_restrictedSet.empty() ? NULL : &m_restrictedSet );
@@ -52,45 +83,45 @@ NODE::OPT_OBSTACLE WALKAROUND::nearestObstacle( const LINE& aPath )
 }
 
 
-WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath,
-                                                              bool aWindingDirection )
+WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( DIRECTION& aDir )
 {
-    OPT<OBSTACLE>& current_obs =
-        aWindingDirection ? m_currentObstacle[0] : m_currentObstacle[1];
+    LINE&          path = aDir.m_path;
+    bool           cw = aDir.m_cw;
+    OPT<OBSTACLE>& current_obs = aDir.m_obstacle;
 
     if( !current_obs )
         return DONE;
 
     SHAPE_LINE_CHAIN path_pre[2], path_walk[2], path_post[2];
 
-    VECTOR2I last = aPath.CPoint( -1 );
+    VECTOR2I last = path.CPoint( -1 );
 
     if( ( current_obs->m_hull ).PointInside( last ) || ( current_obs->m_hull ).PointOnEdge( last ) )
     {
-        m_recursiveBlockageCount++;
+        aDir.m_blockageCount++;
 
-        if( m_recursiveBlockageCount < 3 )
-            aPath.Line().Append( current_obs->m_hull.NearestPoint( last ) );
+        if( aDir.m_blockageCount < 3 )
+            path.Line().Append( current_obs->m_hull.NearestPoint( last ) );
         else
         {
-            aPath = aPath.ClipToNearestObstacle( m_world );
+            path = path.ClipToNearestObstacle( m_world );
             return DONE;
         }
     }
 
-      aPath.Walkaround( current_obs->m_hull, path_pre[0], path_walk[0],
-                      path_post[0], aWindingDirection );
-    aPath.Walkaround( current_obs->m_hull, path_pre[1], path_walk[1],
-                      path_post[1], !aWindingDirection );
+      path.Walkaround( current_obs->m_hull, path_pre[0], path_walk[0],
+                      path_post[0], cw );
+    path.Walkaround( current_obs->m_hull, path_pre[1], path_walk[1],
+                      path_post[1], !cw );
 
-    if( ! aPath.Walkaround( current_obs->m_hull, path_pre[1], path_walk[1],
-                      path_post[1], !aWindingDirection ) )
+    if( ! path.Walkaround( current_obs->m_hull, path_pre[1], path_walk[1],
+                      path_post[1], !cw ) )
         return STUCK;
-    auto l =aPath.CLine();
+    auto l =path.CLine();
 #ifdef DEBUG
     if( m_logger )
     {
-        m_logger->NewGroup( aWindingDirection ? "walk-cw" : "walk-ccw", m_iteration );
+        m_logger->NewGroup( cw ? "walk-cw" : "walk-ccw", aDir.m_iteration );
         m_logger->Log( &path_walk[0], 0, "path_walk" );
         m_logger->Log( &path_pre[0], 1, "path_pre" );
         m_logger->Log( &path_post[0], 4, "path_post" );
@@ -99,19 +130,21 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath,
     }
 #endif
 
-    if ( Dbg() )
+    if ( aDir.m_dbg )
     {
         char name[128];
-        snprintf(name, sizeof(name), "hull-%s-%d", aWindingDirection ? "cw" : "ccw", m_iteration );
-        Dbg()->AddLine( current_obs->m_hull, 0, 1, name);
-        snprintf(name, sizeof(name), "path-%s-%d", aWindingDirection ? "cw" : "ccw", m_iteration );
-        Dbg()->AddLine( aPath.CLine(), 1, 1, name );
+        snprintf(name, sizeof(name), "hull-%s-%d", cw ? "cw" : "ccw",
+                 aDir.m_iteration );
+        aDir.m_dbg->AddLine( current_obs->m_hull, 0, 1, name);
+        snprintf(name, sizeof(name), "path-%s-%d", cw ? "cw" : "ccw",
+                 aDir.m_iteration );
+        aDir.m_dbg->AddLine( path.CLine(), 1, 1, name );
     }
 
     int len_pre = path_walk[0].Length();
     int len_alt = path_walk[1].Length();
 
-    LINE walk_path( aPath, path_walk[1] );
+    LINE walk_path( path, path_walk[1] );
 
     bool alt_collides = static_cast<bool>( m_world->CheckColliding( &walk_path, m_itemMask ) );
 
@@ -124,9 +157,9 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath,
         pnew.Append( path_post[1] );
 
         if( !path_post[1].PointCount() || !path_walk[1].PointCount() )
-            current_obs = nearestObstacle( LINE( aPath, path_pre[1] ) );
+            current_obs = nearestObstacle( LINE( path, path_pre[1] ) );
         else
-            current_obs = nearestObstacle( LINE( aPath, path_post[1] ) );
+            current_obs = nearestObstacle( LINE( path, path_post[1] ) );
     }
     else*/
     {
@@ -135,25 +168,25 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath,
         pnew.Append( path_post[0] );
 
         if( path_post[0].PointCount() == 0 || path_walk[0].PointCount() == 0 )
-            current_obs = nearestObstacle( LINE( aPath, path_pre[0] ) );
+            current_obs = nearestObstacle( LINE( path, path_pre[0] ) );
         else
-            current_obs = nearestObstacle( LINE( aPath, path_walk[0] ) );
+            current_obs = nearestObstacle( LINE( path, path_walk[0] ) );
 
         if( !current_obs )
         {
-            current_obs = nearestObstacle( LINE( aPath, path_post[0] ) );
+            current_obs = nearestObstacle( LINE( path, path_post[0] ) );
         }
     }
 
     pnew.Simplify();
-    aPath.SetShape( pnew );
+    path.SetShape( pnew );
 
     return IN_PROGRESS;
 }
 
 
 
-bool clipToLoopStart( SHAPE_LINE_CHAIN& l )
+static bool clipToLoopStart( SHAPE_LINE_CHAIN& l, DEBUG_DECORATOR* aDbg )
 {
     auto ip = l.SelfIntersecting();
 
@@ -166,8 +199,8 @@ bool clipToLoopStart( SHAPE_LINE_CHAIN& l )
 
         int pidx2 = tail.Split( ip->p );
         
-        auto dbg = ROUTER::GetInstance()->GetInterface()->GetDebugDecorator();
-        dbg->AddPoint( ip->p, 5 );
+        if( aDbg )
+            aDbg->AddPoint( ip->p, 5 );
         
         l = lead;
         l.Append( tail.Slice( 0, pidx2 ) );
@@ -182,9 +215,6 @@ bool clipToLoopStart( SHAPE_LINE_CHAIN& l )
 
 const WALKAROUND::RESULT WALKAROUND::Route( const LINE& aInitialPath )
 {
-    LINE path_cw( aInitialPath ), path_ccw( aInitialPath );
-    WALKAROUND_STATUS s_cw = IN_PROGRESS, s_ccw = IN_PROGRESS;
-    SHAPE_LINE_CHAIN best_path;
     RESULT result;
 
     // special case for via-in-the-middle-of-track placement
@@ -198,79 +228,41 @@ const WALKAROUND::RESULT WALKAROUND::Route( const LINE& aInitialPath )
 
     start( aInitialPath );
 
-    m_currentObstacle[0] = m_currentObstacle[1] = nearestObstacle( aInitialPath );
-    m_recursiveBlockageCount = 0;
+    DIRECTION cw( aInitialPath, true ), ccw( aInitialPath, false );
 
-    result.lineCw = aInitialPath;
-    result.lineCcw = aInitialPath;
+    cw.m_obstacle = ccw.m_obstacle = nearestObstacle( aInitialPath );
 
     if( m_forceWinding )
     {
-        s_cw = m_forceCw ? IN_PROGRESS : STUCK;
-        s_ccw = m_forceCw ? STUCK : IN_PROGRESS;
+        cw.m_status = m_forceCw ? IN_PROGRESS : STUCK;
+        ccw.m_status = m_forceCw ? STUCK : IN_PROGRESS;
         m_forceSingleDirection = true;
     } else {
         m_forceSingleDirection = false;
     }
 
-    while( m_iteration < m_iterationLimit )
-    {
-        if( s_cw != STUCK )
-            s_cw = singleStep( path_cw, true );
-
-        if( s_ccw != STUCK )
-            s_ccw = singleStep( path_ccw, false );
-
-        //Dbg()->AddLine( path_cw.CLine(), 2, 10000 );
-
-
-        //printf("iter %d s_cw %d s_ccw %d\n", m_iteration, s_cw, s_ccw );
-        
-        auto old = path_cw.CLine();
-
-        if( clipToLoopStart( path_cw.Line() ))
-        {
-            //printf("ClipCW\n");
-            //Dbg()->AddLine( old, 1, 40000 );
-            s_cw = ALMOST_DONE;
-        }
-
-        if( clipToLoopStart( path_ccw.Line() ))
-        {
-            //printf("ClipCCW\n");
-            s_ccw = ALMOST_DONE;
-        }
-
-        
-        if( s_cw != IN_PROGRESS )
-        {
-            result.lineCw = path_cw;
-            result.statusCw = s_cw;
-        }
-
-        if( s_ccw != IN_PROGRESS )
-        {
-            result.lineCcw = path_ccw;
-            result.statusCcw = s_ccw;
-        }
+    // Each direction is walked until it is done, stuck, or clipped at the start of a loop
+    walkBoth( cw, ccw, [&]( DIRECTION& aDir )
+            {
+                for( ; aDir.m_iteration < m_iterationLimit; aDir.m_iteration++ )
+                {
+                    if( aDir.m_status != STUCK )
+                        aDir.m_status = singleStep( aDir );
 
-        if( s_cw != IN_PROGRESS && s_ccw != IN_PROGRESS )
-            break;
+                    if( clipToLoopStart( aDir.m_path.Line(), aDir.m_dbg ) )
+                        aDir.m_status = ALMOST_DONE;
 
-        m_iteration++;
-    }
+                    if( aDir.m_status != IN_PROGRESS )
+                        return;
+                }
 
-    if( s_cw == IN_PROGRESS )
-    {
-        result.lineCw = path_cw;
-        result.statusCw = ALMOST_DONE;
-    }
+                aDir.m_status = ALMOST_DONE;
+            } );
 
-    if( s_ccw == IN_PROGRESS )
-    {
-        result.lineCcw = path_ccw;
-        result.statusCcw = ALMOST_DONE;
-    }
+    result.lineCw = cw.m_path;
+    result.statusCw = cw.m_status;
+    result.lineCcw = ccw.m_path;
+    result.statusCcw = ccw.m_status;
 
     result.lineCw.Line().Simplify();
     result.lineCcw.Line().Simplify();
@@ -303,10 +295,6 @@ const WALKAROUND::RESULT WALKAROUND::Route( const LINE& aInitialPath )
 WALKAROUND::WALKAROUND_STATUS WALKAROUND::Route( const LINE& aInitialPath,
         LINE& aWalkPath, bool aOptimize )
 {
-    LINE path_cw( aInitialPath ), path_ccw( aInitialPath );
-    WALKAROUND_STATUS s_cw = IN_PROGRESS, s_ccw = IN_PROGRESS;
-    SHAPE_LINE_CHAIN best_path;
-
     // special case for via-in-the-middle-of-track placement
     if( aInitialPath.PointCount() <= 1 )
     {
@@ -319,63 +307,81 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::Route( const LINE& aInitialPath,
 
     start( aInitialPath );
 
-    m_currentObstacle[0] = m_currentObstacle[1] = nearestObstacle( aInitialPath );
-    m_recursiveBlockageCount = 0;
+    DIRECTION cw( aInitialPath, true ), ccw( aInitialPath, false );
+
+    cw.m_obstacle = ccw.m_obstacle = nearestObstacle( aInitialPath );
 
     aWalkPath = aInitialPath;
 
     if( m_forceWinding )
     {
-        s_cw = m_forceCw ? IN_PROGRESS : STUCK;
-        s_ccw = m_forceCw ? STUCK : IN_PROGRESS;
+        cw.m_status = m_forceCw ? IN_PROGRESS : STUCK;
+        ccw.m_status = m_forceCw ? STUCK : IN_PROGRESS;
         m_forceSingleDirection = true;
     } else {
         m_forceSingleDirection = false;
     }
 
-    while( m_iteration < m_iterationLimit )
-    {
-        if( s_cw != STUCK )
-            s_cw = singleStep( path_cw, true );
+    // Each direction is walked until it is done or stuck.  Unless the longer path is wanted,
+    // the first direction to be done wins, so the other one stops after that iteration.
+    walkBoth( cw, ccw, [&]( DIRECTION& aDir )
+            {
+                const DIRECTION& other = aDir.m_cw ? ccw : cw;
 
-        if( s_ccw != STUCK )
-            s_ccw = singleStep( path_ccw, false );
+                for( ; aDir.m_iteration < m_iterationLimit; aDir.m_iteration++ )
+                {
+                    if( !m_forceLongerPath && other.m_doneIteration < aDir.m_iteration )
+                        return;
 
-        if( ( s_cw == DONE && s_ccw == DONE ) || ( s_cw == STUCK && s_ccw == STUCK ) )
-        {
-            int len_cw  = path_cw.CLine().Length();
-            int len_ccw = path_ccw.CLine().Length();
+                    if( aDir.m_status != STUCK )
+                        aDir.m_status = singleStep( aDir );
 
-            if( m_forceLongerPath )
-                aWalkPath = ( len_cw > len_ccw ? path_cw : path_ccw );
-            else
-                aWalkPath = ( len_cw < len_ccw ? path_cw : path_ccw );
+                    if( aDir.m_status != IN_PROGRESS )
+                    {
+                        if( aDir.m_status == DONE )
+                            aDir.m_doneIteration = aDir.m_iteration;
 
-            break;
-        }
-        else if( s_cw == DONE && !m_forceLongerPath )
-        {
-            aWalkPath = path_cw;
-            break;
-        }
-        else if( s_ccw == DONE && !m_forceLongerPath )
-        {
-            aWalkPath = path_ccw;
-            break;
-        }
+                        return;
+                    }
+                }
+            } );
+
+    // The iteration at which the directions, stepped together, would have been stopped
+    auto endIteration = []( const DIRECTION& aDir )
+            {
+                return aDir.m_status == IN_PROGRESS ? INT_MAX : aDir.m_iteration;
+            };
 
-        m_iteration++;
+    int end = INT_MAX;
+
+    if( cw.m_status == ccw.m_status )
+        end = std::max( endIteration( cw ), endIteration( ccw ) );
+
+    if( !m_forceLongerPath )
+    {
+        if( cw.m_status == DONE )
+            end = std::min( end, endIteration( cw ) );
+
+        if( ccw.m_status == DONE )
+            end = std::min( end, endIteration( ccw ) );
     }
 
-    if( m_iteration == m_iterationLimit )
+    WALKAROUND_STATUS s_cw = endIteration( cw ) <= end ? cw.m_status : IN_PROGRESS;
+    WALKAROUND_STATUS s_ccw = endIteration( ccw ) <= end ? ccw.m_status : IN_PROGRESS;
+
+    if( end == INT_MAX || ( s_cw == DONE && s_ccw == DONE ) || ( s_cw == STUCK && s_ccw == STUCK ) )
     {
-        int len_cw  = path_cw.CLine().Length();
-        int len_ccw = path_ccw.CLine().Length();
+        int len_cw  = cw.m_path.CLine().Length();
+        int len_ccw = ccw.m_path.CLine().Length();
 
         if( m_forceLongerPath )
-            aWalkPath = ( len_cw > len_ccw ? path_cw : path_ccw );
+            aWalkPath = ( len_cw > len_ccw ? cw.m_path : ccw.m_path );
         else
-            aWalkPath = ( len_cw < len_ccw ? path_cw : path_ccw );
+            aWalkPath = ( len_cw < len_ccw ? cw.m_path : ccw.m_path );
+    }
+    else
+    {
+        aWalkPath = ( s_cw == DONE ? cw.m_path : ccw.m_path );
     }
 
     if( m_cursorApproachMode )
@@ -22,6 +22,10 @@
 #ifndef __PNS_WALKAROUND_H
 #define __PNS_WALKAROUND_H
 
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <functional>
 #include <set>
 
 #include "pns_line.h"
@@ -30,8 +34,16 @@
 #include "pns_logger.h"
 #include "pns_algo_base.h"
 
+class THREAD_POOL;
+
 namespace PNS {
 
+/**
+ * WALKAROUND
+ *
+ * Walks a line around the obstacles of a node, clockwise and counter-clockwise.  The two
+ * directions only read the node, and are walked at the same time on the thread pool.
+ */
 class WALKAROUND : public ALGO_BASE
 {
     static const int DefaultIterationLimit = 50;
@@ -40,7 +52,8 @@ public:
     WALKAROUND( NODE* aWorld, ROUTER* aRouter ) :
         ALGO_BASE ( aRouter ),
         m_world( aWorld ),
-        m_iterationLimit( DefaultIterationLimit )
+        m_iterationLimit( DefaultIterationLimit ),
+        m_threadPool( nullptr )
     {
         m_forceSingleDirection = false;
         m_forceLongerPath = false;
@@ -49,9 +62,7 @@ public:
         m_itemMask = ITEM::ANY_T;
 
         // Initialize other members, to avoid uninitialized variables.
-        m_recursiveBlockageCount = 0;
         m_recursiveCollision[0] = m_recursiveCollision[1] = false;
-        m_iteration = 0;
         m_forceCw = false;
         m_forceUniqueWindingDirection = false;
     }
@@ -85,6 +96,12 @@ public:
         m_world = aNode;
     }
 
+    ///> Sets the pool the two directions are walked on, the pool of the process by default
+    void SetThreadPool( THREAD_POOL* aPool )
+    {
+        m_threadPool = aPool;
+    }
+
     void SetIterationLimit( const int aIterLimit )
     {
         m_iterationLimit = aIterLimit;
@@ -140,16 +157,42 @@ public:
     const RESULT Route( const LINE& aInitialPath );
 
 private:
+    ///> The walk of the line in one winding direction
+    struct DIRECTION
+    {
+        DIRECTION( const LINE& aPath, bool aCw ) :
+            m_path( aPath ),
+            m_cw( aCw )
+        {}
+
+        LINE               m_path;
+        bool               m_cw;
+        WALKAROUND_STATUS  m_status = IN_PROGRESS;
+        int                m_iteration = 0;         ///< of the last step, or of the end
+        int                m_blockageCount = 0;
+        NODE::OPT_OBSTACLE m_obstacle;
+        DEBUG_DECORATOR*   m_dbg = nullptr;
+
+        ///> Iteration at which the direction was done, read by the other direction
+        std::atomic<int>   m_doneIteration { INT_MAX };
+    };
+
     void start( const LINE& aInitialPath );
 
-    WALKAROUND_STATUS singleStep( LINE& aPath, bool aWindingDirection );
+    /**
+     * Function walkBoth()
+     * runs aWalk on both directions, at the same time when the algorithm does not log.
+     */
+    void walkBoth( DIRECTION& aCw, DIRECTION& aCcw,
+                   const std::function<void( DIRECTION& )>& aWalk );
+
+    WALKAROUND_STATUS singleStep( DIRECTION& aDir );
     NODE::OPT_OBSTACLE nearestObstacle( const LINE& aPath );
 
     NODE* m_world;
 
-    int m_recursiveBlockageCount;
-    int m_iteration;
     int m_iterationLimit;
+    THREAD_POOL* m_threadPool;
     int m_itemMask;
     bool m_forceSingleDirection, m_forceLongerPath;
     bool m_cursorApproachMode;
@@ -157,7 +200,6 @@ private:
     bool m_forceCw;
     bool m_forceUniqueWindingDirection;
     VECTOR2I m_cursorPos;
-    NODE::OPT_OBSTACLE m_currentObstacle[2];
     bool m_recursiveCollision[2];
     std::set<ITEM*> m_restrictedSet;
 };
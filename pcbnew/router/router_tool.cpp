@@ -465,7 +465,12 @@ void ROUTER_TOOL::Reset( RESET_REASON aReason )
 
 void ROUTER_TOOL::handleCommonEvents( const TOOL_EVENT& aEvent )
 {
-#ifdef DEBUG
+#ifndef DEBUG
+    // Release builds only save the logs when the router events are recorded
+    if( !m_router->Logger() )
+        return;
+#endif
+
     if( aEvent.IsKeyPressed() )
     {
         switch( aEvent.KeyCode() )
@@ -476,7 +481,6 @@ void ROUTER_TOOL::handleCommonEvents( const TOOL_EVENT& aEvent )
             break;
         }
     }
-#endif
 }
 
 
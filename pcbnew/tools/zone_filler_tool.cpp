@@ -67,6 +67,8 @@ void ZONE_FILLER_TOOL::CheckAllZones( wxWindow* aCaller )
 
     ZONE_FILLER filler( frame()->GetBoard(), &commit );
     filler.InstallNewProgressReporter( aCaller, _( "Checking Zones" ), 4 );
+    setDirtyAreas( filler );
+    filler.SetCacheTriangulation( canvas()->GetBackend() == EDA_DRAW_PANEL_GAL::GAL_TYPE_OPENGL );
 
     if( filler.Fill( toFill, true ) )
     {
@@ -76,6 +78,17 @@ void ZONE_FILLER_TOOL::CheckAllZones( wxWindow* aCaller )
 }
 
 
+void ZONE_FILLER_TOOL::setDirtyAreas( ZONE_FILLER& aFiller )
+{
+    PCB_EDIT_FRAME* editFrame = getEditFrame<PCB_EDIT_FRAME>();
+
+    // Only zones near the changes made since the last fill need refilling, provided all
+    // of them went through a BOARD_COMMIT
+    if( editFrame->m_ZoneFillsDirty && editFrame->m_ZoneFillDirtyAreasValid )
+        aFiller.SetDirtyAreas( editFrame->m_ZoneFillDirtyAreas );
+}
+
+
 void ZONE_FILLER_TOOL::singleShotRefocus( wxIdleEvent& )
 {
     canvas()->SetFocus();
@@ -94,6 +107,8 @@ void ZONE_FILLER_TOOL::FillAllZones( wxWindow* aCaller )
 
     ZONE_FILLER filler( board(), &commit );
     filler.InstallNewProgressReporter( aCaller, _( "Fill All Zones" ),  4 );
+    setDirtyAreas( filler );
+    filler.SetCacheTriangulation( canvas()->GetBackend() == EDA_DRAW_PANEL_GAL::GAL_TYPE_OPENGL );
 
     if( filler.Fill( toFill ) )
         getEditFrame<PCB_EDIT_FRAME>()->m_ZoneFillsDirty = false;
@@ -128,6 +143,7 @@ int ZONE_FILLER_TOOL::ZoneFill( const TOOL_EVENT& aEvent )
 
     ZONE_FILLER filler( board(), &commit );
     filler.InstallNewProgressReporter( frame(), _( "Fill Zone" ), 4 );
+    filler.SetCacheTriangulation( canvas()->GetBackend() == EDA_DRAW_PANEL_GAL::GAL_TYPE_OPENGL );
     filler.Fill( toFill );
 
     canvas()->Refresh();
@@ -29,6 +29,7 @@
 
 
 class PCB_EDIT_FRAME;
+class ZONE_FILLER;
 
 /**
  * ZONE_FILLER_TOOL
@@ -53,6 +54,9 @@ public:
     int ZoneUnfillAll( const TOOL_EVENT& aEvent );
 
 private:
+    ///> Restricts aFiller to the zones affected by changes since the last fill, if known.
+    void setDirtyAreas( ZONE_FILLER& aFiller );
+
     ///> Refocuses on an idle event (used after the Progress Reporter messes up the focus)
     void singleShotRefocus( wxIdleEvent& );
 
@@ -0,0 +1,548 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+#include <climits>
+#include <set>
+
+#include <wx/ffile.h>
+#include <wx/filename.h>
+
+#include <md5_hash.h>
+#include <richio.h>
+#include <wildcards_and_files_ext.h>
+#include <class_board.h>
+#include <class_module.h>
+#include <class_zone.h>
+#include <zone_fill_cache.h>
+
+/*
+ * File format, all numbers being unsigned LEB128 varints unless noted:
+ *
+ *  - the magic string "KiCadZoneFills", then the format version
+ *  - the size of the board file, then the 32 hex digits of its MD5 hash
+ *  - the number of zones, then for each zone:
+ *      - the length of its UUID string, then the string
+ *      - the size of its entry, then the entry:
+ *          - the number of outlines of the fill, then for each outline its number of
+ *            contours, and for each contour its point count and its points
+ *          - 1 if the triangulation of the fill follows, else 0.  The triangulation is the
+ *            number of triangulated polygons, then for each polygon its vertex count and its
+ *            vertices, its triangle count and the 3 vertex indexes of each triangle
+ *
+ * Points are stored as the zigzag encoded difference with the previous point of their list.
+ */
+
+static const char  MAGIC[] = "KiCadZoneFills";
+static const int   FORMAT_VERSION = 1;
+
+
+static void writeUnsigned( std::string& aOut, uint64_t aValue )
+{
+    while( aValue >= 0x80 )
+    {
+        aOut += (char) ( ( aValue & 0x7F ) | 0x80 );
+        aValue >>= 7;
+    }
+
+    aOut += (char) aValue;
+}
+
+
+static void writeSigned( std::string& aOut, int64_t aValue )
+{
+    writeUnsigned( aOut, ( (uint64_t) aValue << 1 ) ^ (uint64_t) ( aValue >> 63 ) );
+}
+
+
+static void writeString( std::string& aOut, const std::string& aString )
+{
+    writeUnsigned( aOut, aString.size() );
+    aOut += aString;
+}
+
+
+/**
+ * Writes a list of points as deltas.  aPoint( i ) returns the i-th point.
+ */
+template <typename POINT_FUNC>
+static void writePoints( std::string& aOut, size_t aCount, POINT_FUNC aPoint )
+{
+    VECTOR2I prev;
+
+    writeUnsigned( aOut, aCount );
+
+    for( size_t ii = 0; ii < aCount; ++ii )
+    {
+        const VECTOR2I& pt = aPoint( ii );
+
+        writeSigned( aOut, (int64_t) pt.x - prev.x );
+        writeSigned( aOut, (int64_t) pt.y - prev.y );
+        prev = pt;
+    }
+}
+
+
+/**
+ * BINARY_READER
+ * reads the numbers written by the functions above, checking the bounds of its data.
+ */
+class BINARY_READER
+{
+public:
+    BINARY_READER( const char* aStart, const char* aEnd ) :
+        m_pos( aStart ),
+        m_end( aEnd )
+    {
+    }
+
+    const char* Pos() const { return m_pos; }
+
+    bool ReadUnsigned( uint64_t& aValue )
+    {
+        aValue = 0;
+
+        for( int shift = 0; shift < 64 && m_pos < m_end; shift += 7 )
+        {
+            uint8_t byte = (uint8_t) *m_pos++;
+
+            aValue |= (uint64_t) ( byte & 0x7F ) << shift;
+
+            if( !( byte & 0x80 ) )
+                return true;
+        }
+
+        return false;
+    }
+
+    bool ReadSigned( int64_t& aValue )
+    {
+        uint64_t value;
+
+        if( !ReadUnsigned( value ) )
+            return false;
+
+        aValue = (int64_t) ( value >> 1 ) ^ -(int64_t) ( value & 1 );
+        return true;
+    }
+
+    ///> Reads a count of items of at least aItemSize bytes each, so that it cannot exceed
+    ///> the remaining data.
+    bool ReadCount( size_t& aCount, size_t aItemSize = 1 )
+    {
+        uint64_t value;
+
+        if( !ReadUnsigned( value ) || value > (uint64_t) ( m_end - m_pos ) / aItemSize )
+            return false;
+
+        aCount = (size_t) value;
+        return true;
+    }
+
+    bool ReadBytes( std::string& aBytes, size_t aCount )
+    {
+        if( aCount > (size_t) ( m_end - m_pos ) )
+            return false;
+
+        aBytes.assign( m_pos, aCount );
+        m_pos += aCount;
+        return true;
+    }
+
+    bool Skip( size_t aCount )
+    {
+        if( aCount > (size_t) ( m_end - m_pos ) )
+            return false;
+
+        m_pos += aCount;
+        return true;
+    }
+
+    ///> Reads a list of points written by writePoints().
+    bool ReadPoints( std::vector<VECTOR2I>& aPoints )
+    {
+        size_t   count;
+        VECTOR2I prev;
+
+        // Each coordinate takes at least one byte
+        if( !ReadCount( count, 2 ) )
+            return false;
+
+        aPoints.clear();
+        aPoints.reserve( count );
+
+        for( size_t ii = 0; ii < count; ++ii )
+        {
+            int64_t dx, dy;
+
+            if( !ReadSigned( dx ) || !ReadSigned( dy ) )
+                return false;
+
+            int64_t x = prev.x + dx;
+            int64_t y = prev.y + dy;
+
+            if( x < INT_MIN || x > INT_MAX || y < INT_MIN || y > INT_MAX )
+                return false;
+
+            prev = VECTOR2I( (int) x, (int) y );
+            aPoints.push_back( prev );
+        }
+
+        return true;
+    }
+
+private:
+    const char* m_pos;
+    const char* m_end;
+};
+
+
+static wxString cacheFileName( const wxString& aBoardFileName )
+{
+    wxFileName fn( aBoardFileName );
+
+    fn.SetExt( ZoneFillCacheFileExtension );
+    return fn.GetFullPath();
+}
+
+
+static void writeEntry( std::string& aOut, ZONE_CONTAINER* aZone )
+{
+    const SHAPE_POLY_SET& fill = aZone->GetFilledPolysList();
+
+    writeUnsigned( aOut, fill.OutlineCount() );
+
+    for( int ii = 0; ii < fill.OutlineCount(); ++ii )
+    {
+        const SHAPE_POLY_SET::POLYGON& poly = fill.CPolygon( ii );
+
+        writeUnsigned( aOut, poly.size() );
+
+        for( const SHAPE_LINE_CHAIN& chain : poly )
+        {
+            writePoints( aOut, chain.PointCount(),
+                         [&chain]( size_t aIdx ) -> const VECTOR2I&
+                         {
+                             return chain.CPoint( aIdx );
+                         } );
+        }
+    }
+
+    if( !fill.IsTriangulationUpToDate() )
+    {
+        writeUnsigned( aOut, 0 );
+        return;
+    }
+
+    writeUnsigned( aOut, 1 );
+    writeUnsigned( aOut, fill.TriangulatedPolyCount() );
+
+    for( unsigned ii = 0; ii < fill.TriangulatedPolyCount(); ++ii )
+    {
+        const SHAPE_POLY_SET::TRIANGULATED_POLYGON* tri = fill.TriangulatedPolygon( ii );
+
+        writePoints( aOut, tri->GetVertexCount(),
+                     [tri]( size_t aIdx ) -> const VECTOR2I&
+                     {
+                         return tri->GetVertex( aIdx );
+                     } );
+
+        writeUnsigned( aOut, tri->GetTriangleCount() );
+
+        for( size_t jj = 0; jj < tri->GetTriangleCount(); ++jj )
+        {
+            const SHAPE_POLY_SET::TRIANGULATED_POLYGON::TRI& indices =
+                    tri->GetTriangleIndices( jj );
+
+            writeUnsigned( aOut, indices.a );
+            writeUnsigned( aOut, indices.b );
+            writeUnsigned( aOut, indices.c );
+        }
+    }
+}
+
+
+bool ZONE_FILL_CACHE::Save( const wxString& aBoardFileName, BOARD* aBoard )
+{
+    std::map<KIID, ZONE_CONTAINER*> zones;
+    std::set<KIID>                  duplicates;
+
+    auto addZone = [&]( ZONE_CONTAINER* aZone )
+    {
+        if( aZone->GetFilledPolysList().IsEmpty() )
+            return;
+
+        // A cached fill must not be given to another zone
+        if( !zones.emplace( aZone->m_Uuid, aZone ).second )
+            duplicates.insert( aZone->m_Uuid );
+    };
+
+    for( ZONE_CONTAINER* zone : aBoard->Zones() )
+        addZone( zone );
+
+    for( MODULE* module : aBoard->Modules() )
+    {
+        for( MODULE_ZONE_CONTAINER* zone : module->Zones() )
+            addZone( zone );
+    }
+
+    for( const KIID& uuid : duplicates )
+        zones.erase( uuid );
+
+    std::string out( MAGIC );
+    std::string entry;
+
+    writeUnsigned( out, FORMAT_VERSION );
+
+    try
+    {
+        MAPPED_FILE_LINE_READER boardFile( aBoardFileName );
+
+        writeUnsigned( out, boardFile.Size() );
+        out += MD5_HASH::FormatData( boardFile.Data(), boardFile.Size() );
+    }
+    catch( const IO_ERROR& )
+    {
+        return false;
+    }
+
+    writeUnsigned( out, zones.size() );
+
+    for( const std::pair<const KIID, ZONE_CONTAINER*>& zone : zones )
+    {
+        entry.clear();
+        writeEntry( entry, zone.second );
+
+        writeString( out, TO_UTF8( zone.first.AsString() ) );
+        writeString( out, entry );
+    }
+
+    wxFFile file( cacheFileName( aBoardFileName ), "wb" );
+
+    if( !file.IsOpened() )
+        return false;
+
+    return file.Write( out.data(), out.size() ) == out.size() && file.Close();
+}
+
+
+void ZONE_FILL_CACHE::Remove( const wxString& aBoardFileName )
+{
+    wxString fileName = cacheFileName( aBoardFileName );
+
+    if( wxFileName::FileExists( fileName ) )
+        wxRemoveFile( fileName );
+}
+
+
+/**
+ * Decodes the entry of a zone, written by writeEntry(), which spans aStart to aEnd.  The
+ * entry is only checked when aFill and aTriangulation are null.
+ * @return false if the entry is not valid.
+ */
+static bool decodeEntry( const char* aStart, const char* aEnd, SHAPE_POLY_SET* aFill,
+                         SHAPE_POLY_SET::TRIANGULATION* aTriangulation,
+                         bool* aHasTriangulation = nullptr )
+{
+    BINARY_READER         reader( aStart, aEnd );
+    std::vector<VECTOR2I> points;
+    size_t                outlineCount;
+    size_t                contourCount;
+    uint64_t              hasTriangulation;
+
+    if( !reader.ReadCount( outlineCount ) )
+        return false;
+
+    for( size_t ii = 0; ii < outlineCount; ++ii )
+    {
+        if( !reader.ReadCount( contourCount ) || contourCount == 0 )
+            return false;
+
+        for( size_t jj = 0; jj < contourCount; ++jj )
+        {
+            if( !reader.ReadPoints( points ) )
+                return false;
+
+            if( !aFill )
+                continue;
+
+            if( jj == 0 )
+                aFill->Outline( aFill->NewOutline() ).Append( points );
+            else
+                aFill->Hole( (int) ii, aFill->NewHole() ).Append( points );
+        }
+    }
+
+    if( !reader.ReadUnsigned( hasTriangulation ) || hasTriangulation > 1 )
+        return false;
+
+    if( hasTriangulation )
+    {
+        size_t polyCount;
+        size_t triangleCount;
+
+        if( !reader.ReadCount( polyCount ) )
+            return false;
+
+        for( size_t ii = 0; ii < polyCount; ++ii )
+        {
+            SHAPE_POLY_SET::TRIANGULATED_POLYGON* tri = nullptr;
+
+            if( !reader.ReadPoints( points ) )
+                return false;
+
+            if( aTriangulation )
+            {
+                aTriangulation->push_back(
+                        std::make_unique<SHAPE_POLY_SET::TRIANGULATED_POLYGON>() );
+                tri = aTriangulation->back().get();
+
+                for( const VECTOR2I& pt : points )
+                    tri->AddVertex( pt );
+            }
+
+            if( !reader.ReadCount( triangleCount, 3 ) )
+                return false;
+
+            for( size_t jj = 0; jj < triangleCount; ++jj )
+            {
+                uint64_t a, b, c;
+
+                if( !reader.ReadUnsigned( a ) || !reader.ReadUnsigned( b )
+                        || !reader.ReadUnsigned( c ) || a >= points.size()
+                        || b >= points.size() || c >= points.size() )
+                {
+                    return false;
+                }
+
+                if( tri )
+                    tri->AddTriangle( (int) a, (int) b, (int) c );
+            }
+        }
+    }
+
+    if( aHasTriangulation )
+        *aHasTriangulation = hasTriangulation != 0;
+
+    // The whole entry must have been read
+    return reader.Pos() == aEnd;
+}
+
+
+bool ZONE_FILL_CACHE::Load( const wxString& aBoardFileName, const char* aBoardData,
+                            size_t aBoardSize )
+{
+    wxString fileName = cacheFileName( aBoardFileName );
+
+    m_data.clear();
+    m_entries.clear();
+
+    if( !wxFileName::FileExists( fileName ) )
+        return false;
+
+    wxFFile file( fileName, "rb" );
+
+    if( !file.IsOpened() )
+        return false;
+
+    wxFileOffset length = file.Length();
+
+    if( length <= 0 )
+        return false;
+
+    m_data.resize( (size_t) length );
+
+    if( file.Read( &m_data[0], m_data.size() ) != m_data.size() )
+    {
+        m_data.clear();
+        return false;
+    }
+
+    BINARY_READER reader( m_data.data(), m_data.data() + m_data.size() );
+    std::string   text;
+    uint64_t      version;
+    uint64_t      boardSize;
+    size_t        zoneCount;
+
+    if( !reader.ReadBytes( text, strlen( MAGIC ) ) || text != MAGIC
+            || !reader.ReadUnsigned( version ) || version != FORMAT_VERSION
+            || !reader.ReadUnsigned( boardSize ) || boardSize != aBoardSize
+            || !reader.ReadBytes( text, 32 )
+            || text != MD5_HASH::FormatData( aBoardData, aBoardSize )
+            || !reader.ReadCount( zoneCount ) )
+    {
+        m_data.clear();
+        return false;
+    }
+
+    // The parser skips the fills of the board file for the zones found here, and could not
+    // read them back if Apply() failed: every entry is checked now.  Entries are only built
+    // by Apply(), on the threads parsing their zones.
+    for( size_t ii = 0; ii < zoneCount; ++ii )
+    {
+        size_t size;
+
+        if( !reader.ReadCount( size ) || !reader.ReadBytes( text, size )
+                || !reader.ReadCount( size )
+                || !decodeEntry( reader.Pos(), reader.Pos() + size, nullptr, nullptr ) )
+        {
+            m_data.clear();
+            m_entries.clear();
+            return false;
+        }
+
+        m_entries[ KIID( FROM_UTF8( text.c_str() ) ) ] =
+                std::make_pair( reader.Pos() - m_data.data(), size );
+        reader.Skip( size );
+    }
+
+    return true;
+}
+
+
+bool ZONE_FILL_CACHE::Apply( ZONE_CONTAINER* aZone ) const
+{
+    auto it = m_entries.find( aZone->m_Uuid );
+
+    if( it == m_entries.end() )
+        return false;
+
+    const char*                   start = m_data.data() + it->second.first;
+    SHAPE_POLY_SET                fill;
+    SHAPE_POLY_SET::TRIANGULATION triangulation;
+    bool                          hasTriangulation;
+
+    if( !decodeEntry( start, start + it->second.second, &fill, &triangulation,
+                      &hasTriangulation ) )
+    {
+        return false;
+    }
+
+    aZone->SetFilledPolysList( fill );
+
+    if( hasTriangulation )
+        aZone->SetFilledPolysTriangulation( std::move( triangulation ) );
+
+    aZone->CalculateFilledArea();
+    return true;
+}
@@ -0,0 +1,100 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef ZONE_FILL_CACHE_H
+#define ZONE_FILL_CACHE_H
+
+#include <map>
+#include <utility>
+#include <string>
+
+#include <common.h>
+
+class BOARD;
+class ZONE_CONTAINER;
+
+
+/**
+ * ZONE_FILL_CACHE
+ * holds the filled polygons of the zones of a board, and their triangulation, read from a
+ * binary file saved next to the board file.  Coordinates are stored as variable length
+ * deltas, so the cache is much smaller and quicker to read than the filled_polygon lists of
+ * the board file, and the triangulation does not have to be computed again.
+ *
+ * The cache is tied to the content of the board file it was saved with, by a hash of the
+ * whole file: once the board file is modified, the cache is ignored and the fills are read
+ * from the board file as usual.  The fills are found by the UUID of their zone.
+ */
+class ZONE_FILL_CACHE
+{
+public:
+    /**
+     * Function Save
+     * writes the cache of the zones of @a aBoard, which has just been saved in
+     * @a aBoardFileName.
+     * @return bool - false if the cache could not be written.
+     */
+    static bool Save( const wxString& aBoardFileName, BOARD* aBoard );
+
+    /**
+     * Function Remove
+     * deletes the cache of the board file @a aBoardFileName, if there is one.
+     */
+    static void Remove( const wxString& aBoardFileName );
+
+    /**
+     * Function Load
+     * reads the cache of a board file, if it matches the content of the board file and all
+     * its entries are valid.
+     * @param aBoardFileName is the name of the board file.
+     * @param aBoardData is the content of the board file.
+     * @param aBoardSize is the size of @a aBoardData.
+     * @return bool - false if there is no valid cache for this board file.
+     */
+    bool Load( const wxString& aBoardFileName, const char* aBoardData, size_t aBoardSize );
+
+    /**
+     * Function Contains
+     * @return bool - true if the cache holds the fills of the zone @a aZone.
+     */
+    bool Contains( const KIID& aZone ) const
+    {
+        return m_entries.count( aZone ) > 0;
+    }
+
+    /**
+     * Function Apply
+     * gives @a aZone its filled polygons read from the cache, and their triangulation if
+     * it was up to date when the cache was saved.  Can be called from several threads.
+     * @return bool - false if the cache has no entry for @a aZone.
+     */
+    bool Apply( ZONE_CONTAINER* aZone ) const;
+
+private:
+    std::string                                m_data;      ///< the content of the cache file
+
+    ///> offset and size in m_data of the fills of each zone
+    std::map<KIID, std::pair<size_t, size_t>>  m_entries;
+};
+
+#endif  // ZONE_FILL_CACHE_H
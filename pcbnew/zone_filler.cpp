@@ -23,9 +23,8 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
-#include <thread>
 #include <algorithm>
-#include <future>
+#include <mutex>
 
 #include <class_board.h>
 #include <class_zone.h>
@@ -44,7 +43,9 @@
 #include <geometry/geometry_utils.h>
 #include <confirm.h>
 #include <convert_to_biu.h>
+#include <zone_knockout_cache.h>
 #include <math/util.h>      // for KiROUND
+#include <thread_pool.h>
 
 #include "zone_filler.h"
 
@@ -74,11 +75,54 @@ static const double s_RoundPadThermalSpokeAngle = 450;
 static const bool s_DumpZonesWhenFilling = false;
 
 
+// Copper zones are split in tiles of at least this size (in mm) to be filled by several threads
+static const double s_MinZoneTileSizeMM = 20.0;
+
+
+/**
+ * Runs aJob( i ) for every i in [0, aCount) on the thread pool, keeping the progress
+ * reporter (if any) refreshing while waiting for the workers.
+ */
+static void runParallel( size_t aCount, WX_PROGRESS_REPORTER* aReporter,
+                         const std::function<void( size_t )>& aJob )
+{
+    std::function<bool()> progress;
+
+    if( aReporter )
+    {
+        progress = [aReporter]() -> bool
+                   {
+                       aReporter->KeepRefreshing();
+                       return true;
+                   };
+    }
+
+    THREAD_POOL::ParallelFor( aCount, aJob, progress );
+}
+
+
+static SHAPE_POLY_SET rectToPolygon( const EDA_RECT& aRect )
+{
+    SHAPE_POLY_SET poly;
+
+    poly.NewOutline();
+    poly.Append( aRect.GetLeft(), aRect.GetTop() );
+    poly.Append( aRect.GetRight(), aRect.GetTop() );
+    poly.Append( aRect.GetRight(), aRect.GetBottom() );
+    poly.Append( aRect.GetLeft(), aRect.GetBottom() );
+
+    return poly;
+}
+
+
 ZONE_FILLER::ZONE_FILLER(  BOARD* aBoard, COMMIT* aCommit ) :
     m_board( aBoard ),
     m_brdOutlinesValid( false ),
     m_commit( aCommit ),
     m_progressReporter( nullptr ),
+    m_incremental( false ),
+    m_cacheTriangulation( false ),
+    m_tiling( true ),
     m_high_def( 9 ),
     m_low_def( 6 )
 {
@@ -98,6 +142,38 @@ void ZONE_FILLER::InstallNewProgressReporter( wxWindow* aParent, const wxString&
 }
 
 
+void ZONE_FILLER::SetDirtyAreas( const std::vector<EDA_RECT>& aAreas )
+{
+    m_incremental = true;
+    m_dirtyAreas = aAreas;
+}
+
+
+bool ZONE_FILLER::isZoneDirty( const ZONE_CONTAINER* aZone ) const
+{
+    if( !aZone->IsFilled() || aZone->NeedRefill() )
+        return true;
+
+    // The dirty areas already include the clearances of the changed items; the zone side
+    // must account for its own clearances, thermal gaps and the board edge clearance.
+    const BOARD_DESIGN_SETTINGS& bds = m_board->GetDesignSettings();
+    int margin = std::max( bds.GetBiggestClearanceValue(), aZone->GetClearance() );
+    margin = std::max( margin, aZone->GetThermalReliefGap() );
+    margin = std::max( margin, bds.m_CopperEdgeClearance );
+
+    EDA_RECT zoneArea = aZone->GetBoundingBox();
+    zoneArea.Inflate( margin + Millimeter2iu( 0.002 ) );
+
+    for( const EDA_RECT& area : m_dirtyAreas )
+    {
+        if( area.Intersects( zoneArea ) )
+            return true;
+    }
+
+    return false;
+}
+
+
 bool ZONE_FILLER::Fill( const std::vector<ZONE_CONTAINER*>& aZones, bool aCheck )
 {
     std::vector<CN_ZONE_ISOLATED_ISLAND_LIST> toFill;
@@ -112,7 +188,6 @@ bool ZONE_FILLER::Fill( const std::vector<ZONE_CONTAINER*>& aZones, bool aCheck
     if( m_progressReporter )
     {
         m_progressReporter->Report( aCheck ? _( "Checking zone fills..." ) : _( "Building zone fills..." ) );
-        m_progressReporter->SetMaxProgress( toFill.size() );
     }
 
     // The board outlines is used to clip solid areas inside the board (when outlines are valid)
@@ -125,6 +200,10 @@ bool ZONE_FILLER::Fill( const std::vector<ZONE_CONTAINER*>& aZones, bool aCheck
         if( zone->GetIsKeepout() )
             continue;
 
+        // In incremental mode zones clear of every changed area keep their current fill
+        if( m_incremental && !isZoneDirty( zone ) )
+            continue;
+
         if( m_commit )
             m_commit->Modify( zone );
 
@@ -140,55 +219,95 @@ bool ZONE_FILLER::Fill( const std::vector<ZONE_CONTAINER*>& aZones, bool aCheck
         zone->UnFill();
     }
 
-    std::atomic<size_t> nextItem( 0 );
-    size_t              parallelThreadCount =
-            std::min<size_t>( std::thread::hardware_concurrency(), aZones.size() );
-    std::vector<std::future<size_t>> returns( parallelThreadCount );
+    // The arc approximations are set once here: the fill jobs below run concurrently and
+    // only read them.
+    m_high_def = m_board->GetDesignSettings().m_MaxError;
+    m_low_def = std::min( ARC_LOW_DEF, int( m_high_def*1.5 ) );   // Reasonable value
 
-    auto fill_lambda = [&] ( PROGRESS_REPORTER* aReporter ) -> size_t
-    {
-        size_t num = 0;
+    // Large copper zones are split into tiles so that a single zone is filled by several
+    // threads.  Each job fills either a whole zone or one tile of a zone.
+    std::vector<std::vector<ZONE_TILE>>      zoneTiles( toFill.size() );
+    std::vector<std::vector<SHAPE_POLY_SET>> tileFills( toFill.size() );
+    std::vector<SHAPE_POLY_SET>              smoothedPolys( toFill.size() );
+    std::vector<std::pair<size_t, size_t>>   jobs;
 
-        for( size_t i = nextItem++; i < toFill.size(); i = nextItem++ )
-        {
-            ZONE_CONTAINER* zone = toFill[i].m_zone;
-            zone->SetFilledPolysUseThickness( filledPolyWithOutline );
-            SHAPE_POLY_SET rawPolys, finalPolys;
-            fillSingleZone( zone, rawPolys, finalPolys );
+    for( size_t i = 0; i < toFill.size(); ++i )
+    {
+        ZONE_CONTAINER* zone = toFill[i].m_zone;
+        zone->SetFilledPolysUseThickness( filledPolyWithOutline );
 
-            zone->SetRawPolysList( rawPolys );
-            zone->SetFilledPolysList( finalPolys );
-            zone->SetIsFilled( true );
+        buildTiles( zone, zoneTiles[i] );
 
-            if( m_progressReporter )
-                m_progressReporter->AdvanceProgress();
+        if( !zoneTiles[i].empty() )
+        {
+            std::set<VECTOR2I> colinearCorners;
+            zone->GetColinearCorners( m_board, colinearCorners );
 
-            num++;
+            if( !zone->BuildSmoothedPoly( smoothedPolys[i], &colinearCorners ) )
+                zoneTiles[i].clear();
         }
 
-        return num;
-    };
+        tileFills[i].resize( zoneTiles[i].size() );
 
-    if( parallelThreadCount <= 1 )
-        fill_lambda( m_progressReporter );
-    else
-    {
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-            returns[ii] = std::async( std::launch::async, fill_lambda, m_progressReporter );
+        for( size_t t = 0; t < std::max<size_t>( zoneTiles[i].size(), 1 ); ++t )
+            jobs.emplace_back( i, t );
+    }
 
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-        {
-            // Here we balance returns with a 100ms timeout to allow UI updating
-            std::future_status status;
-            do
+    if( m_progressReporter )
+        m_progressReporter->SetMaxProgress( jobs.size() );
+
+    runParallel( jobs.size(), m_progressReporter,
+            [&]( size_t aJob )
             {
+                size_t          i = jobs[aJob].first;
+                size_t          t = jobs[aJob].second;
+                ZONE_CONTAINER* zone = toFill[i].m_zone;
+
+                if( zoneTiles[i].empty() )
+                {
+                    SHAPE_POLY_SET rawPolys, finalPolys;
+                    fillSingleZone( zone, rawPolys, finalPolys );
+
+                    zone->SetRawPolysList( rawPolys );
+                    zone->SetFilledPolysList( finalPolys );
+                    zone->SetIsFilled( true );
+                }
+                else
+                {
+                    SHAPE_POLY_SET unused;
+                    computeRawFilledArea( zone, smoothedPolys[i], nullptr, tileFills[i][t], unused,
+                                          &zoneTiles[i][t] );
+                }
+
                 if( m_progressReporter )
-                    m_progressReporter->KeepRefreshing();
+                    m_progressReporter->AdvanceProgress();
+            } );
 
-                status = returns[ii].wait_for( std::chrono::milliseconds( 100 ) );
-            } while( status != std::future_status::ready );
-        }
-    }
+    // Stitch tiled zones back together.  Fracturing has to wait until then, as tile borders
+    // would otherwise split the copper areas used to find insulated islands.
+    runParallel( toFill.size(), m_progressReporter,
+            [&]( size_t i )
+            {
+                if( zoneTiles[i].empty() )
+                    return;
+
+                ZONE_CONTAINER* zone = toFill[i].m_zone;
+                SHAPE_POLY_SET  rawPolys;
+
+                for( const SHAPE_POLY_SET& tileFill : tileFills[i] )
+                    rawPolys.Append( tileFill );
+
+                tileFills[i].clear();
+
+                // Adjacent tiles share their borders exactly, so a union merges them back
+                rawPolys.Simplify( SHAPE_POLY_SET::PM_FAST );
+                rawPolys.Fracture( SHAPE_POLY_SET::PM_FAST );
+
+                zone->SetRawPolysList( rawPolys );
+                zone->SetFilledPolysList( rawPolys );
+                zone->SetIsFilled( true );
+                zone->SetNeedRefill( false );
+            } );
 
     // Now update the connectivity to check for copper islands
     if( m_progressReporter )
@@ -274,44 +393,16 @@ bool ZONE_FILLER::Fill( const std::vector<ZONE_CONTAINER*>& aZones, bool aCheck
         m_progressReporter->SetMaxProgress( toFill.size() );
     }
 
-
-    nextItem = 0;
-
-    auto tri_lambda = [&] ( PROGRESS_REPORTER* aReporter ) -> size_t
+    if( m_cacheTriangulation )
     {
-        size_t num = 0;
-
-        for( size_t i = nextItem++; i < toFill.size(); i = nextItem++ )
-        {
-            toFill[i].m_zone->CacheTriangulation();
-            num++;
-
-            if( m_progressReporter )
-                m_progressReporter->AdvanceProgress();
-        }
-
-        return num;
-    };
-
-    if( parallelThreadCount <= 1 )
-        tri_lambda( m_progressReporter );
-    else
-    {
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-            returns[ii] = std::async( std::launch::async, tri_lambda, m_progressReporter );
-
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
-        {
-            // Here we balance returns with a 100ms timeout to allow UI updating
-            std::future_status status;
-            do
-            {
-                if( m_progressReporter )
-                    m_progressReporter->KeepRefreshing();
+        runParallel( toFill.size(), m_progressReporter,
+                [&]( size_t i )
+                {
+                    toFill[i].m_zone->CacheTriangulation();
 
-                status = returns[ii].wait_for( std::chrono::milliseconds( 100 ) );
-            } while( status != std::future_status::ready );
-        }
+                    if( m_progressReporter )
+                        m_progressReporter->AdvanceProgress();
+                } );
     }
 
     if( m_progressReporter )
@@ -323,6 +414,11 @@ bool ZONE_FILLER::Fill( const std::vector<ZONE_CONTAINER*>& aZones, bool aCheck
 
     connectivity->SetProgressReporter( nullptr );
 
+    // Incremental fills only see part of the board, so only full fills can tell which
+    // knockouts are no longer needed
+    if( !m_incremental )
+        m_board->GetKnockoutCache()->Prune();
+
     if( m_commit )
     {
         m_commit->Push( _( "Fill Zone(s)" ), false );
@@ -384,10 +480,46 @@ static void setupDummyPadForHole( const D_PAD* aPad, D_PAD& aDummyPad )
 
 
 /**
- * Add a knockout for a pad.  The knockout is 'aGap' larger than the pad (which might be
- * either the thermal clearance or the electrical clearance).
+ * Append the knockout of a pad, track or via to aHoles, taking it from the knockout cache
+ * when available.
+ */
+void ZONE_FILLER::addCachedKnockout( BOARD_ITEM* aItem, int aGap, SHAPE_POLY_SET& aHoles,
+                                     const std::function<void( SHAPE_POLY_SET& )>& aBuilder )
+{
+    KNOCKOUT_CACHE*          cache = m_board->GetKnockoutCache().get();
+    KNOCKOUT_CACHE::KEY      key = KNOCKOUT_CACHE::MakeKey( aItem, aGap, m_high_def, m_low_def );
+    KNOCKOUT_CACHE::KNOCKOUT knockout = cache->Get( key );
+
+    if( !knockout )
+    {
+        std::shared_ptr<SHAPE_POLY_SET> poly = std::make_shared<SHAPE_POLY_SET>();
+        aBuilder( *poly );
+        cache->Put( key, poly );
+        knockout = poly;
+    }
+
+    aHoles.Append( *knockout );
+}
+
+
+/**
+ * Add a knockout for a pad.
  */
 void ZONE_FILLER::addKnockout( D_PAD* aPad, int aGap, SHAPE_POLY_SET& aHoles )
+{
+    addCachedKnockout( aPad, aGap, aHoles,
+                       [&]( SHAPE_POLY_SET& aKnockout )
+                       {
+                           buildPadKnockout( aPad, aGap, aKnockout );
+                       } );
+}
+
+
+/**
+ * Build the knockout for a pad.  The knockout is 'aGap' larger than the pad (which might be
+ * either the thermal clearance or the electrical clearance).
+ */
+void ZONE_FILLER::buildPadKnockout( D_PAD* aPad, int aGap, SHAPE_POLY_SET& aHoles )
 {
     if( aPad->GetShape() == PAD_SHAPE_CUSTOM )
     {
@@ -472,7 +604,8 @@ void ZONE_FILLER::addKnockout( BOARD_ITEM* aItem, int aGap, bool aIgnoreLineWidt
  * Removes thermal reliefs from the shape for any pads connected to the zone.  Does NOT add
  * in spokes, which must be done later.
  */
-void ZONE_FILLER::knockoutThermalReliefs( const ZONE_CONTAINER* aZone, SHAPE_POLY_SET& aFill )
+void ZONE_FILLER::knockoutThermalReliefs( const ZONE_CONTAINER* aZone, const EDA_RECT& aArea,
+                                          SHAPE_POLY_SET& aFill )
 {
     SHAPE_POLY_SET holes;
 
@@ -490,6 +623,12 @@ void ZONE_FILLER::knockoutThermalReliefs( const ZONE_CONTAINER* aZone, SHAPE_POL
             if( !hasThermalConnection( pad, aZone ) )
                 continue;
 
+            EDA_RECT reliefBB = pad->GetBoundingBox();
+            reliefBB.Inflate( aZone->GetThermalReliefGap( pad ) );
+
+            if( !reliefBB.Intersects( aArea ) )
+                continue;
+
             // If the pad isn't on the current layer but has a hole, knock out a thermal relief
             // for the hole.
             if( !pad->IsOnLayer( aZone->GetLayer() ) )
@@ -514,7 +653,8 @@ void ZONE_FILLER::knockoutThermalReliefs( const ZONE_CONTAINER* aZone, SHAPE_POL
  * Removes clearance from the shape for copper items which share the zone's layer but are
  * not connected to it.
  */
-void ZONE_FILLER::buildCopperItemClearances( const ZONE_CONTAINER* aZone, SHAPE_POLY_SET& aHoles )
+void ZONE_FILLER::buildCopperItemClearances( const ZONE_CONTAINER* aZone, const EDA_RECT& aArea,
+                                             SHAPE_POLY_SET& aHoles )
 {
     // a small extra clearance to be sure actual track clearance is not smaller
     // than requested clearance due to many approximations in calculations,
@@ -526,9 +666,9 @@ void ZONE_FILLER::buildCopperItemClearances( const ZONE_CONTAINER* aZone, SHAPE_
     int edgeClearance = m_board->GetDesignSettings().m_CopperEdgeClearance;
     int zone_to_edgecut_clearance = std::max( aZone->GetZoneClearance(), edgeClearance );
 
-    // items outside the zone bounding box are skipped
-    // the bounding box is the zone bounding box + the biggest clearance found in Netclass list
-    EDA_RECT zone_boundingbox = aZone->GetBoundingBox();
+    // items outside the area (the zone bounding box or the tile) are skipped
+    // the bounding box is the area + the biggest clearance found in Netclass list
+    EDA_RECT zone_boundingbox = aArea;
     int biggest_clearance = m_board->GetDesignSettings().GetBiggestClearanceValue();
     biggest_clearance = std::max( biggest_clearance, zone_clearance ) + extra_margin;
     zone_boundingbox.Inflate( biggest_clearance );
@@ -595,7 +735,14 @@ void ZONE_FILLER::buildCopperItemClearances( const ZONE_CONTAINER* aZone, SHAPE_
         EDA_RECT item_boundingbox = track->GetBoundingBox();
 
         if( item_boundingbox.Intersects( zone_boundingbox ) )
-            track->TransformShapeWithClearanceToPolygon( aHoles, gap, m_low_def );
+        {
+            addCachedKnockout( track, gap, aHoles,
+                               [&]( SHAPE_POLY_SET& aKnockout )
+                               {
+                                   track->TransformShapeWithClearanceToPolygon( aKnockout, gap,
+                                                                                m_low_def );
+                               } );
+        }
     }
 
     // Add graphic item clearances.  They are by definition unconnected, and have no clearance
@@ -695,11 +842,9 @@ void ZONE_FILLER::computeRawFilledArea( const ZONE_CONTAINER* aZone,
                                         const SHAPE_POLY_SET& aSmoothedOutline,
                                         std::set<VECTOR2I>* aPreserveCorners,
                                         SHAPE_POLY_SET& aRawPolys,
-                                        SHAPE_POLY_SET& aFinalPolys )
+                                        SHAPE_POLY_SET& aFinalPolys,
+                                        const ZONE_TILE* aTile )
 {
-    m_high_def = m_board->GetDesignSettings().m_MaxError;
-    m_low_def = std::min( ARC_LOW_DEF, int( m_high_def*1.5 ) );   // Reasonable value
-
     // Features which are min_width should survive pruning; features that are *less* than
     // min_width should not.  Therefore we subtract epsilon from the min_width when
     // deflating/inflating.
@@ -727,36 +872,46 @@ void ZONE_FILLER::computeRawFilledArea( const ZONE_CONTAINER* aZone,
     std::unique_ptr<SHAPE_FILE_IO> dumper( new SHAPE_FILE_IO(
                     s_DumpZonesWhenFilling ? "zones_dump.txt" : "", SHAPE_FILE_IO::IOM_APPEND ) );
 
+    // When filling a single tile, only the tile and its surroundings are considered
+    EDA_RECT area = aTile ? aTile->m_Context : aZone->GetBoundingBox();
+
     aRawPolys = aSmoothedOutline;
 
+    if( aTile )
+        aRawPolys.BooleanIntersection( rectToPolygon( area ), SHAPE_POLY_SET::PM_FAST );
+
     if( s_DumpZonesWhenFilling )
         dumper->BeginGroup( "clipper-zone" );
 
-    knockoutThermalReliefs( aZone, aRawPolys );
+    knockoutThermalReliefs( aZone, area, aRawPolys );
 
     if( s_DumpZonesWhenFilling )
         dumper->Write( &aRawPolys, "solid-areas-minus-thermal-reliefs" );
 
-    buildCopperItemClearances( aZone, clearanceHoles );
+    buildCopperItemClearances( aZone, area, clearanceHoles );
 
     if( s_DumpZonesWhenFilling )
         dumper->Write( &aRawPolys, "clearance holes" );
 
-    buildThermalSpokes( aZone, thermalSpokes );
+    buildThermalSpokes( aZone, area, thermalSpokes );
 
     // Create a temporary zone that we can hit-test spoke-ends against.  It's only temporary
     // because the "real" subtract-clearance-holes has to be done after the spokes are added.
     static const bool USE_BBOX_CACHES = true;
-    SHAPE_POLY_SET testAreas = aRawPolys;
-    testAreas.BooleanSubtract( clearanceHoles, SHAPE_POLY_SET::PM_FAST );
+    SHAPE_POLY_SET                  testAreas;
+    SHAPE_POLY_SET::BOOLEAN_BUILDER testBuilder( aRawPolys );
+
+    testBuilder.Subtract( clearanceHoles, SHAPE_POLY_SET::PM_FAST );
 
     // Prune features that don't meet minimum-width criteria
     if( half_min_width - epsilon > epsilon )
     {
-        testAreas.Deflate( half_min_width - epsilon, numSegs, intermediatecornerStrategy );
-        testAreas.Inflate( half_min_width - epsilon, numSegs, intermediatecornerStrategy );
+        testBuilder.Deflate( half_min_width - epsilon, numSegs, intermediatecornerStrategy );
+        testBuilder.Inflate( half_min_width - epsilon, numSegs, intermediatecornerStrategy );
     }
 
+    testBuilder.Result( testAreas );
+
     // Spoke-end-testing is hugely expensive so we generate cached bounding-boxes to speed
     // things up a bit.
     testAreas.BuildBBoxCaches();
@@ -783,18 +938,26 @@ void ZONE_FILLER::computeRawFilledArea( const ZONE_CONTAINER* aZone,
         }
     }
 
+    // The polygons stay in Clipper form from here to the hatching
+    SHAPE_POLY_SET::BOOLEAN_BUILDER builder( aRawPolys );
+
     // Ensure previous changes (adding thermal stubs) do not add
     // filled areas outside the zone boundary
-    aRawPolys.BooleanIntersection( aSmoothedOutline, SHAPE_POLY_SET::PM_FAST );
-    aRawPolys.Simplify( SHAPE_POLY_SET::PM_FAST );
+    builder.Intersect( aSmoothedOutline, SHAPE_POLY_SET::PM_FAST );
+    builder.Simplify( SHAPE_POLY_SET::PM_FAST );
 
     if( s_DumpZonesWhenFilling )
+    {
+        builder.Result( aRawPolys );
         dumper->Write( &aRawPolys, "solid-areas-with-thermal-spokes" );
+    }
 
-    aRawPolys.BooleanSubtract( clearanceHoles, SHAPE_POLY_SET::PM_FAST );
+    builder.Subtract( clearanceHoles, SHAPE_POLY_SET::PM_FAST );
     // Prune features that don't meet minimum-width criteria
     if( half_min_width - epsilon > epsilon )
-        aRawPolys.Deflate( half_min_width - epsilon, numSegs, intermediatecornerStrategy );
+        builder.Deflate( half_min_width - epsilon, numSegs, intermediatecornerStrategy );
+
+    builder.Result( aRawPolys );
 
     if( s_DumpZonesWhenFilling )
         dumper->Write( &aRawPolys, "solid-areas-before-hatching" );
@@ -806,21 +969,39 @@ void ZONE_FILLER::computeRawFilledArea( const ZONE_CONTAINER* aZone,
     if( s_DumpZonesWhenFilling )
         dumper->Write( &aRawPolys, "solid-areas-after-hatching" );
 
-    // Re-inflate after pruning of areas that don't meet minimum-width criteria
-    if( aZone->GetFilledPolysUseThickness() )
+    // Re-inflate after pruning of areas that don't meet minimum-width criteria.  If we're
+    // stroking the zone with a min_width stroke then this will naturally inflate the zone by
+    // half_min_width.
+    bool reinflate = !aZone->GetFilledPolysUseThickness() && half_min_width - epsilon > epsilon;
+
+    if( reinflate || aTile )
     {
-        // If we're stroking the zone with a min_width stroke then this will naturally
-        // inflate the zone by half_min_width
+        SHAPE_POLY_SET::BOOLEAN_BUILDER finalBuilder( aRawPolys );
+
+        if( reinflate )
+        {
+            finalBuilder.Simplify( SHAPE_POLY_SET::PM_FAST );
+            finalBuilder.Inflate( half_min_width - epsilon, numSegs, finalcornerStrategy );
+
+            // If we've deflated/inflated by something near our corner radius then we will have
+            // ended up with too-sharp corners.  Apply outline smoothing again.
+            if( aZone->GetMinThickness() > (int)aZone->GetCornerRadius() )
+                finalBuilder.Intersect( aSmoothedOutline, SHAPE_POLY_SET::PM_FAST );
+        }
+
+        if( aTile )
+            finalBuilder.Intersect( rectToPolygon( aTile->m_Area ), SHAPE_POLY_SET::PM_FAST );
+
+        finalBuilder.Result( aRawPolys );
     }
-    else if( half_min_width - epsilon > epsilon )
+
+    // Tiles are fractured once stitched back together
+    if( aTile )
     {
-        aRawPolys.Simplify( SHAPE_POLY_SET::PM_FAST );
-        aRawPolys.Inflate( half_min_width - epsilon, numSegs, finalcornerStrategy );
+        if( s_DumpZonesWhenFilling )
+            dumper->EndGroup();
 
-        // If we've deflated/inflated by something near our corner radius then we will have
-        // ended up with too-sharp corners.  Apply outline smoothing again.
-        if( aZone->GetMinThickness() > (int)aZone->GetCornerRadius() )
-            aRawPolys.BooleanIntersection( aSmoothedOutline, SHAPE_POLY_SET::PM_FAST );
+        return;
     }
 
     aRawPolys.Fracture( SHAPE_POLY_SET::PM_FAST );
@@ -835,6 +1016,73 @@ void ZONE_FILLER::computeRawFilledArea( const ZONE_CONTAINER* aZone,
 }
 
 
+void ZONE_FILLER::buildTiles( const ZONE_CONTAINER* aZone, std::vector<ZONE_TILE>& aTiles )
+{
+    if( !m_tiling )
+        return;
+
+    // Hatch patterns are aligned on the whole zone, so only solid copper fills can be tiled
+    if( !aZone->IsOnCopperLayer() || aZone->GetFillMode() == ZONE_FILL_MODE::HATCH_PATTERN )
+        return;
+
+    EDA_RECT zoneBB = aZone->GetBoundingBox();
+
+    // The fill of a tile can be changed by anything within this distance: copper item
+    // clearances, thermal reliefs and spokes (which extend across their whole pad), and the
+    // deflate/inflate pass pruning features thinner than the zone min width.
+    int maxReliefSize = 0;
+
+    for( MODULE* module : m_board->Modules() )
+    {
+        for( D_PAD* pad : module->Pads() )
+        {
+            EDA_RECT padBB = pad->GetBoundingBox();
+
+            if( !padBB.Intersects( zoneBB ) )
+                continue;
+
+            int reliefSize = std::max( padBB.GetWidth(), padBB.GetHeight() )
+                             + aZone->GetThermalReliefGap( pad );
+            maxReliefSize = std::max( maxReliefSize, reliefSize );
+        }
+    }
+
+    int margin = std::max( m_board->GetDesignSettings().GetBiggestClearanceValue(),
+                           aZone->GetClearance() );
+    margin += maxReliefSize + 2 * aZone->GetMinThickness() + Millimeter2iu( 0.1 );
+
+    // Keep tiles large enough that their surroundings remain a small part of them
+    int minTileSize = std::max( Millimeter2iu( s_MinZoneTileSizeMM ), 4 * margin );
+    int maxTilesPerAxis = KiROUND( ceil( sqrt( 2.0 * THREAD_POOL::Get().GetThreadCount() ) ) );
+    int cols = Clamp( 1, zoneBB.GetWidth() / minTileSize, maxTilesPerAxis );
+    int rows = Clamp( 1, zoneBB.GetHeight() / minTileSize, maxTilesPerAxis );
+
+    if( cols * rows < 2 )
+        return;
+
+    // Tiles share their borders; make sure the outer ones fully enclose the zone
+    zoneBB.Inflate( Millimeter2iu( 0.01 ) );
+
+    for( int row = 0; row < rows; ++row )
+    {
+        int top = zoneBB.GetY() + (int) ( (int64_t) zoneBB.GetHeight() * row / rows );
+        int bottom = zoneBB.GetY() + (int) ( (int64_t) zoneBB.GetHeight() * ( row + 1 ) / rows );
+
+        for( int col = 0; col < cols; ++col )
+        {
+            int left = zoneBB.GetX() + (int) ( (int64_t) zoneBB.GetWidth() * col / cols );
+            int right = zoneBB.GetX() + (int) ( (int64_t) zoneBB.GetWidth() * ( col + 1 ) / cols );
+
+            ZONE_TILE tile;
+            tile.m_Area = EDA_RECT( wxPoint( left, top ), wxSize( right - left, bottom - top ) );
+            tile.m_Context = tile.m_Area;
+            tile.m_Context.Inflate( margin );
+            aTiles.push_back( tile );
+        }
+    }
+}
+
+
 /*
  * Build the filled solid areas data from real outlines (stored in m_Poly)
  * The solid areas can be more than one on copper layers, and do not have holes
@@ -900,10 +1148,10 @@ bool ZONE_FILLER::fillSingleZone( ZONE_CONTAINER* aZone, SHAPE_POLY_SET& aRawPol
 /**
  * Function buildThermalSpokes
  */
-void ZONE_FILLER::buildThermalSpokes( const ZONE_CONTAINER* aZone,
+void ZONE_FILLER::buildThermalSpokes( const ZONE_CONTAINER* aZone, const EDA_RECT& aArea,
                                       std::deque<SHAPE_LINE_CHAIN>& aSpokesList )
 {
-    auto zoneBB = aZone->GetBoundingBox();
+    EDA_RECT zoneBB = aArea;
     int  zone_clearance = aZone->GetZoneClearance();
     int  biggest_clearance = m_board->GetDesignSettings().GetBiggestClearanceValue();
     biggest_clearance = std::max( biggest_clearance, zone_clearance );
@@ -953,14 +1201,16 @@ void ZONE_FILLER::buildThermalSpokes( const ZONE_CONTAINER* aZone,
             // We use the bounding-box to lay out the spokes, but for this to work the
             // bounding box has to be built at the same rotation as the spokes.
 
+            //
+            // The pad is copied rather than temporarily rotated: several threads (filling
+            // other zones or other tiles of this zone) can be reading it.
+
             wxPoint shapePos = pad->ShapePos();
-            wxPoint padPos = pad->GetPosition();
             double padAngle = pad->GetOrientation();
-            pad->SetOrientation( 0.0 );
-            pad->SetPosition( { 0, 0 } );
-            BOX2I reliefBB = pad->GetBoundingBox();
-            pad->SetPosition( padPos );
-            pad->SetOrientation( padAngle );
+            D_PAD   unrotatedPad( *pad );
+            unrotatedPad.SetOrientation( 0.0 );
+            unrotatedPad.SetPosition( { 0, 0 } );
+            BOX2I reliefBB = unrotatedPad.GetBoundingBox();
 
             reliefBB.Inflate( thermalReliefGap + epsilon );
 
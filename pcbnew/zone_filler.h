@@ -27,6 +27,7 @@
 #define __ZONE_FILLER_H
 
 #include <vector>
+#include <functional>
 #include <class_zone.h>
 
 class WX_PROGRESS_REPORTER;
@@ -39,21 +40,63 @@ class SHAPE_LINE_CHAIN;
 class ZONE_FILLER
 {
 public:
+    /**
+     * A rectangular part of a copper zone, filled independently from the rest of the zone.
+     */
+    struct ZONE_TILE
+    {
+        EDA_RECT m_Area;        ///< the part of the zone fill computed by this tile
+        EDA_RECT m_Context;     ///< m_Area inflated by the distance at which items can still
+                                ///< change the fill inside m_Area
+    };
+
     ZONE_FILLER( BOARD* aBoard, COMMIT* aCommit = nullptr );
     ~ZONE_FILLER();
 
     void InstallNewProgressReporter( wxWindow* aParent, const wxString& aTitle, int aNumPhases );
     bool Fill( const std::vector<ZONE_CONTAINER*>& aZones, bool aCheck = false );
 
+    /**
+     * Switches the filler to incremental mode: only zones whose fill can be affected by
+     * changes inside aAreas (as recorded by BOARD_COMMIT) are refilled.  Zones which are
+     * already filled and lie clear of every area keep their current fill.
+     */
+    void SetDirtyAreas( const std::vector<EDA_RECT>& aAreas );
+
+    /**
+     * Triangulates the filled areas at the end of Fill(), on all cores.  Only worth it when
+     * the zones are about to be drawn by OpenGL; otherwise triangulation is left to be built
+     * on first use.
+     */
+    void SetCacheTriangulation( bool aCache ) { m_cacheTriangulation = aCache; }
+
+    /**
+     * Large copper zones are split into tiles filled in parallel, see buildTiles(), unless
+     * aTiling is false.  Both ways give the same fills.
+     */
+    void SetTiling( bool aTiling ) { m_tiling = aTiling; }
+
 private:
 
+    /**
+     * @return true if aZone has to be refilled in incremental mode.
+     */
+    bool isZoneDirty( const ZONE_CONTAINER* aZone ) const;
+
+    void addCachedKnockout( BOARD_ITEM* aItem, int aGap, SHAPE_POLY_SET& aHoles,
+                            const std::function<void( SHAPE_POLY_SET& )>& aBuilder );
+
+    void buildPadKnockout( D_PAD* aPad, int aGap, SHAPE_POLY_SET& aHoles );
+
     void addKnockout( D_PAD* aPad, int aGap, SHAPE_POLY_SET& aHoles );
 
     void addKnockout( BOARD_ITEM* aItem, int aGap, bool aIgnoreLineWidth, SHAPE_POLY_SET& aHoles );
 
-    void knockoutThermalReliefs( const ZONE_CONTAINER* aZone, SHAPE_POLY_SET& aFill );
+    void knockoutThermalReliefs( const ZONE_CONTAINER* aZone, const EDA_RECT& aArea,
+                                 SHAPE_POLY_SET& aFill );
 
-    void buildCopperItemClearances( const ZONE_CONTAINER* aZone, SHAPE_POLY_SET& aHoles );
+    void buildCopperItemClearances( const ZONE_CONTAINER* aZone, const EDA_RECT& aArea,
+                                    SHAPE_POLY_SET& aHoles );
 
     /**
      * Function computeRawFilledArea
@@ -65,17 +108,27 @@ private:
      * BuildFilledSolidAreasPolygons() call this function just after creating the
      *  filled copper area polygon (without clearance areas
      * @param aPcb: the current board
+     * @param aTile: if not null, only the part of the zone inside this tile is computed,
+     * and it is not fractured
      */
     void computeRawFilledArea( const ZONE_CONTAINER* aZone,
                                const SHAPE_POLY_SET& aSmoothedOutline,
                                std::set<VECTOR2I>* aPreserveCorners,
-                               SHAPE_POLY_SET& aRawPolys, SHAPE_POLY_SET& aFinalPolys );
+                               SHAPE_POLY_SET& aRawPolys, SHAPE_POLY_SET& aFinalPolys,
+                               const ZONE_TILE* aTile = nullptr );
 
     /**
      * Function buildThermalSpokes
-     * Constructs a list of all thermal spokes for the given zone.
+     * Constructs a list of all thermal spokes for the given zone, within aArea.
+     */
+    void buildThermalSpokes( const ZONE_CONTAINER* aZone, const EDA_RECT& aArea,
+                             std::deque<SHAPE_LINE_CHAIN>& aSpokes );
+
+    /**
+     * Splits a large copper zone into tiles which can be filled in parallel.
+     * @param aTiles is left empty if the zone is to be filled as a whole.
      */
-    void buildThermalSpokes( const ZONE_CONTAINER* aZone, std::deque<SHAPE_LINE_CHAIN>& aSpokes );
+    void buildTiles( const ZONE_CONTAINER* aZone, std::vector<ZONE_TILE>& aTiles );
 
     /**
      * Build the filled solid areas polygons from zone outlines (stored in m_Poly)
@@ -109,6 +162,10 @@ private:
                                         // false if not (not closed outlines for instance)
     COMMIT* m_commit;
     WX_PROGRESS_REPORTER* m_progressReporter;
+    bool m_incremental;                     // true to refill only zones near m_dirtyAreas
+    bool m_cacheTriangulation;              // true to triangulate the filled areas in Fill()
+    bool m_tiling;                          // true to fill large copper zones as tiles
+    std::vector<EDA_RECT> m_dirtyAreas;
     std::unique_ptr<WX_PROGRESS_REPORTER> m_uniqueReporter;
 
     // m_high_def can be used to define a high definition arc to polygon approximation
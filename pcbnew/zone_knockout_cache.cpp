@@ -0,0 +1,163 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <cstring>
+
+#include <boost/functional/hash.hpp>
+
+#include <class_pad.h>
+#include <class_track.h>
+#include <geometry/shape_poly_set.h>
+#include <zone_knockout_cache.h>
+
+
+///> Stores the bits of a double in a key, so that the key compares it exactly
+static int64_t doubleBits( double aValue )
+{
+    int64_t bits;
+    memcpy( &bits, &aValue, sizeof( bits ) );
+    return bits;
+}
+
+
+KNOCKOUT_CACHE::KEY KNOCKOUT_CACHE::MakeKey( const BOARD_ITEM* aItem, int aGap, int aHighDef,
+                                             int aLowDef )
+{
+    KEY key = { aItem->Type(), aGap, aHighDef, aLowDef };
+
+    switch( aItem->Type() )
+    {
+    case PCB_PAD_T:
+    {
+        const D_PAD* pad = static_cast<const D_PAD*>( aItem );
+
+        key.insert( key.end(), { static_cast<int>( pad->GetShape() ),
+                                 static_cast<int>( pad->GetDrillShape() ),
+                                 pad->GetPosition().x, pad->GetPosition().y,
+                                 doubleBits( pad->GetOrientation() ),
+                                 pad->GetSize().x, pad->GetSize().y,
+                                 pad->GetOffset().x, pad->GetOffset().y,
+                                 pad->GetDelta().x, pad->GetDelta().y,
+                                 pad->GetDrillSize().x, pad->GetDrillSize().y,
+                                 doubleBits( pad->GetRoundRectRadiusRatio() ),
+                                 doubleBits( pad->GetChamferRectRatio() ),
+                                 pad->GetChamferPositions() } );
+
+        if( pad->GetShape() == PAD_SHAPE_CUSTOM )
+        {
+            key.push_back( static_cast<int>( pad->GetAnchorPadShape() ) );
+            key.push_back( static_cast<int>( pad->GetCustomShapeInZoneOpt() ) );
+
+            const SHAPE_POLY_SET& shape = pad->GetCustomShapeAsPolygon();
+
+            // The contour sizes, so that the same points split otherwise make another key
+            for( int ii = 0; ii < shape.OutlineCount(); ii++ )
+            {
+                for( const SHAPE_LINE_CHAIN& contour : shape.CPolygon( ii ) )
+                    key.push_back( contour.PointCount() );
+
+                key.push_back( -1 );
+            }
+
+            for( auto it = shape.CIterateWithHoles(); it; it++ )
+            {
+                key.push_back( it->x );
+                key.push_back( it->y );
+            }
+        }
+
+        break;
+    }
+
+    case PCB_TRACE_T:
+    case PCB_ARC_T:
+    case PCB_VIA_T:
+    {
+        const TRACK* track = static_cast<const TRACK*>( aItem );
+
+        key.insert( key.end(), { track->GetWidth(),
+                                 track->GetStart().x, track->GetStart().y,
+                                 track->GetEnd().x, track->GetEnd().y } );
+
+        if( track->Type() == PCB_ARC_T )
+        {
+            const ARC* arc = static_cast<const ARC*>( track );
+
+            key.push_back( arc->GetMid().x );
+            key.push_back( arc->GetMid().y );
+        }
+
+        break;
+    }
+
+    default:
+        wxFAIL_MSG( "KNOCKOUT_CACHE::MakeKey: unexpected item type" );
+    }
+
+    return key;
+}
+
+
+size_t KNOCKOUT_CACHE::KEY_HASH::operator()( const KEY& aKey ) const
+{
+    return boost::hash_range( aKey.begin(), aKey.end() );
+}
+
+
+KNOCKOUT_CACHE::KNOCKOUT KNOCKOUT_CACHE::Get( const KEY& aKey )
+{
+    std::lock_guard<std::mutex> lock( m_lock );
+    auto it = m_knockouts.find( aKey );
+
+    if( it == m_knockouts.end() )
+        return nullptr;
+
+    it->second.m_used = true;
+    return it->second.m_knockout;
+}
+
+
+void KNOCKOUT_CACHE::Put( const KEY& aKey, const KNOCKOUT& aKnockout )
+{
+    std::lock_guard<std::mutex> lock( m_lock );
+    m_knockouts[ aKey ] = { aKnockout, true };
+}
+
+
+void KNOCKOUT_CACHE::Prune()
+{
+    std::lock_guard<std::mutex> lock( m_lock );
+
+    for( auto it = m_knockouts.begin(); it != m_knockouts.end(); )
+    {
+        if( it->second.m_used )
+        {
+            it->second.m_used = false;
+            ++it;
+        }
+        else
+        {
+            it = m_knockouts.erase( it );
+        }
+    }
+}
@@ -0,0 +1,91 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef ZONE_KNOCKOUT_CACHE_H
+#define ZONE_KNOCKOUT_CACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class BOARD_ITEM;
+class SHAPE_POLY_SET;
+
+
+/**
+ * KNOCKOUT_CACHE
+ * holds the knockouts of the pads, tracks and vias of a board across zone fills, so each
+ * knockout is built once per fill whatever the number of zones and layers it affects, and is
+ * reused by later fills as long as its item is left unchanged.
+ *
+ * The knockouts are found by the geometry they are built from, compared field by field: two
+ * items only share a knockout when their shapes are the same.
+ */
+class KNOCKOUT_CACHE
+{
+public:
+    typedef std::shared_ptr<const SHAPE_POLY_SET> KNOCKOUT;
+
+    /// The fields of an item which define its shape, then the knockout gap and the arc
+    /// approximation errors
+    typedef std::vector<int64_t> KEY;
+
+    /**
+     * Function MakeKey
+     * @return the key of the knockout of @a aItem, a pad, track, arc or via.
+     */
+    static KEY MakeKey( const BOARD_ITEM* aItem, int aGap, int aHighDef, int aLowDef );
+
+    /**
+     * Function Get
+     * @return the knockout stored for @a aKey, or nullptr if there is none.
+     */
+    KNOCKOUT Get( const KEY& aKey );
+
+    void Put( const KEY& aKey, const KNOCKOUT& aKnockout );
+
+    /**
+     * Function Prune
+     * drops the knockouts which have not been used since the previous call.
+     */
+    void Prune();
+
+private:
+    struct ENTRY
+    {
+        KNOCKOUT m_knockout;
+        bool     m_used;
+    };
+
+    struct KEY_HASH
+    {
+        size_t operator()( const KEY& aKey ) const;
+    };
+
+    std::mutex                                 m_lock;
+    std::unordered_map<KEY, ENTRY, KEY_HASH>   m_knockouts;
+};
+
+#endif  // ZONE_KNOCKOUT_CACHE_H
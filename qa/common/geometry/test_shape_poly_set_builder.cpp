@@ -0,0 +1,167 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_shape_poly_set_builder.cpp
+ * Checks that SHAPE_POLY_SET::BOOLEAN_BUILDER gives the same polygons as the sequential
+ * operations of SHAPE_POLY_SET.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <geometry/shape_line_chain.h>
+#include <geometry/shape_poly_set.h>
+
+
+static SHAPE_LINE_CHAIN rectangle( int aX0, int aY0, int aX1, int aY1 )
+{
+    SHAPE_LINE_CHAIN chain;
+
+    chain.Append( aX0, aY0 );
+    chain.Append( aX1, aY0 );
+    chain.Append( aX1, aY1 );
+    chain.Append( aX0, aY1 );
+    chain.SetClosed( true );
+
+    return chain;
+}
+
+
+struct SPS_BUILDER_FIXTURE
+{
+    SPS_BUILDER_FIXTURE()
+    {
+        outline.AddOutline( rectangle( 0, 0, 1000000, 600000 ) );
+        outline.AddOutline( rectangle( 800000, 400000, 1400000, 900000 ) );
+
+        for( int ii = 0; ii < 5; ii++ )
+        {
+            int x = 100000 + 200000 * ii;
+            holes.AddOutline( rectangle( x, 100000, x + 50000, 800000 ) );
+        }
+
+        clip.AddOutline( rectangle( -100000, 50000, 1300000, 850000 ) );
+    }
+
+    ///> Checks that aResult and aExpected cover the same points
+    void checkSame( const SHAPE_POLY_SET& aResult, const SHAPE_POLY_SET& aExpected )
+    {
+        BOOST_CHECK_EQUAL( aResult.OutlineCount(), aExpected.OutlineCount() );
+        BOOST_CHECK_EQUAL( aResult.TotalVertices(), aExpected.TotalVertices() );
+
+        for( int x = -200000; x <= 1600000; x += 12347 )
+        {
+            for( int y = -200000; y <= 1100000; y += 12347 )
+            {
+                VECTOR2I p( x, y );
+
+                BOOST_CHECK_MESSAGE( aResult.Contains( p ) == aExpected.Contains( p ),
+                                     "Point " << x << ", " << y );
+            }
+        }
+    }
+
+    SHAPE_POLY_SET outline;
+    SHAPE_POLY_SET holes;
+    SHAPE_POLY_SET clip;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( SPSBuilder, SPS_BUILDER_FIXTURE )
+
+
+/**
+ * Merged differences and unions, and offsets between them
+ */
+BOOST_AUTO_TEST_CASE( Chain )
+{
+    SHAPE_POLY_SET expected = outline;
+
+    expected.Simplify( SHAPE_POLY_SET::PM_FAST );
+    expected.BooleanSubtract( holes, SHAPE_POLY_SET::PM_FAST );
+    expected.BooleanSubtract( holes.UnitSet( 0 ), SHAPE_POLY_SET::PM_FAST );
+    expected.BooleanAdd( holes.Subset( 2, 4 ), SHAPE_POLY_SET::PM_FAST );
+    expected.Deflate( 20000, 16 );
+    expected.Inflate( 20000, 16 );
+    expected.BooleanIntersection( clip, SHAPE_POLY_SET::PM_FAST );
+
+    SHAPE_POLY_SET                  result;
+    SHAPE_POLY_SET::BOOLEAN_BUILDER builder( outline );
+
+    builder.Simplify( SHAPE_POLY_SET::PM_FAST );
+    builder.Subtract( holes, SHAPE_POLY_SET::PM_FAST );
+    builder.Subtract( holes.UnitSet( 0 ), SHAPE_POLY_SET::PM_FAST );
+    builder.Add( holes.Subset( 2, 4 ), SHAPE_POLY_SET::PM_FAST );
+    builder.Deflate( 20000, 16 );
+    builder.Inflate( 20000, 16 );
+    builder.Intersect( clip, SHAPE_POLY_SET::PM_FAST );
+    builder.Result( result );
+
+    checkSame( result, expected );
+}
+
+
+/**
+ * Consecutive intersections are not merged, and the builder can go on after Result()
+ */
+BOOST_AUTO_TEST_CASE( IntersectionsAndResults )
+{
+    SHAPE_POLY_SET expected = outline;
+
+    expected.BooleanIntersection( clip, SHAPE_POLY_SET::PM_FAST );
+    expected.BooleanIntersection( holes, SHAPE_POLY_SET::PM_FAST );
+
+    SHAPE_POLY_SET                  result;
+    SHAPE_POLY_SET::BOOLEAN_BUILDER builder( outline );
+
+    builder.Intersect( clip, SHAPE_POLY_SET::PM_FAST );
+    builder.Intersect( holes, SHAPE_POLY_SET::PM_FAST );
+    builder.Result( result );
+
+    checkSame( result, expected );
+
+    expected.Inflate( 10000, 16 );
+    builder.Inflate( 10000, 16 );
+    builder.Result( result );
+
+    checkSame( result, expected );
+}
+
+
+/**
+ * Without operations, the result is the simplified input
+ */
+BOOST_AUTO_TEST_CASE( NoOperation )
+{
+    SHAPE_POLY_SET expected = outline;
+
+    expected.Simplify( SHAPE_POLY_SET::PM_FAST );
+
+    SHAPE_POLY_SET result;
+
+    SHAPE_POLY_SET::BOOLEAN_BUILDER( outline ).Result( result );
+
+    checkSame( result, expected );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
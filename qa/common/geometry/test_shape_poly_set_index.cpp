@@ -0,0 +1,307 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_shape_poly_set_index.cpp
+ * Checks the queries of SHAPE_POLY_SET using its edge index against plain scans of the
+ * contours.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <cmath>
+
+#include <geometry/shape_line_chain.h>
+#include <geometry/shape_poly_set.h>
+#include <math/util.h>
+
+
+/**
+ * Returns a closed star shaped contour with aCount vertices, between the radii aInner and
+ * aOuter around aCenter.
+ */
+static SHAPE_LINE_CHAIN starContour( const VECTOR2I& aCenter, int aInner, int aOuter,
+                                     int aCount )
+{
+    SHAPE_LINE_CHAIN chain;
+
+    for( int ii = 0; ii < aCount; ii++ )
+    {
+        double angle = 2.0 * M_PI * ii / aCount;
+        int    radius = ( ii % 2 ) ? aInner : aOuter;
+
+        chain.Append( aCenter.x + KiROUND( radius * cos( angle ) ),
+                      aCenter.y + KiROUND( radius * sin( angle ) ) );
+    }
+
+    chain.SetClosed( true );
+    return chain;
+}
+
+
+struct SPS_INDEX_FIXTURE
+{
+    SPS_INDEX_FIXTURE()
+    {
+        // Two stars, the first one with star shaped holes, with enough vertices to be indexed
+        polySet.AddOutline( starContour( { 0, 0 }, 800000, 1000000, 2000 ) );
+        polySet.AddHole( starContour( { 300000, 0 }, 100000, 150000, 400 ) );
+        polySet.AddHole( starContour( { -300000, 0 }, 100000, 150000, 400 ) );
+        polySet.AddOutline( starContour( { 2500000, 0 }, 500000, 700000, 1000 ) );
+
+        // Points all over the set, and points on its vertices and edges
+        for( int x = -1200000; x <= 3300000; x += 40009 )
+        {
+            for( int y = -1200000; y <= 1200000; y += 40009 )
+                points.emplace_back( x, y );
+        }
+
+        for( auto it = polySet.CIterateSegments( 0, -1, true ); it; it++ )
+        {
+            SEG seg = *it;
+
+            points.push_back( seg.A );
+            points.push_back( ( seg.A + seg.B ) / 2 );
+        }
+    }
+
+    ///> Contains(), the way SHAPE_POLY_SET does it without index
+    bool scanContains( const VECTOR2I& aP, int aAccuracy ) const
+    {
+        for( int ii = 0; ii < polySet.OutlineCount(); ii++ )
+        {
+            if( !polySet.COutline( ii ).PointInside( aP, aAccuracy ) )
+                continue;
+
+            bool inHole = false;
+
+            for( int jj = 0; jj < polySet.HoleCount( ii ); jj++ )
+                inHole |= polySet.CHole( ii, jj ).PointInside( aP, 1 );
+
+            if( !inHole )
+                return true;
+        }
+
+        return false;
+    }
+
+    ///> The squared distance from aP to the nearest edge of the set
+    SEG::ecoord scanSquaredDistance( const VECTOR2I& aP ) const
+    {
+        SEG::ecoord distance = VECTOR2I::ECOORD_MAX;
+
+        for( auto it = polySet.CIterateSegments( 0, -1, true ); it; it++ )
+            distance = std::min( distance, ( *it ).SquaredDistance( aP ) );
+
+        return distance;
+    }
+
+    SHAPE_POLY_SET        polySet;
+    std::vector<VECTOR2I> points;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( SPSIndex, SPS_INDEX_FIXTURE )
+
+
+/**
+ * Contains() gives the same results as the plain scans of the contours, with all accuracies
+ */
+BOOST_AUTO_TEST_CASE( Contains )
+{
+    for( int accuracy : { 0, 1, 2, 1000 } )
+    {
+        for( const VECTOR2I& p : points )
+        {
+            BOOST_CHECK_MESSAGE( polySet.Contains( p, -1, accuracy ) == scanContains( p, accuracy ),
+                                 "Point " << p.x << ", " << p.y << " accuracy " << accuracy );
+        }
+    }
+}
+
+
+/**
+ * PointOnEdge() and Collide() give the same results as the plain scans of the edges
+ */
+BOOST_AUTO_TEST_CASE( PointOnEdgeAndCollide )
+{
+    const int clearance = 20000;
+
+    for( const VECTOR2I& p : points )
+    {
+        SEG::ecoord distance = scanSquaredDistance( p );
+
+        bool onEdge = false;
+
+        for( int ii = 0; ii < polySet.OutlineCount(); ii++ )
+        {
+            for( const SHAPE_LINE_CHAIN& contour : polySet.CPolygon( ii ) )
+                onEdge |= contour.PointOnEdge( p );
+        }
+
+        BOOST_CHECK_EQUAL( polySet.PointOnEdge( p ), onEdge );
+
+        BOOST_CHECK_EQUAL( polySet.Collide( p, clearance ),
+                           scanContains( p, 0 ) || distance < (SEG::ecoord) clearance * clearance );
+
+        SEG seg( p, p + VECTOR2I( 12345, 6789 ) );
+
+        BOOST_CHECK_EQUAL( polySet.Collide( seg, 0 ),
+                           scanContains( p, 0 ) || [&]()
+                           {
+                               for( auto it = polySet.CIterateSegments( 0, -1, true ); it; it++ )
+                               {
+                                   if( ( *it ).Intersect( seg, true ) )
+                                       return true;
+                               }
+
+                               return false;
+                           }() );
+    }
+}
+
+
+/**
+ * Collide() gives the same results for sets just too small to be indexed and for sets just
+ * large enough, with the clearance applied to the exact distance to the edges
+ */
+BOOST_AUTO_TEST_CASE( CollideIndexThreshold )
+{
+    // A star and a far polygon of 3 or 4 vertices: 999 and 1000 vertices in all
+    SHAPE_POLY_SET below;
+    SHAPE_POLY_SET above;
+
+    for( SHAPE_POLY_SET* set : { &below, &above } )
+    {
+        set->AddOutline( starContour( { 0, 0 }, 300000, 500000, 996 ) );
+        set->AddOutline( starContour( { 10000000, 0 }, 1000, 1000, set == &below ? 3 : 4 ) );
+    }
+
+    BOOST_REQUIRE_EQUAL( below.TotalVertices(), 999 );
+    BOOST_REQUIRE_EQUAL( above.TotalVertices(), 1000 );
+
+    for( int clearance : { 0, 1000, 100000 } )
+    {
+        for( int x = -700000; x <= 700000; x += 20011 )
+        {
+            for( int y = -700000; y <= 700000; y += 20011 )
+            {
+                VECTOR2I    p( x, y );
+                SEG         seg( p, p + VECTOR2I( 54321, -12345 ) );
+                SEG::ecoord clearanceSq = (SEG::ecoord) clearance * clearance;
+                bool        pointHit = below.Contains( p );
+                bool        segHit = pointHit;
+
+                for( auto it = below.CIterateSegments( 0, -1, true ); it; it++ )
+                {
+                    pointHit |= clearance > 0 && ( *it ).SquaredDistance( p ) < clearanceSq;
+
+                    if( clearance > 0 )
+                        segHit |= ( *it ).SquaredDistance( seg ) < clearanceSq;
+                    else
+                        segHit |= (bool) ( *it ).Intersect( seg, true );
+                }
+
+                BOOST_TEST_CONTEXT( "Point " << x << ", " << y << " clearance " << clearance )
+                {
+                    BOOST_CHECK_EQUAL( below.Collide( p, clearance ), pointHit );
+                    BOOST_CHECK_EQUAL( above.Collide( p, clearance ), pointHit );
+                    BOOST_CHECK_EQUAL( below.Collide( seg, clearance ), segHit );
+                    BOOST_CHECK_EQUAL( above.Collide( seg, clearance ), segHit );
+                }
+            }
+        }
+    }
+}
+
+
+/**
+ * The index follows the changes of the set
+ */
+BOOST_AUTO_TEST_CASE( Invalidation )
+{
+    VECTOR2I center( 300000, 0 );   // in the first hole
+
+    BOOST_CHECK( !polySet.Contains( center ) );
+    BOOST_CHECK( polySet.Contains( center + VECTOR2I( 0, 400000 ) ) );
+
+    polySet.Move( VECTOR2I( 0, 400000 ) );
+
+    BOOST_CHECK( polySet.Contains( center ) );
+    BOOST_CHECK( !polySet.Contains( center + VECTOR2I( 0, 400000 ) ) );
+
+    SHAPE_POLY_SET copy( polySet );
+
+    copy.DeletePolygon( 0 );
+
+    BOOST_CHECK( !copy.Contains( center ) );
+    BOOST_CHECK( polySet.Contains( center ) );
+
+    // The first vertex of the second star, moved away from its center past the point
+    SHAPE_POLY_SET::VERTEX_INDEX vertex;
+    VECTOR2I                     point( 3300000, 400000 );
+
+    vertex.m_polygon = 1;
+    vertex.m_contour = 0;
+    vertex.m_vertex = 0;
+
+    BOOST_CHECK( !polySet.Contains( point ) );
+
+    polySet.SetVertex( vertex, VECTOR2I( 3400000, 400000 ) );
+
+    BOOST_CHECK( polySet.Contains( point ) );
+}
+
+
+/**
+ * A copy of an indexed set sees the changes made through its non const accessors, and they
+ * do not change the original set
+ */
+BOOST_AUTO_TEST_CASE( InvalidationThroughAccessors )
+{
+    VECTOR2I spike( 3300000, 0 );   // past the first vertex of the second star
+    VECTOR2I center( 300000, 0 );   // in the first hole
+
+    BOOST_REQUIRE( !polySet.Collide( spike, 0 ) );
+    BOOST_REQUIRE( !polySet.Collide( center, 0 ) );
+
+    SHAPE_POLY_SET copy( polySet );
+
+    copy.Outline( 1 ).SetPoint( 0, VECTOR2I( 3400000, 0 ) );
+
+    BOOST_CHECK( copy.Collide( spike, 0 ) );
+    BOOST_CHECK( copy.Contains( spike ) );
+
+    copy.Hole( 0, 0 ).Move( VECTOR2I( 0, 400000 ) );
+
+    BOOST_CHECK( copy.Collide( center, 0 ) );
+
+    copy.Polygon( 1 )[0].Move( VECTOR2I( 0, 2000000 ) );
+
+    BOOST_CHECK( !copy.Collide( spike, 0 ) );
+
+    BOOST_CHECK( !polySet.Collide( spike, 0 ) );
+    BOOST_CHECK( !polySet.Collide( center, 0 ) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
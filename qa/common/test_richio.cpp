@@ -0,0 +1,204 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_richio.cpp
+ * Checks that OUTPUTFORMATTER::Print() writes the formats of strings and integers, which it
+ * writes without vsnprintf(), as vsnprintf() does, and the lines read by the span and mapped
+ * file line readers.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <climits>
+
+#include <wx/ffile.h>
+#include <wx/filename.h>
+
+#include <richio.h>
+
+
+struct RICHIO_FIXTURE
+{
+    using LINES = std::vector<std::pair<unsigned, std::string>>;
+
+    ~RICHIO_FIXTURE()
+    {
+        if( !fileName.IsEmpty() )
+            wxRemoveFile( fileName );
+    }
+
+    ///> Writes @a aContent to a new temporary file
+    void writeFile( const std::string& aContent )
+    {
+        fileName = wxFileName::CreateTempFileName( "richio" );
+        BOOST_REQUIRE( !fileName.IsEmpty() );
+
+        wxFFile file( fileName, "wb" );
+        BOOST_REQUIRE( file.IsOpened() );
+        BOOST_REQUIRE( file.Write( aContent.data(), aContent.size() ) == aContent.size() );
+    }
+
+    ///> Reads all the lines of @a aReader, with their line number
+    static LINES readLines( LINE_READER& aReader )
+    {
+        LINES lines;
+
+        while( aReader.ReadLine() )
+        {
+            lines.emplace_back( aReader.LineNumber(),
+                                std::string( aReader.Line(), aReader.Length() ) );
+        }
+
+        return lines;
+    }
+
+    wxString fileName;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( Richio, RICHIO_FIXTURE )
+
+
+/**
+ * Strings, integers, characters and percent signs, with the indentation
+ */
+BOOST_AUTO_TEST_CASE( SimpleFormat )
+{
+    STRING_FORMATTER formatter;
+
+    formatter.Print( 0, "(%s %d %d %u %c %%)", "name", -42, INT_MIN, UINT_MAX, 'x' );
+    formatter.Print( 2, "(at %d %d)\n", 0, 1234567 );
+    formatter.Print( 1, "" );
+
+    BOOST_CHECK_EQUAL( formatter.GetString(),
+                       "(name -42 -2147483648 4294967295 x %)    (at 0 1234567)\n  " );
+}
+
+
+/**
+ * A null string is written as "(null)", as the vsnprintf() of glibc does
+ */
+BOOST_AUTO_TEST_CASE( NullString )
+{
+    STRING_FORMATTER formatter;
+    const char*      text = nullptr;
+
+    formatter.Print( 0, "(%s %d)", text, 3 );
+
+    BOOST_CHECK_EQUAL( formatter.GetString(), "((null) 3)" );
+}
+
+
+/**
+ * The last line of a file with no trailing newline is read up to the end of the file
+ */
+BOOST_AUTO_TEST_CASE( MappedNoTrailingNewline )
+{
+    writeFile( "(kicad_pcb\n  (version 4)\n)" );
+
+    MAPPED_FILE_LINE_READER reader( fileName );
+    const LINES expected = { { 1, "(kicad_pcb\n" }, { 2, "  (version 4)\n" }, { 3, ")" } };
+
+    BOOST_CHECK( readLines( reader ) == expected );
+    BOOST_CHECK( reader.ReadLine() == nullptr );
+}
+
+
+/**
+ * CRLF line endings are kept in the lines, as by FILE_LINE_READER
+ */
+BOOST_AUTO_TEST_CASE( MappedCrlf )
+{
+    writeFile( "(a)\r\n\r\n(b)\r\n" );
+
+    MAPPED_FILE_LINE_READER reader( fileName );
+    const LINES expected = { { 1, "(a)\r\n" }, { 2, "\r\n" }, { 3, "(b)\r\n" } };
+
+    BOOST_CHECK( readLines( reader ) == expected );
+}
+
+
+/**
+ * An empty file, which cannot be mapped, has no lines
+ */
+BOOST_AUTO_TEST_CASE( MappedEmptyFile )
+{
+    writeFile( "" );
+
+    MAPPED_FILE_LINE_READER reader( fileName );
+
+    BOOST_CHECK_EQUAL( reader.Size(), 0u );
+    BOOST_CHECK( reader.ReadLine() == nullptr );
+    BOOST_CHECK_EQUAL( reader.Length(), 0u );
+}
+
+
+/**
+ * A line longer than the maximum is an error, as for the other line readers
+ */
+BOOST_AUTO_TEST_CASE( MappedLineTooLong )
+{
+    writeFile( "(a)\n" + std::string( LINE_READER_LINE_DEFAULT_MAX, 'x' ) + "\n(b)\n" );
+
+    MAPPED_FILE_LINE_READER reader( fileName );
+
+    BOOST_CHECK( reader.ReadLine() != nullptr );
+    BOOST_CHECK_THROW( reader.ReadLine(), IO_ERROR );
+}
+
+
+/**
+ * Skipped parts read as their line breaks: lines next to a skipped part end at it when it
+ * holds line breaks, and are joined around it otherwise
+ */
+BOOST_AUTO_TEST_CASE( SpanSkippedParts )
+{
+    const std::string text = "(a (b\n c)\n  (d) (e\n))\n(f)";
+
+    SPAN_LINE_READER reader( text.data(), text.size(), "span" );
+
+    reader.Skip( text.find( "(b" ), text.find( "\n  (d)" ) );
+    reader.Skip( text.find( " (d)" ), text.find( " (e" ) );
+
+    const LINES expected = { { 1, "(a " }, { 2, "\n" }, { 3, "  (e\n" }, { 4, "))\n" },
+                             { 5, "(f)" } };
+
+    BOOST_CHECK( readLines( reader ) == expected );
+}
+
+
+/**
+ * A span starting inside a line is indented to its column
+ */
+BOOST_AUTO_TEST_CASE( SpanFirstColumn )
+{
+    const std::string text = "(b\n c)";
+
+    SPAN_LINE_READER reader( text.data(), text.size(), "span", 9, 3 );
+    const LINES      expected = { { 10, "   (b\n" }, { 11, " c)" } };
+
+    BOOST_CHECK( readLines( reader ) == expected );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,116 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_thread_pool.cpp
+ * Test suite for THREAD_POOL and TASK_GROUP.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <chrono>
+#include <stdexcept>
+
+#include <thread_pool.h>
+
+
+BOOST_AUTO_TEST_SUITE( ThreadPool )
+
+
+/**
+ * Every job of a ParallelFor is run once
+ */
+BOOST_AUTO_TEST_CASE( ParallelForRunsAllJobs )
+{
+    const size_t                  count = 10000;
+    std::vector<std::atomic<int>> runs( count );
+
+    for( std::atomic<int>& run : runs )
+        run = 0;
+
+    BOOST_CHECK( THREAD_POOL::ParallelFor( count, [&]( size_t i ) { runs[i]++; } ) );
+
+    for( size_t ii = 0; ii < count; ++ii )
+        BOOST_CHECK_EQUAL( runs[ii], 1 );
+}
+
+
+/**
+ * Nested parallel loops complete, even with more tasks than workers
+ */
+BOOST_AUTO_TEST_CASE( Nested )
+{
+    std::atomic<int> sum( 0 );
+
+    THREAD_POOL::ParallelFor( 100,
+            [&]( size_t )
+            {
+                THREAD_POOL::ParallelFor( 100, [&]( size_t ) { sum++; } );
+            } );
+
+    BOOST_CHECK_EQUAL( sum, 10000 );
+}
+
+
+/**
+ * Wait() rethrows the exceptions of the tasks, once they are all done
+ */
+BOOST_AUTO_TEST_CASE( Exception )
+{
+    std::atomic<int> done( 0 );
+    TASK_GROUP       group;
+
+    group.Run( []() { throw std::runtime_error( "task failure" ); } );
+
+    for( int ii = 0; ii < 10; ++ii )
+        group.Run( [&]() { done++; } );
+
+    BOOST_CHECK_THROW( group.Wait(), std::runtime_error );
+    BOOST_CHECK_EQUAL( done, 10 );
+}
+
+
+/**
+ * A progress hook returning false cancels the jobs which did not start
+ */
+BOOST_AUTO_TEST_CASE( ProgressCancels )
+{
+    std::atomic<size_t> started( 0 );
+    const size_t        count = 100 * THREAD_POOL::Get().GetThreadCount();
+
+    bool completed = THREAD_POOL::ParallelFor( count,
+            [&]( size_t )
+            {
+                started++;
+                std::this_thread::sleep_for( std::chrono::milliseconds( 5 ) );
+            },
+            []()
+            {
+                return false;
+            } );
+
+    BOOST_CHECK( !completed );
+    BOOST_CHECK_LT( started, count );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -23,6 +23,7 @@
 
 #include <wx/wx.h>
 #include <richio.h>
+#include <dsnlexer.h>
 
 #include <chrono>
 #include <ios>
@@ -303,6 +304,29 @@ static void bench_wxbis_reuse( const wxFileName& aFile, int aReps, BENCH_REPORT&
     }
 }
 
+/**
+ * Benchmark tokenising with a DSNLEXER reading from a given LINE_READER
+ * implementation.  The LINE_READER is recreated for each cycle.
+ *
+ * Lines read are counted as usual, the accumulator sums the first char of each token.
+ */
+template<typename LR>
+static void bench_dsnlexer( const wxFileName& aFile, int aReps, BENCH_REPORT& report )
+{
+    for( int i = 0; i < aReps; ++i)
+    {
+        LR       fstr( aFile.GetFullPath() );
+        DSNLEXER lexer( nullptr, 0, &fstr );
+
+        while( lexer.NextTok() != DSN_EOF )
+            report.charAcc += (unsigned char) lexer.CurText()[0];
+
+        // the lexer reads one line past the end of the file
+        report.linesRead += lexer.CurLineNumber() - 1;
+    }
+}
+
+
 /**
  * List of available benchmarks
  */
@@ -312,6 +336,8 @@ static std::vector<BENCHMARK> benchmarkList =
     { 'F', bench_fstream_reuse, "std::fstream, reused" },
     { 'r', bench_line_reader<FILE_LINE_READER>, "RichIO FILE_L_R" },
     { 'R', bench_line_reader_reuse<FILE_LINE_READER>, "RichIO FILE_L_R, reused" },
+    { 'm', bench_line_reader<MAPPED_FILE_LINE_READER>, "RichIO MAPPED_FILE_L_R" },
+    { 'M', bench_line_reader_reuse<MAPPED_FILE_LINE_READER>, "RichIO MAPPED_FILE_L_R, reused" },
     { 'n', bench_line_reader<IFSTREAM_LINE_READER>, "std::ifstream L_R" },
     { 'N', bench_line_reader_reuse<IFSTREAM_LINE_READER>, "std::ifstream L_R, reused" },
     { 's', bench_string_lr, "RichIO STRING_L_R"},
@@ -324,6 +350,8 @@ static std::vector<BENCHMARK> benchmarkList =
     { 'B', bench_wxbis_reuse<wxFileInputStream>, "wxFileIStream, buf'd, reused" },
     { 'c', bench_wxbis<wxFFileInputStream>, "wxFFileIStream. buf'd" },
     { 'C', bench_wxbis_reuse<wxFFileInputStream>, "wxFFileIStream, buf'd, reused" },
+    { 'd', bench_dsnlexer<FILE_LINE_READER>, "DSNLEXER, FILE_L_R" },
+    { 'D', bench_dsnlexer<MAPPED_FILE_LINE_READER>, "DSNLEXER, MAPPED_FILE_L_R" },
 };
 
 
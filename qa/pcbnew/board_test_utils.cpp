@@ -23,6 +23,11 @@
 
 #include "board_test_utils.h"
 
+#include <class_board.h>
+#include <class_drawsegment.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_track.h>
 #include <pcbnew_utils/board_file_utils.h>
 
 // For the temp directory logic: can be std::filesystem in C++17
@@ -50,4 +55,71 @@ void BOARD_DUMPER::DumpBoardToFile( BOARD& aBoard, const std::string& aName ) co
     ::KI_TEST::DumpBoardToFile( aBoard, path.string() );
 }
 
+
+wxPoint MmPoint( double aX, double aY )
+{
+    return wxPoint( Millimeter2iu( aX ), Millimeter2iu( aY ) );
+}
+
+
+std::vector<DRAWSEGMENT*> AddBoardOutline( BOARD& aBoard, const wxSize& aSize )
+{
+    const wxPoint corners[] = { { 0, 0 }, { aSize.x, 0 }, { aSize.x, aSize.y },
+                                { 0, aSize.y } };
+
+    std::vector<DRAWSEGMENT*> edges;
+
+    for( int ii = 0; ii < 4; ii++ )
+    {
+        DRAWSEGMENT* edge = new DRAWSEGMENT( &aBoard );
+
+        edge->SetLayer( Edge_Cuts );
+        edge->SetWidth( Millimeter2iu( 0.1 ) );
+        edge->SetStart( corners[ii] );
+        edge->SetEnd( corners[( ii + 1 ) % 4] );
+        aBoard.Add( edge );
+        edges.push_back( edge );
+    }
+
+    return edges;
+}
+
+
+D_PAD* AddSmdPad( MODULE& aModule, NETINFO_ITEM* aNet, const wxPoint& aPos )
+{
+    D_PAD* pad = new D_PAD( &aModule );
+
+    pad->SetShape( PAD_SHAPE_RECT );
+    pad->SetAttribute( PAD_ATTRIB_SMD );
+    pad->SetLayerSet( D_PAD::SMDMask() );
+    pad->SetSize( wxSize( Millimeter2iu( 2 ), Millimeter2iu( 2 ) ) );
+    pad->SetDrillSize( wxSize( 0, 0 ) );
+    pad->SetPosition( aPos );
+    pad->SetPos0( aPos );
+
+    if( aNet )
+        pad->SetNet( aNet );
+
+    aModule.Add( pad );
+    return pad;
+}
+
+
+TRACK* AddTrack( BOARD& aBoard, const wxPoint& aStart, const wxPoint& aEnd, int aWidth,
+                 NETINFO_ITEM* aNet )
+{
+    TRACK* track = new TRACK( &aBoard );
+
+    track->SetLayer( F_Cu );
+    track->SetWidth( aWidth );
+    track->SetStart( aStart );
+    track->SetEnd( aEnd );
+
+    if( aNet )
+        track->SetNet( aNet );
+
+    aBoard.Add( track );
+    return track;
+}
+
 } // namespace KI_TEST
\ No newline at end of file
@@ -30,9 +30,17 @@
 #define QA_PCBNEW_BOARD_TEST_UTILS__H
 
 #include <string>
+#include <vector>
+
+#include <wx/gdicmn.h>
 
 class BOARD;
 class BOARD_ITEM;
+class D_PAD;
+class DRAWSEGMENT;
+class MODULE;
+class NETINFO_ITEM;
+class TRACK;
 
 
 namespace KI_TEST
@@ -58,6 +66,32 @@ public:
     const bool m_dump_boards;
 };
 
+
+/**
+ * @return the point at aX, aY given in millimetres
+ */
+wxPoint MmPoint( double aX, double aY );
+
+/**
+ * Adds a rectangular board outline on Edge_Cuts, from the origin to aSize, drawn with
+ * 0.1 mm lines.
+ * @return the top, right, bottom and left edges
+ */
+std::vector<DRAWSEGMENT*> AddBoardOutline( BOARD& aBoard, const wxSize& aSize );
+
+/**
+ * Adds a 2 x 2 mm rectangular SMD pad on the front layers to aModule.
+ * @param aNet is the net of the pad, or nullptr for no net
+ */
+D_PAD* AddSmdPad( MODULE& aModule, NETINFO_ITEM* aNet, const wxPoint& aPos );
+
+/**
+ * Adds a track on F_Cu to aBoard.
+ * @param aNet is the net of the track, or nullptr for no net
+ */
+TRACK* AddTrack( BOARD& aBoard, const wxPoint& aStart, const wxPoint& aEnd, int aWidth,
+                 NETINFO_ITEM* aNet = nullptr );
+
 } // namespace KI_TEST
 
 #endif // QA_PCBNEW_BOARD_TEST_UTILS__H
\ No newline at end of file
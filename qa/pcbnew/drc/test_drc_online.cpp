@@ -0,0 +1,168 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_drc_online.cpp
+ * Checks the track tests of the online DRC, which are run after each commit, and their
+ * interaction with a full DRC run.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <algorithm>
+
+#include <class_board.h>
+#include <class_drawsegment.h>
+#include <class_track.h>
+#include <drc/drc.h>
+#include <drc/drc_item.h>
+
+#include "../board_test_utils.h"
+#include "drc_test_utils.h"
+
+
+struct DRC_ONLINE_FIXTURE
+{
+    DRC_ONLINE_FIXTURE()
+    {
+        // A 20 x 20 mm board outline, with a track in its middle
+        const int size = Millimeter2iu( 20 );
+
+        edges = KI_TEST::AddBoardOutline( board, wxSize( size, size ) );
+        track = KI_TEST::AddTrack( board, KI_TEST::MmPoint( 5, 10 ), KI_TEST::MmPoint( 15, 10 ),
+                                   Millimeter2iu( 0.25 ) );
+    }
+
+    ~DRC_ONLINE_FIXTURE()
+    {
+        for( MARKER_PCB* marker : newMarkers )
+            delete marker;
+    }
+
+    ///> Runs the online DRC after a commit which changed the board outline
+    void runOnlineDrc()
+    {
+        for( MARKER_PCB* marker : newMarkers )
+            delete marker;
+
+        staleMarkers.clear();
+        newMarkers.clear();
+
+        // Edge.Cuts changes have no area, and retest every track
+        drc.TestTracksOnline( &board, nullptr, {}, staleMarkers, newMarkers );
+    }
+
+    ///> Moves the right edge of the outline, and the ends of the two edges joining it
+    void moveRightEdge( const wxPoint& aOffset )
+    {
+        edges[1]->Move( aOffset );
+        edges[0]->SetEnd( edges[0]->GetEnd() + aOffset );
+        edges[2]->SetStart( edges[2]->GetStart() + aOffset );
+    }
+
+    int edgeMarkerCount() const
+    {
+        return std::count_if( newMarkers.begin(), newMarkers.end(),
+                              []( MARKER_PCB* aMarker )
+                              {
+                                  return KI_TEST::IsDrcMarkerOfType( *aMarker,
+                                                                     DRCE_TRACK_NEAR_EDGE );
+                              } );
+    }
+
+    BOARD                     board;
+    DRC                       drc;
+    std::vector<DRAWSEGMENT*> edges;
+    TRACK*                    track;
+
+    std::vector<MARKER_PCB*>  staleMarkers;
+    std::vector<MARKER_PCB*>  newMarkers;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( DrcOnline, DRC_ONLINE_FIXTURE )
+
+
+/**
+ * Moving the board edge next to a track adds a marker, moving it back removes the marker
+ */
+BOOST_AUTO_TEST_CASE( TrackNearMovedEdge )
+{
+    runOnlineDrc();
+
+    BOOST_CHECK_EQUAL( edgeMarkerCount(), 0 );
+    BOOST_CHECK( staleMarkers.empty() );
+
+    // The right edge of the outline, and the two edges joining it, now end 0.1 mm away from
+    // the end of the track
+    const wxPoint offset( -Millimeter2iu( 4.9 ), 0 );
+
+    moveRightEdge( offset );
+
+    runOnlineDrc();
+
+    BOOST_REQUIRE_EQUAL( newMarkers.size(), 1 );
+    BOOST_CHECK_EQUAL( edgeMarkerCount(), 1 );
+    BOOST_CHECK( newMarkers[0]->GetRCItem()->GetMainItemID() == track->m_Uuid );
+
+    // Commit the marker, as RunOnlineDrc() does, then move the edge back
+    board.Add( newMarkers[0] );
+    newMarkers.clear();
+
+    moveRightEdge( -offset );
+
+    runOnlineDrc();
+
+    BOOST_CHECK_EQUAL( edgeMarkerCount(), 0 );
+    BOOST_REQUIRE_EQUAL( staleMarkers.size(), 1 );
+    BOOST_CHECK_PREDICATE( KI_TEST::IsDrcMarkerOfType,
+                           ( *staleMarkers[0] )( DRCE_TRACK_NEAR_EDGE ) );
+}
+
+
+/**
+ * A full DRC reports a track violation once, even when the online DRC reported it before
+ */
+BOOST_AUTO_TEST_CASE( FullDrcReportsTrackOnce )
+{
+    moveRightEdge( wxPoint( -Millimeter2iu( 4.9 ), 0 ) );
+
+    runOnlineDrc();
+
+    BOOST_REQUIRE_EQUAL( newMarkers.size(), 1 );
+
+    board.Add( newMarkers[0] );
+    newMarkers.clear();
+
+    // The DRC dialog deletes all the markers before a full run
+    board.DeleteMARKERs();
+
+    drc.RunTestsOnBoard( &board );
+
+    BOOST_REQUIRE_EQUAL( board.Markers().size(), 1 );
+    BOOST_CHECK_PREDICATE( KI_TEST::IsDrcMarkerOfType,
+                           ( *board.Markers()[0] )( DRCE_TRACK_NEAR_EDGE ) );
+    BOOST_CHECK( board.Markers()[0]->GetRCItem()->GetMainItemID() == track->m_Uuid );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,81 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include "pns_test_utils.h"
+
+
+using namespace PNS;
+
+
+PNS_RANDOM_ITEMS_FIXTURE::PNS_RANDOM_ITEMS_FIXTURE( unsigned aSeed, int aObstacleCount ) :
+        rng( aSeed ),
+        coord( 0, 20000000 ),
+        length( -3000000, 3000000 )
+{
+    root.SetMaxClearance( 1000000 );
+
+    for( int ii = 0; ii < aObstacleCount; ii++ )
+        root.Add( randomSegment( 2 + ii ) );
+}
+
+
+PNS_RANDOM_ITEMS_FIXTURE::~PNS_RANDOM_ITEMS_FIXTURE()
+{
+    root.KillChildren();
+}
+
+
+std::unique_ptr<SEGMENT> PNS_RANDOM_ITEMS_FIXTURE::randomSegment( int aNet )
+{
+    VECTOR2I a( coord( rng ), coord( rng ) );
+    VECTOR2I b = a + VECTOR2I( length( rng ), length( rng ) );
+
+    std::unique_ptr<SEGMENT> segment = std::make_unique<SEGMENT>( SEG( a, b ), aNet );
+
+    segment->SetWidth( 200000 );
+    segment->SetLayers( LAYER_RANGE( 0 ) );
+    return segment;
+}
+
+
+LINE PNS_RANDOM_ITEMS_FIXTURE::makeLine( const std::vector<VECTOR2I>& aMoves )
+{
+    LINE             line;
+    SHAPE_LINE_CHAIN chain;
+    VECTOR2I         p( coord( rng ), coord( rng ) );
+
+    line.SetNet( 1 );
+    line.SetWidth( 200000 );
+    line.SetLayer( 0 );
+
+    chain.Append( p );
+
+    for( const VECTOR2I& move : aMoves )
+    {
+        p += move;
+        chain.Append( p );
+    }
+
+    line.SetShape( chain );
+    return line;
+}
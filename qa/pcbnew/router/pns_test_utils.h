@@ -0,0 +1,63 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file pns_test_utils.h
+ * General utilities for the router tests
+ */
+
+#ifndef QA_PCBNEW_PNS_TEST_UTILS__H
+#define QA_PCBNEW_PNS_TEST_UTILS__H
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <router/pns_line.h>
+#include <router/pns_node.h>
+#include <router/pns_segment.h>
+
+
+/**
+ * A root node of random obstacle segments on the nets 2 and more, and random lines to route
+ * among them on net 1.  All the items are 0.2 mm wide, on layer 0, in a square of 20 mm.
+ */
+struct PNS_RANDOM_ITEMS_FIXTURE
+{
+    PNS_RANDOM_ITEMS_FIXTURE( unsigned aSeed, int aObstacleCount );
+
+    ~PNS_RANDOM_ITEMS_FIXTURE();
+
+    ///> A segment on net @a aNet, of up to 3 mm in x and y from a random point
+    std::unique_ptr<PNS::SEGMENT> randomSegment( int aNet );
+
+    ///> A line on net 1 from a random point, with the vertices at each of @a aMoves
+    PNS::LINE makeLine( const std::vector<VECTOR2I>& aMoves );
+
+    PNS::NODE                          root;
+    std::mt19937                       rng;
+    std::uniform_int_distribution<int> coord;
+    std::uniform_int_distribution<int> length;
+};
+
+#endif // QA_PCBNEW_PNS_TEST_UTILS__H
@@ -0,0 +1,327 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_pns_node.cpp
+ * Checks the items seen by the branches of a PNS::NODE, which share their items, joints and
+ * overrides with their parent until either of them changes them, and their revisions.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <router/pns_node.h>
+#include <router/pns_segment.h>
+
+
+using namespace PNS;
+
+
+struct PNS_NODE_FIXTURE
+{
+    PNS_NODE_FIXTURE()
+    {
+        root.SetMaxClearance( 1000 );
+        rootSegment = add( &root, SEG( VECTOR2I( 0, 0 ), VECTOR2I( 1000, 0 ) ), 1 );
+    }
+
+    ~PNS_NODE_FIXTURE()
+    {
+        root.KillChildren();
+    }
+
+    static SEGMENT* add( NODE* aNode, const SEG& aSeg, int aNet )
+    {
+        std::unique_ptr<SEGMENT> segment = std::make_unique<SEGMENT>( aSeg, aNet );
+        SEGMENT*                 added = segment.get();
+
+        segment->SetWidth( 100 );
+        segment->SetLayers( LAYER_RANGE( 0 ) );
+        aNode->Add( std::move( segment ) );
+
+        return added;
+    }
+
+    ///> Number of items of @a aNode colliding with a segment of another net along @a aSeg
+    static int collisionCount( NODE* aNode, const SEG& aSeg )
+    {
+        SEGMENT         probe( aSeg, 99 );
+        NODE::OBSTACLES obstacles;
+
+        probe.SetWidth( 100 );
+        probe.SetLayers( LAYER_RANGE( 0 ) );
+
+        return aNode->QueryColliding( &probe, obstacles, ITEM::ANY_T, -1, false );
+    }
+
+    ///> Number of items of @a aNode linked at @a aPos, on net @a aNet
+    static int linkCount( NODE* aNode, const VECTOR2I& aPos, int aNet )
+    {
+        JOINT* joint = aNode->FindJoint( aPos, 0, aNet );
+
+        return joint ? joint->LinkCount() : 0;
+    }
+
+    NODE     root;
+    SEGMENT* rootSegment;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( PnsNode, PNS_NODE_FIXTURE )
+
+
+/**
+ * Every node starts with a revision of its own
+ */
+BOOST_AUTO_TEST_CASE( NewRevisions )
+{
+    NODE* branch1 = root.Branch();
+    NODE* branch2 = root.Branch();
+    NODE* branch3 = branch1->Branch();
+
+    BOOST_CHECK_NE( branch1->Revision(), root.Revision() );
+    BOOST_CHECK_NE( branch2->Revision(), root.Revision() );
+    BOOST_CHECK_NE( branch2->Revision(), branch1->Revision() );
+    BOOST_CHECK_NE( branch3->Revision(), branch1->Revision() );
+}
+
+
+/**
+ * Adding or removing items in a branch changes its revision, not the revisions of its
+ * parent or sibling
+ */
+BOOST_AUTO_TEST_CASE( BranchRevision )
+{
+    NODE* branch = root.Branch();
+    NODE* sibling = root.Branch();
+    NODE* child = branch->Branch();
+
+    uint64_t rootRevision = root.Revision();
+    uint64_t branchRevision = branch->Revision();
+    uint64_t siblingRevision = sibling->Revision();
+    uint64_t childRevision = child->Revision();
+
+    SEGMENT* segment = add( child, SEG( VECTOR2I( 0, 5000 ), VECTOR2I( 1000, 5000 ) ), 2 );
+
+    BOOST_CHECK_NE( child->Revision(), childRevision );
+    BOOST_CHECK_EQUAL( branch->Revision(), branchRevision );
+    BOOST_CHECK_EQUAL( sibling->Revision(), siblingRevision );
+    BOOST_CHECK_EQUAL( root.Revision(), rootRevision );
+
+    childRevision = child->Revision();
+    child->Remove( segment );
+
+    BOOST_CHECK_NE( child->Revision(), childRevision );
+
+    // Removing an item of the root only overrides it in the branch
+    childRevision = child->Revision();
+    child->Remove( rootSegment );
+
+    BOOST_CHECK_NE( child->Revision(), childRevision );
+    BOOST_CHECK_EQUAL( branch->Revision(), branchRevision );
+    BOOST_CHECK_EQUAL( root.Revision(), rootRevision );
+}
+
+
+/**
+ * Adding or removing items in the root changes the revisions of the root and of all the
+ * branches, which see the items of the root
+ */
+BOOST_AUTO_TEST_CASE( RootRevision )
+{
+    NODE* branch = root.Branch();
+    NODE* child = branch->Branch();
+
+    uint64_t rootRevision = root.Revision();
+    uint64_t branchRevision = branch->Revision();
+    uint64_t childRevision = child->Revision();
+
+    SEGMENT* segment = add( &root, SEG( VECTOR2I( 0, 5000 ), VECTOR2I( 1000, 5000 ) ), 2 );
+
+    BOOST_CHECK_NE( root.Revision(), rootRevision );
+    BOOST_CHECK_NE( branch->Revision(), branchRevision );
+    BOOST_CHECK_NE( child->Revision(), childRevision );
+
+    rootRevision = root.Revision();
+    branchRevision = branch->Revision();
+    childRevision = child->Revision();
+
+    root.Remove( segment );
+
+    BOOST_CHECK_NE( root.Revision(), rootRevision );
+    BOOST_CHECK_NE( branch->Revision(), branchRevision );
+    BOOST_CHECK_NE( child->Revision(), childRevision );
+}
+
+
+/**
+ * The changes made in a branch of a branch are not seen by its parent or by its sibling, which
+ * share the same items until then, and the changes of the parent are not seen by the branch
+ */
+BOOST_AUTO_TEST_CASE( BranchOfBranchEdits )
+{
+    const SEG parentSeg( VECTOR2I( 0, 1000000 ), VECTOR2I( 1000, 1000000 ) );
+    const SEG childSeg( VECTOR2I( 0, 2000000 ), VECTOR2I( 1000, 2000000 ) );
+    const SEG laterSeg( VECTOR2I( 0, 3000000 ), VECTOR2I( 1000, 3000000 ) );
+    const SEG rootSeg = rootSegment->Seg();
+
+    NODE*    parent = root.Branch();
+    SEGMENT* parentSegment = add( parent, parentSeg, 2 );
+    NODE*    child = parent->Branch();
+    NODE*    sibling = parent->Branch();
+
+    BOOST_CHECK_EQUAL( collisionCount( child, parentSeg ), 1 );
+    BOOST_CHECK_EQUAL( linkCount( child, parentSeg.A, 2 ), 1 );
+
+    // Remove the items of the parent and of the root, add one of its own
+    child->Remove( parentSegment );
+    child->Remove( rootSegment );
+    add( child, childSeg, 3 );
+
+    BOOST_CHECK_EQUAL( collisionCount( child, parentSeg ), 0 );
+    BOOST_CHECK_EQUAL( collisionCount( child, rootSeg ), 0 );
+    BOOST_CHECK_EQUAL( collisionCount( child, childSeg ), 1 );
+    BOOST_CHECK_EQUAL( linkCount( child, parentSeg.A, 2 ), 0 );
+    BOOST_CHECK_EQUAL( linkCount( child, childSeg.A, 3 ), 1 );
+
+    for( NODE* node : { parent, sibling } )
+    {
+        BOOST_CHECK_EQUAL( collisionCount( node, parentSeg ), 1 );
+        BOOST_CHECK_EQUAL( collisionCount( node, rootSeg ), 1 );
+        BOOST_CHECK_EQUAL( collisionCount( node, childSeg ), 0 );
+        BOOST_CHECK_EQUAL( linkCount( node, parentSeg.A, 2 ), 1 );
+        BOOST_CHECK_EQUAL( linkCount( node, childSeg.A, 3 ), 0 );
+    }
+
+    BOOST_CHECK_EQUAL( collisionCount( &root, rootSeg ), 1 );
+    BOOST_CHECK_EQUAL( collisionCount( &root, parentSeg ), 0 );
+
+    // The items added to the parent after branching are its own
+    add( parent, laterSeg, 4 );
+
+    BOOST_CHECK_EQUAL( collisionCount( parent, laterSeg ), 1 );
+    BOOST_CHECK_EQUAL( collisionCount( child, laterSeg ), 0 );
+    BOOST_CHECK_EQUAL( collisionCount( sibling, laterSeg ), 0 );
+    BOOST_CHECK_EQUAL( linkCount( sibling, laterSeg.A, 4 ), 0 );
+
+    NODE::ITEM_VECTOR removed, added;
+
+    sibling->GetUpdatedItems( removed, added );
+    BOOST_CHECK( removed.empty() );
+    BOOST_CHECK_EQUAL( added.size(), 1 );
+}
+
+
+/**
+ * Destroying branches which share the items of their parent leaves the items of the parent,
+ * and destroying a parent destroys its children first
+ */
+BOOST_AUTO_TEST_CASE( DestroySharedBranches )
+{
+    const SEG parentSeg( VECTOR2I( 0, 1000000 ), VECTOR2I( 1000, 1000000 ) );
+    const SEG childSeg( VECTOR2I( 0, 2000000 ), VECTOR2I( 1000, 2000000 ) );
+
+    NODE* parent = root.Branch();
+
+    add( parent, parentSeg, 2 );
+
+    NODE* editedChild = parent->Branch();
+    NODE* sharingChild = parent->Branch();
+    NODE* grandChild = sharingChild->Branch();
+
+    add( editedChild, childSeg, 3 );
+
+    // A child which copied the items of its parent, then one which still shares them
+    delete editedChild;
+
+    BOOST_CHECK_EQUAL( collisionCount( parent, parentSeg ), 1 );
+    BOOST_CHECK_EQUAL( collisionCount( grandChild, parentSeg ), 1 );
+    BOOST_CHECK_EQUAL( parent->BranchCount(), 2 );
+
+    delete grandChild;
+
+    BOOST_CHECK_EQUAL( collisionCount( parent, parentSeg ), 1 );
+    BOOST_CHECK_EQUAL( collisionCount( sharingChild, parentSeg ), 1 );
+    BOOST_CHECK_EQUAL( linkCount( sharingChild, parentSeg.A, 2 ), 1 );
+
+    // The parent with its child, which still shares its items
+    root.KillChildren();
+
+    BOOST_CHECK_EQUAL( root.BranchCount(), 0 );
+    BOOST_CHECK_EQUAL( collisionCount( &root, rootSegment->Seg() ), 1 );
+    BOOST_CHECK_EQUAL( collisionCount( &root, parentSeg ), 0 );
+
+    // New branches see the root only
+    NODE* branch = root.Branch();
+
+    BOOST_CHECK_EQUAL( collisionCount( branch, rootSegment->Seg() ), 1 );
+    BOOST_CHECK_EQUAL( collisionCount( branch, parentSeg ), 0 );
+}
+
+
+/**
+ * Committing a branch of a branch gives the root the items the branch sees, including those
+ * of the intermediate branch, which the root then owns
+ */
+BOOST_AUTO_TEST_CASE( CommitSecondLevel )
+{
+    const SEG rootSeg = rootSegment->Seg();
+    const SEG keptSeg( VECTOR2I( 0, 1000000 ), VECTOR2I( 1000, 1000000 ) );
+    const SEG removedSeg( VECTOR2I( 0, 2000000 ), VECTOR2I( 1000, 2000000 ) );
+    const SEG childSeg( VECTOR2I( 0, 3000000 ), VECTOR2I( 1000, 3000000 ) );
+
+    NODE*    parent = root.Branch();
+    SEGMENT* kept = add( parent, keptSeg, 2 );
+    SEGMENT* removedSegment = add( parent, removedSeg, 3 );
+    NODE*    child = parent->Branch();
+
+    root.Branch();
+    child->Remove( removedSegment );
+    child->Remove( rootSegment );
+    add( child, childSeg, 4 );
+
+    root.Commit( child );
+
+    BOOST_CHECK_EQUAL( root.BranchCount(), 0 );
+
+    BOOST_CHECK_EQUAL( collisionCount( &root, rootSeg ), 0 );
+    BOOST_CHECK_EQUAL( collisionCount( &root, keptSeg ), 1 );
+    BOOST_CHECK_EQUAL( collisionCount( &root, removedSeg ), 0 );
+    BOOST_CHECK_EQUAL( collisionCount( &root, childSeg ), 1 );
+
+    BOOST_CHECK_EQUAL( linkCount( &root, rootSeg.A, 1 ), 0 );
+    BOOST_CHECK_EQUAL( linkCount( &root, keptSeg.A, 2 ), 1 );
+    BOOST_CHECK_EQUAL( linkCount( &root, removedSeg.A, 3 ), 0 );
+    BOOST_CHECK_EQUAL( linkCount( &root, childSeg.A, 4 ), 1 );
+
+    // The item of the destroyed parent is the root's now
+    BOOST_CHECK( kept->BelongsTo( &root ) );
+
+    NODE* branch = root.Branch();
+
+    branch->Remove( kept );
+
+    BOOST_CHECK_EQUAL( collisionCount( branch, keptSeg ), 0 );
+    BOOST_CHECK_EQUAL( collisionCount( &root, keptSeg ), 1 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
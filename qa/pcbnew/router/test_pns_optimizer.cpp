@@ -0,0 +1,132 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_pns_optimizer.cpp
+ * Checks that the cache of the collision checks of PNS::OPTIMIZER does not change the
+ * optimized lines.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <router/pns_optimizer.h>
+
+#include "pns_test_utils.h"
+
+
+using namespace PNS;
+
+
+struct PNS_OPTIMIZER_FIXTURE : PNS_RANDOM_ITEMS_FIXTURE
+{
+    PNS_OPTIMIZER_FIXTURE() :
+            PNS_RANDOM_ITEMS_FIXTURE( 4321, 300 )
+    {
+    }
+
+    ///> A line of 12 segments, straight or diagonal
+    LINE randomLine()
+    {
+        std::uniform_int_distribution<int> step( 200000, 1500000 );
+        std::vector<VECTOR2I>              moves;
+
+        for( int ii = 0; ii < 12; ii++ )
+        {
+            const int d = step( rng );
+            const VECTOR2I directions[] = { { d, 0 }, { 0, d }, { d, d }, { d, -d } };
+
+            moves.push_back( directions[rng() % 4] );
+        }
+
+        return makeLine( moves );
+    }
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( PnsOptimizer, PNS_OPTIMIZER_FIXTURE )
+
+
+/**
+ * Lines optimized in a root and in a branch changed between the optimizations are the same
+ * with and without the collision cache, with optimizers kept across the changes
+ */
+BOOST_AUTO_TEST_CASE( CollisionCache )
+{
+    NODE*     branch = root.Branch();
+    OPTIMIZER cached( &root );
+    OPTIMIZER plain( &root );
+
+    for( OPTIMIZER* opt : { &cached, &plain } )
+    {
+        opt->SetEffortLevel( OPTIMIZER::MERGE_SEGMENTS | OPTIMIZER::MERGE_OBTUSE );
+        opt->SetCollisionMask( -1 );
+    }
+
+    plain.SetCollisionCache( false );
+
+    std::vector<SEGMENT*> added;
+
+    for( int ii = 0; ii < 400; ii++ )
+    {
+        NODE* world = ( ii % 2 ) ? branch : &root;
+        LINE  line = randomLine();
+        LINE  cachedLine( line );
+        LINE  plainLine( line );
+
+        cached.SetWorld( world );
+        plain.SetWorld( world );
+
+        BOOST_CHECK_EQUAL( cached.Optimize( &cachedLine ), plain.Optimize( &plainLine ) );
+        BOOST_CHECK( cachedLine.CLine().CPoints() == plainLine.CLine().CPoints() );
+
+        // Change the branch now and then: add an obstacle, or remove one of the root or
+        // one added before
+        if( ii % 20 == 19 )
+        {
+            std::unique_ptr<SEGMENT> segment = randomSegment( 1000 + ii );
+
+            added.push_back( segment.get() );
+            branch->Add( std::move( segment ) );
+        }
+        else if( ii % 20 == 9 && !added.empty() )
+        {
+            branch->Remove( added.back() );
+            added.pop_back();
+        }
+        else if( ii % 20 == 14 )
+        {
+            NODE::OBSTACLES obstacles;
+            LINE            probe = randomLine();
+
+            probe.SetNet( 0 );
+
+            if( branch->QueryColliding( &probe, obstacles, ITEM::SEGMENT_T, 1 ) )
+                branch->Remove( obstacles[0].m_item );
+        }
+    }
+
+    BOOST_CHECK_GT( cached.CollisionCacheStats().m_hits, 0 );
+    BOOST_CHECK_EQUAL( plain.CollisionCacheStats().m_hits, 0 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
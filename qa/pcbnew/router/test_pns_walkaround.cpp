@@ -0,0 +1,146 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_pns_walkaround.cpp
+ * Checks that PNS::WALKAROUND finds the same paths whether it walks the two winding
+ * directions one after the other or at the same time.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <thread_pool.h>
+
+#include <router/pns_walkaround.h>
+
+#include "pns_test_utils.h"
+
+
+using namespace PNS;
+
+
+struct PNS_WALKAROUND_FIXTURE : PNS_RANDOM_ITEMS_FIXTURE
+{
+    PNS_WALKAROUND_FIXTURE() :
+            PNS_RANDOM_ITEMS_FIXTURE( 1234, 400 ),
+            singlePool( 1 ),
+            multiPool( 4 )
+    {
+    }
+
+    ///> A line of two segments, horizontal then vertical
+    LINE randomLine()
+    {
+        int dx = 2 * length( rng );
+        int dy = 2 * length( rng );
+
+        return makeLine( { { dx, 0 }, { 0, dy } } );
+    }
+
+    ///> Sets up a walkaround on @a aPool, with the options of @a aMode
+    void setup( WALKAROUND& aWalkaround, THREAD_POOL& aPool, int aMode, int aLineIndex )
+    {
+        aWalkaround.SetThreadPool( &aPool );
+        aWalkaround.SetIterationLimit( 50 );
+
+        if( aMode == 1 )
+            aWalkaround.SetSingleDirection( true );
+        else if( aMode == 2 )
+            aWalkaround.SetForceWinding( true, aLineIndex % 2 );
+    }
+
+    static void checkSameLine( const LINE& aExpected, const LINE& aActual )
+    {
+        const std::vector<VECTOR2I>& expected = aExpected.CLine().CPoints();
+        const std::vector<VECTOR2I>& actual = aActual.CLine().CPoints();
+
+        BOOST_CHECK_EQUAL_COLLECTIONS( actual.begin(), actual.end(), expected.begin(),
+                                       expected.end() );
+    }
+
+    THREAD_POOL singlePool;
+    THREAD_POOL multiPool;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( PnsWalkaround, PNS_WALKAROUND_FIXTURE )
+
+
+/**
+ * The walked line and its status do not depend on the number of threads
+ */
+BOOST_AUTO_TEST_CASE( RouteLine )
+{
+    for( int mode = 0; mode < 3; mode++ )
+    {
+        for( int ii = 0; ii < 200; ii++ )
+        {
+            BOOST_TEST_CONTEXT( "Mode " << mode << ", line " << ii )
+            {
+                LINE       line = randomLine();
+                LINE       singlePath, multiPath;
+                WALKAROUND single( &root, nullptr );
+                WALKAROUND multi( &root, nullptr );
+
+                setup( single, singlePool, mode, ii );
+                setup( multi, multiPool, mode, ii );
+
+                // There is no router to optimize the walked lines with
+                BOOST_CHECK_EQUAL( single.Route( line, singlePath, false ),
+                                   multi.Route( line, multiPath, false ) );
+                checkSameLine( singlePath, multiPath );
+            }
+        }
+    }
+}
+
+
+/**
+ * The lines walked in both directions and their statuses do not depend on the number of
+ * threads
+ */
+BOOST_AUTO_TEST_CASE( RouteBothDirections )
+{
+    for( int ii = 0; ii < 300; ii++ )
+    {
+        BOOST_TEST_CONTEXT( "Line " << ii )
+        {
+            LINE       line = randomLine();
+            WALKAROUND single( &root, nullptr );
+            WALKAROUND multi( &root, nullptr );
+
+            setup( single, singlePool, 0, ii );
+            setup( multi, multiPool, 0, ii );
+
+            WALKAROUND::RESULT singleResult = single.Route( line );
+            WALKAROUND::RESULT multiResult = multi.Route( line );
+
+            BOOST_CHECK_EQUAL( singleResult.statusCw, multiResult.statusCw );
+            BOOST_CHECK_EQUAL( singleResult.statusCcw, multiResult.statusCcw );
+            checkSameLine( singleResult.lineCw, multiResult.lineCw );
+            checkSameLine( singleResult.lineCcw, multiResult.lineCcw );
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
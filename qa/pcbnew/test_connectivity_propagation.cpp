@@ -0,0 +1,192 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_connectivity_propagation.cpp
+ * Checks that the incremental net propagation gives the tracks the nets of a full propagation.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_track.h>
+#include <connectivity/connectivity_data.h>
+#include <netinfo.h>
+
+#include <map>
+
+#include "board_test_utils.h"
+
+
+struct PROPAGATION_FIXTURE
+{
+    PROPAGATION_FIXTURE()
+    {
+        for( int net = 1; net <= 3; net++ )
+            board.Add( new NETINFO_ITEM( &board, wxString::Format( "Net%d", net ), net ) );
+
+        MODULE* module = new MODULE( &board );
+
+        board.Add( module );
+
+        pad1 = KI_TEST::AddSmdPad( *module, board.FindNet( 1 ), KI_TEST::MmPoint( 0, 0 ) );
+        pad2 = KI_TEST::AddSmdPad( *module, board.FindNet( 2 ), KI_TEST::MmPoint( 50, 0 ) );
+
+        // A chain of tracks from each pad, and a chain connected to nothing, all on no net
+        chain1 = { addTrack( 0, 0, 10, 0 ), addTrack( 10, 0, 20, 0 ) };
+        chain2 = { addTrack( 50, 0, 40, 0 ), addTrack( 40, 0, 30, 0 ) };
+        floating = { addTrack( 20, 10, 20, 20 ), addTrack( 20, 20, 30, 20 ) };
+
+        board.BuildConnectivity();
+        connectivity = board.GetConnectivity();
+
+        checkNets( chain1, 1 );
+        checkNets( chain2, 2 );
+        checkNets( floating, 0 );
+    }
+
+    ///> Adds a track on no net from @a aX1, @a aY1 to @a aX2, @a aY2, in mm
+    TRACK* addTrack( double aX1, double aY1, double aX2, double aY2 )
+    {
+        return KI_TEST::AddTrack( board, KI_TEST::MmPoint( aX1, aY1 ), KI_TEST::MmPoint( aX2, aY2 ),
+                                  Millimeter2iu( 0.25 ) );
+    }
+
+    void removeTrack( TRACK* aTrack )
+    {
+        board.Remove( aTrack );
+        removed.emplace_back( aTrack );
+    }
+
+    static void checkNets( const std::vector<TRACK*>& aTracks, int aNet )
+    {
+        for( TRACK* track : aTracks )
+            BOOST_CHECK_EQUAL( track->GetNetCode(), aNet );
+    }
+
+    ///> Checks that a full propagation from scratch changes none of the nets
+    void checkFullPropagation()
+    {
+        std::map<TRACK*, int> nets;
+
+        for( TRACK* track : board.Tracks() )
+            nets[track] = track->GetNetCode();
+
+        CONNECTIVITY_DATA full;
+
+        full.Build( &board );
+
+        for( TRACK* track : board.Tracks() )
+            BOOST_CHECK_EQUAL( track->GetNetCode(), nets[track] );
+    }
+
+    BOARD                               board;
+    std::shared_ptr<CONNECTIVITY_DATA>  connectivity;
+    D_PAD*                              pad1;
+    D_PAD*                              pad2;
+    std::vector<TRACK*>                 chain1;
+    std::vector<TRACK*>                 chain2;
+    std::vector<TRACK*>                 floating;
+    std::vector<std::unique_ptr<TRACK>> removed;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( ConnectivityPropagation, PROPAGATION_FIXTURE )
+
+
+/**
+ * A track joining a cluster to a pad gives the net of the pad to the whole cluster, not only
+ * to the added track
+ */
+BOOST_AUTO_TEST_CASE( MergeThroughAddedTrack )
+{
+    TRACK* link = addTrack( 20, 0, 20, 10 );
+
+    connectivity->RecalculateRatsnest();
+
+    checkNets( { link }, 1 );
+    checkNets( floating, 1 );
+    checkNets( chain2, 2 );
+    checkFullPropagation();
+}
+
+
+/**
+ * The part of a cluster split by a removed track gets the net of the cluster it joins next
+ */
+BOOST_AUTO_TEST_CASE( SplitThenJoin )
+{
+    removeTrack( chain1[0] );
+    connectivity->RecalculateRatsnest();
+
+    // A split keeps the nets
+    checkNets( { chain1[1] }, 1 );
+
+    TRACK* link = addTrack( 20, 0, 30, 0 );
+
+    connectivity->RecalculateRatsnest();
+
+    checkNets( { chain1[1], link }, 2 );
+    checkFullPropagation();
+}
+
+
+/**
+ * A pad changing net gives its new net to its cluster
+ */
+BOOST_AUTO_TEST_CASE( PadNetChange )
+{
+    pad1->SetNetCode( 3 );
+    connectivity->Update( pad1 );
+    connectivity->RecalculateRatsnest();
+
+    checkNets( chain1, 3 );
+    checkNets( chain2, 2 );
+    checkFullPropagation();
+}
+
+
+/**
+ * The clusters no change can reach are not propagated again
+ */
+BOOST_AUTO_TEST_CASE( UntouchedClustersKept )
+{
+    // Changed behind the back of the connectivity: only a full propagation restores it
+    chain2[1]->SetNetCode( 3 );
+
+    addTrack( 20, 0, 20, 10 );
+    connectivity->RecalculateRatsnest();
+
+    checkNets( floating, 1 );
+    BOOST_CHECK_EQUAL( chain2[1]->GetNetCode(), 3 );
+
+    CONNECTIVITY_DATA full;
+
+    full.Build( &board );
+    checkNets( chain2, 2 );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
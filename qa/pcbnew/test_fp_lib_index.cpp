@@ -0,0 +1,268 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_fp_lib_index.cpp
+ * Checks that the index of a footprint library is saved and read back, that its entries are
+ * invalidated when their footprint file changes, and that a corrupt index is not used.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+// For the temp directory logic: can be std::filesystem in C++17
+#include <boost/filesystem.hpp>
+
+#include <wx/ffile.h>
+#include <wx/filename.h>
+
+#include <common.h>
+#include <fp_lib_index.h>
+#include <kicad_plugin.h>
+#include <md5_hash.h>
+#include <wildcards_and_files_ext.h>
+
+
+struct FP_LIB_INDEX_FIXTURE
+{
+    FP_LIB_INDEX_FIXTURE()
+    {
+        boost::filesystem::path path = boost::filesystem::temp_directory_path()
+                / boost::filesystem::unique_path( "fp_lib_index_%%%%%%%%" );
+
+        libPath = path.string() + ".pretty";
+        BOOST_REQUIRE( wxFileName::Mkdir( libPath ) );
+
+        fpFile = libPath + wxFileName::GetPathSeparator() + "R_0603." + KiCadFootprintFileExtension;
+    }
+
+    ~FP_LIB_INDEX_FIXTURE()
+    {
+        wxRemoveFile( FP_LIB_INDEX( libPath ).GetFileName() );
+        wxFileName::Rmdir( libPath, wxPATH_RMDIR_RECURSIVE );
+    }
+
+    ///> Writes the footprint file with the description @a aDoc
+    void writeFootprint( const std::string& aDoc )
+    {
+        std::string content = "(module R_0603 (layer F.Cu) (tedit 5E4F9D30)\n"
+                              "  (descr \"" + aDoc + "\")\n"
+                              "  (tags \"resistor\")\n"
+                              "  (pad 1 smd rect (at -0.75 0) (size 0.8 0.9) (layers F.Cu))\n"
+                              "  (pad 2 smd rect (at 0.75 0) (size 0.8 0.9) (layers F.Cu))\n"
+                              "  (pad \"\" np_thru_hole circle (at 0 1) (size 1 1) (drill 1)"
+                              " (layers *.Cu))\n"
+                              ")\n";
+        wxFFile file( fpFile, "wb" );
+
+        BOOST_REQUIRE( file.IsOpened() );
+        BOOST_REQUIRE( file.Write( content.data(), content.size() ) == content.size() );
+    }
+
+    ///> Moves the modification time of the footprint file by @a aSeconds
+    void touchFootprint( int aSeconds )
+    {
+        wxFileName fn( fpFile );
+        wxDateTime time = fn.GetModificationTime() + wxTimeSpan::Seconds( aSeconds );
+
+        BOOST_REQUIRE( fn.SetTimes( nullptr, &time, nullptr ) );
+    }
+
+    ///> The index entry of the footprint file as it is now, as FP_CACHE makes it
+    FP_LIB_INDEX::ENTRY currentEntry()
+    {
+        WX_FILENAME         fn( libPath, wxFileName( fpFile ).GetFullName() );
+        wxFFile             file( fpFile, "rb" );
+        std::string         content( file.Length(), '\0' );
+        FP_LIB_INDEX::ENTRY entry;
+
+        BOOST_REQUIRE( file.Read( &content[0], content.size() ) == content.size() );
+
+        entry.m_Timestamp = fn.GetTimestamp();
+        entry.m_Hash = MD5_HASH::FormatData( content.data(), content.size() );
+        return entry;
+    }
+
+    ///> The summary of the footprint given by a new plugin, from the index if it is valid
+    FOOTPRINT_SUMMARY getSummary()
+    {
+        PCB_IO            plugin;
+        FOOTPRINT_SUMMARY summary;
+
+        BOOST_REQUIRE( plugin.GetEnumeratedFootprintSummary( libPath, "R_0603", summary ) );
+        return summary;
+    }
+
+    wxString libPath;
+    wxString fpFile;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( FpLibIndex, FP_LIB_INDEX_FIXTURE )
+
+
+/**
+ * The entries read back are the entries written, including the separators of the fields
+ * and lines in the texts
+ */
+BOOST_AUTO_TEST_CASE( RoundTrip )
+{
+    FP_LIB_INDEX        index( libPath );
+    FP_LIB_INDEX::ENTRY entry;
+
+    entry.m_Timestamp = 1234567890123LL;
+    entry.m_Hash = MD5_HASH::FormatData( "R_0603", 6 );
+    entry.m_Summary.m_Keywords = wxString::FromUTF8( "resistor\tsmd \\ 0603 \xce\xa9" );
+    entry.m_Summary.m_Doc = "Resistor\r\nSMD 0603\\n";
+    entry.m_Summary.m_PadCount = 2;
+    entry.m_Summary.m_UniquePadCount = 1;
+
+    index.Set( "R_0603", entry );
+    index.Set( "Empty", FP_LIB_INDEX::ENTRY() );
+    index.Write();
+
+    FP_LIB_INDEX read( libPath );
+
+    read.Read();
+
+    const FP_LIB_INDEX::ENTRY* found = read.Find( "R_0603", entry.m_Timestamp );
+
+    BOOST_REQUIRE( found );
+    BOOST_CHECK_EQUAL( found->m_Hash, entry.m_Hash );
+    BOOST_CHECK( found->m_Summary.m_Keywords == entry.m_Summary.m_Keywords );
+    BOOST_CHECK( found->m_Summary.m_Doc == entry.m_Summary.m_Doc );
+    BOOST_CHECK_EQUAL( found->m_Summary.m_PadCount, 2u );
+    BOOST_CHECK_EQUAL( found->m_Summary.m_UniquePadCount, 1u );
+
+    BOOST_CHECK( read.Find( "Empty", 0 ) );
+    BOOST_CHECK( !read.Find( "Missing", 0 ) );
+}
+
+
+/**
+ * An entry is still valid after a change of the modification time of its file alone, e.g.
+ * after a checkout, and gets the new time
+ */
+BOOST_AUTO_TEST_CASE( TimestampChange )
+{
+    writeFootprint( "first" );
+
+    FP_LIB_INDEX        index( libPath );
+    FP_LIB_INDEX::ENTRY entry = currentEntry();
+
+    index.Set( "R_0603", entry );
+
+    touchFootprint( 3600 );
+
+    FP_LIB_INDEX::ENTRY touched = currentEntry();
+
+    BOOST_REQUIRE( touched.m_Timestamp != entry.m_Timestamp );
+    BOOST_CHECK( !index.Find( "R_0603", touched.m_Timestamp ) );
+    BOOST_CHECK( index.FindContent( "R_0603", touched.m_Timestamp, touched.m_Hash ) );
+
+    index.Write();
+
+    FP_LIB_INDEX read( libPath );
+
+    read.Read();
+    BOOST_CHECK( read.Find( "R_0603", touched.m_Timestamp ) );
+}
+
+
+/**
+ * An entry is invalid once the content of its file changed, and the footprint library gives
+ * the summary of the new content
+ */
+BOOST_AUTO_TEST_CASE( ContentChange )
+{
+    writeFootprint( "first" );
+
+    FOOTPRINT_SUMMARY summary = getSummary();
+
+    BOOST_CHECK( summary.m_Doc == "first" );
+    BOOST_CHECK_EQUAL( summary.m_PadCount, 2u );
+    BOOST_CHECK_EQUAL( summary.m_UniquePadCount, 2u );
+
+    FP_LIB_INDEX::ENTRY entry = currentEntry();
+
+    writeFootprint( "second" );
+    touchFootprint( 3600 );
+
+    FP_LIB_INDEX::ENTRY changed = currentEntry();
+    FP_LIB_INDEX        index( libPath );
+
+    index.Read();
+    BOOST_CHECK( index.Find( "R_0603", entry.m_Timestamp ) );
+    BOOST_CHECK( !index.Find( "R_0603", changed.m_Timestamp ) );
+    BOOST_CHECK( !index.FindContent( "R_0603", changed.m_Timestamp, changed.m_Hash ) );
+
+    BOOST_CHECK( getSummary().m_Doc == "second" );
+}
+
+
+/**
+ * A corrupt index file is not read: no entry is found when its header is wrong, and the
+ * entries with a wrong number of fields are dropped
+ */
+BOOST_AUTO_TEST_CASE( CorruptIndex )
+{
+    FP_LIB_INDEX index( libPath );
+
+    index.Set( "A", FP_LIB_INDEX::ENTRY() );
+    index.Set( "B", FP_LIB_INDEX::ENTRY() );
+    index.Write();
+
+    wxFFile     file( index.GetFileName(), "rb" );
+    std::string content( file.Length(), '\0' );
+
+    BOOST_REQUIRE( file.Read( &content[0], content.size() ) == content.size() );
+    file.Close();
+
+    auto rewrite = [&]( const std::string& aContent )
+    {
+        wxFFile corrupt( index.GetFileName(), "wb" );
+
+        BOOST_REQUIRE( corrupt.Write( aContent.data(), aContent.size() ) == aContent.size() );
+    };
+
+    // Truncated in the middle of the last entry
+    rewrite( content.substr( 0, content.size() - 4 ) );
+    index.Read();
+    BOOST_CHECK( index.Find( "A", 0 ) );
+    BOOST_CHECK( !index.Find( "B", 0 ) );
+
+    // Garbage in place of the header
+    rewrite( "\x01\x02garbage\n" + content.substr( content.find( '\n' ) + 1 ) );
+    index.Read();
+    BOOST_CHECK( !index.Find( "A", 0 ) );
+
+    // The index of another library
+    std::string other = content;
+
+    other.replace( other.find( "fp_lib_index_" ), 1, "x" );
+    rewrite( other );
+    index.Read();
+    BOOST_CHECK( !index.Find( "A", 0 ) );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,240 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_pcb_parser_numbers.cpp
+ * Checks that the numbers read by PCB_PARSER without strtod() get the values they get with
+ * strtod(), in board units, in angles and in the point lists of the zone fills.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <cstdlib>
+#include <limits>
+
+#include <class_board.h>
+#include <class_drawsegment.h>
+#include <class_zone.h>
+#include <common.h>
+#include <kicad_plugin.h>
+#include <pcb_parser.h>
+#include <richio.h>
+#include <trigo.h>
+
+
+/**
+ * Numbers as KiCad writes them, and numbers in other forms the lexer accepts, which are
+ * read with strtod(): signs, missing integer or fractional parts, more decimals than the
+ * internal units, more than 15 digits, exponents, and half nm which are rounded.
+ */
+static const std::vector<std::string> s_lengths = {
+    "0", "1", "-1", "+1", "0.5", "-0.5", ".5", "-.5", "+.5", "5.", "-5.", "+5.",
+    "0.000001", "-0.000001", "12.345678", "-12.345678", "+12.345678", "000012.500000",
+    "123456.789012", "-99999.999999", "1234.5", "0.1", "0.2", "0.3", "2.54", "-25.4",
+    "1.23456789", "-0.12345678", "12.3456785", "0.0000005", "-0.0000005", "0.0000015",
+    "-0.0000015", "0.0000025", "0.0000035", "1.0000005", "-2.0000015",
+    "0.1234567890123456789", "1234567890.12345678",
+    "5e-7", "-1.5E-6", "1e3", "2.5e+2", "-2.54e1", ".5e1", "1.e2",
+    "999999999999999", "-999999999999999", "3000", "-3000"
+};
+
+static const std::vector<std::string> s_angles = {
+    "0", "90", "-90", "+90", "45.5", "-45.5", ".5", "-.25", "+.75", "5.", "33.333333333",
+    "0.1", "-0.3", "123.456789012345", "0.1234567890123456", "-179.9999999999999999",
+    "1e1", "-2.5E1", "3.6e+2", "1.5e-3"
+};
+
+
+///> The length in board units, as strtod() gives it
+static int strtodBoardUnits( const std::string& aText )
+{
+    LOCALE_IO    toggle;
+    const double limit = std::numeric_limits<int>::max() * 0.7071;
+    double       value = strtod( aText.c_str(), nullptr ) * IU_PER_MM;
+
+    return KiROUND( Clamp<double>( -limit, value, limit ) );
+}
+
+
+///> The angle of an arc in tenths of degrees, as strtod() gives it
+static double strtodArcAngle( const std::string& aText )
+{
+    LOCALE_IO toggle;
+
+    return NormalizeAngle360Max( strtod( aText.c_str(), nullptr ) * 10.0 );
+}
+
+
+///> The coordinate of the i-th point which is not a tested length, unique to the point
+static std::string otherCoord( size_t aIndex )
+{
+    return std::to_string( 1000 + aIndex );
+}
+
+
+struct PCB_PARSER_NUMBERS_FIXTURE
+{
+    ///> Parses the board made of @a aItems
+    std::unique_ptr<BOARD> parse( const std::string& aItems )
+    {
+        std::string text = "(kicad_pcb (version " + std::to_string( SEXPR_BOARD_FILE_VERSION )
+                           + ") (host pcbnew test)\n" + aItems + ")\n";
+
+        STRING_LINE_READER reader( text, "test board" );
+        PCB_PARSER         parser;
+
+        parser.SetLineReader( &reader );
+
+        std::unique_ptr<BOARD> board( dynamic_cast<BOARD*>( parser.Parse() ) );
+
+        BOOST_REQUIRE( board );
+        return board;
+    }
+
+    ///> The graphic items of @a aBoard, in file order
+    static std::vector<DRAWSEGMENT*> drawSegments( BOARD& aBoard )
+    {
+        std::vector<DRAWSEGMENT*> segments;
+
+        for( BOARD_ITEM* item : aBoard.Drawings() )
+            segments.push_back( static_cast<DRAWSEGMENT*>( item ) );
+
+        return segments;
+    }
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( PcbParserNumbers, PCB_PARSER_NUMBERS_FIXTURE )
+
+
+/**
+ * The coordinates read by parseBoardUnits() are the ones strtod() gives
+ */
+BOOST_AUTO_TEST_CASE( BoardUnits )
+{
+    std::string items;
+
+    for( const std::string& length : s_lengths )
+    {
+        items += "(gr_line (start " + length + " " + length + ") (end 0 0) (layer F.SilkS) "
+                 "(width 0.15))\n";
+    }
+
+    std::unique_ptr<BOARD>    board = parse( items );
+    std::vector<DRAWSEGMENT*> segments = drawSegments( *board );
+
+    BOOST_REQUIRE_EQUAL( segments.size(), s_lengths.size() );
+
+    for( size_t ii = 0; ii < s_lengths.size(); ++ii )
+    {
+        BOOST_TEST_CONTEXT( "Length " << s_lengths[ii] )
+        {
+            BOOST_CHECK_EQUAL( segments[ii]->GetStart().x, strtodBoardUnits( s_lengths[ii] ) );
+            BOOST_CHECK_EQUAL( segments[ii]->GetStart().y, strtodBoardUnits( s_lengths[ii] ) );
+        }
+    }
+
+    // A few values worked out by hand
+    BOOST_CHECK_EQUAL( strtodBoardUnits( "-12.345678" ), -12345678 );
+    BOOST_CHECK_EQUAL( strtodBoardUnits( "+.5" ), 500000 );
+    BOOST_CHECK_EQUAL( strtodBoardUnits( "2.5e+2" ), 250000000 );
+}
+
+
+/**
+ * The angles read by parseDouble() are the ones strtod() gives
+ */
+BOOST_AUTO_TEST_CASE( Doubles )
+{
+    std::string items;
+
+    for( const std::string& angle : s_angles )
+    {
+        items += "(gr_arc (start 0 0) (end 1 0) (angle " + angle + ") (layer F.SilkS) "
+                 "(width 0.15))\n";
+    }
+
+    std::unique_ptr<BOARD>    board = parse( items );
+    std::vector<DRAWSEGMENT*> segments = drawSegments( *board );
+
+    BOOST_REQUIRE_EQUAL( segments.size(), s_angles.size() );
+
+    for( size_t ii = 0; ii < s_angles.size(); ++ii )
+    {
+        BOOST_TEST_CONTEXT( "Angle " << s_angles[ii] )
+        {
+            // Exactly the same double
+            BOOST_CHECK_EQUAL( segments[ii]->GetAngle(), strtodArcAngle( s_angles[ii] ) );
+        }
+    }
+}
+
+
+/**
+ * The points of a zone fill read by parseXYList() are the ones the lexer and strtod() give,
+ * with the points on one line, across lines and with unusual spacing
+ */
+BOOST_AUTO_TEST_CASE( XYList )
+{
+    std::vector<VECTOR2I> expected;
+    std::string           points;
+
+    for( size_t ii = 0; ii < s_lengths.size(); ++ii )
+    {
+        const std::string& length = s_lengths[ii];
+        const std::string  other = otherCoord( ii );
+
+        expected.emplace_back( strtodBoardUnits( length ), strtodBoardUnits( other ) );
+        expected.emplace_back( strtodBoardUnits( other ), strtodBoardUnits( length ) );
+
+        std::string first = "(xy " + length + " " + other + ")";
+        std::string second = "(xy " + other + " " + length + ")";
+
+        if( ii % 4 == 0 )
+            points += first + " " + second;
+        else if( ii % 4 == 1 )
+            points += first + "\n" + second;
+        else if( ii % 4 == 2 )
+            points += "(xy\t" + length + "  " + other + " )(xy " + other + "\n" + length + ")";
+        else
+            points += "\n  " + first + " " + second + "\n";
+    }
+
+    std::unique_ptr<BOARD> board = parse( "(zone (net 0) (net_name \"\") (layer F.Cu)\n"
+                                          "  (polygon (pts (xy 0 0) (xy 10 0) (xy 10 10)))\n"
+                                          "  (filled_polygon (pts " + points + "))\n"
+                                          ")\n" );
+
+    BOOST_REQUIRE_EQUAL( board->Zones().size(), 1 );
+
+    const SHAPE_POLY_SET& fill = board->Zones()[0]->GetFilledPolysList();
+
+    BOOST_REQUIRE_EQUAL( fill.OutlineCount(), 1 );
+
+    const std::vector<VECTOR2I>& actual = fill.COutline( 0 ).CPoints();
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( actual.begin(), actual.end(), expected.begin(),
+                                   expected.end() );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,172 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_ratsnest_data.cpp
+ * Checks that the incremental ratsnest updates give the ratsnest of a full recompute.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <connectivity/connectivity_items.h>
+#include <ratsnest_data.h>
+
+#include <random>
+#include <set>
+
+
+struct RATSNEST_FIXTURE
+{
+    ///> A cluster of items connected together, each one with a single anchor
+    struct CLUSTER
+    {
+        std::shared_ptr<CN_CLUSTER>          m_cluster;
+        std::vector<std::unique_ptr<CN_ITEM>> m_items;
+    };
+
+    using RN_LINE = std::pair<std::pair<int, int>, std::pair<int, int>>;
+
+    RATSNEST_FIXTURE() :
+        rng( 1 )
+    {
+    }
+
+    /**
+     * Creates a cluster of 1 to 3 anchors on a grid, so that equal distances and cocircular
+     * anchors are frequent.
+     */
+    std::unique_ptr<CLUSTER> makeCluster( int aGrid )
+    {
+        std::uniform_int_distribution<int> cell( 0, 60 );
+        std::uniform_int_distribution<int> offset( 0, 3 );
+        std::uniform_int_distribution<int> count( 1, 3 );
+
+        auto      cluster = std::make_unique<CLUSTER>();
+        VECTOR2I  origin( cell( rng ) * aGrid, cell( rng ) * aGrid );
+        int       anchors = count( rng );
+
+        cluster->m_cluster = std::make_shared<CN_CLUSTER>();
+
+        for( int i = 0; i < anchors; i++ )
+        {
+            auto item = std::make_unique<CN_ITEM>( nullptr, false, 1 );
+
+            if( i == 0 )
+                item->AddAnchor( origin );
+            else
+                item->AddAnchor( origin + VECTOR2I( offset( rng ), offset( rng ) ) * aGrid );
+
+            cluster->m_cluster->Add( item.get() );
+            cluster->m_items.push_back( std::move( item ) );
+        }
+
+        return cluster;
+    }
+
+    void fillNet( RN_NET& aNet )
+    {
+        aNet.Clear();
+
+        for( const auto& cluster : clusters )
+            aNet.AddCluster( cluster->m_cluster );
+
+        aNet.Update();
+    }
+
+    static std::set<RN_LINE> getLines( const RN_NET& aNet )
+    {
+        std::set<RN_LINE> lines;
+
+        for( const CN_EDGE& edge : aNet.GetEdges() )
+        {
+            const VECTOR2I& src = edge.GetSourceNode()->Pos();
+            const VECTOR2I& dst = edge.GetTargetNode()->Pos();
+
+            lines.insert( std::minmax( std::make_pair( src.x, src.y ),
+                                       std::make_pair( dst.x, dst.y ) ) );
+        }
+
+        return lines;
+    }
+
+    std::mt19937                          rng;
+    std::vector<std::unique_ptr<CLUSTER>> clusters;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( RatsnestData, RATSNEST_FIXTURE )
+
+
+/**
+ * A net updated after each random edit has the same ratsnest lines as the net computed from
+ * scratch, whatever the edits done before
+ */
+BOOST_AUTO_TEST_CASE( IncrementalMatchesFullRecompute )
+{
+    for( int seed = 0; seed < 6; seed++ )
+    {
+        // Grids of a round and of an odd pitch
+        int grid = seed % 2 ? 1000 : 1237;
+
+        rng.seed( seed );
+        clusters.clear();
+
+        for( int i = 0; i < 300; i++ )
+            clusters.push_back( makeCluster( grid ) );
+
+        RN_NET incremental;
+
+        for( int step = 0; step < 40; step++ )
+        {
+            std::uniform_int_distribution<int> edits( 1, 4 );
+
+            for( int i = edits( rng ); i > 0; i-- )
+            {
+                size_t index = rng() % clusters.size();
+
+                switch( rng() % 3 )
+                {
+                case 0:  clusters.push_back( makeCluster( grid ) ); break;
+                case 1:  clusters.erase( clusters.begin() + index ); break;
+                default: clusters[index] = makeCluster( grid ); break;
+                }
+            }
+
+            RN_NET full;
+
+            fillNet( incremental );
+            fillNet( full );
+
+            BOOST_TEST_CONTEXT( "Seed " << seed << ", step " << step )
+            {
+                std::set<RN_LINE> lines = getLines( incremental );
+
+                BOOST_CHECK_EQUAL( lines.size(), incremental.GetEdges().size() );
+                BOOST_CHECK( lines == getLines( full ) );
+            }
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
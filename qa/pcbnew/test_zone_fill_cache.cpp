@@ -0,0 +1,280 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_zone_fill_cache.cpp
+ * Checks that the fills read from the zone fill cache are the fills saved in the board file.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+// For the temp directory logic: can be std::filesystem in C++17
+#include <boost/filesystem.hpp>
+
+#include <wx/ffile.h>
+#include <wx/filename.h>
+
+#include <pcbnew_utils/board_file_utils.h>
+
+#include <class_board.h>
+#include <class_zone.h>
+#include <pcb_parser.h>
+#include <richio.h>
+#include <wildcards_and_files_ext.h>
+#include <zone_fill_cache.h>
+
+
+struct ZONE_FILL_CACHE_FIXTURE
+{
+    ZONE_FILL_CACHE_FIXTURE()
+    {
+        boost::filesystem::path path = boost::filesystem::temp_directory_path()
+                / boost::filesystem::unique_path( "zone_fill_cache_%%%%%%%%" );
+
+        boardFile = path.string() + "." + KiCadPcbFileExtension;
+
+        // A zone with two outlines and its triangulation, and a zone with no triangulation.
+        // Some coordinates are negative and not a round number of mm.
+        addZone( { -Millimeter2iu( 3.2 ) - 1, Millimeter2iu( 1.7 ) + 3 }, true );
+        addZone( { Millimeter2iu( 41.1 ) + 7, -Millimeter2iu( 12.9 ) - 5 }, false );
+
+        KI_TEST::DumpBoardToFile( board, boardFile );
+        BOOST_REQUIRE( ZONE_FILL_CACHE::Save( boardFile, &board ) );
+    }
+
+    ~ZONE_FILL_CACHE_FIXTURE()
+    {
+        ZONE_FILL_CACHE::Remove( boardFile );
+        wxRemoveFile( boardFile );
+    }
+
+    void addZone( const wxPoint& aOrigin, bool aTriangulate )
+    {
+        const int       size = Millimeter2iu( 10 );
+        ZONE_CONTAINER* zone = new ZONE_CONTAINER( &board );
+
+        zone->SetLayer( F_Cu );
+        zone->AppendCorner( aOrigin, -1 );
+        zone->AppendCorner( aOrigin + wxPoint( size, 0 ), -1 );
+        zone->AppendCorner( aOrigin + wxPoint( size, size ), -1 );
+        zone->AppendCorner( aOrigin + wxPoint( 0, size ), -1 );
+
+        SHAPE_POLY_SET fill;
+        VECTOR2I       origin( aOrigin );
+
+        fill.NewOutline();
+        fill.Append( origin + VECTOR2I( 101, 99 ) );
+        fill.Append( origin + VECTOR2I( size / 2 - 13, 102 ) );
+        fill.Append( origin + VECTOR2I( size / 3, size - 101 ) );
+        fill.Append( origin + VECTOR2I( 98, size / 2 + 17 ) );
+
+        fill.NewOutline();
+        fill.Append( origin + VECTOR2I( size / 2 + 11, size / 2 ) );
+        fill.Append( origin + VECTOR2I( size - 100, size / 2 + 3 ) );
+        fill.Append( origin + VECTOR2I( size - 97, size - 100 ) );
+
+        zone->SetFilledPolysList( fill );
+        zone->SetIsFilled( true );
+
+        if( aTriangulate )
+            zone->CacheTriangulation();
+
+        board.Add( zone );
+    }
+
+    ///> Parses the saved board file as PCB_IO::Load() does, with the fills of @a aCache
+    std::unique_ptr<BOARD> parseBoard( const ZONE_FILL_CACHE* aCache )
+    {
+        MAPPED_FILE_LINE_READER fileReader( boardFile );
+        PCB_PARSER              parser;
+
+        parser.SetBoard( nullptr );
+        parser.SetZoneFillCache( aCache );
+
+        parser.SplitBoardItems( fileReader );
+        parser.SetLineReader( &fileReader );
+
+        std::unique_ptr<BOARD> parsed( dynamic_cast<BOARD*>( parser.Parse() ) );
+
+        BOOST_REQUIRE( parsed );
+        return parsed;
+    }
+
+    BOARD    board;
+    wxString boardFile;
+};
+
+
+static const ZONE_CONTAINER* findZone( BOARD& aBoard, const KIID& aUuid )
+{
+    for( const ZONE_CONTAINER* zone : aBoard.Zones() )
+    {
+        if( zone->m_Uuid == aUuid )
+            return zone;
+    }
+
+    return nullptr;
+}
+
+
+static void checkSameFill( const SHAPE_POLY_SET& aExpected, const SHAPE_POLY_SET& aActual )
+{
+    BOOST_REQUIRE_EQUAL( aActual.OutlineCount(), aExpected.OutlineCount() );
+
+    for( int ii = 0; ii < aExpected.OutlineCount(); ++ii )
+    {
+        const std::vector<VECTOR2I>& expected = aExpected.COutline( ii ).CPoints();
+        const std::vector<VECTOR2I>& actual = aActual.COutline( ii ).CPoints();
+
+        BOOST_CHECK_EQUAL( aActual.HoleCount( ii ), aExpected.HoleCount( ii ) );
+        BOOST_CHECK_EQUAL_COLLECTIONS( actual.begin(), actual.end(), expected.begin(),
+                                       expected.end() );
+    }
+}
+
+
+static void checkSameTriangulation( const SHAPE_POLY_SET& aExpected,
+                                    const SHAPE_POLY_SET& aActual )
+{
+    BOOST_REQUIRE_EQUAL( aActual.TriangulatedPolyCount(), aExpected.TriangulatedPolyCount() );
+
+    for( unsigned ii = 0; ii < aExpected.TriangulatedPolyCount(); ++ii )
+    {
+        const SHAPE_POLY_SET::TRIANGULATED_POLYGON* expected = aExpected.TriangulatedPolygon( ii );
+        const SHAPE_POLY_SET::TRIANGULATED_POLYGON* actual = aActual.TriangulatedPolygon( ii );
+
+        BOOST_REQUIRE_EQUAL( actual->GetTriangleCount(), expected->GetTriangleCount() );
+
+        for( size_t jj = 0; jj < expected->GetTriangleCount(); ++jj )
+        {
+            VECTOR2I ea, eb, ec, aa, ab, ac;
+
+            expected->GetTriangle( jj, ea, eb, ec );
+            actual->GetTriangle( jj, aa, ab, ac );
+
+            BOOST_CHECK( aa == ea && ab == eb && ac == ec );
+        }
+    }
+}
+
+
+BOOST_FIXTURE_TEST_SUITE( ZoneFillCache, ZONE_FILL_CACHE_FIXTURE )
+
+
+/**
+ * The fills read from the cache are the fills parsed from the board file, and the saved
+ * triangulations are restored
+ */
+BOOST_AUTO_TEST_CASE( RoundTrip )
+{
+    MAPPED_FILE_LINE_READER fileReader( boardFile );
+    ZONE_FILL_CACHE         cache;
+
+    BOOST_REQUIRE( cache.Load( boardFile, fileReader.Data(), fileReader.Size() ) );
+
+    std::unique_ptr<BOARD> parsed = parseBoard( nullptr );
+    std::unique_ptr<BOARD> cached = parseBoard( &cache );
+
+    for( const ZONE_CONTAINER* zone : board.Zones() )
+    {
+        BOOST_TEST_CONTEXT( "Zone " << zone->m_Uuid.AsString() )
+        {
+            BOOST_REQUIRE( cache.Contains( zone->m_Uuid ) );
+
+            const ZONE_CONTAINER* parsedZone = findZone( *parsed, zone->m_Uuid );
+            const ZONE_CONTAINER* cachedZone = findZone( *cached, zone->m_Uuid );
+
+            BOOST_REQUIRE( parsedZone && cachedZone );
+
+            const SHAPE_POLY_SET& saved = zone->GetFilledPolysList();
+            const SHAPE_POLY_SET& fromFile = parsedZone->GetFilledPolysList();
+            const SHAPE_POLY_SET& fromCache = cachedZone->GetFilledPolysList();
+
+            checkSameFill( saved, fromFile );
+            checkSameFill( fromFile, fromCache );
+            BOOST_CHECK_EQUAL( cachedZone->GetFilledArea(), parsedZone->GetFilledArea() );
+
+            BOOST_CHECK_EQUAL( fromCache.IsTriangulationUpToDate(),
+                               saved.IsTriangulationUpToDate() );
+
+            if( saved.IsTriangulationUpToDate() )
+                checkSameTriangulation( saved, fromCache );
+        }
+    }
+}
+
+
+/**
+ * A cache whose board file has changed is not loaded
+ */
+BOOST_AUTO_TEST_CASE( ModifiedBoardFile )
+{
+    MAPPED_FILE_LINE_READER fileReader( boardFile );
+    std::string             modified( fileReader.Data(), fileReader.Size() );
+    ZONE_FILL_CACHE         cache;
+
+    modified.back() = ' ';
+
+    BOOST_CHECK( !cache.Load( boardFile, modified.data(), modified.size() ) );
+    BOOST_CHECK( !cache.Contains( board.Zones()[0]->m_Uuid ) );
+}
+
+
+/**
+ * A cache with a faulty entry is not loaded at all, as the parser skips the fills of the
+ * board file for every zone found in the cache
+ */
+BOOST_AUTO_TEST_CASE( FaultyEntry )
+{
+    wxFileName  cacheFile( boardFile );
+    std::string data;
+
+    cacheFile.SetExt( ZoneFillCacheFileExtension );
+
+    {
+        wxFFile file( cacheFile.GetFullPath(), "rb" );
+
+        BOOST_REQUIRE( file.IsOpened() );
+        data.resize( (size_t) file.Length() );
+        BOOST_REQUIRE( file.Read( &data[0], data.size() ) == data.size() );
+    }
+
+    // The last byte of the last entry now starts a number which does not end in the entry
+    data.back() = (char) 0x80;
+
+    {
+        wxFFile file( cacheFile.GetFullPath(), "wb" );
+
+        BOOST_REQUIRE( file.Write( data.data(), data.size() ) == data.size() );
+    }
+
+    MAPPED_FILE_LINE_READER fileReader( boardFile );
+    ZONE_FILL_CACHE         cache;
+
+    BOOST_CHECK( !cache.Load( boardFile, fileReader.Data(), fileReader.Size() ) );
+
+    for( const ZONE_CONTAINER* zone : board.Zones() )
+        BOOST_CHECK( !cache.Contains( zone->m_Uuid ) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
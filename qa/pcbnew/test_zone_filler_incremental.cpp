@@ -0,0 +1,195 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_zone_filler_incremental.cpp
+ * Checks that in incremental mode ZONE_FILLER refills the zones which the dirty areas can
+ * affect, and only them.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <class_board.h>
+#include <class_track.h>
+#include <class_zone.h>
+#include <netinfo.h>
+#include <zone_filler.h>
+
+#include "board_test_utils.h"
+
+
+struct ZONE_INCREMENTAL_FIXTURE
+{
+    ZONE_INCREMENTAL_FIXTURE()
+    {
+        // A 100 x 40 mm board, with a GND zone on each side of a 10 mm gap
+        gnd = new NETINFO_ITEM( &board, "GND", 1 );
+        sig = new NETINFO_ITEM( &board, "SIG", 2 );
+
+        board.Add( gnd );
+        board.Add( sig );
+
+        KI_TEST::AddBoardOutline( board, wxSize( Millimeter2iu( 100 ), Millimeter2iu( 40 ) ) );
+
+        left = addZone( 0, 45 );
+        right = addZone( 55, 100 );
+
+        board.BuildConnectivity();
+
+        ZONE_FILLER filler( &board );
+
+        BOOST_REQUIRE( filler.Fill( board.Zones() ) );
+
+        // SIG tracks added behind the filler's back: a zone was refilled if and only if its
+        // fill no longer covers its witness
+        leftWitness = addTrack( KI_TEST::MmPoint( 20, 5 ), KI_TEST::MmPoint( 20, 15 ) );
+        rightWitness = addTrack( KI_TEST::MmPoint( 80, 5 ), KI_TEST::MmPoint( 80, 15 ) );
+
+        BOOST_REQUIRE( !refilled( left, leftWitness ) );
+        BOOST_REQUIRE( !refilled( right, rightWitness ) );
+    }
+
+    ///> Adds a GND zone over the height of the board, from @a aLeft to @a aRight in mm
+    ZONE_CONTAINER* addZone( double aLeft, double aRight )
+    {
+        ZONE_CONTAINER* zone = new ZONE_CONTAINER( &board );
+
+        zone->SetLayer( F_Cu );
+        zone->SetNet( gnd );
+        zone->SetMinThickness( Millimeter2iu( 0.25 ) );
+        zone->AppendCorner( KI_TEST::MmPoint( aLeft, 0 ), -1 );
+        zone->AppendCorner( KI_TEST::MmPoint( aRight, 0 ), -1 );
+        zone->AppendCorner( KI_TEST::MmPoint( aRight, 40 ), -1 );
+        zone->AppendCorner( KI_TEST::MmPoint( aLeft, 40 ), -1 );
+        board.Add( zone );
+
+        return zone;
+    }
+
+    TRACK* addTrack( const wxPoint& aStart, const wxPoint& aEnd )
+    {
+        return KI_TEST::AddTrack( board, aStart, aEnd, Millimeter2iu( 0.5 ), sig );
+    }
+
+    ///> The area BOARD_COMMIT records for a change of @a aTrack
+    static EDA_RECT dirtyArea( TRACK* aTrack )
+    {
+        EDA_RECT area = aTrack->GetBoundingBox();
+
+        area.Inflate( aTrack->GetClearance() );
+        return area;
+    }
+
+    static bool refilled( const ZONE_CONTAINER* aZone, const TRACK* aWitness )
+    {
+        return !aZone->GetFilledPolysList().Contains( VECTOR2I( aWitness->GetStart() ) );
+    }
+
+    ///> Fills the zones in incremental mode, with @a aAreas as dirty areas
+    void fill( const std::vector<EDA_RECT>& aAreas )
+    {
+        ZONE_FILLER filler( &board );
+
+        filler.SetDirtyAreas( aAreas );
+        BOOST_REQUIRE( filler.Fill( board.Zones() ) );
+    }
+
+    BOARD           board;
+    NETINFO_ITEM*   gnd;
+    NETINFO_ITEM*   sig;
+    ZONE_CONTAINER* left;
+    ZONE_CONTAINER* right;
+    TRACK*          leftWitness;
+    TRACK*          rightWitness;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( ZoneFillerIncremental, ZONE_INCREMENTAL_FIXTURE )
+
+
+/**
+ * Filled zones are kept when there is no dirty area
+ */
+BOOST_AUTO_TEST_CASE( NoDirtyArea )
+{
+    fill( {} );
+
+    BOOST_CHECK( !refilled( left, leftWitness ) );
+    BOOST_CHECK( !refilled( right, rightWitness ) );
+}
+
+
+/**
+ * Only the zone under a dirty area is refilled, and it gets the fill of a full refill
+ */
+BOOST_AUTO_TEST_CASE( DirtyZoneOnly )
+{
+    fill( { dirtyArea( rightWitness ) } );
+
+    BOOST_CHECK( !refilled( left, leftWitness ) );
+    BOOST_CHECK( refilled( right, rightWitness ) );
+
+    SHAPE_POLY_SET incremental = right->GetFilledPolysList();
+    ZONE_FILLER    filler( &board );
+
+    BOOST_REQUIRE( filler.Fill( board.Zones() ) );
+
+    BOOST_CHECK( refilled( left, leftWitness ) );
+    BOOST_CHECK_CLOSE( incremental.Area(), right->GetFilledPolysList().Area(), 1e-6 );
+}
+
+
+/**
+ * A change outside of a zone but within its clearance refills it, a change further away
+ * does not
+ */
+BOOST_AUTO_TEST_CASE( ClearanceMargin )
+{
+    // In the gap, 0.1 mm from the left zone and 9.9 mm from the right one
+    EDA_RECT nearLeft( KI_TEST::MmPoint( 45.1, 20 ),
+                       wxSize( Millimeter2iu( 0.1 ), Millimeter2iu( 0.1 ) ) );
+
+    fill( { nearLeft } );
+
+    BOOST_CHECK( refilled( left, leftWitness ) );
+    BOOST_CHECK( !refilled( right, rightWitness ) );
+}
+
+
+/**
+ * Zones which are not filled or are flagged for a refill are filled whatever the dirty areas
+ */
+BOOST_AUTO_TEST_CASE( UnfilledZones )
+{
+    left->UnFill();
+    right->SetNeedRefill( true );
+
+    fill( {} );
+
+    BOOST_CHECK( left->IsFilled() );
+    BOOST_CHECK( refilled( left, leftWitness ) );
+    BOOST_CHECK( refilled( right, rightWitness ) );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,193 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file test_zone_filler_tiles.cpp
+ * Checks that large copper zones filled as several tiles get the fill they get as a whole.
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <class_board.h>
+#include <class_drawsegment.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_zone.h>
+#include <netinfo.h>
+#include <zone_filler.h>
+
+#include "board_test_utils.h"
+
+
+struct ZONE_TILES_FIXTURE
+{
+    ZONE_TILES_FIXTURE()
+    {
+        // A 100 x 60 mm board, filled by a GND zone.  It is split in at most 5 x 3 tiles of
+        // at least 20 mm, depending on the number of threads.
+        NETINFO_ITEM* gnd = new NETINFO_ITEM( &board, "GND", 1 );
+        NETINFO_ITEM* sig = new NETINFO_ITEM( &board, "SIG", 2 );
+
+        board.Add( gnd );
+        board.Add( sig );
+
+        ZONE_CONTAINER* zone = new ZONE_CONTAINER( &board );
+
+        zone->SetLayer( F_Cu );
+        zone->SetNet( gnd );
+        zone->SetMinThickness( Millimeter2iu( 0.25 ) );
+        zone->SetPadConnection( ZONE_CONNECTION::THERMAL );
+
+        const wxSize size( Millimeter2iu( 100 ), Millimeter2iu( 60 ) );
+
+        for( DRAWSEGMENT* edge : KI_TEST::AddBoardOutline( board, size ) )
+            zone->AppendCorner( edge->GetStart(), -1 );
+
+        board.Add( zone );
+
+        // GND pads on every possible tile border, so their thermal spokes cross it
+        MODULE* module = new MODULE( &board );
+
+        board.Add( module );
+
+        for( double fraction : { 1.0 / 5, 1.0 / 4, 1.0 / 3, 2.0 / 5, 1.0 / 2, 3.0 / 5, 2.0 / 3,
+                                 3.0 / 4, 4.0 / 5 } )
+        {
+            addPad( module, gnd, wxPoint( KiROUND( size.x * fraction ), Millimeter2iu( 10 ) ) );
+        }
+
+        for( double fraction : { 1.0 / 3, 1.0 / 2, 2.0 / 3 } )
+            addPad( module, gnd, wxPoint( Millimeter2iu( 10 ), KiROUND( size.y * fraction ) ) );
+
+        // On the corner of four tiles
+        addPad( module, gnd, KI_TEST::MmPoint( 50, 30 ) );
+
+        // Two rings of SIG tracks with no GND pad inside: the islands they insulate cross the
+        // tile borders in both directions, and must be removed
+        addRing( sig, KI_TEST::MmPoint( 3, 44 ), KI_TEST::MmPoint( 97, 55 ) );
+        addRing( sig, KI_TEST::MmPoint( 55, 14 ), KI_TEST::MmPoint( 64, 41 ) );
+
+        islandPoints = { KI_TEST::MmPoint( 50, 49.5 ), KI_TEST::MmPoint( 20, 49.5 ),
+                         KI_TEST::MmPoint( 59.5, 20 ), KI_TEST::MmPoint( 59.5, 35 ) };
+
+        board.BuildConnectivity();
+    }
+
+    void addPad( MODULE* aModule, NETINFO_ITEM* aNet, const wxPoint& aPos )
+    {
+        pads.push_back( KI_TEST::AddSmdPad( *aModule, aNet, aPos ) );
+    }
+
+    void addRing( NETINFO_ITEM* aNet, const wxPoint& aMin, const wxPoint& aMax )
+    {
+        const wxPoint corners[] = { aMin, { aMax.x, aMin.y }, aMax, { aMin.x, aMax.y } };
+
+        for( int ii = 0; ii < 4; ii++ )
+        {
+            KI_TEST::AddTrack( board, corners[ii], corners[( ii + 1 ) % 4], Millimeter2iu( 0.5 ),
+                               aNet );
+        }
+    }
+
+    ///> Fills the zone, and returns its fill
+    SHAPE_POLY_SET fill( bool aTiling )
+    {
+        ZONE_FILLER filler( &board );
+
+        filler.SetTiling( aTiling );
+        BOOST_REQUIRE( filler.Fill( board.Zones() ) );
+
+        return board.Zones()[0]->GetFilledPolysList();
+    }
+
+    BOARD                board;
+    std::vector<D_PAD*>  pads;
+    std::vector<wxPoint> islandPoints;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( ZoneFillerTiles, ZONE_TILES_FIXTURE )
+
+
+/**
+ * The tiled fill covers the same copper as the whole zone fill, with the same thermal spokes
+ * and the same islands removed
+ */
+BOOST_AUTO_TEST_CASE( SameFill )
+{
+    SHAPE_POLY_SET whole = fill( false );
+    SHAPE_POLY_SET tiled = fill( true );
+
+    BOOST_REQUIRE( !whole.IsEmpty() );
+
+    // 0.001 mm2, the tile borders only add colinear vertices
+    const double tolerance = 1e-3 * Millimeter2iu( 1 ) * Millimeter2iu( 1 );
+
+    BOOST_CHECK_CLOSE( tiled.Area(), whole.Area(), 1e-4 );
+
+    SHAPE_POLY_SET onlyWhole = whole;
+    SHAPE_POLY_SET onlyTiled = tiled;
+
+    onlyWhole.BooleanSubtract( tiled, SHAPE_POLY_SET::PM_FAST );
+    onlyTiled.BooleanSubtract( whole, SHAPE_POLY_SET::PM_FAST );
+
+    BOOST_CHECK_LT( onlyWhole.Area(), tolerance );
+    BOOST_CHECK_LT( onlyTiled.Area(), tolerance );
+
+    // Merging the fractured outlines gives one outline per copper area
+    whole.Simplify( SHAPE_POLY_SET::PM_FAST );
+    tiled.Simplify( SHAPE_POLY_SET::PM_FAST );
+
+    BOOST_CHECK_EQUAL( tiled.OutlineCount(), whole.OutlineCount() );
+
+    for( const wxPoint& pt : islandPoints )
+    {
+        BOOST_TEST_CONTEXT( "Island point " << pt.x << ", " << pt.y )
+        {
+            BOOST_CHECK( !whole.Contains( pt ) );
+            BOOST_CHECK( !tiled.Contains( pt ) );
+        }
+    }
+
+    // The pads are connected to the zone by their thermal spokes, in the 4 directions
+    const ZONE_CONTAINER* zone = board.Zones()[0];
+
+    for( D_PAD* pad : pads )
+    {
+        int reach = pad->GetSize().x / 2 + zone->GetThermalReliefGap( pad ) / 2;
+
+        for( const wxPoint& dir : { wxPoint( 1, 0 ), wxPoint( -1, 0 ), wxPoint( 0, 1 ),
+                                    wxPoint( 0, -1 ) } )
+        {
+            wxPoint spoke = pad->GetPosition() + dir * reach;
+
+            BOOST_TEST_CONTEXT( "Spoke point " << spoke.x << ", " << spoke.y )
+            {
+                BOOST_CHECK( whole.Contains( spoke ) );
+                BOOST_CHECK( tiled.Contains( spoke ) );
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,300 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file pns_index_bench.cpp
+ * Measures the throughput of the obstacle queries of the router on a board: the queries of
+ * PNS::INDEX, compared with the per-layer R-trees it used to be made of, and the full
+ * NODE::QueryColliding() calls of the router.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <set>
+
+#include <common.h>
+#include <profile.h>
+
+#include <wx/cmdline.h>
+
+#include <class_board.h>
+#include <geometry/shape_index.h>
+#include <router/pns_index.h>
+#include <router/pns_kicad_iface.h>
+#include <router/pns_node.h>
+#include <router/pns_router.h>
+
+#include <pcbnew_utils/board_file_utils.h>
+#include <qa_utils/utility_registry.h>
+
+
+/**
+ * The spatial index of the router before PNS::INDEX used grids: one R-tree per layer, with
+ * the same assignment of the items to the subindices.
+ */
+class RTREE_INDEX
+{
+public:
+    void Add( PNS::ITEM* aItem )
+    {
+        m_subIndices[subindex( aItem )].Add( aItem );
+    }
+
+    template <class Visitor>
+    int Query( const PNS::ITEM* aItem, int aMinDistance, Visitor& aVisitor )
+    {
+        const SHAPE*       shape = aItem->Shape();
+        const LAYER_RANGE& layers = aItem->Layers();
+        int                total = querySingle( SI_Multilayer, shape, aMinDistance, aVisitor );
+
+        if( layers.IsMultilayer() )
+        {
+            total += querySingle( SI_PadsTop, shape, aMinDistance, aVisitor );
+            total += querySingle( SI_PadsBottom, shape, aMinDistance, aVisitor );
+
+            for( int i = layers.Start(); i <= layers.End(); ++i )
+                total += querySingle( SI_Traces + 2 * i + 1, shape, aMinDistance, aVisitor );
+        }
+        else
+        {
+            int l = layers.Start();
+
+            if( l == B_Cu )
+                total += querySingle( SI_PadsTop, shape, aMinDistance, aVisitor );
+            else if( l == F_Cu )
+                total += querySingle( SI_PadsBottom, shape, aMinDistance, aVisitor );
+
+            total += querySingle( SI_Traces + 2 * l + 1, shape, aMinDistance, aVisitor );
+        }
+
+        return total;
+    }
+
+private:
+    static const int SI_PadsTop = 0;
+    static const int SI_PadsBottom = 1;
+    static const int SI_Multilayer = 2;
+    static const int SI_Traces = 3;
+
+    static int subindex( const PNS::ITEM* aItem )
+    {
+        const LAYER_RANGE& l = aItem->Layers();
+
+        if( aItem->Kind() == PNS::ITEM::VIA_T )
+            return SI_Multilayer;
+
+        if( aItem->Kind() == PNS::ITEM::SOLID_T )
+        {
+            if( l.IsMultilayer() )
+                return SI_Multilayer;
+            else if( l.Start() == B_Cu )
+                return SI_PadsTop;
+            else if( l.Start() == F_Cu )
+                return SI_PadsBottom;
+        }
+
+        return SI_Traces + 2 * l.Start() + 1;
+    }
+
+    template <class Visitor>
+    int querySingle( int aIndex, const SHAPE* aShape, int aMinDistance, Visitor& aVisitor )
+    {
+        auto it = m_subIndices.find( aIndex );
+
+        if( it == m_subIndices.end() )
+            return 0;
+
+        return it->second.Query( aShape, aMinDistance, aVisitor, false );
+    }
+
+    std::map<int, SHAPE_INDEX<PNS::ITEM*>> m_subIndices;
+};
+
+
+///> Counts the candidates of a query, as a cheap stand-in for the collision checks
+struct COUNTING_VISITOR
+{
+    bool operator()( PNS::ITEM* aItem )
+    {
+        m_count++;
+        return true;
+    }
+
+    long m_count = 0;
+};
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    {
+            wxCMD_LINE_SWITCH,
+            "h",
+            "help",
+            _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE,
+            wxCMD_LINE_OPTION_HELP,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "r",
+            "repeat",
+            _( "number of times each query is repeated (default 10)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER,
+    },
+    {
+            wxCMD_LINE_PARAM,
+            nullptr,
+            nullptr,
+            _( "input file" ).mb_str(),
+            wxCMD_LINE_VAL_STRING,
+            wxCMD_LINE_PARAM_OPTIONAL,
+    },
+    { wxCMD_LINE_NONE }
+};
+
+
+/**
+ * Tool=specific return codes
+ */
+enum PARSER_RET_CODES
+{
+    PARSE_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+};
+
+
+static void showThroughput( const std::string& aName, PROF_COUNTER& aCounter, long aQueries,
+                            long aFound )
+{
+    double ms = aCounter.msecs();
+
+    std::cout << aName << ": " << aQueries << " queries, " << aFound << " found in " << ms
+              << " ms, " << (long) ( aQueries / std::max( ms, 1e-3 ) * 1000.0 ) << " queries/s"
+              << std::endl;
+}
+
+
+int pns_index_bench_main_func( int argc, char** argv )
+{
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText( _( "This program measures the obstacle queries of the router "
+                               "on the tracks, vias and pads of a PCB file." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        return ( cmd_parsed_ok == -1 ) ? KI_TEST::RET_CODES::OK : KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    long repeat = 10;
+    cl_parser.Found( "repeat", &repeat );
+
+    std::string filename;
+
+    if( cl_parser.GetParamCount() )
+        filename = cl_parser.GetParam( 0 ).ToStdString();
+
+    std::unique_ptr<BOARD> board = KI_TEST::ReadBoardFromFileOrStream( filename );
+
+    if( !board )
+        return PARSER_RET_CODES::PARSE_FAILED;
+
+    PNS::ROUTER          router;
+    PNS_KICAD_IFACE_BASE iface;
+
+    iface.SetBoard( board.get() );
+    router.SetInterface( &iface );
+    router.SyncWorld();
+
+    PNS::NODE*           world = router.GetWorld();
+    std::set<PNS::ITEM*> items;
+
+    for( int net = 0; net < (int) board->GetNetCount(); net++ )
+        world->AllItemsInNet( net, items );
+
+    PNS::INDEX  gridIndex;
+    RTREE_INDEX rtreeIndex;
+
+    for( PNS::ITEM* item : items )
+    {
+        gridIndex.Add( item );
+        rtreeIndex.Add( item );
+    }
+
+    const int clearance = world->GetMaxClearance();
+    const long queries = repeat * (long) items.size();
+
+    std::cout << items.size() << " items, query distance " << clearance << std::endl;
+
+    COUNTING_VISITOR rtreeVisitor;
+    PROF_COUNTER     rtreeCounter( "rtree" );
+
+    for( long ii = 0; ii < repeat; ii++ )
+    {
+        for( PNS::ITEM* item : items )
+            rtreeIndex.Query( item, clearance, rtreeVisitor );
+    }
+
+    rtreeCounter.Stop();
+    showThroughput( "R-tree index", rtreeCounter, queries, rtreeVisitor.m_count );
+
+    COUNTING_VISITOR gridVisitor;
+    PROF_COUNTER     gridCounter( "grid" );
+
+    for( long ii = 0; ii < repeat; ii++ )
+    {
+        for( PNS::ITEM* item : items )
+            gridIndex.Query( item, clearance, gridVisitor );
+    }
+
+    gridCounter.Stop();
+    showThroughput( "PNS::INDEX", gridCounter, queries, gridVisitor.m_count );
+
+    if( gridVisitor.m_count != rtreeVisitor.m_count )
+        std::cout << "Warning: the indexes found different candidates" << std::endl;
+
+    // The obstacle queries of the router, with the collision checks
+    long             obstacles = 0;
+    PROF_COUNTER     nodeCounter( "node" );
+
+    for( long ii = 0; ii < repeat; ii++ )
+    {
+        for( PNS::ITEM* item : items )
+        {
+            PNS::NODE::OBSTACLES found;
+            obstacles += world->QueryColliding( item, found );
+        }
+    }
+
+    nodeCounter.Stop();
+    showThroughput( "NODE::QueryColliding", nodeCounter, queries, obstacles );
+
+    return KI_TEST::RET_CODES::OK;
+}
+
+
+static bool registered = UTILITY_REGISTRY::Register( { "pns_index_bench",
+        "Measure the obstacle queries of the router on a PCB", pns_index_bench_main_func } );
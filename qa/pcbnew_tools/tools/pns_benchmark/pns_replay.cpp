@@ -0,0 +1,357 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file pns_replay.cpp
+ * Replays the events of the interactive router recorded by PNS::LOGGER on a board, without
+ * GUI, and measures the latency of each event.
+ *
+ * The events are recorded by pcbnew when the RecordRouterEvents advanced option is set, and
+ * saved with the logs of the router to the temporary directory by the '0' key.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <map>
+
+#include <common.h>
+#include <profile.h>
+
+#include <wx/cmdline.h>
+
+#include <class_board.h>
+#include <router/pns_debug_decorator.h>
+#include <router/pns_kicad_iface.h>
+#include <router/pns_logger.h>
+#include <router/pns_node.h>
+#include <router/pns_router.h>
+#include <router/pns_routing_settings.h>
+#include <router/pns_sizes_settings.h>
+
+#include <pcbnew_utils/board_file_utils.h>
+#include <qa_utils/utility_registry.h>
+
+
+using EVENT = PNS::LOGGER::EVENT_ENTRY;
+
+
+///> Latencies and branch counts of the replayed events of a type
+struct EVENT_STATS
+{
+    std::vector<double> m_msecs;
+    long                m_branches = 0;
+    int                 m_maxBranches = 0;
+};
+
+
+static const char* eventName( PNS::LOGGER::EVENT_TYPE aType )
+{
+    switch( aType )
+    {
+    case PNS::LOGGER::EVT_START_ROUTE:  return "start route";
+    case PNS::LOGGER::EVT_START_DRAG:   return "start drag";
+    case PNS::LOGGER::EVT_MOVE:         return "move";
+    case PNS::LOGGER::EVT_FIX:          return "fix";
+    case PNS::LOGGER::EVT_UNFIX:        return "unfix";
+    case PNS::LOGGER::EVT_COMMIT:       return "commit";
+    case PNS::LOGGER::EVT_STOP:         return "stop";
+    case PNS::LOGGER::EVT_SWITCH_LAYER: return "switch layer";
+    case PNS::LOGGER::EVT_TOGGLE_VIA:   return "toggle via";
+    case PNS::LOGGER::EVT_FLIP_POSTURE: return "flip posture";
+    default:                            return "unknown";
+    }
+}
+
+
+/**
+ * Finds the router items of the board items of an event.  The items created during the
+ * recorded session have different identifiers on the board being replayed, so the start
+ * items which are not found are picked at the position of the event, like the router tool
+ * does.
+ */
+static PNS::ITEM_SET eventItems( BOARD* aBoard, PNS::ROUTER& aRouter, const EVENT& aEvent )
+{
+    PNS::ITEM_SET items;
+
+    for( const KIID& uuid : aEvent.m_Items )
+    {
+        auto parent = dynamic_cast<BOARD_CONNECTED_ITEM*>( aBoard->GetItem( uuid ) );
+
+        if( PNS::ITEM* item = parent ? aRouter.GetWorld()->FindItemByParent( parent ) : nullptr )
+            items.Add( item );
+    }
+
+    bool isStart = aEvent.m_Type == PNS::LOGGER::EVT_START_ROUTE
+                   || aEvent.m_Type == PNS::LOGGER::EVT_START_DRAG;
+
+    if( isStart && items.Empty() && !aEvent.m_Items.empty() )
+    {
+        PNS::ITEM_SET candidates = aRouter.QueryHoverItems( aEvent.m_Pos );
+
+        for( PNS::ITEM* item : candidates.Items() )
+        {
+            if( aEvent.m_Type == PNS::LOGGER::EVT_START_ROUTE
+                    && !item->Layers().Overlaps( aEvent.m_Arg ) )
+                continue;
+
+            if( aEvent.m_Type == PNS::LOGGER::EVT_START_DRAG
+                    && !item->OfKind( PNS::ITEM::SEGMENT_T | PNS::ITEM::ARC_T
+                                      | PNS::ITEM::VIA_T ) )
+                continue;
+
+            items.Add( item );
+            break;
+        }
+    }
+
+    return items;
+}
+
+
+static void replayEvent( BOARD* aBoard, PNS::ROUTER& aRouter, const EVENT& aEvent )
+{
+    PNS::ITEM_SET items = eventItems( aBoard, aRouter, aEvent );
+    PNS::ITEM*    item = items.Empty() ? nullptr : items[0];
+
+    switch( aEvent.m_Type )
+    {
+    case PNS::LOGGER::EVT_START_ROUTE:
+    {
+        PNS::SIZES_SETTINGS sizes( aRouter.Sizes() );
+
+        sizes.Init( aBoard, item );
+        sizes.AddLayerPair( F_Cu, B_Cu );
+        aRouter.UpdateSizes( sizes );
+        aRouter.StartRouting( aEvent.m_Pos, item, aEvent.m_Arg );
+        break;
+    }
+
+    case PNS::LOGGER::EVT_START_DRAG:
+        aRouter.StartDragging( aEvent.m_Pos, items, aEvent.m_Arg );
+        break;
+
+    case PNS::LOGGER::EVT_MOVE:
+        aRouter.Move( aEvent.m_Pos, item );
+        break;
+
+    case PNS::LOGGER::EVT_FIX:
+        aRouter.FixRoute( aEvent.m_Pos, item, aEvent.m_Arg != 0 );
+        break;
+
+    case PNS::LOGGER::EVT_UNFIX:
+        aRouter.UndoLastSegment();
+        break;
+
+    case PNS::LOGGER::EVT_COMMIT:
+        aRouter.CommitRouting();
+        break;
+
+    case PNS::LOGGER::EVT_STOP:
+        aRouter.StopRouting();
+        break;
+
+    case PNS::LOGGER::EVT_SWITCH_LAYER:
+        aRouter.SwitchLayer( aEvent.m_Arg );
+        break;
+
+    case PNS::LOGGER::EVT_TOGGLE_VIA:
+        aRouter.ToggleViaPlacement();
+        break;
+
+    case PNS::LOGGER::EVT_FLIP_POSTURE:
+        aRouter.FlipPosture();
+        break;
+
+    default:
+        break;
+    }
+}
+
+
+///> The nearest-rank percentile aPercent of the sorted latencies aMsecs
+static double percentile( const std::vector<double>& aMsecs, double aPercent )
+{
+    size_t rank = (size_t) std::ceil( aPercent / 100.0 * aMsecs.size() );
+
+    return aMsecs[std::min( std::max<size_t>( rank, 1 ), aMsecs.size() ) - 1];
+}
+
+
+static void showStats( const std::string& aName, EVENT_STATS& aStats )
+{
+    std::vector<double>& msecs = aStats.m_msecs;
+
+    if( msecs.empty() )
+        return;
+
+    std::sort( msecs.begin(), msecs.end() );
+
+    std::cout << std::setw( 14 ) << aName << std::setw( 8 ) << msecs.size() << std::fixed
+              << std::setprecision( 3 ) << std::setw( 10 ) << percentile( msecs, 50 )
+              << std::setw( 10 ) << percentile( msecs, 90 ) << std::setw( 10 )
+              << percentile( msecs, 99 ) << std::setw( 10 ) << msecs.back()
+              << std::setprecision( 1 ) << std::setw( 10 )
+              << (double) aStats.m_branches / msecs.size() << std::setw( 10 )
+              << aStats.m_maxBranches << std::defaultfloat << std::endl;
+}
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    {
+            wxCMD_LINE_SWITCH,
+            "h",
+            "help",
+            _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE,
+            wxCMD_LINE_OPTION_HELP,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "m",
+            "mode",
+            _( "routing mode: shove, walkaround or mark (default shove)" ).mb_str(),
+            wxCMD_LINE_VAL_STRING,
+    },
+    {
+            wxCMD_LINE_PARAM,
+            nullptr,
+            nullptr,
+            _( "board file" ).mb_str(),
+            wxCMD_LINE_VAL_STRING,
+    },
+    {
+            wxCMD_LINE_PARAM,
+            nullptr,
+            nullptr,
+            _( "event log file" ).mb_str(),
+            wxCMD_LINE_VAL_STRING,
+    },
+    { wxCMD_LINE_NONE }
+};
+
+
+/**
+ * Tool=specific return codes
+ */
+enum PARSER_RET_CODES
+{
+    PARSE_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+    LOG_READ_FAILED,
+};
+
+
+int pns_replay_main_func( int argc, char** argv )
+{
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText( _( "This program replays the events of the router recorded on a "
+                               "PCB file, and measures their latency." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        return ( cmd_parsed_ok == -1 ) ? KI_TEST::RET_CODES::OK : KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    PNS_MODE mode = RM_Shove;
+    wxString modeName;
+
+    if( cl_parser.Found( "mode", &modeName ) )
+    {
+        if( modeName == "walkaround" )
+            mode = RM_Walkaround;
+        else if( modeName == "mark" )
+            mode = RM_MarkObstacles;
+        else if( modeName != "shove" )
+            return KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    std::vector<EVENT> events;
+
+    if( !PNS::LOGGER::LoadEvents( cl_parser.GetParam( 1 ).ToStdString(), events ) )
+        return PARSER_RET_CODES::LOG_READ_FAILED;
+
+    std::unique_ptr<BOARD> board =
+            KI_TEST::ReadBoardFromFileOrStream( cl_parser.GetParam( 0 ).ToStdString() );
+
+    if( !board )
+        return PARSER_RET_CODES::PARSE_FAILED;
+
+    PNS_KICAD_IFACE_BASE  iface;
+    PNS::ROUTER           router;
+    ROUTING_SETTINGS      settings( nullptr, "pns" );
+
+    settings.SetMode( mode );
+
+    iface.SetBoard( board.get() );
+    iface.SetDebugDecorator( new PNS::DEBUG_DECORATOR );
+    router.SetInterface( &iface );
+    router.LoadSettings( &settings );
+    router.SyncWorld();
+
+    std::map<PNS::LOGGER::EVENT_TYPE, EVENT_STATS> stats;
+    EVENT_STATS                                    all;
+
+    for( const EVENT& event : events )
+    {
+        PROF_COUNTER counter( eventName( event.m_Type ) );
+
+        replayEvent( board.get(), router, event );
+        counter.Stop();
+
+        // The branches left behind by the event, which the next events have to go through
+        int branches = router.GetWorld()->BranchCount();
+
+        for( EVENT_STATS* eventStats : { &stats[event.m_Type], &all } )
+        {
+            eventStats->m_msecs.push_back( counter.msecs() );
+            eventStats->m_branches += branches;
+            eventStats->m_maxBranches = std::max( eventStats->m_maxBranches, branches );
+        }
+    }
+
+    router.StopRouting();
+
+    std::cout << events.size() << " events, latencies in ms" << std::endl;
+    std::cout << std::setw( 14 ) << "event" << std::setw( 8 ) << "count" << std::setw( 10 )
+              << "p50" << std::setw( 10 ) << "p90" << std::setw( 10 ) << "p99" << std::setw( 10 )
+              << "max" << std::setw( 10 ) << "branches" << std::setw( 10 ) << "max br."
+              << std::endl;
+
+    for( auto& eventStats : stats )
+        showStats( eventName( eventStats.first ), eventStats.second );
+
+    showStats( "all", all );
+
+    return KI_TEST::RET_CODES::OK;
+}
+
+
+static bool registered = UTILITY_REGISTRY::Register( { "pns_replay",
+        "Replay the events of the router recorded on a PCB, and measure their latency",
+        pns_replay_main_func } );